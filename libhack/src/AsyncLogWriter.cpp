@@ -0,0 +1,326 @@
+/**
+ * @file libhack/src/AsyncLogWriter.cpp
+ * @ingroup libhack
+ *
+ * @author COMP Omega <compomega@tutanota.com>
+ *
+ * @brief Log hook that writes log messages to a file from its own thread.
+ *
+ * This file is part of the COMP_hack Library (libhack).
+ *
+ * Copyright (C) 2012-2020 COMP_hack Team <compomega@tutanota.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "AsyncLogWriter.h"
+
+// Standard C++11 Includes
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <utility>
+
+// libhack Includes
+#include "Log.h"
+
+using namespace libhack;
+
+/// Number of queued messages that wakes the writer before the interval
+static const size_t BATCH_WAKE_SIZE = 256;
+
+/// Longest time a message waits in the queue before it is written
+static const std::chrono::milliseconds FLUSH_INTERVAL(100);
+
+/// ID of the next writer created
+static std::atomic<uint64_t> gNextWriterID(1);
+
+/// Rings of the current thread by the ID of the writer they belong to
+static thread_local std::vector<std::pair<uint64_t, void*>> tRings;
+
+AsyncLogWriter::Ring::Ring(size_t capacity)
+    : Slots(capacity), Mask(capacity - 1), Head(0), Tail(0) {}
+
+AsyncLogWriter::AsyncLogWriter(const libcomp::String& path,
+                               size_t maxFileSize, size_t maxFiles,
+                               size_t queueSize, Policy_t policy)
+    : mPath(path.ToUtf8()),
+      mMaxFileSize(maxFileSize),
+      mMaxFiles(maxFiles),
+      mQueueSize(1),
+      mPolicy(policy),
+      mID(gNextWriterID++),
+      mSequence(0),
+      mQueued(0),
+      mDropped(0),
+      mDroppedWritten(0),
+      mStandardOutput(false),
+      mRunning(false),
+      mFileSize(0) {
+  while (mQueueSize < queueSize) {
+    mQueueSize <<= 1;
+  }
+}
+
+AsyncLogWriter::~AsyncLogWriter() { Stop(); }
+
+bool AsyncLogWriter::Open() {
+  if (mRunning) {
+    return true;
+  }
+
+  mFile.open(mPath, std::ios::out | std::ios::app | std::ios::binary);
+  if (!mFile.good()) {
+    return false;
+  }
+
+  mFile.seekp(0, std::ios::end);
+  mFileSize = (size_t)mFile.tellp();
+
+  mRunning = true;
+  mThread = std::thread([this]() { Run(); });
+
+  return true;
+}
+
+void AsyncLogWriter::Stop() {
+  {
+    std::lock_guard<std::mutex> lock(mWaitLock);
+    if (!mRunning) {
+      return;
+    }
+
+    mRunning = false;
+  }
+
+  mWriteReady.notify_one();
+  mSpaceReady.notify_all();
+
+  if (mThread.joinable()) {
+    mThread.join();
+  }
+
+  mFile.close();
+}
+
+void AsyncLogWriter::SetStandardOutput(bool enabled) {
+  mStandardOutput = enabled;
+}
+
+void AsyncLogWriter::AddHook(libcomp::BaseLog* log) {
+  auto self = shared_from_this();
+  log->AddLogHook([self](libcomp::GenericLogComponent_t comp,
+                         libcomp::BaseLog::Level_t level,
+                         const libcomp::String& msg) {
+    self->Push(comp, level, msg);
+  });
+}
+
+void AsyncLogWriter::Push(libcomp::GenericLogComponent_t comp,
+                          libcomp::BaseLog::Level_t level,
+                          const libcomp::String& msg) {
+  if (!mRunning) {
+    mDropped++;
+    return;
+  }
+
+  auto ring = GetThreadRing();
+
+  size_t tail = ring->Tail.load(std::memory_order_relaxed);
+  if ((tail - ring->Head.load(std::memory_order_acquire)) > ring->Mask) {
+    if (mPolicy == Policy_t::DROP) {
+      mDropped++;
+      return;
+    }
+
+    std::unique_lock<std::mutex> lock(mWaitLock);
+    mWriteReady.notify_one();
+    mSpaceReady.wait(lock, [this, ring, tail]() {
+      return !mRunning ||
+             (tail - ring->Head.load(std::memory_order_acquire)) <=
+                 ring->Mask;
+    });
+    if (!mRunning) {
+      mDropped++;
+      return;
+    }
+  }
+
+  ring->Slots[tail & ring->Mask] =
+      Entry{mSequence++, std::time(nullptr), comp, level, msg};
+  ring->Tail.store(tail + 1, std::memory_order_release);
+
+  if (++mQueued == BATCH_WAKE_SIZE) {
+    mWriteReady.notify_one();
+  }
+}
+
+uint64_t AsyncLogWriter::GetDroppedCount() const { return mDropped; }
+
+void AsyncLogWriter::Run() {
+  std::vector<Entry> batch;
+
+  bool running = true;
+  while (running) {
+    {
+      std::unique_lock<std::mutex> lock(mWaitLock);
+      mWriteReady.wait_for(lock, FLUSH_INTERVAL, [this]() {
+        return !mRunning || mQueued >= BATCH_WAKE_SIZE;
+      });
+
+      running = mRunning;
+    }
+
+    // Once stopped, anything queued before the stop is still written
+    CollectBatch(batch);
+    if (batch.size() > 0) {
+      WriteBatch(batch);
+      batch.clear();
+    }
+  }
+}
+
+AsyncLogWriter::Ring* AsyncLogWriter::GetThreadRing() {
+  for (auto& pair : tRings) {
+    if (pair.first == mID) {
+      return static_cast<Ring*>(pair.second);
+    }
+  }
+
+  // First message from this thread, the ring is owned by the writer so it
+  // stays valid until the writer is destroyed
+  auto ring = std::make_shared<Ring>(mQueueSize);
+  {
+    std::lock_guard<std::mutex> lock(mRingsLock);
+    mRings.push_back(ring);
+  }
+
+  tRings.push_back(std::make_pair(mID, (void*)ring.get()));
+
+  return ring.get();
+}
+
+void AsyncLogWriter::CollectBatch(std::vector<Entry>& batch) {
+  std::vector<std::shared_ptr<Ring>> rings;
+  {
+    std::lock_guard<std::mutex> lock(mRingsLock);
+    rings = mRings;
+  }
+
+  for (auto& ring : rings) {
+    size_t head = ring->Head.load(std::memory_order_relaxed);
+    size_t tail = ring->Tail.load(std::memory_order_acquire);
+    for (; head != tail; head++) {
+      batch.push_back(std::move(ring->Slots[head & ring->Mask]));
+    }
+
+    ring->Head.store(tail, std::memory_order_release);
+  }
+
+  if (batch.size() > 0) {
+    mQueued -= batch.size();
+    {
+      // Take the lock so a blocked caller can not miss the signal
+      std::lock_guard<std::mutex> lock(mWaitLock);
+    }
+    mSpaceReady.notify_all();
+
+    // Each ring is already in order so only the merge order is restored
+    std::sort(batch.begin(), batch.end(),
+              [](const Entry& a, const Entry& b) {
+                return a.Sequence < b.Sequence;
+              });
+  }
+}
+
+void AsyncLogWriter::WriteBatch(const std::vector<Entry>& batch) {
+  std::string out;
+
+  uint64_t dropped = mDropped;
+  if (dropped != mDroppedWritten) {
+    out += libcomp::String("%1 log messages were dropped\n")
+               .Arg(dropped - mDroppedWritten)
+               .ToUtf8();
+    mDroppedWritten = dropped;
+  }
+
+  char stamp[32];
+  for (auto& entry : batch) {
+    std::strftime(stamp, sizeof(stamp), "%Y/%m/%d %H:%M:%S ",
+                  std::localtime(&entry.Time));
+    out += stamp;
+
+    switch (entry.Level) {
+      case libcomp::BaseLog::Level_t::LOG_LEVEL_DEBUG:
+        out += "DEBUG ";
+        break;
+      case libcomp::BaseLog::Level_t::LOG_LEVEL_INFO:
+        out += "INFO ";
+        break;
+      case libcomp::BaseLog::Level_t::LOG_LEVEL_WARNING:
+        out += "WARNING ";
+        break;
+      case libcomp::BaseLog::Level_t::LOG_LEVEL_ERROR:
+        out += "ERROR ";
+        break;
+      case libcomp::BaseLog::Level_t::LOG_LEVEL_CRITICAL:
+      default:
+        out += "CRITICAL ";
+        break;
+    }
+
+    // Use the free functions so the log singleton is never recreated
+    // while the writer drains during shutdown
+    libcomp::String compName =
+        entry.Component >= LOG_SERVER_SPECIFIC_START_ID
+            ? libhack::LogComponentToString(entry.Component)
+            : libcomp::BaseLogComponentToString(entry.Component);
+    out += compName.ToUtf8();
+    out += ": ";
+    out += entry.Message.ToUtf8();
+  }
+
+  if (mMaxFileSize > 0 && mFileSize > 0 &&
+      (mFileSize + out.size()) > mMaxFileSize) {
+    Rotate();
+  }
+
+  mFile.write(out.data(), (std::streamsize)out.size());
+  mFile.flush();
+  mFileSize += out.size();
+
+  if (mStandardOutput) {
+    std::fwrite(out.data(), 1, out.size(), stdout);
+    std::fflush(stdout);
+  }
+}
+
+void AsyncLogWriter::Rotate() {
+  mFile.close();
+
+  if (mMaxFiles > 0) {
+    std::remove((mPath + "." + std::to_string(mMaxFiles)).c_str());
+    for (size_t i = mMaxFiles; i > 1; i--) {
+      std::rename((mPath + "." + std::to_string(i - 1)).c_str(),
+                  (mPath + "." + std::to_string(i)).c_str());
+    }
+
+    std::rename(mPath.c_str(), (mPath + ".1").c_str());
+  } else {
+    std::remove(mPath.c_str());
+  }
+
+  mFile.open(mPath, std::ios::out | std::ios::trunc | std::ios::binary);
+  mFileSize = 0;
+}
@@ -0,0 +1,280 @@
+/**
+ * @file libhack/src/AsyncLogWriter.h
+ * @ingroup libhack
+ *
+ * @author COMP Omega <compomega@tutanota.com>
+ *
+ * @brief Log hook that writes log messages to a file from its own thread.
+ *
+ * This file is part of the COMP_hack Library (libhack).
+ *
+ * Copyright (C) 2012-2020 COMP_hack Team <compomega@tutanota.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef LIBHACK_SRC_ASYNCLOGWRITER_H
+#define LIBHACK_SRC_ASYNCLOGWRITER_H
+
+// libcomp Includes
+#include <BaseLog.h>
+
+// Standard C++11 Includes
+#include <atomic>
+#include <condition_variable>
+#include <ctime>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace libhack {
+
+/**
+ * Log hook target that queues log messages and writes them to a file from
+ * a single writer thread. Every thread that logs gets its own fixed size
+ * ring of messages that only it writes to and only the writer thread reads
+ * from so logging never takes a lock or waits on another logging thread.
+ * The writer thread drains every ring at once, restores the order the
+ * messages were logged in and writes the whole batch to the file in one
+ * call. Time stamps, level and component names are formatted by the writer
+ * thread instead of the caller. When the file grows past the maximum size
+ * it is rotated to numbered backups. The same batches can also be echoed
+ * to the standard output.
+ *
+ * The number of queued messages per thread is bounded. When the ring of
+ * the calling thread is full the message is either dropped (and counted in
+ * the file) or the caller waits for the writer to catch up, depending on
+ * the policy.
+ *
+ * @code
+ * auto writer = std::make_shared<libhack::AsyncLogWriter>(path);
+ * if (writer->Open()) {
+ *   writer->AddHook(libhack::Log::GetSingletonPtr());
+ * }
+ * @endcode
+ */
+class AsyncLogWriter : public std::enable_shared_from_this<AsyncLogWriter> {
+ public:
+  /// What to do with a message when the queue is full
+  enum class Policy_t {
+    DROP,   //!< Drop the message and count it
+    BLOCK,  //!< Wait until the writer makes room for the message
+  };
+
+  /**
+   * Create a new log writer. The file is not opened until @ref Open is
+   * called.
+   * @param path Path to the log file
+   * @param maxFileSize Size in bytes the file may grow to before it is
+   *  rotated, 0 to never rotate
+   * @param maxFiles Number of rotated backups to keep
+   * @param queueSize Maximum number of messages waiting to be written
+   *  from each logging thread, rounded up to a power of two
+   * @param policy What to do with a message when the queue is full
+   */
+  AsyncLogWriter(const libcomp::String& path, size_t maxFileSize = 0,
+                 size_t maxFiles = 5, size_t queueSize = 4096,
+                 Policy_t policy = Policy_t::DROP);
+
+  /**
+   * Stop the writer thread, writing any queued messages first.
+   */
+  ~AsyncLogWriter();
+
+  /**
+   * Open the log file for appending and start the writer thread.
+   * @return true if the file was opened
+   */
+  bool Open();
+
+  /**
+   * Stop the writer thread after writing every message queued so far.
+   * Messages logged after this call are dropped.
+   */
+  void Stop();
+
+  /**
+   * Set if the writer thread also writes every batch to the standard
+   * output. This replaces the synchronous standard output hook so console
+   * output does not block the logging threads either. This must be set
+   * before @ref Open is called.
+   * @param enabled true if batches should be written to the standard output
+   */
+  void SetStandardOutput(bool enabled);
+
+  /**
+   * Register a hook on the supplied log that queues every message it
+   * processes on this writer. The hook keeps the writer alive.
+   * @param log Log to register the hook on
+   */
+  void AddHook(libcomp::BaseLog* log);
+
+  /**
+   * Queue a message to be written to the log file.
+   * @param comp Component the message belongs to
+   * @param level Level of the message
+   * @param msg Message to write
+   */
+  void Push(libcomp::GenericLogComponent_t comp,
+            libcomp::BaseLog::Level_t level, const libcomp::String& msg);
+
+  /**
+   * Get the number of messages dropped because a queue was full or the
+   * writer had been stopped.
+   * @return Number of messages dropped
+   */
+  uint64_t GetDroppedCount() const;
+
+ private:
+  /// Message waiting to be written
+  struct Entry {
+    /// Order the message was queued in
+    uint64_t Sequence;
+
+    /// Time the message was queued
+    time_t Time;
+
+    /// Component the message belongs to
+    libcomp::GenericLogComponent_t Component;
+
+    /// Level of the message
+    libcomp::BaseLog::Level_t Level;
+
+    /// Message text
+    libcomp::String Message;
+  };
+
+  /**
+   * Queue of messages from a single logging thread. Only that thread adds
+   * messages and only the writer thread removes them so the positions are
+   * the only shared state.
+   */
+  struct Ring {
+    /**
+     * Create a new ring.
+     * @param capacity Number of messages the ring holds, a power of two
+     */
+    explicit Ring(size_t capacity);
+
+    /// Message slots, indexed by position modulo the capacity
+    std::vector<Entry> Slots;
+
+    /// Mask applied to a position to get the slot index
+    size_t Mask;
+
+    /// Position of the next message the writer thread removes
+    std::atomic<size_t> Head;
+
+    /// Position of the next message the logging thread adds
+    std::atomic<size_t> Tail;
+  };
+
+  /**
+   * Main loop of the writer thread.
+   */
+  void Run();
+
+  /**
+   * Get the ring of the calling thread, creating it the first time the
+   * thread logs to this writer.
+   * @return Ring of the calling thread
+   */
+  Ring* GetThreadRing();
+
+  /**
+   * Move every queued message into the batch, oldest first.
+   * @param batch Output list the messages are moved into
+   */
+  void CollectBatch(std::vector<Entry>& batch);
+
+  /**
+   * Format and write a batch of messages to the log file.
+   * @param batch Messages to write, oldest first
+   */
+  void WriteBatch(const std::vector<Entry>& batch);
+
+  /**
+   * Rotate the log file to the numbered backups and open a new file.
+   */
+  void Rotate();
+
+  /// Path to the log file
+  std::string mPath;
+
+  /// Size the file may grow to before it is rotated
+  size_t mMaxFileSize;
+
+  /// Number of rotated backups to keep
+  size_t mMaxFiles;
+
+  /// Maximum number of queued messages per logging thread
+  size_t mQueueSize;
+
+  /// What to do with a message when the queue is full
+  Policy_t mPolicy;
+
+  /// Unique ID of this writer used to find the ring of a thread
+  uint64_t mID;
+
+  /// Lock for the list of rings, only taken when a thread logs for the
+  /// first time and when the writer thread collects a batch
+  std::mutex mRingsLock;
+
+  /// Rings of every thread that has logged to this writer
+  std::vector<std::shared_ptr<Ring>> mRings;
+
+  /// Sequence number of the next message queued
+  std::atomic<uint64_t> mSequence;
+
+  /// Approximate number of messages waiting to be written, used to wake
+  /// the writer thread early
+  std::atomic<size_t> mQueued;
+
+  /// Number of messages dropped
+  std::atomic<uint64_t> mDropped;
+
+  /// Number of dropped messages already noted in the file
+  uint64_t mDroppedWritten;
+
+  /// Indicates if batches are also written to the standard output
+  bool mStandardOutput;
+
+  /// Indicates if the writer thread is accepting messages
+  std::atomic<bool> mRunning;
+
+  /// Lock used to wait on the writer thread or for queue space
+  std::mutex mWaitLock;
+
+  /// Signaled when a batch is ready or the writer is stopping
+  std::condition_variable mWriteReady;
+
+  /// Signaled when the writer has made room in the queue
+  std::condition_variable mSpaceReady;
+
+  /// Writer thread
+  std::thread mThread;
+
+  /// Open log file
+  std::ofstream mFile;
+
+  /// Current size of the log file
+  size_t mFileSize;
+};
+
+}  // namespace libhack
+
+#endif  // LIBHACK_SRC_ASYNCLOGWRITER_H
@@ -106,21 +106,51 @@ bool BinaryDataSet::LoadXml(tinyxml2::XMLDocument& doc, bool loadMore) {
 }
 
 std::string BinaryDataSet::GetXml() const {
-  tinyxml2::XMLDocument doc;
+  std::stringstream ss;
 
-  tinyxml2::XMLElement* pRoot = doc.NewElement("objects");
-  doc.InsertEndChild(pRoot);
+  if (!WriteXml(ss)) {
+    return {};
+  }
+
+  return ss.str();
+}
+
+bool BinaryDataSet::WriteXml(std::ostream& out) const {
+  if (mObjects.empty()) {
+    out << "<objects/>" << std::endl;
+
+    return out.good();
+  }
+
+  out << "<objects>";
 
   for (auto obj : mObjects) {
+    tinyxml2::XMLDocument doc;
+
+    tinyxml2::XMLElement* pRoot = doc.NewElement("objects");
+    doc.InsertEndChild(pRoot);
+
     if (!obj->Save(doc, *pRoot)) {
-      return {};
+      return false;
+    }
+
+    // Print the object as a child of the root element.
+    for (auto pNode = pRoot->FirstChild(); nullptr != pNode;
+         pNode = pNode->NextSibling()) {
+      tinyxml2::XMLPrinter printer(nullptr, false, 1);
+      pNode->Accept(&printer);
+
+      out << "\n    " << printer.CStr();
+    }
+
+    if (!out.good()) {
+      return false;
     }
   }
 
-  tinyxml2::XMLPrinter printer;
-  doc.Print(&printer);
+  out << std::endl << "</objects>" << std::endl;
 
-  return printer.CStr();
+  return out.good();
 }
 
 std::string BinaryDataSet::GetTabular() const {
@@ -61,6 +61,15 @@ class BinaryDataSet {
   std::string GetXml() const;
   std::string GetTabular() const;
 
+  /**
+   * Write the XML for every object to a stream one object at a time so the
+   * XML for the whole set is never held in memory. The output matches the
+   * string returned by @ref GetXml.
+   * @param out Stream to write the XML to
+   * @return true if every object was saved and written
+   */
+  bool WriteXml(std::ostream& out) const;
+
   std::list<std::shared_ptr<libcomp::Object>> GetObjects() const;
   std::shared_ptr<libcomp::Object> GetObjectByID(uint32_t id) const;
 
@@ -0,0 +1,314 @@
+/**
+ * @file libhack/src/CaptureWriter.cpp
+ * @ingroup libhack
+ *
+ * @author COMP Omega <compomega@tutanota.com>
+ *
+ * @brief Writes packet capture records to files from its own thread.
+ *
+ * This file is part of the COMP_hack Library (libhack).
+ *
+ * Copyright (C) 2012-2020 COMP_hack Team <compomega@tutanota.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "CaptureWriter.h"
+
+// libcomp Includes
+#include "Constants.h"
+#include "Crypto.h"
+#include "Endian.h"
+
+// Standard C++11 Includes
+#include <chrono>
+#include <cstring>
+#include <ctime>
+
+using namespace libhack;
+
+/// Capture file magic of a channel capture ("HACK")
+static const uint32_t FORMAT_MAGIC = 0x4B434148;
+
+/// Capture file format version (1.1.0)
+static const uint32_t FORMAT_VER = 0x00010100;
+
+/// Longest time a record waits in a stream before it is written
+static const std::chrono::milliseconds FLUSH_INTERVAL(100);
+
+CaptureStream::CaptureStream(size_t capacity, const std::string& path,
+                             const std::string& address)
+    : mSlots(capacity),
+      mMask(capacity - 1),
+      mHead(0),
+      mTail(0),
+      mClosed(false),
+      mDropped(0),
+      mPath(path),
+      mAddress(address),
+      mFileSize(0),
+      mFileRecords(0),
+      mFileCount(0),
+      mFailed(false) {}
+
+std::vector<char>* CaptureStream::Reserve() {
+  size_t tail = mTail.load(std::memory_order_relaxed);
+  if (mClosed || (tail - mHead.load(std::memory_order_acquire)) > mMask) {
+    mDropped++;
+    return nullptr;
+  }
+
+  return &mSlots[tail & mMask];
+}
+
+void CaptureStream::Commit() {
+  mTail.store(mTail.load(std::memory_order_relaxed) + 1,
+              std::memory_order_release);
+}
+
+void CaptureStream::Close() { mClosed = true; }
+
+uint64_t CaptureStream::GetDroppedCount() const { return mDropped; }
+
+const std::string& CaptureStream::GetPath() const { return mPath; }
+
+CaptureWriter::CaptureWriter(const libcomp::String& directory,
+                             size_t maxFileSize, size_t queueSize)
+    : mDirectory(directory.ToUtf8()),
+      mMaxFileSize(maxFileSize),
+      mQueueSize(1),
+      mStreamCount(0),
+      mClosedDropped(0),
+      mRunning(false) {
+  while (mQueueSize < queueSize) {
+    mQueueSize <<= 1;
+  }
+}
+
+CaptureWriter::~CaptureWriter() { Stop(); }
+
+bool CaptureWriter::Start() {
+  std::lock_guard<std::mutex> lock(mStreamsLock);
+  if (!mRunning) {
+    mRunning = true;
+    mThread = std::thread([this]() { Run(); });
+  }
+
+  return true;
+}
+
+void CaptureWriter::Stop() {
+  {
+    std::lock_guard<std::mutex> lock(mStreamsLock);
+    if (!mRunning) {
+      return;
+    }
+
+    mRunning = false;
+  }
+
+  mStopping.notify_one();
+
+  if (mThread.joinable()) {
+    mThread.join();
+  }
+}
+
+std::shared_ptr<CaptureStream> CaptureWriter::OpenStream(
+    const libcomp::String& address) {
+  std::lock_guard<std::mutex> lock(mStreamsLock);
+  if (!mRunning) {
+    return nullptr;
+  }
+
+  char stamp[32];
+  std::time_t now = std::time(nullptr);
+  std::strftime(stamp, sizeof(stamp), "%Y%m%d%H%M%S", std::localtime(&now));
+
+  std::string path = mDirectory;
+  if (!path.empty() && path.back() != '/') {
+    path += "/";
+  }
+
+  path += std::string(stamp) + "-" + std::to_string(++mStreamCount);
+
+  auto stream = std::shared_ptr<CaptureStream>(
+      new CaptureStream(mQueueSize, path, address.ToUtf8()));
+  mStreams.push_back(stream);
+
+  return stream;
+}
+
+uint64_t CaptureWriter::GetDroppedCount() {
+  std::lock_guard<std::mutex> lock(mStreamsLock);
+
+  uint64_t dropped = mClosedDropped;
+  for (auto& stream : mStreams) {
+    dropped += stream->GetDroppedCount();
+  }
+
+  return dropped;
+}
+
+void CaptureWriter::Run() {
+  std::vector<std::shared_ptr<CaptureStream>> streams;
+
+  bool running = true;
+  while (running) {
+    {
+      std::unique_lock<std::mutex> lock(mStreamsLock);
+      mStopping.wait_for(lock, FLUSH_INTERVAL,
+                         [this]() { return !mRunning; });
+
+      running = mRunning;
+      streams = mStreams;
+    }
+
+    // Once stopped, anything queued before the stop is still written
+    for (auto& stream : streams) {
+      // Check before draining so nothing committed before the close is
+      // left behind
+      bool closed = !running || stream->mClosed;
+
+      Drain(*stream);
+
+      if (closed) {
+        stream->mFile.close();
+
+        std::lock_guard<std::mutex> lock(mStreamsLock);
+        mClosedDropped += stream->GetDroppedCount();
+        for (auto it = mStreams.begin(); it != mStreams.end(); it++) {
+          if (*it == stream) {
+            mStreams.erase(it);
+            break;
+          }
+        }
+      }
+    }
+
+    streams.clear();
+  }
+}
+
+void CaptureWriter::Drain(CaptureStream& stream) {
+  size_t head = stream.mHead.load(std::memory_order_relaxed);
+  size_t tail = stream.mTail.load(std::memory_order_acquire);
+  if (head == tail) {
+    return;
+  }
+
+  for (; head != tail; head++) {
+    auto& record = stream.mSlots[head & stream.mMask];
+
+    // Rotate before the record that would pass the maximum size but keep
+    // at least one record in each file
+    if (mMaxFileSize > 0 && stream.mFileRecords > 0 &&
+        (stream.mFileSize + record.size()) > mMaxFileSize) {
+      stream.mFile.close();
+    }
+
+    if (!stream.mFailed && !stream.mFile.is_open() && !OpenFile(stream)) {
+      stream.mFailed = true;
+    }
+
+    if (stream.mFailed) {
+      stream.mDropped++;
+      continue;
+    }
+
+    stream.mFile.write(record.data(), (std::streamsize)record.size());
+    stream.mFileSize += record.size();
+    stream.mFileRecords++;
+  }
+
+  stream.mHead.store(tail, std::memory_order_release);
+
+  if (stream.mFile.is_open()) {
+    stream.mFile.flush();
+    if (!stream.mFile.good()) {
+      stream.mFile.close();
+      stream.mFailed = true;
+    }
+  }
+}
+
+bool CaptureWriter::OpenFile(CaptureStream& stream) {
+  std::string path = stream.mPath;
+  if (stream.mFileCount++ > 0) {
+    path += "." + std::to_string(stream.mFileCount);
+  }
+
+  stream.mFile.open(path + ".hack",
+                    std::ios::out | std::ios::trunc | std::ios::binary);
+  if (!stream.mFile.good()) {
+    return false;
+  }
+
+  uint64_t stamp = static_cast<uint64_t>(std::time(nullptr));
+  uint32_t addressLength = static_cast<uint32_t>(stream.mAddress.size());
+
+  stream.mFile.write((const char*)&FORMAT_MAGIC, sizeof(FORMAT_MAGIC));
+  stream.mFile.write((const char*)&FORMAT_VER, sizeof(FORMAT_VER));
+  stream.mFile.write((const char*)&stamp, sizeof(stamp));
+  stream.mFile.write((const char*)&addressLength, sizeof(addressLength));
+  stream.mFile.write(stream.mAddress.data(), (std::streamsize)addressLength);
+
+  stream.mFileRecords = 0;
+  stream.mFileSize = sizeof(FORMAT_MAGIC) + sizeof(FORMAT_VER) +
+                     sizeof(stamp) + sizeof(addressLength) + addressLength;
+
+  return stream.mFile.good();
+}
+
+void CaptureWriter::BuildRecord(std::vector<char>& record, uint8_t source,
+                                const char* data, uint32_t realSize) {
+  const uint32_t sizesLength = 2 * static_cast<uint32_t>(sizeof(uint32_t));
+
+  // Round up the size of the packet to a multiple of BLOWFISH_BLOCK_SIZE.
+  uint32_t paddedSize = static_cast<uint32_t>(
+      ((realSize + BLOWFISH_BLOCK_SIZE - 1) / BLOWFISH_BLOCK_SIZE) *
+      BLOWFISH_BLOCK_SIZE);
+
+  uint64_t stamp = static_cast<uint64_t>(std::time(nullptr));
+  uint64_t microtime = static_cast<uint64_t>(
+      std::chrono::time_point_cast<std::chrono::microseconds>(
+          std::chrono::steady_clock::now())
+          .time_since_epoch()
+          .count());
+  uint32_t size = paddedSize + sizesLength;
+
+  size_t headerLength =
+      sizeof(source) + sizeof(stamp) + sizeof(microtime) + sizeof(size);
+
+  // Assigning keeps the capacity of a reused record.
+  record.assign(headerLength + size, 0);
+
+  char* pRecord = record.data();
+  memcpy(pRecord, &source, sizeof(source));
+  pRecord += sizeof(source);
+  memcpy(pRecord, &stamp, sizeof(stamp));
+  pRecord += sizeof(stamp);
+  memcpy(pRecord, &microtime, sizeof(microtime));
+  pRecord += sizeof(microtime);
+  memcpy(pRecord, &size, sizeof(size));
+  pRecord += sizeof(size);
+
+  uint32_t paddedSizeBig = htobe32(paddedSize);
+  uint32_t realSizeBig = htobe32(realSize);
+  memcpy(pRecord, &paddedSizeBig, sizeof(paddedSizeBig));
+  memcpy(pRecord + sizeof(uint32_t), &realSizeBig, sizeof(realSizeBig));
+
+  // The padding is already zero filled.
+  memcpy(pRecord + sizesLength, data, realSize);
+}
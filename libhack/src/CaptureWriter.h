@@ -0,0 +1,267 @@
+/**
+ * @file libhack/src/CaptureWriter.h
+ * @ingroup libhack
+ *
+ * @author COMP Omega <compomega@tutanota.com>
+ *
+ * @brief Writes packet capture records to files from its own thread.
+ *
+ * This file is part of the COMP_hack Library (libhack).
+ *
+ * Copyright (C) 2012-2020 COMP_hack Team <compomega@tutanota.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef LIBHACK_SRC_CAPTUREWRITER_H
+#define LIBHACK_SRC_CAPTUREWRITER_H
+
+// libcomp Includes
+#include <CString.h>
+
+// Standard C++11 Includes
+#include <atomic>
+#include <condition_variable>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace libhack {
+
+class CaptureWriter;
+
+/**
+ * Capture records of a single connection waiting to be written. Records
+ * are built directly in a fixed size ring that only the connection adds
+ * to and only the writer thread removes from so capturing a packet never
+ * takes a lock, allocates once the slots have grown or touches the file.
+ * When the ring is full the record is dropped and counted instead of
+ * stalling the connection.
+ */
+class CaptureStream {
+ public:
+  /**
+   * Get the next free record slot. The slot must be filled with a complete
+   * record and passed on with @ref Commit before the next call.
+   * @return Record to fill or null if the ring is full or the stream has
+   *  been closed, in which case the record is counted as dropped
+   */
+  std::vector<char>* Reserve();
+
+  /**
+   * Queue the record returned by the last call to @ref Reserve.
+   */
+  void Commit();
+
+  /**
+   * Close the stream. Records already queued are still written before the
+   * file is closed.
+   */
+  void Close();
+
+  /**
+   * Get the number of records dropped because the ring was full, the
+   * stream was closed or the file could not be written.
+   * @return Number of records dropped
+   */
+  uint64_t GetDroppedCount() const;
+
+  /**
+   * Get the path of the capture file without the extension. Rotated files
+   * add the file number before the extension.
+   * @return Path of the capture file
+   */
+  const std::string& GetPath() const;
+
+ private:
+  friend class CaptureWriter;
+
+  /**
+   * Create a new stream.
+   * @param capacity Number of records the ring holds, a power of two
+   * @param path Path of the capture file without the extension
+   * @param address Remote address written to the capture file header
+   */
+  CaptureStream(size_t capacity, const std::string& path,
+                const std::string& address);
+
+  /// Record slots, indexed by position modulo the capacity
+  std::vector<std::vector<char>> mSlots;
+
+  /// Mask applied to a position to get the slot index
+  size_t mMask;
+
+  /// Position of the next record the writer thread removes
+  std::atomic<size_t> mHead;
+
+  /// Position of the next record the connection adds
+  std::atomic<size_t> mTail;
+
+  /// Indicates if the connection has closed the stream
+  std::atomic<bool> mClosed;
+
+  /// Number of records dropped
+  std::atomic<uint64_t> mDropped;
+
+  /// Path of the capture file without the extension
+  std::string mPath;
+
+  /// Remote address written to the capture file header
+  std::string mAddress;
+
+  /// Open capture file, only used by the writer thread
+  std::ofstream mFile;
+
+  /// Size of the open capture file
+  size_t mFileSize;
+
+  /// Number of records in the open capture file
+  uint64_t mFileRecords;
+
+  /// Number of files written so far, used to name rotated files
+  uint32_t mFileCount;
+
+  /// Indicates if the capture file could not be opened or written
+  bool mFailed;
+};
+
+/**
+ * Writes the capture records of every connection from a single background
+ * thread. Each connection gets a @ref CaptureStream and its own capture
+ * file in the capture directory. The file is only created once the first
+ * record is written so connections with nothing captured leave no file.
+ * When a file grows past the maximum size the stream continues in a new
+ * numbered file with its own header so each file can be opened on its
+ * own. The file format is the same one capgrep and capstat read.
+ *
+ * @code
+ * auto writer = std::make_shared<libhack::CaptureWriter>(directory);
+ * if (writer->Start()) {
+ *   connection->SetCaptureStream(writer->OpenStream(address));
+ * }
+ * @endcode
+ */
+class CaptureWriter {
+ public:
+  /**
+   * Create a new capture writer. The thread is not started until
+   * @ref Start is called.
+   * @param directory Directory the capture files are written to
+   * @param maxFileSize Size in bytes a capture file may grow to before the
+   *  stream continues in a new file, 0 to never rotate
+   * @param queueSize Maximum number of records waiting to be written for
+   *  each connection, rounded up to a power of two
+   */
+  CaptureWriter(const libcomp::String& directory, size_t maxFileSize = 0,
+                size_t queueSize = 1024);
+
+  /**
+   * Stop the writer thread, writing any queued records first.
+   */
+  ~CaptureWriter();
+
+  /**
+   * Start the writer thread.
+   * @return true if the thread is running
+   */
+  bool Start();
+
+  /**
+   * Stop the writer thread after writing every record queued so far and
+   * close every capture file.
+   */
+  void Stop();
+
+  /**
+   * Create a stream for a new connection.
+   * @param address Remote address of the connection
+   * @return New stream or null if the writer is not running
+   */
+  std::shared_ptr<CaptureStream> OpenStream(const libcomp::String& address);
+
+  /**
+   * Get the number of records dropped on every stream opened so far.
+   * @return Number of records dropped
+   */
+  uint64_t GetDroppedCount();
+
+  /**
+   * Build a capture record for a packet whose sizes have been stripped.
+   * The padded and real sizes are written in front of the data and the
+   * data is padded to the Blowfish block size like it is on the wire.
+   * @param record Record to build, its capacity is reused
+   * @param source Which side sent the packet (HACK_SOURCE_CLIENT or
+   *  HACK_SOURCE_SERVER)
+   * @param data Packet data following the padded and real sizes
+   * @param realSize Number of bytes of packet data
+   */
+  static void BuildRecord(std::vector<char>& record, uint8_t source,
+                          const char* data, uint32_t realSize);
+
+ private:
+  /**
+   * Main loop of the writer thread.
+   */
+  void Run();
+
+  /**
+   * Write every record queued on a stream.
+   * @param stream Stream to write the records of
+   */
+  void Drain(CaptureStream& stream);
+
+  /**
+   * Open the next capture file of a stream and write its header.
+   * @param stream Stream to open the file for
+   * @return true if the file was opened
+   */
+  bool OpenFile(CaptureStream& stream);
+
+  /// Directory the capture files are written to
+  std::string mDirectory;
+
+  /// Size a capture file may grow to before it is rotated
+  size_t mMaxFileSize;
+
+  /// Maximum number of queued records per stream
+  size_t mQueueSize;
+
+  /// Number of streams opened, used to name the capture files
+  uint64_t mStreamCount;
+
+  /// Records dropped on streams that have been closed and removed
+  uint64_t mClosedDropped;
+
+  /// Lock for the stream list and counters
+  std::mutex mStreamsLock;
+
+  /// Streams with records that may still need to be written
+  std::vector<std::shared_ptr<CaptureStream>> mStreams;
+
+  /// Indicates if the writer thread is running
+  bool mRunning;
+
+  /// Signaled when the writer is stopping
+  std::condition_variable mStopping;
+
+  /// Writer thread
+  std::thread mThread;
+};
+
+}  // namespace libhack
+
+#endif  // LIBHACK_SRC_CAPTUREWRITER_H
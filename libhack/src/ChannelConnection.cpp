@@ -27,22 +27,187 @@
 #include "ChannelConnection.h"
 
 // libcomp Includes
+#include "Compress.h"
 #include "Constants.h"
 #include "Crypto.h"
+#include "Endian.h"
 #include "Log.h"
 
+// Standard C Includes
+#include <string.h>
+
+// Standard C++11 Includes
+#include <chrono>
+
 using namespace libcomp;
 using namespace libhack;
 
 ChannelConnection::ChannelConnection(asio::io_service& io_service)
-    : libcomp::EncryptedConnection(io_service) {}
+    : libcomp::EncryptedConnection(io_service), mCaptureEnabled(true) {}
 
 ChannelConnection::ChannelConnection(
     asio::ip::tcp::socket& socket,
     const std::shared_ptr<Crypto::DiffieHellman>& diffieHellman)
-    : libcomp::EncryptedConnection(socket, diffieHellman) {}
+    : libcomp::EncryptedConnection(socket, diffieHellman),
+      mCaptureEnabled(true) {}
+
+ChannelConnection::~ChannelConnection() {
+  if (mCaptureStream) {
+    mCaptureStream->Close();
+  }
+}
+
+float ChannelConnection::GetCompressionRatio() const {
+  return mCompression.GetRatio();
+}
+
+uint64_t ChannelConnection::GetCompressionSkipCount() const {
+  return mCompression.GetSkipCount();
+}
+
+uint64_t ChannelConnection::GetCompressionTime() const {
+  return mCompression.GetCompressTime();
+}
+
+void ChannelConnection::SetCaptureEnabled(bool enabled) {
+  mCaptureEnabled = enabled;
+}
+
+void ChannelConnection::SetCaptureCommandCodes(
+    const std::set<uint16_t>& commandCodes) {
+  mCaptureCommandCodes = commandCodes;
+}
+
+void ChannelConnection::SetCaptureStream(
+    const std::shared_ptr<CaptureStream>& stream) {
+  mCaptureStream = stream;
+}
+
+bool ChannelConnection::ShouldCapture(
+    const std::list<ReadOnlyPacket>& packets) const {
+  if (!mCaptureEnabled) {
+    return false;
+  }
+
+  if (mCaptureCommandCodes.empty()) {
+    return true;
+  }
+
+  // Each packet starts with its command code.
+  for (auto& packet : packets) {
+    if (sizeof(uint16_t) <= packet.Size()) {
+      uint16_t commandCode;
+      memcpy(&commandCode, packet.ConstData(), sizeof(commandCode));
+
+      if (mCaptureCommandCodes.end() !=
+          mCaptureCommandCodes.find(le16toh(commandCode))) {
+        return true;
+      }
+    }
+  }
+
+  return false;
+}
+
+bool ChannelConnection::ShouldCapture(const char* data, uint32_t realSize) {
+  if (!mCaptureEnabled) {
+    return false;
+  }
+
+  if (mCaptureCommandCodes.empty()) {
+    return true;
+  }
+
+  // Skip over: gzip, uncompressedSize, compressedSize, lv6.
+  const uint32_t compressionLength =
+      4 * static_cast<uint32_t>(sizeof(uint32_t));
+  if (compressionLength > realSize) {
+    return false;
+  }
+
+  int32_t uncompressedSize, compressedSize;
+  memcpy(&uncompressedSize, data + sizeof(uint32_t), sizeof(int32_t));
+  memcpy(&compressedSize, data + 2 * sizeof(uint32_t), sizeof(int32_t));
+  uncompressedSize = (int32_t)le32toh((uint32_t)uncompressedSize);
+  compressedSize = (int32_t)le32toh((uint32_t)compressedSize);
+
+  if (0 > uncompressedSize || 0 > compressedSize ||
+      (uint32_t)compressedSize > (realSize - compressionLength)) {
+    return false;
+  }
 
-ChannelConnection::~ChannelConnection() {}
+  const char* pCommands = data + compressionLength;
+  uint32_t commandsSize = static_cast<uint32_t>(compressedSize);
+
+  // Only the filter needs the commands so decompress into a scratch buffer
+  // and leave the packet for the normal path.
+  if (compressedSize != uncompressedSize) {
+    mCaptureFilterBuffer.resize(static_cast<size_t>(uncompressedSize));
+    if (uncompressedSize != Compress::Decompress(pCommands,
+                                                 mCaptureFilterBuffer.data(),
+                                                 compressedSize,
+                                                 uncompressedSize)) {
+      return false;
+    }
+
+    pCommands = mCaptureFilterBuffer.data();
+    commandsSize = static_cast<uint32_t>(uncompressedSize);
+  }
+
+  // Each command is the big and little endian sizes and the command code.
+  uint32_t offset = 0;
+  while (3 * sizeof(uint16_t) <= (commandsSize - offset)) {
+    uint16_t commandSize, commandCode;
+    memcpy(&commandSize, pCommands + offset + sizeof(uint16_t),
+           sizeof(commandSize));
+    memcpy(&commandCode, pCommands + offset + 2 * sizeof(uint16_t),
+           sizeof(commandCode));
+    commandSize = le16toh(commandSize);
+
+    if (mCaptureCommandCodes.end() !=
+        mCaptureCommandCodes.find(le16toh(commandCode))) {
+      return true;
+    }
+
+    // The little endian size covers itself and the command.
+    if (2 * sizeof(uint16_t) > commandSize) {
+      break;
+    }
+
+    offset += static_cast<uint32_t>(sizeof(uint16_t)) + commandSize;
+    if (offset > commandsSize) {
+      break;
+    }
+  }
+
+  return false;
+}
+
+void ChannelConnection::Capture(uint8_t source, const char* data,
+                                uint32_t realSize) {
+  if (mCaptureStream) {
+    // Records are dropped rather than waiting on a full queue.
+    auto pRecord = mCaptureStream->Reserve();
+    if (pRecord) {
+      CaptureWriter::BuildRecord(*pRecord, source, data, realSize);
+      mCaptureStream->Commit();
+    }
+
+    return;
+  }
+
+  CaptureWriter::BuildRecord(mCaptureBuffer, source, data, realSize);
+
+  mCaptureFile->write(mCaptureBuffer.data(),
+                      static_cast<std::streamsize>(mCaptureBuffer.size()));
+
+  if (!mCaptureFile->good()) {
+    LogConnectionCriticalMsg("Failed to write capture file.\n");
+
+    delete mCaptureFile;
+    mCaptureFile = nullptr;
+  }
+}
 
 void ChannelConnection::PreparePackets(std::list<ReadOnlyPacket>& packets) {
   static const uint32_t headerSize = GetHeaderSize();
@@ -69,13 +234,29 @@ void ChannelConnection::PreparePackets(std::list<ReadOnlyPacket>& packets) {
           static_cast<int32_t>(finalPacket.Size() - headerSize);
       int compressedSize;
 
-      // Compress the packet if this is the first try.
+      // Compress the packet if this is the first try and it is likely to
+      // pay off. Otherwise send it as is.
+      if (1 == retryCount &&
+          !mCompression.ShouldCompress(finalPacket.ConstData() + headerSize,
+                                       originalSize)) {
+        retryCount++;
+      }
+
       if (1 == retryCount) {
         finalPacket.Seek(headerSize);
 
         // Attempt to compress the packet.
+        auto start = std::chrono::steady_clock::now();
         compressedSize = finalPacket.Compress(originalSize);
 
+        // Track how well and how fast the traffic on this connection
+        // compresses.
+        mCompression.RecordAttempt(
+            originalSize, compressedSize,
+            (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now() - start)
+                .count());
+
         // If they are equal, this packet might be confused with an
         // uncompressed one. In such a case, do not compress.
         if (compressedSize < originalSize && 0 < compressedSize) {
@@ -110,58 +291,13 @@ void ChannelConnection::PreparePackets(std::list<ReadOnlyPacket>& packets) {
     // If the packet is OK, encrypt and complete the procedure.
     if (packetOK) {
       // Save the packet to the capture.
-      if (nullptr != mCaptureFile) {
-        // Copy the packet and format it for the capture.
-        libcomp::Packet capturePacket(finalPacket.ConstData(),
-                                      finalPacket.Size());
-
-        uint32_t realSize =
-            capturePacket.Size() - 2 * static_cast<uint32_t>(sizeof(uint32_t));
-
-        // Write the real size.
-        capturePacket.Seek(sizeof(uint32_t));
-        capturePacket.WriteU32Big(realSize);
-
-        // Round up the size of the packet to a multiple of
-        // BLOWFISH_BLOCK_SIZE.
-        uint32_t paddedSize = static_cast<uint32_t>(
-            ((realSize + BLOWFISH_BLOCK_SIZE - 1) / BLOWFISH_BLOCK_SIZE) *
-            BLOWFISH_BLOCK_SIZE);
-
-        // Make sure the packet is padded.
-        if (realSize != paddedSize) {
-          capturePacket.End();
-          capturePacket.WriteBlank(paddedSize - realSize);
-        }
+      if ((mCaptureStream || nullptr != mCaptureFile) &&
+          ShouldCapture(packets)) {
+        const uint32_t sizesLength =
+            2 * static_cast<uint32_t>(sizeof(uint32_t));
 
-        // Write the padded size.
-        capturePacket.Rewind();
-        capturePacket.WriteU32Big(paddedSize);
-
-        std::time_t now = std::time(nullptr);
-
-        uint8_t source = HACK_SOURCE_SERVER;
-        uint64_t stamp = static_cast<uint64_t>(now);
-        uint64_t microtime = static_cast<uint64_t>(
-            std::chrono::time_point_cast<std::chrono::microseconds>(
-                std::chrono::steady_clock::now())
-                .time_since_epoch()
-                .count());
-        uint32_t size = capturePacket.Size();
-
-        mCaptureFile->write(reinterpret_cast<char*>(&source), sizeof(source));
-        mCaptureFile->write(reinterpret_cast<char*>(&stamp), sizeof(stamp));
-        mCaptureFile->write(reinterpret_cast<char*>(&microtime),
-                            sizeof(microtime));
-        mCaptureFile->write(reinterpret_cast<char*>(&size), sizeof(size));
-        mCaptureFile->write(capturePacket.ConstData(), size);
-
-        if (!mCaptureFile->good()) {
-          LogConnectionCriticalMsg("Failed to write capture file.\n");
-
-          delete mCaptureFile;
-          mCaptureFile = nullptr;
-        }
+        Capture(HACK_SOURCE_SERVER, finalPacket.ConstData() + sizesLength,
+                finalPacket.Size() - sizesLength);
       }
 
       // Encrypt the packet
@@ -182,6 +318,15 @@ bool ChannelConnection::DecompressPacket(libcomp::Packet& packet,
                                          uint32_t& paddedSize,
                                          uint32_t& realSize,
                                          uint32_t& dataStart) {
+  const uint32_t sizesLength = 2 * static_cast<uint32_t>(sizeof(uint32_t));
+
+  // Incoming packets are only captured here when the capture writer is
+  // used, the capture file gets them from the base class.
+  if (mCaptureStream && (sizesLength + realSize) <= packet.Size() &&
+      ShouldCapture(packet.ConstData() + sizesLength, realSize)) {
+    Capture(HACK_SOURCE_CLIENT, packet.ConstData() + sizesLength, realSize);
+  }
+
   // Make sure we are at the right spot (right after the sizes).
   packet.Seek(2 * sizeof(uint32_t));
 
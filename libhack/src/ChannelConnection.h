@@ -30,6 +30,15 @@
 // libcomp Includes
 #include "EncryptedConnection.h"
 
+// libhack Includes
+#include "CaptureWriter.h"
+#include "CompressionPolicy.h"
+
+// Standard C++11 Includes
+#include <atomic>
+#include <set>
+#include <vector>
+
 namespace libhack {
 
 /**
@@ -58,6 +67,51 @@ class ChannelConnection : public libcomp::EncryptedConnection {
    */
   virtual ~ChannelConnection();
 
+  /**
+   * Get the running average of the compressed to uncompressed size ratio
+   * of the packets compressed on this connection.
+   * @returns Average compression ratio from 0 to 1 (1 being no gain).
+   */
+  float GetCompressionRatio() const;
+
+  /**
+   * Get the number of outgoing flushes that were sent without attempting
+   * to compress them, either because they were too small or because they
+   * looked like random data that would not compress.
+   * @returns Number of flushes sent without a compression attempt.
+   */
+  uint64_t GetCompressionSkipCount() const;
+
+  /**
+   * Get the time spent compressing the packets sent on this connection.
+   * @returns Time spent compressing in nanoseconds.
+   */
+  uint64_t GetCompressionTime() const;
+
+  /**
+   * Set if the packets on this connection are written to the capture.
+   * Captures are written by default when a capture is open.
+   * @param enabled true if packets should be captured.
+   */
+  void SetCaptureEnabled(bool enabled);
+
+  /**
+   * Limit the capture records to packets that contain at least one of the
+   * supplied command codes. This must be set before the connection starts
+   * sending packets.
+   * @param commandCodes Command codes to capture, empty to capture all.
+   */
+  void SetCaptureCommandCodes(const std::set<uint16_t>& commandCodes);
+
+  /**
+   * Write the capture records of this connection to a background capture
+   * writer instead of the capture file. Both incoming and outgoing packets
+   * are then captured and filtered by this connection. This must be set
+   * before the connection starts sending packets.
+   * @param stream Stream opened on the capture writer.
+   */
+  void SetCaptureStream(const std::shared_ptr<CaptureStream>& stream);
+
  protected:
   virtual void PreparePackets(std::list<libcomp::ReadOnlyPacket>& packets);
 
@@ -65,6 +119,50 @@ class ChannelConnection : public libcomp::EncryptedConnection {
                                 uint32_t& realSize, uint32_t& dataStart);
 
   virtual uint32_t GetHeaderSize();
+
+ private:
+  /**
+   * Determine if an outgoing flush should be written to the capture.
+   * @param packets Packets in the flush.
+   * @returns true if the flush should be captured.
+   */
+  bool ShouldCapture(const std::list<libcomp::ReadOnlyPacket>& packets) const;
+
+  /**
+   * Determine if an incoming packet should be written to the capture.
+   * @param data Packet data following the padded and real sizes.
+   * @param realSize Number of bytes of packet data.
+   * @returns true if the packet should be captured.
+   */
+  bool ShouldCapture(const char* data, uint32_t realSize);
+
+  /**
+   * Write a capture record to the capture stream or, if there is none, the
+   * capture file.
+   * @param source Which side sent the packet.
+   * @param data Packet data following the padded and real sizes.
+   * @param realSize Number of bytes of packet data.
+   */
+  void Capture(uint8_t source, const char* data, uint32_t realSize);
+
+  /// Buffer reused to build each outgoing capture record.
+  std::vector<char> mCaptureBuffer;
+
+  /// Buffer reused to decompress incoming packets for the capture filter.
+  std::vector<char> mCaptureFilterBuffer;
+
+  /// Stream the capture records are queued on, null to use the capture
+  /// file.
+  std::shared_ptr<CaptureStream> mCaptureStream;
+
+  /// Command codes of the outgoing packets to capture, empty for all.
+  std::set<uint16_t> mCaptureCommandCodes;
+
+  /// Indicates if outgoing packets are written to the capture file.
+  std::atomic<bool> mCaptureEnabled;
+
+  /// Decides which outgoing flushes are compressed and counts them.
+  CompressionPolicy mCompression;
 };
 
 }  // namespace libhack
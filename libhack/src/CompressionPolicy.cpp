@@ -0,0 +1,141 @@
+/**
+ * @file libhack/src/CompressionPolicy.cpp
+ * @ingroup libhack
+ *
+ * @author COMP Omega <compomega@tutanota.com>
+ *
+ * @brief Decides when outgoing channel traffic is worth compressing.
+ *
+ * This file is part of the COMP_hack Library (libhack).
+ *
+ * Copyright (C) 2012-2020 COMP_hack Team <compomega@tutanota.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "CompressionPolicy.h"
+
+// Standard C++11 Includes
+#include <bitset>
+
+using namespace libhack;
+
+/// Compression counters of every connection in the process
+static std::atomic<uint64_t> gTotalAttempts(0);
+static std::atomic<uint64_t> gTotalSkipped(0);
+static std::atomic<uint64_t> gTotalCompressTime(0);
+static std::atomic<uint64_t> gTotalBytesIn(0);
+static std::atomic<uint64_t> gTotalBytesOut(0);
+
+const int32_t CompressionPolicy::MIN_SIZE;
+const int32_t CompressionPolicy::SAMPLE_SIZE;
+const int32_t CompressionPolicy::MAX_DISTINCT;
+constexpr float CompressionPolicy::RATIO_WEIGHT;
+
+CompressionPolicy::CompressionPolicy()
+    : mRatio(0.f),
+      mSkipCount(0),
+      mAttemptCount(0),
+      mCompressTime(0) {}
+
+bool CompressionPolicy::ShouldCompress(const char* data,
+                                       int32_t originalSize) {
+  if (MIN_SIZE <= originalSize && !LooksRandom(data, originalSize)) {
+    return true;
+  }
+
+  mSkipCount.fetch_add(1, std::memory_order_relaxed);
+
+  gTotalSkipped.fetch_add(1, std::memory_order_relaxed);
+  gTotalBytesIn.fetch_add((uint64_t)originalSize, std::memory_order_relaxed);
+  gTotalBytesOut.fetch_add((uint64_t)originalSize, std::memory_order_relaxed);
+
+  return false;
+}
+
+void CompressionPolicy::RecordAttempt(int32_t originalSize,
+                                      int32_t compressedSize,
+                                      uint64_t elapsed) {
+  bool compressed = 0 < compressedSize && compressedSize < originalSize;
+
+  // Track how well the traffic on this connection compresses.
+  float ratio = compressed ? (float)compressedSize / (float)originalSize : 1.f;
+  float average = mRatio.load(std::memory_order_relaxed);
+  mRatio.store(average + (ratio - average) * RATIO_WEIGHT,
+               std::memory_order_relaxed);
+
+  mAttemptCount.fetch_add(1, std::memory_order_relaxed);
+  mCompressTime.fetch_add(elapsed, std::memory_order_relaxed);
+
+  gTotalAttempts.fetch_add(1, std::memory_order_relaxed);
+  gTotalCompressTime.fetch_add(elapsed, std::memory_order_relaxed);
+  gTotalBytesIn.fetch_add((uint64_t)originalSize, std::memory_order_relaxed);
+  gTotalBytesOut.fetch_add(
+      (uint64_t)(compressed ? compressedSize : originalSize),
+      std::memory_order_relaxed);
+}
+
+bool CompressionPolicy::LooksRandom(const char* data, int32_t size) {
+  if (0 >= size) {
+    return false;
+  }
+
+  int32_t samples = size < SAMPLE_SIZE ? size : SAMPLE_SIZE;
+
+  std::bitset<256> seen;
+  for (int32_t i = 0; i < samples; i++) {
+    seen.set((uint8_t)data[(int64_t)i * size / samples]);
+  }
+
+  // Scale the limit down for samples smaller than SAMPLE_SIZE.
+  return (int32_t)seen.count() * SAMPLE_SIZE > MAX_DISTINCT * samples;
+}
+
+float CompressionPolicy::GetRatio() const {
+  return mRatio.load(std::memory_order_relaxed);
+}
+
+uint64_t CompressionPolicy::GetSkipCount() const {
+  return mSkipCount.load(std::memory_order_relaxed);
+}
+
+uint64_t CompressionPolicy::GetAttemptCount() const {
+  return mAttemptCount.load(std::memory_order_relaxed);
+}
+
+uint64_t CompressionPolicy::GetCompressTime() const {
+  return mCompressTime.load(std::memory_order_relaxed);
+}
+
+CompressionTotals CompressionPolicy::GetTotals(bool reset) {
+  CompressionTotals totals;
+
+  if (reset) {
+    totals.Attempts = gTotalAttempts.exchange(0);
+    totals.Skipped = gTotalSkipped.exchange(0);
+    totals.CompressTime = gTotalCompressTime.exchange(0);
+    totals.BytesIn = gTotalBytesIn.exchange(0);
+    totals.BytesOut = gTotalBytesOut.exchange(0);
+  } else {
+    totals.Attempts = gTotalAttempts.load();
+    totals.Skipped = gTotalSkipped.load();
+    totals.CompressTime = gTotalCompressTime.load();
+    totals.BytesIn = gTotalBytesIn.load();
+    totals.BytesOut = gTotalBytesOut.load();
+  }
+
+  totals.Flushes = totals.Attempts + totals.Skipped;
+
+  return totals;
+}
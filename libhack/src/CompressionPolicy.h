@@ -0,0 +1,170 @@
+/**
+ * @file libhack/src/CompressionPolicy.h
+ * @ingroup libhack
+ *
+ * @author COMP Omega <compomega@tutanota.com>
+ *
+ * @brief Decides when outgoing channel traffic is worth compressing.
+ *
+ * This file is part of the COMP_hack Library (libhack).
+ *
+ * Copyright (C) 2012-2020 COMP_hack Team <compomega@tutanota.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef LIBHACK_SRC_COMPRESSIONPOLICY_H
+#define LIBHACK_SRC_COMPRESSIONPOLICY_H
+
+// Standard C Includes
+#include <stdint.h>
+
+// Standard C++11 Includes
+#include <atomic>
+
+namespace libhack {
+
+/**
+ * Compression counters of every connection in the process.
+ */
+struct CompressionTotals {
+  /// Number of flushes sent
+  uint64_t Flushes = 0;
+
+  /// Number of flushes compression was attempted on
+  uint64_t Attempts = 0;
+
+  /// Number of flushes sent without attempting compression
+  uint64_t Skipped = 0;
+
+  /// Time spent compressing in nanoseconds
+  uint64_t CompressTime = 0;
+
+  /// Uncompressed size of every flush
+  uint64_t BytesIn = 0;
+
+  /// Size of every flush as it was sent
+  uint64_t BytesOut = 0;
+};
+
+/**
+ * Decides if an outgoing flush of a connection should be compressed and
+ * keeps the compression counters of the connection. Flushes that are too
+ * small are never compressed. Larger flushes are sampled and only
+ * compressed if the sample does not look like random data, which zlib can
+ * not shrink. The decision is made per flush so a connection that mixes
+ * compressible and incompressible flushes still compresses the ones that
+ * pay off. Only the thread sending on the connection may call
+ * @ref ShouldCompress and @ref RecordAttempt; the counters may be read from
+ * any thread.
+ */
+class CompressionPolicy {
+ public:
+  /// Flushes smaller than this are never worth the cost of compressing.
+  static const int32_t MIN_SIZE = 128;
+
+  /// Number of bytes sampled from a flush to decide if it is compressed.
+  static const int32_t SAMPLE_SIZE = 256;
+
+  /// Flushes with more than this many distinct byte values in every
+  /// SAMPLE_SIZE bytes sampled look random and are not compressed. A
+  /// sample of random bytes has about 162 distinct values.
+  static const int32_t MAX_DISTINCT = 128;
+
+  /// Weight of the newest sample in the running compression ratio.
+  static constexpr float RATIO_WEIGHT = 0.125f;
+
+  /**
+   * Create a policy for a new connection.
+   */
+  CompressionPolicy();
+
+  /**
+   * Determine if the next outgoing flush should be compressed. A flush
+   * that should not be compressed is counted as skipped.
+   * @param data Uncompressed data of the flush.
+   * @param originalSize Uncompressed size of the flush.
+   * @returns true if compression should be attempted.
+   */
+  bool ShouldCompress(const char* data, int32_t originalSize);
+
+  /**
+   * Check if data looks random by counting the distinct byte values in a
+   * sample spread evenly over the data.
+   * @param data Data to check.
+   * @param size Size of the data.
+   * @returns true if the data looks random.
+   */
+  static bool LooksRandom(const char* data, int32_t size);
+
+  /**
+   * Record a compression attempt.
+   * @param originalSize Uncompressed size of the flush.
+   * @param compressedSize Size returned by the compression. The flush is
+   *  sent uncompressed if this is not positive and smaller than the
+   *  uncompressed size.
+   * @param elapsed Time spent compressing in nanoseconds.
+   */
+  void RecordAttempt(int32_t originalSize, int32_t compressedSize,
+                     uint64_t elapsed);
+
+  /**
+   * Get the running average of the compressed to uncompressed size ratio
+   * of the flushes compression was attempted on.
+   * @returns Average compression ratio from 0 to 1 (1 being no gain).
+   */
+  float GetRatio() const;
+
+  /**
+   * Get the number of flushes sent without attempting compression.
+   * @returns Number of flushes sent without a compression attempt.
+   */
+  uint64_t GetSkipCount() const;
+
+  /**
+   * Get the number of flushes compression was attempted on.
+   * @returns Number of compression attempts.
+   */
+  uint64_t GetAttemptCount() const;
+
+  /**
+   * Get the time spent compressing the flushes of the connection.
+   * @returns Time spent compressing in nanoseconds.
+   */
+  uint64_t GetCompressTime() const;
+
+  /**
+   * Get the compression counters of every connection in the process.
+   * @param reset Reset the counters after reading them.
+   * @returns Compression counters of every connection.
+   */
+  static CompressionTotals GetTotals(bool reset = false);
+
+ private:
+  /// Running average of the compressed to uncompressed size ratio.
+  std::atomic<float> mRatio;
+
+  /// Number of flushes sent without attempting compression.
+  std::atomic<uint64_t> mSkipCount;
+
+  /// Number of flushes compression was attempted on.
+  std::atomic<uint64_t> mAttemptCount;
+
+  /// Time spent compressing in nanoseconds.
+  std::atomic<uint64_t> mCompressTime;
+};
+
+}  // namespace libhack
+
+#endif  // LIBHACK_SRC_COMPRESSIONPOLICY_H
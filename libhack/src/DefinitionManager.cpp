@@ -197,6 +197,10 @@ std::shared_ptr<objects::MiDevilData> DefinitionManager::GetDevilData(
   return GetRecordByID(id, mDevilData);
 }
 
+objects::MiDevilData *DefinitionManager::GetDevilDataPtr(uint32_t id) const {
+  return mDevilData.Get(id);
+}
+
 const std::shared_ptr<objects::MiDevilData> DefinitionManager::GetDevilData(
     const libcomp::String &name) {
   auto iter = mDevilNameLookup.find(name);
@@ -395,6 +399,10 @@ const std::shared_ptr<objects::MiItemData> DefinitionManager::GetItemData(
   return GetRecordByID(id, mItemData);
 }
 
+objects::MiItemData *DefinitionManager::GetItemDataPtr(uint32_t id) const {
+  return mItemData.Get(id);
+}
+
 const std::shared_ptr<objects::MiMissionData> DefinitionManager::GetMissionData(
     uint32_t id) {
   return GetRecordByID(id, mMissionData);
@@ -525,6 +533,10 @@ const std::shared_ptr<objects::MiSkillData> DefinitionManager::GetSkillData(
   return GetRecordByID(id, mSkillData);
 }
 
+objects::MiSkillData *DefinitionManager::GetSkillDataPtr(uint32_t id) const {
+  return mSkillData.Get(id);
+}
+
 std::set<uint32_t> DefinitionManager::GetFunctionIDSkills(uint16_t fid) const {
   auto it = mFunctionIDSkills.find(fid);
   return it != mFunctionIDSkills.end() ? it->second : std::set<uint32_t>();
@@ -547,6 +559,24 @@ DefinitionManager::GetSpotData(uint32_t dynamicMapID) {
   return result;
 }
 
+const std::shared_ptr<objects::MiSpotData> DefinitionManager::GetSpotData(
+    uint32_t dynamicMapID, uint32_t spotID) {
+  auto dynamicMap = GetDynamicMapData(dynamicMapID);
+  if (dynamicMap) {
+    std::string filename(dynamicMap->GetSpotDataFile().C());
+
+    auto it = mSpotData.find(filename);
+    if (it != mSpotData.end()) {
+      auto spotIt = it->second.find(spotID);
+      if (spotIt != it->second.end()) {
+        return spotIt->second;
+      }
+    }
+  }
+
+  return nullptr;
+}
+
 const std::shared_ptr<objects::MiSStatusData> DefinitionManager::GetSStatusData(
     uint32_t id) {
   return GetRecordByID(id, mSStatusData);
@@ -557,6 +587,10 @@ const std::shared_ptr<objects::MiStatusData> DefinitionManager::GetStatusData(
   return GetRecordByID(id, mStatusData);
 }
 
+objects::MiStatusData *DefinitionManager::GetStatusDataPtr(uint32_t id) const {
+  return mStatusData.Get(id);
+}
+
 const std::shared_ptr<objects::MiSynthesisData>
 DefinitionManager::GetSynthesisData(uint32_t id) {
   return GetRecordByID(id, mSynthesisData);
@@ -851,7 +885,7 @@ bool DefinitionManager::LoadData<objects::MiDevilData>(DataStore *pDataStore) {
     auto id = record->GetBasic()->GetID();
     auto name = record->GetBasic()->GetName();
 
-    mDevilData[id] = record;
+    mDevilData.Insert(id, record);
     if (mDevilNameLookup.find(name) == mDevilNameLookup.end()) {
       mDevilNameLookup[name] = id;
     }
@@ -866,6 +900,8 @@ bool DefinitionManager::LoadData<objects::MiDevilData>(DataStore *pDataStore) {
     }
   }
 
+  mDevilData.Freeze();
+
   // Sort the fusion ranges
   for (auto &pair : mFusionRanges) {
     auto &ranges = pair.second;
@@ -1195,9 +1231,11 @@ bool DefinitionManager::LoadData<objects::MiItemData>(DataStore *pDataStore) {
   bool success = LoadBinaryData<objects::MiItemData>(
       pDataStore, "Shield/ItemData.sbin", true, 2, records);
   for (auto record : records) {
-    mItemData[record->GetCommon()->GetID()] = record;
+    mItemData.Insert(record->GetCommon()->GetID(), record);
   }
 
+  mItemData.Freeze();
+
   return success;
 }
 
@@ -1463,13 +1501,15 @@ bool DefinitionManager::LoadData<objects::MiSkillData>(DataStore *pDataStore) {
     uint32_t id = record->GetCommon()->GetID();
     uint16_t fid = record->GetDamage()->GetFunctionID();
 
-    mSkillData[id] = record;
+    mSkillData.Insert(id, record);
 
     if (fid) {
       mFunctionIDSkills[fid].insert(id);
     }
   }
 
+  mSkillData.Freeze();
+
   return success;
 }
 
@@ -1479,9 +1519,11 @@ bool DefinitionManager::LoadData<objects::MiStatusData>(DataStore *pDataStore) {
   bool success = LoadBinaryData<objects::MiStatusData>(
       pDataStore, "Shield/StatusData.sbin", true, 1, records);
   for (auto record : records) {
-    mStatusData[record->GetCommon()->GetID()] = record;
+    mStatusData.Insert(record->GetCommon()->GetID(), record);
   }
 
+  mStatusData.Freeze();
+
   return success;
 }
 
@@ -27,6 +27,9 @@
 #ifndef LIBHACK_SRC_DEFINITIONMANAGER_H
 #define LIBHACK_SRC_DEFINITIONMANAGER_H
 
+// libhack Includes
+#include "DefinitionTable.h"
+
 // libcomp Includes
 #include "CString.h"
 #include "Crypto.h"
@@ -220,6 +223,16 @@ class DefinitionManager {
    */
   std::shared_ptr<objects::MiDevilData> GetDevilData(uint32_t id);
 
+  /**
+   * Get the devil definition corresponding to an ID without copying the
+   * shared pointer. Use this for lookups in hot paths where the definition
+   * is only read and not kept.
+   * @param id Devil ID to retrieve
+   * @return Pointer to the matching devil definition, null if it does
+   *  not exist
+   */
+  objects::MiDevilData* GetDevilDataPtr(uint32_t id) const;
+
   /**
    * Get a devil definition corresponding to a name
    * @param name Devil name to retrieve
@@ -456,6 +469,16 @@ class DefinitionManager {
    */
   const std::shared_ptr<objects::MiItemData> GetItemData(uint32_t id);
 
+  /**
+   * Get the item definition corresponding to an ID without copying the
+   * shared pointer. Use this for lookups in hot paths where the definition
+   * is only read and not kept.
+   * @param id Item ID to retrieve
+   * @return Pointer to the matching item definition, null if it does
+   *  not exist
+   */
+  objects::MiItemData* GetItemDataPtr(uint32_t id) const;
+
   /**
    * Get the item definition corresponding to a name
    * @param name Item name to retrieve
@@ -640,6 +663,16 @@ class DefinitionManager {
    */
   const std::shared_ptr<objects::MiSkillData> GetSkillData(uint32_t id);
 
+  /**
+   * Get the skill definition corresponding to an ID without copying the
+   * shared pointer. Use this for lookups in hot paths where the definition
+   * is only read and not kept.
+   * @param id Skill ID to retrieve
+   * @return Pointer to the matching skill definition, null if it does
+   *  not exist
+   */
+  objects::MiSkillData* GetSkillDataPtr(uint32_t id) const;
+
   /**
    * Get all skill definition IDs that are mapped to the supplied function ID
    * @param fid Skill function ID
@@ -655,6 +688,17 @@ class DefinitionManager {
   const std::unordered_map<uint32_t, std::shared_ptr<objects::MiSpotData>>
   GetSpotData(uint32_t dynamicMapID);
 
+  /**
+   * Get a single spot definition from the spot data of a dynamic map
+   * without copying the rest of the spots
+   * @param dynamicMapID ID of the spot data to retrieve from
+   * @param spotID ID of the spot to retrieve
+   * @return Pointer to the matching spot definition, null if it does
+   *  not exist
+   */
+  const std::shared_ptr<objects::MiSpotData> GetSpotData(uint32_t dynamicMapID,
+                                                         uint32_t spotID);
+
   /**
    * Get the s-status definition corresponding to an ID
    * @param id S-status ID to retrieve
@@ -671,6 +715,16 @@ class DefinitionManager {
    */
   const std::shared_ptr<objects::MiStatusData> GetStatusData(uint32_t id);
 
+  /**
+   * Get the status definition corresponding to an ID without copying the
+   * shared pointer. Use this for lookups in hot paths where the definition
+   * is only read and not kept.
+   * @param id Status ID to retrieve
+   * @return Pointer to the matching status definition, null if it does
+   *  not exist
+   */
+  objects::MiStatusData* GetStatusDataPtr(uint32_t id) const;
+
   /**
    * Get the synthesis definition corresponding to an ID
    * @param id Synthesis ID to retrieve
@@ -971,6 +1025,19 @@ class DefinitionManager {
     return nullptr;
   }
 
+  /**
+   * Utility function to pull the templated type from a frozen definition
+   * table of ID to a pointer of that type
+   * @param id ID of the definition to retrieve from the table
+   * @param data Table to retrieve the data from
+   * @return Pointer to the record in the table matching the
+   *  supplied ID, null if it does not exist
+   */
+  template <class X, class T>
+  std::shared_ptr<T> GetRecordByID(X id, const DefinitionTable<X, T>& data) {
+    return data.Find(id);
+  }
+
  private:
   /// Map of client-side AI definitions by ID
   std::unordered_map<uint32_t, std::shared_ptr<objects::MiAIData>> mAIData;
@@ -1013,9 +1080,8 @@ class DefinitionManager {
   /// Map of lot IDs to devil boost extra stack IDs in that lot
   std::unordered_map<int32_t, std::list<uint16_t>> mDevilBoostLots;
 
-  /// Map of devil definitions by ID
-  std::unordered_map<uint32_t, std::shared_ptr<objects::MiDevilData>>
-      mDevilData;
+  /// Table of devil definitions by ID
+  DefinitionTable<uint32_t, objects::MiDevilData> mDevilData;
 
   /// Map of devil equipment definitions by skill ID
   std::unordered_map<uint32_t, std::shared_ptr<objects::MiDevilEquipmentData>>
@@ -1109,8 +1175,8 @@ class DefinitionManager {
   /// Map of human NPC definitions by ID
   std::unordered_map<uint32_t, std::shared_ptr<objects::MiHNPCData>> mHNPCData;
 
-  /// Map of item definitions by ID
-  std::unordered_map<uint32_t, std::shared_ptr<objects::MiItemData>> mItemData;
+  /// Table of item definitions by ID
+  DefinitionTable<uint32_t, objects::MiItemData> mItemData;
 
   /// Map of mission definitions by ID
   std::unordered_map<uint32_t, std::shared_ptr<objects::MiMissionData>>
@@ -1196,9 +1262,8 @@ class DefinitionManager {
   /// Map of s-item tokusei IDs by item ID
   std::unordered_map<uint32_t, std::set<int32_t>> mSItemTokusei;
 
-  /// Map of skill definitions by ID
-  std::unordered_map<uint32_t, std::shared_ptr<objects::MiSkillData>>
-      mSkillData;
+  /// Table of skill definitions by ID
+  DefinitionTable<uint32_t, objects::MiSkillData> mSkillData;
 
   /// Map of skill function IDs to skill IDs
   std::unordered_map<uint16_t, std::set<uint32_t>> mFunctionIDSkills;
@@ -1213,9 +1278,8 @@ class DefinitionManager {
   std::unordered_map<uint32_t, std::shared_ptr<objects::MiSStatusData>>
       mSStatusData;
 
-  /// Map of status definitions by ID
-  std::unordered_map<uint32_t, std::shared_ptr<objects::MiStatusData>>
-      mStatusData;
+  /// Table of status definitions by ID
+  DefinitionTable<uint32_t, objects::MiStatusData> mStatusData;
 
   /// Map of synthesis definitions by ID
   std::unordered_map<uint32_t, std::shared_ptr<objects::MiSynthesisData>>
@@ -0,0 +1,207 @@
+/**
+ * @file libhack/src/DefinitionTable.h
+ * @ingroup libhack
+ *
+ * @author COMP Omega <compomega@tutanota.com>
+ *
+ * @brief Read-only table of binary game data definitions sorted by ID.
+ *
+ * This file is part of the COMP_hack Library (libhack).
+ *
+ * Copyright (C) 2012-2020 COMP_hack Team <compomega@tutanota.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef LIBHACK_SRC_DEFINITIONTABLE_H
+#define LIBHACK_SRC_DEFINITIONTABLE_H
+
+// Standard C Includes
+#include <stdint.h>
+
+// Standard C++11 Includes
+#include <algorithm>
+#include <memory>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace libhack {
+
+/**
+ * Table of definitions stored in one contiguous array sorted by ID. Records
+ * are added while the definitions are loaded and the table is then frozen.
+ * When the IDs are dense enough the frozen table is indexed by an array so
+ * lookups are a single array access; otherwise it is indexed by a hash map
+ * of ID to position. Lookups can return a raw pointer so the caller
+ * does not have to copy the shared pointer (and touch its reference count)
+ * for every lookup. Once frozen the table is never modified so lookups are
+ * safe from any thread.
+ */
+template <class K, class T>
+class DefinitionTable {
+  static_assert(std::is_integral<K>::value,
+                "Definition table IDs must be integers");
+
+ public:
+  /// Single entry of the table
+  typedef std::pair<K, std::shared_ptr<T>> Entry;
+
+  /**
+   * Add a record to the table. The table must be frozen again before any
+   * lookups are made.
+   * @param id ID of the record
+   * @param record Pointer to the record
+   */
+  void Insert(K id, const std::shared_ptr<T>& record) {
+    mEntries.push_back(Entry(id, record));
+  }
+
+  /**
+   * Sort the table so records can be looked up. If the same ID was added
+   * more than once the last record added replaces the others, just like
+   * assigning to a map would.
+   */
+  void Freeze() {
+    std::stable_sort(
+        mEntries.begin(), mEntries.end(),
+        [](const Entry& a, const Entry& b) { return a.first < b.first; });
+
+    // Keep the last record added for each ID
+    auto out = mEntries.begin();
+    for (auto it = mEntries.begin(); it != mEntries.end(); it++) {
+      if (out != mEntries.begin() && (out - 1)->first == it->first) {
+        *(out - 1) = std::move(*it);
+      } else {
+        *out++ = std::move(*it);
+      }
+    }
+
+    mEntries.erase(out, mEntries.end());
+    mEntries.shrink_to_fit();
+
+    // Index the records by array if it is at most a few slots per record
+    mIndex.clear();
+    mSparseIndex.clear();
+    mIndexBase = 0;
+    if (!mEntries.empty()) {
+      mIndexBase = mEntries.front().first;
+
+      uint64_t span = Offset(mEntries.back().first) + 1;
+      if (span <= (uint64_t)mEntries.size() * INDEX_SLOTS_PER_RECORD) {
+        mIndex.assign((size_t)span, 0);
+        for (size_t i = 0; i < mEntries.size(); i++) {
+          mIndex[(size_t)Offset(mEntries[i].first)] = (uint32_t)i + 1;
+        }
+      } else {
+        mSparseIndex.reserve(mEntries.size());
+        for (size_t i = 0; i < mEntries.size(); i++) {
+          mSparseIndex[mEntries[i].first] = (uint32_t)i;
+        }
+      }
+    }
+
+    mIndex.shrink_to_fit();
+  }
+
+  /**
+   * Get the record with the supplied ID.
+   * @param id ID of the record to retrieve
+   * @return Pointer to the record, null if it does not exist
+   */
+  const std::shared_ptr<T>& Find(K id) const {
+    static const std::shared_ptr<T> empty;
+
+    if (!mIndex.empty()) {
+      if (id < mIndexBase || Offset(id) >= (uint64_t)mIndex.size()) {
+        return empty;
+      }
+
+      uint32_t slot = mIndex[(size_t)Offset(id)];
+      return slot ? mEntries[slot - 1].second : empty;
+    }
+
+    auto it = mSparseIndex.find(id);
+    if (it != mSparseIndex.end()) {
+      return mEntries[it->second].second;
+    }
+
+    return empty;
+  }
+
+  /**
+   * Get the record with the supplied ID without copying the shared pointer.
+   * The record stays valid for as long as the table it came from.
+   * @param id ID of the record to retrieve
+   * @return Pointer to the record, null if it does not exist
+   */
+  T* Get(K id) const { return Find(id).get(); }
+
+  /**
+   * Get the number of records in the table.
+   * @return Number of records in the table
+   */
+  size_t Size() const { return mEntries.size(); }
+
+  /**
+   * Get an iterator to the first record in ID order.
+   * @return Iterator to the first record
+   */
+  typename std::vector<Entry>::const_iterator begin() const {
+    return mEntries.begin();
+  }
+
+  /**
+   * Get an iterator past the last record in ID order.
+   * @return Iterator past the last record
+   */
+  typename std::vector<Entry>::const_iterator end() const {
+    return mEntries.end();
+  }
+
+ private:
+  /**
+   * Get the distance of an ID from the first ID of the table. The ID must
+   * not be less than the first ID.
+   * @param id ID to get the distance of
+   * @return Distance of the ID from the first ID
+   */
+  uint64_t Offset(K id) const {
+    // Unsigned subtraction so signed IDs far apart can not overflow
+    return (uint64_t)id - (uint64_t)mIndexBase;
+  }
+
+  /// Largest number of array index slots allowed per record before the
+  /// table is indexed by hash map instead
+  static const uint64_t INDEX_SLOTS_PER_RECORD = 4;
+
+  /// Records sorted by ID once frozen
+  std::vector<Entry> mEntries;
+
+  /// Position of each record in mEntries plus one by ID minus mIndexBase,
+  /// zero for IDs with no record. Empty if the IDs are too sparse.
+  std::vector<uint32_t> mIndex;
+
+  /// Position of each record in mEntries by ID. Only used if the IDs are
+  /// too sparse for mIndex.
+  std::unordered_map<K, uint32_t> mSparseIndex;
+
+  /// First ID in the table, the ID of the first slot in mIndex
+  K mIndexBase = 0;
+};
+
+}  // namespace libhack
+
+#endif  // LIBHACK_SRC_DEFINITIONTABLE_H
@@ -83,6 +83,12 @@
 // Standard C Includes
 #include <cmath>
 
+// Standard C++11 Includes
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <thread>
+
 using namespace libcomp;
 using namespace libhack;
 
@@ -126,6 +132,17 @@ const std::shared_ptr<objects::ServerZone> ServerDataManager::GetZoneData(
     }
 
     if (partialIDs.size() > 0) {
+      // Definitions never change once loaded so the same set of partials
+      // applied to the same zone always produces the same definition
+      auto key = std::make_tuple(id, zone->GetDynamicMapID(), partialIDs);
+      {
+        std::lock_guard<std::mutex> lock(mAppliedZoneLock);
+        auto appliedIter = mAppliedZoneData.find(key);
+        if (appliedIter != mAppliedZoneData.end()) {
+          return appliedIter->second;
+        }
+      }
+
       // Copy the definition and apply changes
       libcomp::String zoneStr = libcomp::String("%1%2").Arg(id).Arg(
           id != dynamicMapID ? libcomp::String(" (%1)").Arg(dynamicMapID) : "");
@@ -210,6 +227,11 @@ const std::shared_ptr<objects::ServerZone> ServerDataManager::GetZoneData(
 
         zone->RemoveSpawnLocationGroups(slgRemove);
       }
+
+      // If another thread built the same definition first, use theirs so
+      // every caller shares one copy
+      std::lock_guard<std::mutex> lock(mAppliedZoneLock);
+      zone = mAppliedZoneData.emplace(key, zone).first->second;
     }
   }
 
@@ -315,6 +337,11 @@ const std::shared_ptr<objects::Event> ServerDataManager::GetEventData(
   return GetObjectByID<std::string, objects::Event>(id.C(), mEventData);
 }
 
+std::unordered_map<std::string, std::shared_ptr<objects::Event>>
+ServerDataManager::GetEventData() {
+  return mEventData;
+}
+
 const std::shared_ptr<objects::ServerShop> ServerDataManager::GetShopData(
     uint32_t id) {
   return GetObjectByID<uint32_t, objects::ServerShop>(id, mShopData);
@@ -350,6 +377,11 @@ const std::shared_ptr<objects::DropSet> ServerDataManager::GetDropSetData(
   return GetObjectByID<uint32_t, objects::DropSet>(id, mDropSetData);
 }
 
+std::unordered_map<uint32_t, std::shared_ptr<objects::DropSet>>
+ServerDataManager::GetDropSetData() {
+  return mDropSetData;
+}
+
 std::unordered_map<uint32_t, std::shared_ptr<objects::FusionMistake>>
 ServerDataManager::GetFusionMistakeData() {
   return mFusionMistakeData;
@@ -522,22 +554,191 @@ bool ServerDataManager::LoadData(DataStore* pDataStore,
 }
 
 bool ServerDataManager::VerifyDataIntegrity(
+    DefinitionManager* definitionManager, size_t jobCount) {
+  auto checks = GetIntegrityChecks(definitionManager);
+
+  return RunIntegrityChecks(checks, jobCount);
+}
+
+bool ServerDataManager::VerifyEventIntegrity() {
+  std::list<std::shared_ptr<ServerDataCheck>> checks;
+  AddEventIntegrityChecks(checks);
+
+  return RunIntegrityChecks(checks, 1);
+}
+
+bool ServerDataManager::VerifyItemReferences(
     DefinitionManager* definitionManager) {
-  bool valid = VerifyEventIntegrity();
-  ;
+  if (!definitionManager) {
+    // No issues found, not checked either
+    return true;
+  }
+
+  std::list<std::shared_ptr<ServerDataCheck>> checks;
+  AddItemReferenceChecks(checks, definitionManager);
+
+  return RunIntegrityChecks(checks, 1);
+}
+
+std::list<std::shared_ptr<ServerDataCheck>>
+ServerDataManager::GetIntegrityChecks(DefinitionManager* definitionManager) {
+  std::list<std::shared_ptr<ServerDataCheck>> checks;
+
+  AddEventIntegrityChecks(checks);
+
+  if (definitionManager) {
+    AddItemReferenceChecks(checks, definitionManager);
+  }
+
+  return checks;
+}
+
+bool ServerDataManager::RunIntegrityChecks(
+    const std::list<std::shared_ptr<ServerDataCheck>>& checks,
+    size_t jobCount) {
+  std::vector<std::shared_ptr<ServerDataCheck>> pending;
+  for (auto& check : checks) {
+    if (!check->Skip) {
+      pending.push_back(check);
+    }
+  }
+
+  if (!jobCount) {
+    jobCount = std::max(1u, std::thread::hardware_concurrency());
+  }
+
+  jobCount = std::min(jobCount, pending.size());
+
+  // Every check only reads the loaded data so they can be run in any order
+  // on any number of threads.
+  std::atomic<size_t> nextCheck(0);
+
+  auto worker = [&pending, &nextCheck]() {
+    for (size_t idx = nextCheck++; idx < pending.size(); idx = nextCheck++) {
+      auto check = pending[idx];
+
+      auto start = std::chrono::steady_clock::now();
+
+      check->Valid = check->Check();
+      check->Duration = (uint64_t)std::chrono::duration_cast<
+                            std::chrono::microseconds>(
+                            std::chrono::steady_clock::now() - start)
+                            .count();
+    }
+  };
+
+  if (jobCount > 1) {
+    std::vector<std::thread> workers;
+    for (size_t i = 0; i < jobCount; i++) {
+      workers.push_back(std::thread(worker));
+    }
 
-  if (definitionManager && !VerifyItemReferences(definitionManager)) {
-    valid = false;
+    for (auto& t : workers) {
+      t.join();
+    }
+  } else {
+    worker();
+  }
+
+  bool valid = true;
+  for (auto& check : pending) {
+    valid &= check->Valid;
   }
 
   return valid;
 }
 
-bool ServerDataManager::VerifyEventIntegrity() {
+void ServerDataManager::AddIntegrityCheck(
+    std::list<std::shared_ptr<ServerDataCheck>>& checks,
+    const libcomp::String& name, const std::list<libcomp::String>& paths,
+    const std::function<bool()>& check) {
+  auto c = std::make_shared<ServerDataCheck>();
+  c->Name = name;
+  c->Paths = paths;
+  c->Check = check;
+
+  checks.push_back(c);
+}
+
+void ServerDataManager::AddEventIntegrityChecks(
+    std::list<std::shared_ptr<ServerDataCheck>>& checks) {
+  // Events are checked in blocks so a large event set is spread over all
+  // of the workers.
+  const size_t EVENT_BLOCK_SIZE = 500;
+
+  std::vector<std::string> eventIDs;
+  eventIDs.reserve(mEventData.size());
+  for (auto& ePair : mEventData) {
+    eventIDs.push_back(ePair.first);
+  }
+
+  for (size_t i = 0; i < eventIDs.size(); i += EVENT_BLOCK_SIZE) {
+    size_t end = std::min(i + EVENT_BLOCK_SIZE, eventIDs.size());
+
+    std::vector<std::string> block(eventIDs.begin() + (std::ptrdiff_t)i,
+                                   eventIDs.begin() + (std::ptrdiff_t)end);
+
+    AddIntegrityCheck(checks, String("events[%1-%2]").Arg(i).Arg(end - 1),
+                      {"/events"},
+                      [this, block]() { return VerifyEvents(block); });
+  }
+
+  AddIntegrityCheck(checks, "zone_events", {"/zones", "/events"},
+                    [this]() { return VerifyZoneEvents(); });
+  AddIntegrityCheck(checks, "zone_partial_events",
+                    {"/zones/partial", "/events"},
+                    [this]() { return VerifyZonePartialEvents(); });
+  AddIntegrityCheck(checks, "zone_instance_events",
+                    {"/data/zoneinstance", "/events"},
+                    [this]() { return VerifyZoneInstanceEvents(); });
+  AddIntegrityCheck(checks, "zone_instance_variant_events",
+                    {"/data/zoneinstancevariant", "/events"},
+                    [this]() { return VerifyZoneInstanceVariantEvents(); });
+}
+
+void ServerDataManager::AddItemReferenceChecks(
+    std::list<std::shared_ptr<ServerDataCheck>>& checks,
+    DefinitionManager* definitionManager) {
+  // Item and shop product definitions come from the binary data and the
+  // server side definitions in /data.
+  AddIntegrityCheck(checks, "shop_products", {"/shops", "/BinaryData", "/data"},
+                    [this, definitionManager]() {
+                      return VerifyShopProducts(definitionManager);
+                    });
+  AddIntegrityCheck(checks, "dropset_items", {"/BinaryData", "/data"},
+                    [this, definitionManager]() {
+                      return VerifyDropSetItems(definitionManager);
+                    });
+  AddIntegrityCheck(checks, "demon_present_items", {"/BinaryData", "/data"},
+                    [this, definitionManager]() {
+                      return VerifyDemonPresentItems(definitionManager);
+                    });
+  AddIntegrityCheck(checks, "event_drop_items",
+                    {"/events", "/BinaryData", "/data"},
+                    [this, definitionManager]() {
+                      return VerifyEventDropItems(definitionManager);
+                    });
+  AddIntegrityCheck(checks, "zone_drop_items",
+                    {"/zones", "/BinaryData", "/data"},
+                    [this, definitionManager]() {
+                      return VerifyZoneDropItems(definitionManager);
+                    });
+  AddIntegrityCheck(checks, "zone_partial_drop_items",
+                    {"/zones/partial", "/BinaryData", "/data"},
+                    [this, definitionManager]() {
+                      return VerifyZonePartialDropItems(definitionManager);
+                    });
+  AddIntegrityCheck(checks, "demon_quest_reward_dropsets", {"/data"},
+                    [this]() { return VerifyDemonQuestRewardDropSets(); });
+}
+
+bool ServerDataManager::VerifyEvents(const std::vector<std::string>& eventIDs) {
   bool valid = true;
 
   // Gather all sources of actions
-  for (auto ePair : mEventData) {
+  for (auto& id : eventIDs) {
+    auto ePair = *mEventData.find(id);
+
     // Check all direct event references, ignoring invalid types here
     // as those need to be explicitly defined to differ anyway
     std::set<libcomp::String> refIDs;
@@ -680,6 +881,12 @@ bool ServerDataManager::VerifyEventIntegrity() {
     valid &= invalidEventIDs.size() == 0;
   }
 
+  return valid;
+}
+
+bool ServerDataManager::VerifyZoneEvents() {
+  bool valid = true;
+
   // Validate zone references
   for (auto& zdPair : mZoneData) {
     for (auto& zPair : zdPair.second) {
@@ -697,24 +904,34 @@ bool ServerDataManager::VerifyEventIntegrity() {
     }
   }
 
+  return valid;
+}
+
+bool ServerDataManager::VerifyZonePartialEvents() {
+  bool valid = true;
+
   // Validate zone partial references
   for (auto& zPair : mZonePartialData) {
-    for (auto action : GetAllZonePartialActions(zPair.second, true)) {
-      auto actions = GetAllZonePartialActions(zPair.second, true);
-      for (auto eventID : GetInvalidEventIDs(actions)) {
-        LogServerDataManagerError([zPair, eventID]() {
-          return String(
-                     "Invalid event ID reference encountered on zone partial "
-                     "%1: %2\n")
-              .Arg(zPair.first)
-              .Arg(eventID);
-        });
+    auto actions = GetAllZonePartialActions(zPair.second, true);
+    for (auto eventID : GetInvalidEventIDs(actions)) {
+      LogServerDataManagerError([zPair, eventID]() {
+        return String(
+                   "Invalid event ID reference encountered on zone partial "
+                   "%1: %2\n")
+            .Arg(zPair.first)
+            .Arg(eventID);
+      });
 
-        valid = false;
-      }
+      valid = false;
     }
   }
 
+  return valid;
+}
+
+bool ServerDataManager::VerifyZoneInstanceEvents() {
+  bool valid = true;
+
   // Check instance events
   for (auto& iPair : mZoneInstanceData) {
     auto instance = iPair.second;
@@ -735,6 +952,12 @@ bool ServerDataManager::VerifyEventIntegrity() {
     }
   }
 
+  return valid;
+}
+
+bool ServerDataManager::VerifyZoneInstanceVariantEvents() {
+  bool valid = true;
+
   // Check instance variant expiration timers
   for (auto& varPair : mZoneInstanceVariantData) {
     auto variant = varPair.second;
@@ -756,13 +979,8 @@ bool ServerDataManager::VerifyEventIntegrity() {
   return valid;
 }
 
-bool ServerDataManager::VerifyItemReferences(
+bool ServerDataManager::VerifyShopProducts(
     DefinitionManager* definitionManager) {
-  if (!definitionManager) {
-    // No issues found, not checked either
-    return true;
-  }
-
   bool valid = true;
 
   // Verify shop products
@@ -784,6 +1002,13 @@ bool ServerDataManager::VerifyItemReferences(
     }
   }
 
+  return valid;
+}
+
+bool ServerDataManager::VerifyDropSetItems(
+    DefinitionManager* definitionManager) {
+  bool valid = true;
+
   // Verify dropsets
   for (auto& dropsetPair : mDropSetData) {
     for (auto drop : dropsetPair.second->GetDrops()) {
@@ -800,7 +1025,12 @@ bool ServerDataManager::VerifyItemReferences(
     }
   }
 
-  // Verify demon presents
+  return valid;
+}
+
+bool ServerDataManager::VerifyDemonPresentItems(
+    DefinitionManager* definitionManager) {
+  // Verify demon presents (only warned about)
   for (auto& pPair : mDemonPresentData) {
     std::set<uint32_t> itemIDs;
     for (uint32_t itemID : pPair.second->GetCommonItems()) {
@@ -826,6 +1056,13 @@ bool ServerDataManager::VerifyItemReferences(
     }
   }
 
+  return true;
+}
+
+bool ServerDataManager::VerifyEventDropItems(
+    DefinitionManager* definitionManager) {
+  bool valid = true;
+
   // Verify direct drops (warn of invalid dropset uses)
   for (auto& ePair : mEventData) {
     if (ePair.second->GetEventType() ==
@@ -858,6 +1095,13 @@ bool ServerDataManager::VerifyItemReferences(
     }
   }
 
+  return valid;
+}
+
+bool ServerDataManager::VerifyZoneDropItems(
+    DefinitionManager* definitionManager) {
+  bool valid = true;
+
   for (auto& zdPair : mZoneData) {
     for (auto& zPair : zdPair.second) {
       std::set<uint32_t> dropTypes;
@@ -922,6 +1166,13 @@ bool ServerDataManager::VerifyItemReferences(
     }
   }
 
+  return valid;
+}
+
+bool ServerDataManager::VerifyZonePartialDropItems(
+    DefinitionManager* definitionManager) {
+  bool valid = true;
+
   for (auto& zPair : mZonePartialData) {
     std::set<uint32_t> dropTypes;
 
@@ -986,6 +1237,11 @@ bool ServerDataManager::VerifyItemReferences(
     }
   }
 
+  return valid;
+}
+
+bool ServerDataManager::VerifyDemonQuestRewardDropSets() {
+  // Verify demon quest reward dropsets (only warned about)
   for (auto& rPair : mDemonQuestRewardData) {
     std::set<uint32_t> dropSetIDs;
     for (uint32_t dropSetID : rPair.second->GetNormalDropSets()) {
@@ -1013,7 +1269,7 @@ bool ServerDataManager::VerifyItemReferences(
     }
   }
 
-  return valid;
+  return true;
 }
 
 std::list<std::shared_ptr<ServerScript>> ServerDataManager::LoadScripts(
@@ -53,8 +53,14 @@
 #include "PopIgnore.h"
 
 // Standard C++11 Includes
+#include <functional>
+#include <list>
+#include <map>
+#include <mutex>
 #include <set>
+#include <tuple>
 #include <unordered_map>
+#include <vector>
 
 namespace objects {
 class Action;
@@ -89,6 +95,30 @@ struct ServerScript {
   bool Instantiated = false;
 };
 
+/**
+ * Container for a single server data integrity check. Checks only read the
+ * loaded data so any number of them may run at the same time.
+ */
+struct ServerDataCheck {
+  /// Name of the check used in reports
+  libcomp::String Name;
+
+  /// Datastore paths the checked data is loaded from
+  std::list<libcomp::String> Paths;
+
+  /// Function that performs the check and returns false if issues are found
+  std::function<bool()> Check;
+
+  /// If true the check will not be run and is assumed to still be valid
+  bool Skip = false;
+
+  /// Result of the last run of the check
+  bool Valid = true;
+
+  /// Time in microseconds the last run of the check took
+  uint64_t Duration = 0;
+};
+
 /**
  * Manager class responsible for loading server specific files such as
  * zones and script files.
@@ -111,7 +141,8 @@ class ServerDataManager {
    * @param dynamicMapID Dynamic map ID of the zone to retrieve
    * @param applyPartials If true, the definition will be re-instanced and
    *  have all self-applied ServerZonePartial definitions applied to it. If
-   *  false, the normal definition will be returned.
+   *  false, the normal definition will be returned. Re-instanced
+   *  definitions are cached and shared so they must not be modified.
    * @param extraPartialIDs If applying ServerZonePartial definitions, the
    *  IDs supplied will be loaded as well
    * @return Pointer to the server zone matching the specified id
@@ -199,6 +230,13 @@ class ServerDataManager {
    */
   const std::shared_ptr<objects::Event> GetEventData(const libcomp::String& id);
 
+  /**
+   * Get all event definitions
+   * @return Map of all event definitions by ID
+   */
+  std::unordered_map<std::string, std::shared_ptr<objects::Event>>
+  GetEventData();
+
   /**
    * Get a shop by definition ID
    * @param id Definition ID of a shop to load
@@ -249,6 +287,13 @@ class ServerDataManager {
    */
   const std::shared_ptr<objects::DropSet> GetDropSetData(uint32_t id);
 
+  /**
+   * Get all drop set definitions
+   * @return Map of all drop set definitions by ID
+   */
+  std::unordered_map<uint32_t, std::shared_ptr<objects::DropSet>>
+  GetDropSetData();
+
   /**
    * Get all fusion mistake definitions
    * @return Map of all fusion mistake definitions by ID
@@ -295,9 +340,35 @@ class ServerDataManager {
    * @param definitionManager Pointer to the definition manager which
    *  must be loaded with any server side definitions. Checking these
    *  definitions will be skipped if this is null.
+   * @param jobCount Number of threads to run the checks on or 0 to use one
+   *  thread per hardware thread
+   * @return true if no issues are found, false if issues are found
+   */
+  bool VerifyDataIntegrity(DefinitionManager* definitionManager,
+                           size_t jobCount = 0);
+
+  /**
+   * Get every check run by @ref VerifyDataIntegrity without running them.
+   * The checks reference this manager and must not outlive it.
+   * @param definitionManager Pointer to the definition manager which
+   *  must be loaded with any server side definitions. Checks of these
+   *  definitions will be skipped if this is null.
+   * @return List of integrity checks
+   */
+  std::list<std::shared_ptr<ServerDataCheck>> GetIntegrityChecks(
+      DefinitionManager* definitionManager);
+
+  /**
+   * Run each integrity check not marked to be skipped and store the result
+   * and run time on the check.
+   * @param checks List of integrity checks to run
+   * @param jobCount Number of threads to run the checks on or 0 to use one
+   *  thread per hardware thread
    * @return true if no issues are found, false if issues are found
    */
-  bool VerifyDataIntegrity(DefinitionManager* definitionManager);
+  static bool RunIntegrityChecks(
+      const std::list<std::shared_ptr<ServerDataCheck>>& checks,
+      size_t jobCount);
 
   /**
    * Verify all loaded events and event references for non-critical errors.
@@ -545,6 +616,118 @@ class ServerDataManager {
    */
   bool LoadScript(const libcomp::String& path, const libcomp::String& source);
 
+  /**
+   * Add a named integrity check to a list of checks.
+   * @param checks List of integrity checks to add to
+   * @param name Name of the check
+   * @param paths Datastore paths the checked data is loaded from
+   * @param check Function that performs the check
+   */
+  static void AddIntegrityCheck(
+      std::list<std::shared_ptr<ServerDataCheck>>& checks,
+      const libcomp::String& name, const std::list<libcomp::String>& paths,
+      const std::function<bool()>& check);
+
+  /**
+   * Add the checks for all event references to a list of checks. Events
+   * are split into blocks that are each checked separately.
+   * @param checks List of integrity checks to add to
+   */
+  void AddEventIntegrityChecks(
+      std::list<std::shared_ptr<ServerDataCheck>>& checks);
+
+  /**
+   * Add the checks for all item, product and dropset references to a list
+   * of checks.
+   * @param checks List of integrity checks to add to
+   * @param definitionManager Pointer to the definition manager which
+   *  must be loaded with any server side definitions
+   */
+  void AddItemReferenceChecks(
+      std::list<std::shared_ptr<ServerDataCheck>>& checks,
+      DefinitionManager* definitionManager);
+
+  /**
+   * Verify the event references of a block of events.
+   * @param eventIDs IDs of the events to verify
+   * @return true if no issues are found, false if issues are found
+   */
+  bool VerifyEvents(const std::vector<std::string>& eventIDs);
+
+  /**
+   * Verify event references on all zones.
+   * @return true if no issues are found, false if issues are found
+   */
+  bool VerifyZoneEvents();
+
+  /**
+   * Verify event references on all zone partials.
+   * @return true if no issues are found, false if issues are found
+   */
+  bool VerifyZonePartialEvents();
+
+  /**
+   * Verify event references on all zone instances.
+   * @return true if no issues are found, false if issues are found
+   */
+  bool VerifyZoneInstanceEvents();
+
+  /**
+   * Verify timer expiration event references on all zone instance variants.
+   * @return true if no issues are found, false if issues are found
+   */
+  bool VerifyZoneInstanceVariantEvents();
+
+  /**
+   * Verify the product references in all shops.
+   * @param definitionManager Pointer to the definition manager
+   * @return true if no issues are found, false if issues are found
+   */
+  bool VerifyShopProducts(DefinitionManager* definitionManager);
+
+  /**
+   * Verify the item references in all dropsets.
+   * @param definitionManager Pointer to the definition manager
+   * @return true if no issues are found, false if issues are found
+   */
+  bool VerifyDropSetItems(DefinitionManager* definitionManager);
+
+  /**
+   * Warn about invalid item references in demon presents.
+   * @param definitionManager Pointer to the definition manager
+   * @return Always true as issues are only warned about
+   */
+  bool VerifyDemonPresentItems(DefinitionManager* definitionManager);
+
+  /**
+   * Verify the item references of loot created by event actions.
+   * @param definitionManager Pointer to the definition manager
+   * @return true if no issues are found, false if issues are found
+   */
+  bool VerifyEventDropItems(DefinitionManager* definitionManager);
+
+  /**
+   * Verify the item references of drops in all zones and warn about
+   * invalid dropset references.
+   * @param definitionManager Pointer to the definition manager
+   * @return true if no issues are found, false if issues are found
+   */
+  bool VerifyZoneDropItems(DefinitionManager* definitionManager);
+
+  /**
+   * Verify the item references of drops in all zone partials and warn about
+   * invalid dropset references.
+   * @param definitionManager Pointer to the definition manager
+   * @return true if no issues are found, false if issues are found
+   */
+  bool VerifyZonePartialDropItems(DefinitionManager* definitionManager);
+
+  /**
+   * Warn about invalid dropset references in demon quest rewards.
+   * @return Always true as issues are only warned about
+   */
+  bool VerifyDemonQuestRewardDropSets();
+
   /**
    * Merges all pending drops from REDEFINE and APPEND drop sets into the
    * actual drop set and clears the sets. This should only be called once per
@@ -591,6 +774,19 @@ class ServerDataManager {
       std::unordered_map<uint32_t, std::shared_ptr<objects::ServerZone>>>
       mZoneData;
 
+  /// Map of server zone definitions with ServerZonePartial definitions
+  /// applied by zone definition ID, dynamic map ID and applied partial IDs.
+  /// Built the first time each combination is requested and shared by every
+  /// zone created from it afterwards. Entries are never invalidated as the
+  /// zone and partial definitions are only loaded once by LoadData. Anything
+  /// added later that reloads them must clear this map as well.
+  std::map<std::tuple<uint32_t, uint32_t, std::set<uint32_t>>,
+           std::shared_ptr<objects::ServerZone>>
+      mAppliedZoneData;
+
+  /// Lock for access to the applied server zone definitions
+  std::mutex mAppliedZoneLock;
+
   /// List of zone ID to dynamic map ID pairs of field zones
   std::list<std::pair<uint32_t, uint32_t>> mFieldZoneIDs;
 
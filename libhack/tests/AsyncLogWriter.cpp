@@ -0,0 +1,191 @@
+/**
+ * @file libhack/tests/AsyncLogWriter.cpp
+ * @ingroup libhack
+ *
+ * @author COMP Omega <compomega@tutanota.com>
+ *
+ * @brief Test and benchmark the asynchronous log writer.
+ *
+ * This file is part of the COMP_hack Library (libhack).
+ *
+ * Copyright (C) 2012-2020 COMP_hack Team <compomega@tutanota.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <PopIgnore.h>
+#include <PushIgnore.h>
+#include <gtest/gtest.h>
+
+// libhack Includes
+#include <AsyncLogWriter.h>
+#include <Log.h>
+
+// Standard C++11 Includes
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+using namespace libhack;
+
+/// Path of the log file written by the tests
+static const char* LOG_PATH = "TestAsyncLogWriter.log";
+
+/// Component every test message is logged under
+static const libcomp::GenericLogComponent_t LOG_COMPONENT =
+    (libcomp::GenericLogComponent_t)LogComponent_t::ZoneManager;
+
+/**
+ * Log messages from several threads at once.
+ * @param writer Writer to log to
+ * @param threadCount Number of logging threads
+ * @param messageCount Number of messages each thread logs
+ */
+static void LogFromThreads(const std::shared_ptr<AsyncLogWriter>& writer,
+                           int threadCount, int messageCount) {
+  std::vector<std::thread> threads;
+
+  for (int t = 0; t < threadCount; t++) {
+    threads.push_back(std::thread([writer, t, messageCount]() {
+      for (int i = 0; i < messageCount; i++) {
+        writer->Push(LOG_COMPONENT,
+                     libcomp::BaseLog::Level_t::LOG_LEVEL_INFO,
+                     libcomp::String("T%1 %2\n").Arg(t).Arg(i));
+      }
+    }));
+  }
+
+  for (auto& thread : threads) {
+    thread.join();
+  }
+}
+
+TEST(AsyncLogWriter, OrderAndCount) {
+  const int threadCount = 8;
+  const int messageCount = 20000;
+
+  std::remove(LOG_PATH);
+
+  // Block instead of dropping so every message must be written
+  auto writer = std::make_shared<AsyncLogWriter>(
+      LOG_PATH, 0, 0, 1024, AsyncLogWriter::Policy_t::BLOCK);
+  ASSERT_TRUE(writer->Open());
+
+  LogFromThreads(writer, threadCount, messageCount);
+  writer->Stop();
+
+  EXPECT_EQ(writer->GetDroppedCount(), 0u);
+
+  std::vector<int> next(threadCount, 0);
+  int lines = 0;
+
+  std::ifstream file(LOG_PATH);
+  std::string line;
+  while (std::getline(file, line)) {
+    auto pos = line.find(" ZoneManager: T");
+    ASSERT_NE(pos, std::string::npos) << line;
+
+    int t = 0, i = 0;
+    ASSERT_EQ(std::sscanf(line.c_str() + pos, " ZoneManager: T%d %d", &t,
+                          &i),
+              2)
+        << line;
+    ASSERT_GE(t, 0);
+    ASSERT_LT(t, threadCount);
+
+    // Messages from the same thread must keep the order they were logged in
+    EXPECT_EQ(next[(size_t)t], i);
+    next[(size_t)t] = i + 1;
+    lines++;
+  }
+
+  EXPECT_EQ(lines, threadCount * messageCount);
+
+  std::remove(LOG_PATH);
+}
+
+TEST(AsyncLogWriter, Rotate) {
+  std::remove(LOG_PATH);
+  std::remove((std::string(LOG_PATH) + ".1").c_str());
+
+  auto writer = std::make_shared<AsyncLogWriter>(
+      LOG_PATH, 128, 1, 1024, AsyncLogWriter::Policy_t::BLOCK);
+  ASSERT_TRUE(writer->Open());
+
+  // Wait past the flush interval after each message so every message is
+  // written in its own batch
+  for (int i = 0; i < 10; i++) {
+    LogFromThreads(writer, 1, 1);
+    std::this_thread::sleep_for(std::chrono::milliseconds(250));
+  }
+
+  writer->Stop();
+
+  std::ifstream backup(std::string(LOG_PATH) + ".1");
+  EXPECT_TRUE(backup.good());
+
+  std::ifstream file(LOG_PATH, std::ios::ate | std::ios::binary);
+  EXPECT_LE((size_t)file.tellg(), (size_t)128);
+
+  std::remove(LOG_PATH);
+  std::remove((std::string(LOG_PATH) + ".1").c_str());
+}
+
+TEST(AsyncLogWriter, Benchmark) {
+  const int messageCount = 100000;
+
+  for (int threadCount : {1, 2, 4, 8}) {
+    std::remove(LOG_PATH);
+
+    auto writer = std::make_shared<AsyncLogWriter>(LOG_PATH);
+    ASSERT_TRUE(writer->Open());
+
+    auto start = std::chrono::steady_clock::now();
+    LogFromThreads(writer, threadCount, messageCount);
+    auto logged = std::chrono::steady_clock::now();
+    writer->Stop();
+    auto stopped = std::chrono::steady_clock::now();
+
+    uint64_t total = (uint64_t)(threadCount * messageCount);
+    uint64_t pushTime =
+        (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+            logged - start)
+            .count();
+    uint64_t drainTime =
+        (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(
+            stopped - logged)
+            .count();
+
+    std::cout << threadCount << " thread(s): " << (pushTime / total)
+              << " ns per message logged, " << writer->GetDroppedCount()
+              << " dropped, " << drainTime << " us to drain" << std::endl;
+
+    EXPECT_LE(writer->GetDroppedCount(), total);
+  }
+
+  std::remove(LOG_PATH);
+}
+
+int main(int argc, char* argv[]) {
+  try {
+    ::testing::InitGoogleTest(&argc, argv);
+
+    return RUN_ALL_TESTS();
+  } catch (...) {
+    return EXIT_FAILURE;
+  }
+}
@@ -0,0 +1,331 @@
+/**
+ * @file libhack/tests/CaptureWriter.cpp
+ * @ingroup libhack
+ *
+ * @author COMP Omega <compomega@tutanota.com>
+ *
+ * @brief Test and benchmark the background packet capture writer.
+ *
+ * This file is part of the COMP_hack Library (libhack).
+ *
+ * Copyright (C) 2012-2020 COMP_hack Team <compomega@tutanota.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <PopIgnore.h>
+#include <PushIgnore.h>
+#include <gtest/gtest.h>
+
+// libhack Includes
+#include <CaptureWriter.h>
+#include <Constants.h>
+
+// Standard C++11 Includes
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+using namespace libhack;
+
+/// Address written to the header of every test capture
+static const char* CAPTURE_ADDRESS = "127.0.0.1";
+
+/**
+ * Capture file read back by the tests.
+ */
+struct CaptureContents {
+  /// Indicates if the file exists and has a valid header
+  bool Valid = false;
+
+  /// Address in the file header
+  std::string Address;
+
+  /// Real packet size of each record in the file
+  std::vector<uint32_t> RealSizes;
+
+  /// First byte of the packet data of each record
+  std::vector<uint8_t> FirstBytes;
+};
+
+/**
+ * Read a capture file the same way capgrep and capstat do.
+ * @param path Path to the capture file
+ * @return Contents of the file
+ */
+static CaptureContents ReadCapture(const std::string& path) {
+  CaptureContents contents;
+
+  std::ifstream file(path, std::ios::in | std::ios::binary);
+
+  uint32_t magic = 0, ver = 0, addressLength = 0;
+  uint64_t stamp = 0;
+  file.read((char*)&magic, 4);
+  file.read((char*)&ver, 4);
+  file.read((char*)&stamp, 8);
+  file.read((char*)&addressLength, 4);
+  if (!file.good() || magic != 0x4B434148 || ver != 0x00010100) {
+    return contents;
+  }
+
+  contents.Address.resize(addressLength);
+  file.read(&contents.Address[0], addressLength);
+
+  std::vector<char> buffer;
+  while (file.peek() != std::ifstream::traits_type::eof()) {
+    uint8_t source = 0;
+    uint64_t micro = 0;
+    uint32_t size = 0;
+    file.read((char*)&source, 1);
+    file.read((char*)&stamp, 8);
+    file.read((char*)&micro, 8);
+    file.read((char*)&size, 4);
+
+    buffer.resize(size);
+    if (!file.good() || size < 8 || !file.read(buffer.data(), size)) {
+      return contents;
+    }
+
+    uint32_t paddedSize = 0, realSize = 0;
+    memcpy(&paddedSize, buffer.data(), 4);
+    memcpy(&realSize, buffer.data() + 4, 4);
+    paddedSize = be32toh(paddedSize);
+    realSize = be32toh(realSize);
+
+    // The record holds the sizes and the padded packet data
+    if (paddedSize + 8 != size || realSize > paddedSize ||
+        paddedSize % BLOWFISH_BLOCK_SIZE) {
+      return contents;
+    }
+
+    contents.RealSizes.push_back(realSize);
+    contents.FirstBytes.push_back((uint8_t)buffer[8]);
+  }
+
+  contents.Valid = true;
+
+  return contents;
+}
+
+/**
+ * Queue a record on a stream.
+ * @param stream Stream to queue on
+ * @param data Packet data
+ * @param size Number of bytes of packet data
+ * @return true if the record was queued, false if it was dropped
+ */
+static bool PushRecord(const std::shared_ptr<CaptureStream>& stream,
+                       const char* data, uint32_t size) {
+  auto record = stream->Reserve();
+  if (!record) {
+    return false;
+  }
+
+  CaptureWriter::BuildRecord(*record, HACK_SOURCE_SERVER, data, size);
+  stream->Commit();
+
+  return true;
+}
+
+TEST(CaptureWriter, OrderAndFormat) {
+  const int recordCount = 5000;
+
+  auto writer = std::make_shared<CaptureWriter>("", 0, 8192);
+  ASSERT_TRUE(writer->Start());
+
+  auto stream = writer->OpenStream(CAPTURE_ADDRESS);
+  ASSERT_NE(nullptr, stream);
+
+  std::vector<char> data(300);
+  for (int i = 0; i < recordCount; i++) {
+    data[0] = (char)i;
+    ASSERT_TRUE(PushRecord(stream, data.data(), (uint32_t)(1 + i % 300)));
+  }
+
+  stream->Close();
+  writer->Stop();
+
+  auto path = stream->GetPath() + ".hack";
+  auto contents = ReadCapture(path);
+  ASSERT_TRUE(contents.Valid);
+  EXPECT_EQ(CAPTURE_ADDRESS, contents.Address);
+  ASSERT_EQ((size_t)recordCount, contents.RealSizes.size());
+
+  for (int i = 0; i < recordCount; i++) {
+    ASSERT_EQ((uint32_t)(1 + i % 300), contents.RealSizes[(size_t)i]);
+    ASSERT_EQ((uint8_t)i, contents.FirstBytes[(size_t)i]);
+  }
+
+  EXPECT_EQ(0u, writer->GetDroppedCount());
+
+  std::remove(path.c_str());
+}
+
+TEST(CaptureWriter, Rotate) {
+  const int recordCount = 100;
+  const size_t maxFileSize = 1024;
+
+  auto writer = std::make_shared<CaptureWriter>("", maxFileSize, 256);
+  ASSERT_TRUE(writer->Start());
+
+  auto stream = writer->OpenStream(CAPTURE_ADDRESS);
+  ASSERT_NE(nullptr, stream);
+
+  std::vector<char> data(100);
+  for (int i = 0; i < recordCount; i++) {
+    data[0] = (char)i;
+    ASSERT_TRUE(PushRecord(stream, data.data(), (uint32_t)data.size()));
+  }
+
+  stream->Close();
+  writer->Stop();
+
+  // Every file must open on its own and the records continue in order
+  int fileCount = 0;
+  int next = 0;
+  for (int part = 1;; part++) {
+    auto path = stream->GetPath();
+    if (part > 1) {
+      path += "." + std::to_string(part);
+    }
+
+    path += ".hack";
+
+    std::ifstream file(path);
+    if (!file.good()) {
+      break;
+    }
+
+    file.close();
+
+    auto contents = ReadCapture(path);
+    ASSERT_TRUE(contents.Valid) << path;
+    EXPECT_GT(contents.RealSizes.size(), 0u);
+
+    for (auto first : contents.FirstBytes) {
+      EXPECT_EQ((uint8_t)next++, first);
+    }
+
+    std::ifstream sized(path, std::ios::binary | std::ios::ate);
+    EXPECT_LE((size_t)sized.tellg(), maxFileSize);
+
+    fileCount++;
+    std::remove(path.c_str());
+  }
+
+  EXPECT_GT(fileCount, 1);
+  EXPECT_EQ(recordCount, next);
+}
+
+TEST(CaptureWriter, DropWhenFull) {
+  const int recordCount = 10000;
+  const size_t queueSize = 16;
+
+  auto writer = std::make_shared<CaptureWriter>("", 0, queueSize);
+  ASSERT_TRUE(writer->Start());
+
+  auto stream = writer->OpenStream(CAPTURE_ADDRESS);
+  ASSERT_NE(nullptr, stream);
+
+  // The writer only drains every so often so a burst fills the ring and
+  // the connection must never wait on it
+  std::vector<char> data(64);
+  int queued = 0;
+  for (int i = 0; i < recordCount; i++) {
+    queued += PushRecord(stream, data.data(), (uint32_t)data.size()) ? 1 : 0;
+  }
+
+  stream->Close();
+
+  // Records after the close are dropped too
+  EXPECT_FALSE(PushRecord(stream, data.data(), (uint32_t)data.size()));
+
+  writer->Stop();
+
+  auto path = stream->GetPath() + ".hack";
+  auto contents = ReadCapture(path);
+  ASSERT_TRUE(contents.Valid);
+
+  EXPECT_LT(queued, recordCount);
+  EXPECT_EQ((size_t)queued, contents.RealSizes.size());
+  EXPECT_EQ((uint64_t)(recordCount - queued + 1), stream->GetDroppedCount());
+  EXPECT_EQ(stream->GetDroppedCount(), writer->GetDroppedCount());
+
+  std::remove(path.c_str());
+}
+
+TEST(CaptureWriter, Benchmark) {
+  const int recordCount = 50000;
+  const uint32_t recordSize = 512;
+
+  std::vector<char> data(recordSize);
+
+  // Capture the way the connection did before: a record written straight
+  // to the file from the connection's thread
+  const char* syncPath = "TestCaptureWriterSync.hack";
+  std::vector<char> record;
+  auto start = std::chrono::steady_clock::now();
+  {
+    std::ofstream file(syncPath, std::ios::out | std::ios::binary);
+    for (int i = 0; i < recordCount; i++) {
+      CaptureWriter::BuildRecord(record, HACK_SOURCE_SERVER, data.data(),
+                                 recordSize);
+      file.write(record.data(), (std::streamsize)record.size());
+    }
+  }
+  auto syncTime = std::chrono::steady_clock::now() - start;
+  std::remove(syncPath);
+
+  auto writer = std::make_shared<CaptureWriter>("", 0, 65536);
+  ASSERT_TRUE(writer->Start());
+
+  auto stream = writer->OpenStream(CAPTURE_ADDRESS);
+  ASSERT_NE(nullptr, stream);
+
+  start = std::chrono::steady_clock::now();
+  for (int i = 0; i < recordCount; i++) {
+    PushRecord(stream, data.data(), recordSize);
+  }
+  auto asyncTime = std::chrono::steady_clock::now() - start;
+
+  stream->Close();
+  writer->Stop();
+  std::remove((stream->GetPath() + ".hack").c_str());
+
+  std::cout << "Capture records: "
+            << std::chrono::duration_cast<std::chrono::nanoseconds>(syncTime)
+                       .count() /
+                   recordCount
+            << " ns per record written synchronously, "
+            << std::chrono::duration_cast<std::chrono::nanoseconds>(
+                   asyncTime)
+                       .count() /
+                   recordCount
+            << " ns per record queued (" << stream->GetDroppedCount()
+            << " dropped)" << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+  try {
+    ::testing::InitGoogleTest(&argc, argv);
+
+    return RUN_ALL_TESTS();
+  } catch (...) {
+    return EXIT_FAILURE;
+  }
+}
@@ -0,0 +1,328 @@
+/**
+ * @file libhack/tests/CompressionPolicy.cpp
+ * @ingroup libhack
+ *
+ * @author COMP Omega <compomega@tutanota.com>
+ *
+ * @brief Test the compression policy and replay traffic through it.
+ *
+ * This file is part of the COMP_hack Library (libhack).
+ *
+ * Copyright (C) 2012-2020 COMP_hack Team <compomega@tutanota.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <PopIgnore.h>
+#include <PushIgnore.h>
+#include <gtest/gtest.h>
+
+// libcomp Includes
+#include <Packet.h>
+
+// libhack Includes
+#include <CompressionPolicy.h>
+
+// Standard C++11 Includes
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <vector>
+
+using namespace libhack;
+
+/**
+ * Build a flush that looks like a few small movement commands. These are
+ * always under the minimum compression size.
+ */
+static std::vector<char> MovementFlush(std::mt19937& rng) {
+  std::uniform_int_distribution<int> size(20, 100);
+  std::uniform_int_distribution<int> byte(0, 255);
+
+  std::vector<char> data((size_t)size(rng));
+  for (auto& c : data) {
+    c = (char)byte(rng);
+  }
+
+  return data;
+}
+
+/**
+ * Build a flush that looks like a list of entities sent on zone entry. The
+ * records share most of their fields so the flush compresses well.
+ */
+static std::vector<char> ZoneFlush(std::mt19937& rng) {
+  std::uniform_int_distribution<int> count(4, 60);
+  std::uniform_int_distribution<int> id(0, 50);
+
+  std::vector<char> data;
+  for (int i = count(rng); i > 0; i--) {
+    const char name[] = "Demon name padded to size";
+    int32_t entityID = 1000 + id(rng);
+    float pos[3] = {(float)id(rng), 0.f, (float)id(rng)};
+
+    data.insert(data.end(), (const char*)&entityID,
+                (const char*)&entityID + sizeof(entityID));
+    data.insert(data.end(), (const char*)pos, (const char*)pos + sizeof(pos));
+    data.insert(data.end(), name, name + sizeof(name));
+    data.insert(data.end(), 24, 0);
+  }
+
+  return data;
+}
+
+/**
+ * Build a flush of random bytes that does not compress.
+ */
+static std::vector<char> RandomFlush(std::mt19937& rng) {
+  std::uniform_int_distribution<int> size(200, 1500);
+  std::uniform_int_distribution<int> byte(0, 255);
+
+  std::vector<char> data((size_t)size(rng));
+  for (auto& c : data) {
+    c = (char)byte(rng);
+  }
+
+  return data;
+}
+
+/**
+ * Build a trace of outgoing flushes. The trace alternates between phases
+ * where most large flushes compress and phases where they do not.
+ */
+static std::vector<std::vector<char>> BuildTrace(size_t phases,
+                                                 size_t flushesPerPhase) {
+  std::mt19937 rng(4321);
+  std::uniform_int_distribution<int> kind(0, 9);
+
+  std::vector<std::vector<char>> trace;
+  for (size_t phase = 0; phase < phases; phase++) {
+    bool compressible = 0 == phase % 2;
+
+    for (size_t i = 0; i < flushesPerPhase; i++) {
+      int k = kind(rng);
+      if (k < 6) {
+        trace.push_back(MovementFlush(rng));
+      } else if (compressible == (k < 9)) {
+        trace.push_back(ZoneFlush(rng));
+      } else {
+        trace.push_back(RandomFlush(rng));
+      }
+    }
+  }
+
+  return trace;
+}
+
+/**
+ * Send a flush the way ChannelConnection::PreparePackets does, without the
+ * header and encryption.
+ * @param data Flush to send.
+ * @param policy Policy to decide with, null to always compress.
+ * @return Size of the flush as it would be sent.
+ */
+static int32_t SendFlush(const std::vector<char>& data,
+                         CompressionPolicy* policy) {
+  int32_t originalSize = (int32_t)data.size();
+
+  libcomp::Packet packet;
+  packet.WriteArray(&data[0], (uint32_t)data.size());
+
+  if (policy && !policy->ShouldCompress(&data[0], originalSize)) {
+    return originalSize;
+  }
+
+  packet.Seek(0);
+
+  auto start = std::chrono::steady_clock::now();
+  int32_t compressedSize = packet.Compress(originalSize);
+
+  if (policy) {
+    policy->RecordAttempt(
+        originalSize, compressedSize,
+        (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - start)
+            .count());
+  }
+
+  if (0 < compressedSize && compressedSize < originalSize) {
+    return compressedSize;
+  }
+
+  // Rebuild the flush to send it uncompressed.
+  packet.Clear();
+  packet.WriteArray(&data[0], (uint32_t)data.size());
+
+  return originalSize;
+}
+
+TEST(CompressionPolicy, SmallFlushesSkipped) {
+  CompressionPolicy policy;
+  std::vector<char> data((size_t)CompressionPolicy::MIN_SIZE, 0);
+
+  EXPECT_FALSE(policy.ShouldCompress(&data[0], 0));
+  EXPECT_FALSE(
+      policy.ShouldCompress(&data[0], CompressionPolicy::MIN_SIZE - 1));
+  EXPECT_EQ(policy.GetSkipCount(), 2u);
+
+  EXPECT_TRUE(policy.ShouldCompress(&data[0], CompressionPolicy::MIN_SIZE));
+  EXPECT_EQ(policy.GetSkipCount(), 2u);
+  EXPECT_EQ(policy.GetAttemptCount(), 0u);
+}
+
+TEST(CompressionPolicy, RandomFlushesSkipped) {
+  std::mt19937 rng(1234);
+  CompressionPolicy policy;
+
+  for (int i = 0; i < 1000; i++) {
+    auto data = RandomFlush(rng);
+    EXPECT_FALSE(policy.ShouldCompress(&data[0], (int32_t)data.size()));
+  }
+
+  EXPECT_EQ(policy.GetSkipCount(), 1000u);
+
+  // Random data at the minimum size still looks random
+  for (int i = 0; i < 1000; i++) {
+    auto data = MovementFlush(rng);
+    EXPECT_TRUE(CompressionPolicy::LooksRandom(&data[0],
+                                               (int32_t)data.size()));
+  }
+}
+
+TEST(CompressionPolicy, StructuredFlushesCompressed) {
+  std::mt19937 rng(1234);
+  CompressionPolicy policy;
+
+  for (int i = 0; i < 1000; i++) {
+    auto data = ZoneFlush(rng);
+    if (CompressionPolicy::MIN_SIZE <= (int32_t)data.size()) {
+      EXPECT_TRUE(policy.ShouldCompress(&data[0], (int32_t)data.size()));
+    }
+  }
+
+  EXPECT_EQ(policy.GetSkipCount(), 0u);
+
+  // Text compresses even though it is not a repeated record
+  const char text[] =
+      "Welcome to the channel. Please read the rules posted at the "
+      "entrance before you start to play.";
+  EXPECT_FALSE(
+      CompressionPolicy::LooksRandom(text, (int32_t)sizeof(text) - 1));
+}
+
+TEST(CompressionPolicy, RecordAttempt) {
+  CompressionPolicy policy;
+  EXPECT_EQ(policy.GetRatio(), 0.f);
+
+  for (int i = 0; i < 100; i++) {
+    policy.RecordAttempt(1000, 250, 10);
+  }
+
+  EXPECT_NEAR(policy.GetRatio(), 0.25f, 0.01f);
+
+  // A failed compression counts as no gain
+  for (int i = 0; i < 100; i++) {
+    policy.RecordAttempt(1000, 0, 10);
+  }
+
+  EXPECT_NEAR(policy.GetRatio(), 1.f, 0.01f);
+  EXPECT_EQ(policy.GetAttemptCount(), 200u);
+  EXPECT_EQ(policy.GetCompressTime(), 2000u);
+  EXPECT_EQ(policy.GetSkipCount(), 0u);
+}
+
+TEST(CompressionPolicy, Totals) {
+  std::mt19937 rng(1234);
+  std::vector<char> zeros(1000, 0);
+  auto random = RandomFlush(rng);
+
+  CompressionPolicy::GetTotals(true);
+
+  CompressionPolicy a;
+  CompressionPolicy b;
+
+  EXPECT_FALSE(a.ShouldCompress(&zeros[0], 50));
+  EXPECT_TRUE(a.ShouldCompress(&zeros[0], 1000));
+  a.RecordAttempt(1000, 400, 7);
+  EXPECT_TRUE(b.ShouldCompress(&zeros[0], 500));
+  b.RecordAttempt(500, 600, 3);
+  EXPECT_FALSE(b.ShouldCompress(&random[0], 200));
+
+  auto totals = CompressionPolicy::GetTotals(true);
+  EXPECT_EQ(totals.Flushes, 4u);
+  EXPECT_EQ(totals.Attempts, 2u);
+  EXPECT_EQ(totals.Skipped, 2u);
+  EXPECT_EQ(totals.CompressTime, 10u);
+  EXPECT_EQ(totals.BytesIn, 1750u);
+  EXPECT_EQ(totals.BytesOut, 1150u);
+
+  totals = CompressionPolicy::GetTotals();
+  EXPECT_EQ(totals.Flushes, 0u);
+  EXPECT_EQ(totals.BytesIn, 0u);
+}
+
+TEST(CompressionPolicy, ReplayBenchmark) {
+  auto trace = BuildTrace(10, 4000);
+
+  uint64_t bytesIn = 0;
+  for (auto& flush : trace) {
+    bytesIn += flush.size();
+  }
+
+  // Every flush compressed, as it was done before the policy
+  uint64_t alwaysBytes = 0;
+  auto start = std::chrono::steady_clock::now();
+  for (auto& flush : trace) {
+    alwaysBytes += (uint64_t)SendFlush(flush, nullptr);
+  }
+  auto alwaysTime = std::chrono::steady_clock::now() - start;
+
+  CompressionPolicy policy;
+  uint64_t policyBytes = 0;
+  start = std::chrono::steady_clock::now();
+  for (auto& flush : trace) {
+    policyBytes += (uint64_t)SendFlush(flush, &policy);
+  }
+  auto policyTime = std::chrono::steady_clock::now() - start;
+
+  // Skipping flushes that do not pay off costs little in size
+  EXPECT_LE(policyBytes, alwaysBytes + alwaysBytes / 100);
+  EXPECT_LT(policy.GetSkipCount(), (uint64_t)trace.size());
+  EXPECT_EQ(policy.GetSkipCount() + policy.GetAttemptCount(),
+            (uint64_t)trace.size());
+
+  std::cout << "Compression replay of " << trace.size() << " flushes ("
+            << bytesIn << " bytes): always "
+            << std::chrono::duration_cast<std::chrono::microseconds>(
+                   alwaysTime)
+                   .count()
+            << " us for " << alwaysBytes << " bytes, policy "
+            << std::chrono::duration_cast<std::chrono::microseconds>(
+                   policyTime)
+                   .count()
+            << " us for " << policyBytes << " bytes ("
+            << policy.GetSkipCount() << " skipped, "
+            << policy.GetCompressTime() / 1000 << " us compressing)"
+            << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+  try {
+    ::testing::InitGoogleTest(&argc, argv);
+
+    return RUN_ALL_TESTS();
+  } catch (...) {
+    return EXIT_FAILURE;
+  }
+}
@@ -0,0 +1,304 @@
+/**
+ * @file libhack/tests/DefinitionTable.cpp
+ * @ingroup libhack
+ *
+ * @author COMP Omega <compomega@tutanota.com>
+ *
+ * @brief Test and benchmark the frozen definition tables.
+ *
+ * This file is part of the COMP_hack Library (libhack).
+ *
+ * Copyright (C) 2012-2020 COMP_hack Team <compomega@tutanota.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <PopIgnore.h>
+#include <PushIgnore.h>
+#include <gtest/gtest.h>
+
+// libhack Includes
+#include <DefinitionManager.h>
+#include <DefinitionTable.h>
+
+// Standard C++11 Includes
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <unordered_map>
+
+using namespace libhack;
+
+/// Record stored in the test tables
+struct TestRecord {
+  /// ID the record was added with
+  uint32_t ID;
+
+  /// Order the record was added in
+  uint32_t Order;
+};
+
+/**
+ * Build a list of unique IDs in random order. Every ID is one more than a
+ * multiple of the stride so the values between them are known misses. A
+ * small stride builds a table indexed by array and a large stride builds a
+ * table indexed by hash map.
+ */
+static std::vector<uint32_t> RandomIDs(std::mt19937& rng, size_t count,
+                                       uint32_t stride = 2) {
+  std::vector<uint32_t> ids;
+  for (uint32_t i = 0; i < (uint32_t)count; i++) {
+    ids.push_back(i * stride + 1);
+  }
+
+  std::shuffle(ids.begin(), ids.end(), rng);
+
+  return ids;
+}
+
+TEST(DefinitionTable, Empty) {
+  DefinitionTable<uint32_t, TestRecord> table;
+  table.Freeze();
+
+  EXPECT_EQ(table.Size(), 0u);
+  EXPECT_TRUE(table.begin() == table.end());
+  EXPECT_EQ(table.Find(0), nullptr);
+  EXPECT_EQ(table.Get(0), nullptr);
+  EXPECT_EQ(table.Get(0xFFFFFFFF), nullptr);
+}
+
+/**
+ * Check every stored ID is found and every ID around them is a miss.
+ */
+static void CheckHitsAndMisses(uint32_t stride) {
+  std::mt19937 rng(1234);
+  auto ids = RandomIDs(rng, 1000, stride);
+
+  DefinitionTable<uint32_t, TestRecord> table;
+  std::unordered_map<uint32_t, std::shared_ptr<TestRecord>> reference;
+  for (uint32_t i = 0; i < (uint32_t)ids.size(); i++) {
+    auto record = std::shared_ptr<TestRecord>(new TestRecord{ids[i], i});
+    table.Insert(ids[i], record);
+    reference[ids[i]] = record;
+  }
+
+  table.Freeze();
+  ASSERT_EQ(table.Size(), reference.size());
+
+  // Every stored ID is found and both lookups return the same record
+  for (auto& pair : reference) {
+    auto& found = table.Find(pair.first);
+    EXPECT_EQ(found, pair.second);
+    EXPECT_EQ(table.Get(pair.first), pair.second.get());
+  }
+
+  // IDs below, between and above the stored IDs are misses
+  uint32_t last = (uint32_t)(ids.size() - 1) * stride + 1;
+  EXPECT_EQ(table.Get(0), nullptr);
+  for (uint32_t id = 2; id < last; id++) {
+    if (id % stride != 1) {
+      EXPECT_EQ(table.Find(id), nullptr) << "ID " << id;
+      EXPECT_EQ(table.Get(id), nullptr) << "ID " << id;
+    }
+  }
+
+  EXPECT_EQ(table.Get(last + 1), nullptr);
+  EXPECT_EQ(table.Get(last + stride), nullptr);
+  EXPECT_EQ(table.Get(0xFFFFFFFF), nullptr);
+}
+
+TEST(DefinitionTable, HitsAndMissesIndexed) { CheckHitsAndMisses(2); }
+
+TEST(DefinitionTable, HitsAndMissesHashed) { CheckHitsAndMisses(1000); }
+
+TEST(DefinitionTable, SignedIDs) {
+  DefinitionTable<int32_t, TestRecord> table;
+  table.Insert(-5, std::shared_ptr<TestRecord>(new TestRecord{0, 0}));
+  table.Insert(3, std::shared_ptr<TestRecord>(new TestRecord{0, 1}));
+  table.Insert(-2, std::shared_ptr<TestRecord>(new TestRecord{0, 2}));
+  table.Freeze();
+
+  ASSERT_NE(table.Get(-5), nullptr);
+  ASSERT_NE(table.Get(-2), nullptr);
+  ASSERT_NE(table.Get(3), nullptr);
+  EXPECT_EQ(table.Get(-5)->Order, 0u);
+  EXPECT_EQ(table.Get(-2)->Order, 2u);
+  EXPECT_EQ(table.Get(3)->Order, 1u);
+  EXPECT_EQ(table.Get(-6), nullptr);
+  EXPECT_EQ(table.Get(0), nullptr);
+  EXPECT_EQ(table.Get(4), nullptr);
+  EXPECT_EQ(table.Get(INT32_MIN), nullptr);
+  EXPECT_EQ(table.Get(INT32_MAX), nullptr);
+
+  // IDs at both ends of the range are too sparse for the array index
+  table.Insert(INT32_MIN, std::shared_ptr<TestRecord>(new TestRecord{0, 3}));
+  table.Insert(INT32_MAX, std::shared_ptr<TestRecord>(new TestRecord{0, 4}));
+  table.Freeze();
+
+  ASSERT_NE(table.Get(INT32_MIN), nullptr);
+  ASSERT_NE(table.Get(INT32_MAX), nullptr);
+  EXPECT_EQ(table.Get(INT32_MIN)->Order, 3u);
+  EXPECT_EQ(table.Get(-2)->Order, 2u);
+  EXPECT_EQ(table.Get(INT32_MAX)->Order, 4u);
+  EXPECT_EQ(table.Get(INT32_MIN + 1), nullptr);
+  EXPECT_EQ(table.Get(0), nullptr);
+}
+
+TEST(DefinitionTable, Ordering) {
+  std::mt19937 rng(5678);
+  auto ids = RandomIDs(rng, 500);
+
+  DefinitionTable<uint32_t, TestRecord> table;
+  for (uint32_t i = 0; i < (uint32_t)ids.size(); i++) {
+    table.Insert(ids[i],
+                 std::shared_ptr<TestRecord>(new TestRecord{ids[i], i}));
+  }
+
+  table.Freeze();
+
+  // Iteration is in ID order no matter the order records were added in
+  std::sort(ids.begin(), ids.end());
+  ASSERT_EQ(table.Size(), ids.size());
+
+  size_t i = 0;
+  for (auto& entry : table) {
+    EXPECT_EQ(entry.first, ids[i]);
+    EXPECT_EQ(entry.second->ID, ids[i]);
+    i++;
+  }
+}
+
+TEST(DefinitionTable, DuplicatesKeepLast) {
+  DefinitionTable<uint32_t, TestRecord> table;
+  table.Insert(7, std::shared_ptr<TestRecord>(new TestRecord{7, 0}));
+  table.Insert(3, std::shared_ptr<TestRecord>(new TestRecord{3, 1}));
+  table.Insert(7, std::shared_ptr<TestRecord>(new TestRecord{7, 2}));
+  table.Insert(5, std::shared_ptr<TestRecord>(new TestRecord{5, 3}));
+  table.Insert(7, std::shared_ptr<TestRecord>(new TestRecord{7, 4}));
+  table.Insert(3, std::shared_ptr<TestRecord>(new TestRecord{3, 5}));
+  table.Freeze();
+
+  ASSERT_EQ(table.Size(), 3u);
+  ASSERT_NE(table.Get(3), nullptr);
+  ASSERT_NE(table.Get(5), nullptr);
+  ASSERT_NE(table.Get(7), nullptr);
+  EXPECT_EQ(table.Get(3)->Order, 5u);
+  EXPECT_EQ(table.Get(5)->Order, 3u);
+  EXPECT_EQ(table.Get(7)->Order, 4u);
+
+  // Freezing again keeps the table unchanged
+  table.Freeze();
+  EXPECT_EQ(table.Size(), 3u);
+  EXPECT_EQ(table.Get(7)->Order, 4u);
+}
+
+TEST(DefinitionTable, ManagerMisses) {
+  // Nothing is loaded so every lookup is a miss
+  DefinitionManager definitionManager;
+
+  EXPECT_EQ(definitionManager.GetDevilDataPtr(0), nullptr);
+  EXPECT_EQ(definitionManager.GetDevilDataPtr(1), nullptr);
+  EXPECT_EQ(definitionManager.GetItemDataPtr(0), nullptr);
+  EXPECT_EQ(definitionManager.GetItemDataPtr(1), nullptr);
+  EXPECT_EQ(definitionManager.GetSkillDataPtr(0), nullptr);
+  EXPECT_EQ(definitionManager.GetSkillDataPtr(1), nullptr);
+  EXPECT_EQ(definitionManager.GetStatusDataPtr(0), nullptr);
+  EXPECT_EQ(definitionManager.GetStatusDataPtr(1), nullptr);
+
+  EXPECT_EQ(definitionManager.GetDevilData(1u), nullptr);
+  EXPECT_EQ(definitionManager.GetItemData(1u), nullptr);
+  EXPECT_EQ(definitionManager.GetSkillData(1u), nullptr);
+  EXPECT_EQ(definitionManager.GetStatusData(1u), nullptr);
+}
+
+/**
+ * Time lookups of a mix of hits and misses in random order against the
+ * unordered map and shared pointer copies the accessors used before.
+ */
+static void Benchmark(uint32_t stride, const char* name) {
+  const size_t count = 20000;
+  const size_t lookups = 2000000;
+
+  std::mt19937 rng(91011);
+  auto ids = RandomIDs(rng, count, stride);
+
+  DefinitionTable<uint32_t, TestRecord> table;
+  std::unordered_map<uint32_t, std::shared_ptr<TestRecord>> map;
+  for (uint32_t i = 0; i < (uint32_t)ids.size(); i++) {
+    auto record = std::shared_ptr<TestRecord>(new TestRecord{ids[i], i});
+    table.Insert(ids[i], record);
+    map[ids[i]] = record;
+  }
+
+  table.Freeze();
+
+  std::uniform_int_distribution<uint32_t> idDist(0, (uint32_t)count * stride);
+  std::vector<uint32_t> keys;
+  for (size_t i = 0; i < lookups; i++) {
+    keys.push_back(idDist(rng));
+  }
+
+  uint64_t mapSum = 0;
+  auto start = std::chrono::steady_clock::now();
+  for (auto key : keys) {
+    std::shared_ptr<TestRecord> record;
+    auto it = map.find(key);
+    if (it != map.end()) {
+      record = it->second;
+    }
+
+    if (record) {
+      mapSum += record->Order;
+    }
+  }
+  auto mapTime = std::chrono::steady_clock::now() - start;
+
+  uint64_t tableSum = 0;
+  start = std::chrono::steady_clock::now();
+  for (auto key : keys) {
+    auto record = table.Get(key);
+    if (record) {
+      tableSum += record->Order;
+    }
+  }
+  auto tableTime = std::chrono::steady_clock::now() - start;
+
+  EXPECT_EQ(mapSum, tableSum);
+
+  std::cout << name << " definition lookups: "
+            << std::chrono::duration_cast<std::chrono::nanoseconds>(mapTime)
+                       .count() /
+                   (int64_t)lookups
+            << " ns per map lookup, "
+            << std::chrono::duration_cast<std::chrono::nanoseconds>(tableTime)
+                       .count() /
+                   (int64_t)lookups
+            << " ns per table lookup" << std::endl;
+}
+
+TEST(DefinitionTable, Benchmark) {
+  Benchmark(2, "Dense");
+  Benchmark(1000, "Sparse");
+}
+
+int main(int argc, char* argv[]) {
+  try {
+    ::testing::InitGoogleTest(&argc, argv);
+
+    return RUN_ALL_TESTS();
+  } catch (...) {
+    return EXIT_FAILURE;
+  }
+}
@@ -0,0 +1,182 @@
+/**
+ * @file libhack/tests/ServerZoneData.cpp
+ * @ingroup libhack
+ *
+ * @author COMP Omega <compomega@tutanota.com>
+ *
+ * @brief Test and benchmark the shared zone definitions with partials.
+ *
+ * This file is part of the COMP_hack Library (libhack).
+ *
+ * Copyright (C) 2012-2020 COMP_hack Team <compomega@tutanota.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <PopIgnore.h>
+#include <PushIgnore.h>
+#include <gtest/gtest.h>
+
+// libcomp Includes
+#include <DataStore.h>
+
+// libhack Includes
+#include <ServerDataManager.h>
+
+// object Includes
+#include <ServerZone.h>
+
+// Standard C++11 Includes
+#include <chrono>
+#include <iostream>
+#include <set>
+#include <vector>
+
+using namespace libhack;
+
+/// Data store of the testing data, tests are run from the build directory
+/// where contrib/testing is copied to
+static libcomp::DataStore* gDataStore = nullptr;
+
+/// Zone and dynamic map ID of the test zone
+static const uint32_t TEST_ZONE_ID = 1;
+
+/// Number of instance partials defined for the test zone
+static const uint32_t TEST_PARTIAL_COUNT = 8;
+
+/// Number of spots each test partial adds
+static const size_t TEST_PARTIAL_SPOTS = 4;
+
+/**
+ * Get every combination of the test partials as an instance variant would
+ * list them, one combination per bit pattern.
+ */
+static std::vector<std::set<uint32_t>> PartialCombinations() {
+  std::vector<std::set<uint32_t>> combinations;
+  for (uint32_t mask = 1; mask < (1u << TEST_PARTIAL_COUNT); mask++) {
+    std::set<uint32_t> partialIDs;
+    for (uint32_t i = 0; i < TEST_PARTIAL_COUNT; i++) {
+      if (mask & (1u << i)) {
+        partialIDs.insert(i + 1);
+      }
+    }
+
+    combinations.push_back(partialIDs);
+  }
+
+  return combinations;
+}
+
+TEST(ServerZoneData, SharesAppliedDefinitions) {
+  ServerDataManager serverDataManager;
+  ASSERT_TRUE(serverDataManager.LoadData(gDataStore, nullptr));
+
+  auto base =
+      serverDataManager.GetZoneData(TEST_ZONE_ID, TEST_ZONE_ID, false);
+  ASSERT_NE(base, nullptr);
+  size_t baseSpots = base->SpotsCount();
+  size_t baseTriggers = base->TriggersCount();
+
+  // Nothing is applied automatically to the test zone
+  EXPECT_EQ(serverDataManager.GetZoneData(TEST_ZONE_ID, TEST_ZONE_ID, true),
+            base);
+
+  auto applied = serverDataManager.GetZoneData(TEST_ZONE_ID, TEST_ZONE_ID,
+                                               true, {1, 2});
+  ASSERT_NE(applied, nullptr);
+  EXPECT_NE(applied, base);
+  EXPECT_EQ(applied->SpotsCount(), baseSpots + 2 * TEST_PARTIAL_SPOTS);
+  EXPECT_EQ(applied->TriggersCount(), baseTriggers + 2);
+
+  // The same partials always give the same definition
+  EXPECT_EQ(serverDataManager.GetZoneData(TEST_ZONE_ID, TEST_ZONE_ID, true,
+                                          {2, 1}),
+            applied);
+
+  // Partials that do not exist are dropped before the definition is found
+  EXPECT_EQ(serverDataManager.GetZoneData(TEST_ZONE_ID, TEST_ZONE_ID, true,
+                                          {1, 2, 1000}),
+            applied);
+
+  auto other =
+      serverDataManager.GetZoneData(TEST_ZONE_ID, TEST_ZONE_ID, true, {1});
+  ASSERT_NE(other, nullptr);
+  EXPECT_NE(other, applied);
+  EXPECT_EQ(other->SpotsCount(), baseSpots + TEST_PARTIAL_SPOTS);
+
+  // The loaded definition is never changed
+  EXPECT_EQ(base->SpotsCount(), baseSpots);
+  EXPECT_EQ(base->TriggersCount(), baseTriggers);
+}
+
+TEST(ServerZoneData, InstanceCreationBenchmark) {
+  const int passes = 20;
+
+  ServerDataManager serverDataManager;
+  ASSERT_TRUE(serverDataManager.LoadData(gDataStore, nullptr));
+
+  auto combinations = PartialCombinations();
+
+  // The first instance of each variant builds its definition, which is
+  // what every instance creation did before definitions were shared
+  std::vector<std::shared_ptr<objects::ServerZone>> built;
+  auto start = std::chrono::steady_clock::now();
+  for (auto& partialIDs : combinations) {
+    built.push_back(serverDataManager.GetZoneData(
+        TEST_ZONE_ID, TEST_ZONE_ID, true, partialIDs));
+  }
+  auto buildTime = std::chrono::steady_clock::now() - start;
+
+  size_t shared = 0;
+  start = std::chrono::steady_clock::now();
+  for (int pass = 0; pass < passes; pass++) {
+    for (size_t i = 0; i < combinations.size(); i++) {
+      shared += serverDataManager.GetZoneData(TEST_ZONE_ID, TEST_ZONE_ID,
+                                              true, combinations[i]) ==
+                built[i];
+    }
+  }
+  auto sharedTime = std::chrono::steady_clock::now() - start;
+
+  EXPECT_EQ(shared, combinations.size() * passes);
+
+  std::cout << "Instance zone definitions for " << combinations.size()
+            << " variants: "
+            << std::chrono::duration_cast<std::chrono::nanoseconds>(buildTime)
+                       .count() /
+                   (int64_t)combinations.size()
+            << " ns per definition built, "
+            << std::chrono::duration_cast<std::chrono::nanoseconds>(
+                   sharedTime)
+                       .count() /
+                   (int64_t)(combinations.size() * passes)
+            << " ns per definition shared" << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+  try {
+    ::testing::InitGoogleTest(&argc, argv);
+
+    libcomp::DataStore store(argv[0]);
+    if (!store.AddSearchPaths({"testing/datastore"})) {
+      return EXIT_FAILURE;
+    }
+
+    gDataStore = &store;
+
+    return RUN_ALL_TESTS();
+  } catch (...) {
+    return EXIT_FAILURE;
+  }
+}
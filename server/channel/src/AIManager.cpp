@@ -63,9 +63,11 @@
 
 // channel Includes
 #include "AICommand.h"
+#include "AIUpdateSchedule.h"
 #include "ChannelServer.h"
 #include "CharacterManager.h"
 #include "EventManager.h"
+#include "Simulation.h"
 #include "SkillManager.h"
 #include "TokuseiManager.h"
 #include "ZoneManager.h"
@@ -269,9 +271,30 @@ bool AIManager::Prepare(const std::shared_ptr<ActiveEntityState>& eState,
 
 void AIManager::UpdateActiveStates(const std::shared_ptr<Zone>& zone,
                                    uint64_t now, bool isNight) {
+  // Gather the positions AI entities are scheduled around once. Player
+  // and partner positions are moved by their own connections so the last
+  // position calculated for them is used as is.
+  AIUpdateSchedule schedule;
+  for (auto& client : zone->GetConnectionList()) {
+    auto state = client->GetClientState();
+    std::list<std::shared_ptr<ActiveEntityState>> entities = {
+        state->GetCharacterState(), state->GetDemonState()};
+    for (auto& entity : entities) {
+      if (entity && entity->Ready() && entity->GetZone() == zone) {
+        schedule.AddAnchor(entity->GetCurrentX(), entity->GetCurrentY());
+      }
+    }
+  }
+
+  for (auto& ally : zone->GetAllies()) {
+    ally->RefreshCurrentPosition(now);
+    schedule.AddAnchor(ally->GetCurrentX(), ally->GetCurrentY());
+  }
+
   std::list<std::shared_ptr<ActiveEntityState>> updated;
   for (auto eState : zone->GetEnemiesAndAllies()) {
-    if (UpdateState(eState, now, isNight)) {
+    if (IsUpdateDue(eState, schedule, now) &&
+        UpdateState(eState, now, isNight)) {
       updated.push_back(eState);
     }
   }
@@ -375,7 +398,7 @@ void AIManager::CombatSkillHit(
       // there is a chance they will target them now (20% chance by
       // default)
       if (aiState->GetTargetEntityID() != source->GetEntityID() &&
-          RNG(int32_t, 1, 10) <= 2) {
+          SIM_RNG(int32_t, 1, 10) <= 2) {
         UpdateAggro(eState, source->GetEntityID());
       }
 
@@ -454,13 +477,13 @@ void AIManager::CombatSkillComplete(
         // If the target is hitstunned, use again to attempt to combo
         // into knockback most of the time. Even if no combo occurs,
         // do not wait to use the next skill.
-        combo = RNG(int32_t, 1, 10) <= 9;
+        combo = SIM_RNG(int32_t, 1, 10) <= 9;
         wait = false;
       } else {
         // If the target was still hit, repeat attack 30% of the
         // time, 10% if they were not hit
-        combo = (hit && RNG(int32_t, 1, 10) <= 3) ||
-                (!hit && RNG(int32_t, 1, 10) == 1);
+        combo = (hit && SIM_RNG(int32_t, 1, 10) <= 3) ||
+                (!hit && SIM_RNG(int32_t, 1, 10) == 1);
       }
 
       if (combo && !aiState->GetCurrentCommand()) {
@@ -869,8 +892,8 @@ bool AIManager::Circle(const std::shared_ptr<ActiveEntityState>& eState,
 
   // Rotate the starting point around the target for the second
   // (or third) point
-  int32_t pointCount = RNG(int32_t, 1, 2);
-  bool invert = RNG(int32_t, 1, 2) == 1;
+  int32_t pointCount = SIM_RNG(int32_t, 1, 2);
+  bool invert = SIM_RNG(int32_t, 1, 2) == 1;
   for (int32_t i = 0; i < pointCount; i++) {
     Point prev = pathing.size() > 0 ? pathing.back() : src;
     Point p = zoneManager->RotatePoint(prev, target, invert ? -0.52f : 0.52f);
@@ -902,6 +925,39 @@ bool AIManager::Circle(const std::shared_ptr<ActiveEntityState>& eState,
   return false;
 }
 
+bool AIManager::IsUpdateDue(const std::shared_ptr<ActiveEntityState>& eState,
+                            const AIUpdateSchedule& schedule, uint64_t now) {
+  auto aiState = eState->GetAIState();
+  if (!aiState || eState->GetEntityType() != EntityType_t::ENEMY) {
+    return true;
+  }
+
+  // Despawns always happen on time
+  uint64_t despawnTimout = aiState->GetDespawnTimeout();
+  if (despawnTimout && despawnTimout <= now) {
+    return true;
+  }
+
+  // Anything engaged, following or scripted runs every tick
+  if (aiState->IsAggro() || aiState->HasFollowTarget() ||
+      aiState->StatusChanged() || aiState->GetTargetEntityID() > 0 ||
+      aiState->ActionOverridesCount() > 0 ||
+      eState->GetOpponentIDs().size() > 0) {
+    aiState->SetNextLODUpdate(0);
+    return true;
+  }
+
+  eState->RefreshCurrentPosition(now);
+  auto rate = schedule.GetRate(eState->GetCurrentX(), eState->GetCurrentY(),
+                               eState->IsMoving());
+
+  uint64_t nextUpdate = aiState->GetNextLODUpdate();
+  bool due = AIUpdateSchedule::IsDue(rate, nextUpdate, now);
+  aiState->SetNextLODUpdate(nextUpdate);
+
+  return due;
+}
+
 bool AIManager::UpdateState(const std::shared_ptr<ActiveEntityState>& eState,
                             uint64_t now, bool isNight) {
   eState->RefreshCurrentPosition(now);
@@ -1395,7 +1451,7 @@ bool AIManager::UpdateEnemyState(
     if (!CanRetrySkill(eState, activated)) {
       // Somehow we have an error
       cancelAndReset = true;
-    } else if (!skillActivationWait && RNG(uint16_t, 1, 2) == 1) {
+    } else if (!skillActivationWait && SIM_RNG(uint16_t, 1, 2) == 1) {
       // Chance to cancel and reset if we've waited for a while
       cancelAndReset = true;
     } else if (aiState->GetFollowEntityID() > 0 &&
@@ -1478,7 +1534,7 @@ bool AIManager::UpdateEnemyState(
     uint32_t waitTime = 0;
 
     int16_t waitChance = (int16_t)(100.f * aiState->GetAggression());
-    if (RNG(int16_t, 1, waitChance > 25 ? waitChance : 25) <= 20) {
+    if (SIM_RNG(int16_t, 1, waitChance > 25 ? waitChance : 25) <= 20) {
       // 20% chance to just wait (lower for high aggression)
       waitTime = 1000;
     } else if (eState->CurrentSkillsCount() > 0) {
@@ -1640,19 +1696,13 @@ void AIManager::Wander(const std::shared_ptr<ActiveEntityState>& eState,
       dest.y = (float)(spawnLocation->GetY() - point.y);
 
       if (wanderBack) {
-        std::list<Point> vertices;
-        vertices.push_back(Point(spawnLocation->GetX(), spawnLocation->GetY()));
-        vertices.push_back(
-            Point(spawnLocation->GetX() + spawnLocation->GetWidth(),
-                  spawnLocation->GetY()));
-        vertices.push_back(
-            Point(spawnLocation->GetX() + spawnLocation->GetWidth(),
-                  spawnLocation->GetY() - spawnLocation->GetHeight()));
-        vertices.push_back(
-            Point(spawnLocation->GetX(),
-                  spawnLocation->GetY() - spawnLocation->GetHeight()));
-
-        wanderBack = !zoneManager->PointInPolygon(source, vertices);
+        // The spawn location is an axis aligned rectangle so there is no
+        // need to build a polygon to check if the entity is still in it
+        wanderBack =
+            source.x < spawnLocation->GetX() ||
+            source.x > spawnLocation->GetX() + spawnLocation->GetWidth() ||
+            source.y > spawnLocation->GetY() ||
+            source.y < spawnLocation->GetY() - spawnLocation->GetHeight();
       }
     } else if (spotID) {
       // Wander using spot, clear if somehow set invalid (via script etc)
@@ -1663,9 +1713,10 @@ void AIManager::Wander(const std::shared_ptr<ActiveEntityState>& eState,
         auto spotIter = dynamicMap->Spots.find(spotID);
         if (spotIter != dynamicMap->Spots.end()) {
           auto spot = spotIter->second;
-          dest = zoneManager->GetRandomSpotPoint(spot->Definition);
+          dest = zoneManager->GetRandomSpotPoint(spot, zone);
 
-          wanderBack &= !zoneManager->PointInPolygon(source, spot->Vertices);
+          wanderBack &= !spot->InBoundaries(source) ||
+                        !zoneManager->PointInPolygon(source, spot->Vertices);
         } else {
           error = true;
         }
@@ -1732,8 +1783,8 @@ void AIManager::Wander(const std::shared_ptr<ActiveEntityState>& eState,
   uint16_t maxWait = aiState->GetWanderWaitMax();
   QueueWaitCommand(
       aiState,
-      (uint32_t)(RNG(int32_t, (int32_t)minWait,
-                     (int32_t)(maxWait > minWait ? maxWait : minWait)) *
+      (uint32_t)(SIM_RNG(int32_t, (int32_t)minWait,
+                         (int32_t)(maxWait > minWait ? maxWait : minWait)) *
                  1000));
 }
 
@@ -1827,7 +1878,7 @@ std::shared_ptr<ActiveEntityState> AIManager::Retarget(
     // If the entity has a low aggression level, check if targetting should
     // occur
     uint8_t aggroChance = (uint8_t)(aiState->GetAggression() * 100.f);
-    if (aggroChance < 100 && RNG(int32_t, 1, 100) > aggroChance) {
+    if (aggroChance < 100 && SIM_RNG(int32_t, 1, 100) > aggroChance) {
       if (currentTarget > 0) {
         UpdateAggro(eState, -1);
       }
@@ -2000,7 +2051,7 @@ std::shared_ptr<ActiveEntityState> AIManager::Retarget(
         target = zone->GetActiveEntity(*scriptResult);
       }
     } else {
-      target = libcomp::Randomizer::GetEntry(possibleTargets);
+      target = Simulation::GetEntry(possibleTargets);
     }
 
     newTarget = target ? target->GetEntityID() : -1;
@@ -2371,7 +2422,7 @@ bool AIManager::PrepareSkillUsage(
 
       uint8_t selectedActionType = 0;
       if (totalWeight > 0) {
-        uint16_t rVal = RNG(uint16_t, 1, totalWeight);
+        uint16_t rVal = SIM_RNG(uint16_t, 1, totalWeight);
         for (auto& pair : actionTypeWeights) {
           if (pair.second >= rVal) {
             selectedActionType = pair.first;
@@ -2417,7 +2468,7 @@ bool AIManager::PrepareSkillUsage(
         totalWeight = (uint16_t)(totalWeight + wSkill.second);
       }
 
-      uint16_t rVal = RNG(uint16_t, 1, totalWeight);
+      uint16_t rVal = SIM_RNG(uint16_t, 1, totalWeight);
       for (auto& wSkill : weightedSkills) {
         if (wSkill.second >= rVal) {
           skillData = wSkill.first;
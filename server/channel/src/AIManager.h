@@ -44,6 +44,7 @@ namespace channel {
 
 class AICommand;
 class AIMoveCommand;
+class AIUpdateSchedule;
 class ChannelServer;
 class EnemyBase;
 class Point;
@@ -281,6 +282,21 @@ class AIManager {
               float y, bool interrupt = false, float distance = 800.f);
 
  private:
+  /**
+   * Determine if an entity's AI should be updated this tick based upon how
+   * far it is from the nearest player or ally. Entities that are engaged,
+   * following, scripted or about to despawn are always updated. Idle and
+   * wandering enemies are updated every tick near players, at a reduced
+   * rate further away and not at all when far away and not moving.
+   * @param eState Pointer to the entity state to check
+   * @param schedule Positions of every player and ally entity in the
+   *  zone
+   * @param now Current timestamp of the server
+   * @return true if the entity should be updated this tick
+   */
+  bool IsUpdateDue(const std::shared_ptr<ActiveEntityState>& eState,
+                   const AIUpdateSchedule& schedule, uint64_t now);
+
   /**
    * Update the state of an entity, processing AI and performing other
    * related actions.
@@ -0,0 +1,82 @@
+/**
+ * @file server/channel/src/AIUpdateSchedule.cpp
+ * @ingroup channel
+ *
+ * @author COMP Omega <compomega@tutanota.com>
+ *
+ * @brief Distance based update rates of idle AI entities in a zone.
+ *
+ * This file is part of the Channel Server (channel).
+ *
+ * Copyright (C) 2012-2020 COMP_hack Team <compomega@tutanota.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "AIUpdateSchedule.h"
+
+// libcomp Includes
+#include <Constants.h>
+
+using namespace channel;
+
+void AIUpdateSchedule::AddAnchor(float x, float y) {
+  mAnchorX.push_back(x);
+  mAnchorY.push_back(y);
+}
+
+size_t AIUpdateSchedule::AnchorCount() const { return mAnchorX.size(); }
+
+AIUpdateRate_t AIUpdateSchedule::GetRate(float x, float y, bool moving) const {
+  const float fullDist = AI_LOD_FULL_DISTANCE * AI_LOD_FULL_DISTANCE;
+  const float suspendDist = AI_LOD_SUSPEND_DISTANCE * AI_LOD_SUSPEND_DISTANCE;
+
+  float nearest = -1.f;
+  for (size_t i = 0; i < mAnchorX.size(); i++) {
+    float dx = mAnchorX[i] - x;
+    float dy = mAnchorY[i] - y;
+    float dist = dx * dx + dy * dy;
+    if (dist <= fullDist) {
+      // Nothing can be closer than close enough
+      return AIUpdateRate_t::FULL;
+    } else if (nearest < 0.f || dist < nearest) {
+      nearest = dist;
+    }
+  }
+
+  if ((nearest < 0.f || nearest > suspendDist) && !moving) {
+    return AIUpdateRate_t::SUSPENDED;
+  }
+
+  return AIUpdateRate_t::REDUCED;
+}
+
+bool AIUpdateSchedule::IsDue(AIUpdateRate_t rate, uint64_t& nextUpdate,
+                             uint64_t now) {
+  switch (rate) {
+    case AIUpdateRate_t::FULL:
+      nextUpdate = 0;
+      return true;
+    case AIUpdateRate_t::SUSPENDED:
+      return false;
+    case AIUpdateRate_t::REDUCED:
+    default:
+      if (nextUpdate > now) {
+        return false;
+      }
+
+      nextUpdate = now + (uint64_t)AI_LOD_REDUCED_INTERVAL;
+      return true;
+  }
+}
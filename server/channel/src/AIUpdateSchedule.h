@@ -0,0 +1,98 @@
+/**
+ * @file server/channel/src/AIUpdateSchedule.h
+ * @ingroup channel
+ *
+ * @author COMP Omega <compomega@tutanota.com>
+ *
+ * @brief Distance based update rates of idle AI entities in a zone.
+ *
+ * This file is part of the Channel Server (channel).
+ *
+ * Copyright (C) 2012-2020 COMP_hack Team <compomega@tutanota.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SERVER_CHANNEL_SRC_AIUPDATESCHEDULE_H
+#define SERVER_CHANNEL_SRC_AIUPDATESCHEDULE_H
+
+// Standard C++11 Includes
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+namespace channel {
+
+/**
+ * Rate an idle or wandering AI entity is updated at.
+ */
+enum class AIUpdateRate_t : uint8_t {
+  FULL,       //!< Updated every tick
+  REDUCED,    //!< Updated once every AI_LOD_REDUCED_INTERVAL
+  SUSPENDED,  //!< Not updated until a player or ally comes closer
+};
+
+/**
+ * Positions of the players and allies in a zone, gathered once per tick,
+ * that idle AI entities are scheduled around. Entities near one of them
+ * are updated every tick, entities further away at a reduced rate and
+ * entities far away that are not moving are not updated at all.
+ */
+class AIUpdateSchedule {
+ public:
+  /**
+   * Add the position of a player or ally entity.
+   * @param x X coordinate of the entity
+   * @param y Y coordinate of the entity
+   */
+  void AddAnchor(float x, float y);
+
+  /**
+   * Get the number of positions added.
+   * @return Number of positions added
+   */
+  size_t AnchorCount() const;
+
+  /**
+   * Get the rate an idle AI entity at a position is updated at.
+   * @param x X coordinate of the entity
+   * @param y Y coordinate of the entity
+   * @param moving true if the entity is currently moving
+   * @return Update rate of the entity
+   */
+  AIUpdateRate_t GetRate(float x, float y, bool moving) const;
+
+  /**
+   * Check if an entity is due to be updated at a rate and move its next
+   * reduced rate update forward if it is.
+   * @param rate Rate the entity is updated at
+   * @param nextUpdate Next reduced rate update time of the entity, set to
+   *  0 when updated every tick and moved forward when a reduced rate
+   *  update is due
+   * @param now Current timestamp of the server
+   * @return true if the entity should be updated this tick
+   */
+  static bool IsDue(AIUpdateRate_t rate, uint64_t& nextUpdate, uint64_t now);
+
+ private:
+  /// X coordinates of the positions added
+  std::vector<float> mAnchorX;
+
+  /// Y coordinates of the positions added
+  std::vector<float> mAnchorY;
+};
+
+}  // namespace channel
+
+#endif  // SERVER_CHANNEL_SRC_AIUPDATESCHEDULE_H
@@ -97,6 +97,8 @@ void AccountManager::HandleLoginRequest(
     login->SetAccount(account);
     login->SetSessionKey(sessionKey);
 
+    client->SetCaptureEnabled(server->IsCaptureAccount(username));
+
     server->GetManagerConnection()->SetClientConnection(client);
 
     LogAccountManagerDebug([&]() {
@@ -119,52 +119,62 @@ using namespace channel;
 
 ActionManager::ActionManager(const std::weak_ptr<ChannelServer>& server)
     : mServer(server) {
-  mActionHandlers[objects::Action::ActionType_t::ZONE_CHANGE] =
+  libcomp::EnumMap<objects::Action::ActionType_t, ActionHandler_t> handlers;
+  handlers[objects::Action::ActionType_t::ZONE_CHANGE] =
       &ActionManager::ZoneChange;
-  mActionHandlers[objects::Action::ActionType_t::START_EVENT] =
+  handlers[objects::Action::ActionType_t::START_EVENT] =
       &ActionManager::StartEvent;
-  mActionHandlers[objects::Action::ActionType_t::SET_HOMEPOINT] =
+  handlers[objects::Action::ActionType_t::SET_HOMEPOINT] =
       &ActionManager::SetHomepoint;
-  mActionHandlers[objects::Action::ActionType_t::SET_NPC_STATE] =
+  handlers[objects::Action::ActionType_t::SET_NPC_STATE] =
       &ActionManager::SetNPCState;
-  mActionHandlers[objects::Action::ActionType_t::ADD_REMOVE_ITEMS] =
+  handlers[objects::Action::ActionType_t::ADD_REMOVE_ITEMS] =
       &ActionManager::AddRemoveItems;
-  mActionHandlers[objects::Action::ActionType_t::ADD_REMOVE_STATUS] =
+  handlers[objects::Action::ActionType_t::ADD_REMOVE_STATUS] =
       &ActionManager::AddRemoveStatus;
-  mActionHandlers[objects::Action::ActionType_t::UPDATE_COMP] =
+  handlers[objects::Action::ActionType_t::UPDATE_COMP] =
       &ActionManager::UpdateCOMP;
-  mActionHandlers[objects::Action::ActionType_t::GRANT_SKILLS] =
+  handlers[objects::Action::ActionType_t::GRANT_SKILLS] =
       &ActionManager::GrantSkills;
-  mActionHandlers[objects::Action::ActionType_t::GRANT_XP] =
-      &ActionManager::GrantXP;
-  mActionHandlers[objects::Action::ActionType_t::DISPLAY_MESSAGE] =
+  handlers[objects::Action::ActionType_t::GRANT_XP] = &ActionManager::GrantXP;
+  handlers[objects::Action::ActionType_t::DISPLAY_MESSAGE] =
       &ActionManager::DisplayMessage;
-  mActionHandlers[objects::Action::ActionType_t::STAGE_EFFECT] =
+  handlers[objects::Action::ActionType_t::STAGE_EFFECT] =
       &ActionManager::StageEffect;
-  mActionHandlers[objects::Action::ActionType_t::SPECIAL_DIRECTION] =
+  handlers[objects::Action::ActionType_t::SPECIAL_DIRECTION] =
       &ActionManager::SpecialDirection;
-  mActionHandlers[objects::Action::ActionType_t::PLAY_BGM] =
-      &ActionManager::PlayBGM;
-  mActionHandlers[objects::Action::ActionType_t::PLAY_SOUND_EFFECT] =
+  handlers[objects::Action::ActionType_t::PLAY_BGM] = &ActionManager::PlayBGM;
+  handlers[objects::Action::ActionType_t::PLAY_SOUND_EFFECT] =
       &ActionManager::PlaySoundEffect;
-  mActionHandlers[objects::Action::ActionType_t::UPDATE_FLAG] =
+  handlers[objects::Action::ActionType_t::UPDATE_FLAG] =
       &ActionManager::UpdateFlag;
-  mActionHandlers[objects::Action::ActionType_t::UPDATE_LNC] =
+  handlers[objects::Action::ActionType_t::UPDATE_LNC] =
       &ActionManager::UpdateLNC;
-  mActionHandlers[objects::Action::ActionType_t::UPDATE_POINTS] =
+  handlers[objects::Action::ActionType_t::UPDATE_POINTS] =
       &ActionManager::UpdatePoints;
-  mActionHandlers[objects::Action::ActionType_t::UPDATE_QUEST] =
+  handlers[objects::Action::ActionType_t::UPDATE_QUEST] =
       &ActionManager::UpdateQuest;
-  mActionHandlers[objects::Action::ActionType_t::UPDATE_ZONE_FLAGS] =
+  handlers[objects::Action::ActionType_t::UPDATE_ZONE_FLAGS] =
       &ActionManager::UpdateZoneFlags;
-  mActionHandlers[objects::Action::ActionType_t::ZONE_INSTANCE] =
+  handlers[objects::Action::ActionType_t::ZONE_INSTANCE] =
       &ActionManager::UpdateZoneInstance;
-  mActionHandlers[objects::Action::ActionType_t::SPAWN] = &ActionManager::Spawn;
-  mActionHandlers[objects::Action::ActionType_t::CREATE_LOOT] =
+  handlers[objects::Action::ActionType_t::SPAWN] = &ActionManager::Spawn;
+  handlers[objects::Action::ActionType_t::CREATE_LOOT] =
       &ActionManager::CreateLoot;
-  mActionHandlers[objects::Action::ActionType_t::DELAY] = &ActionManager::Delay;
-  mActionHandlers[objects::Action::ActionType_t::RUN_SCRIPT] =
+  handlers[objects::Action::ActionType_t::DELAY] = &ActionManager::Delay;
+  handlers[objects::Action::ActionType_t::RUN_SCRIPT] =
       &ActionManager::RunScript;
+
+  // Flatten the handlers into a table indexed by action type so each
+  // action is dispatched without a hash lookup
+  for (auto& pair : handlers) {
+    size_t idx = (size_t)to_underlying(pair.first);
+    if (idx >= mActionHandlers.size()) {
+      mActionHandlers.resize(idx + 1, nullptr);
+    }
+
+    mActionHandlers[idx] = pair.second;
+  }
 }
 
 ActionManager::~ActionManager() {}
@@ -213,9 +223,12 @@ void ActionManager::PerformActions(
 
     ctx.Action = action;
 
-    auto it = mActionHandlers.find(action->GetActionType());
+    size_t handlerIdx = (size_t)to_underlying(action->GetActionType());
+    auto handler = handlerIdx < mActionHandlers.size()
+                       ? mActionHandlers[handlerIdx]
+                       : nullptr;
 
-    if (mActionHandlers.end() == it) {
+    if (!handler) {
       LogActionManagerError([&]() {
         return libcomp::String("Failed to parse action of type %1\n")
             .Arg(to_underlying(action->GetActionType()));
@@ -254,7 +267,7 @@ void ActionManager::PerformActions(
             copyCtx.SourceEntityID = eBase->GetEntityID();
             copyCtx.Options.AutoEventsOnly = true;
 
-            failure |= !it->second(*this, copyCtx);
+            failure |= !(this->*handler)(copyCtx);
           }
         }
       } else if (srcCtx == objects::Action::SourceContext_t::NONE) {
@@ -287,7 +300,7 @@ void ActionManager::PerformActions(
             copyCtx.SourceEntityID = 0;
             copyCtx.Options.AutoEventsOnly = true;
 
-            failure |= !it->second(*this, copyCtx);
+            failure |= !(this->*handler)(copyCtx);
           }
         }
       } else if (srcCtx != objects::Action::SourceContext_t::SOURCE) {
@@ -345,12 +358,12 @@ void ActionManager::PerformActions(
               // execution context
               copyCtx.Options.AutoEventsOnly = false;
 
-              failure |= !it->second(*this, copyCtx);
+              failure |= !(this->*handler)(copyCtx);
             }
           }
         }
       } else {
-        failure = !it->second(*this, ctx);
+        failure = !(this->*handler)(ctx);
 
         if (ctx.Client) {
           auto state = ctx.Client->GetClientState();
@@ -741,13 +754,13 @@ bool ActionManager::ZoneChange(ActionContext& ctx) {
     if (zoneDef) {
       auto definitionManager = server->GetDefinitionManager();
       auto zoneData = definitionManager->GetZoneData(zoneDef->GetID());
-      auto spots = definitionManager->GetSpotData(zoneDef->GetDynamicMapID());
-      auto spotIter = spots.find(spotID);
-      if (spotIter != spots.end()) {
-        Point p = zoneManager->GetRandomSpotPoint(spotIter->second, zoneData);
+      auto spot =
+          definitionManager->GetSpotData(zoneDef->GetDynamicMapID(), spotID);
+      if (spot) {
+        Point p = zoneManager->GetRandomSpotPoint(spot, zoneData);
         x = p.x;
         y = p.y;
-        rotation = spotIter->second->GetRotation();
+        rotation = spot->GetRotation();
       }
     } else {
       LogActionManagerError([&]() {
@@ -2882,7 +2895,7 @@ bool ActionManager::CreateLoot(ActionContext& ctx) {
     if (loc->GetSpotID()) {
       auto spotIter = zoneSpots.find(loc->GetSpotID());
       if (spotIter != zoneSpots.end()) {
-        Point p = zoneManager->GetRandomSpotPoint(spotIter->second->Definition);
+        Point p = zoneManager->GetRandomSpotPoint(spotIter->second, zone);
         x = p.x;
         y = p.y;
       } else {
@@ -3163,8 +3176,7 @@ bool ActionManager::RecordTimeTrial(ActionContext& ctx, uint32_t rewardItem,
   return true;
 }
 
-bool ActionManager::VerifyClient(ActionContext& ctx,
-                                 const libcomp::String& typeName) {
+bool ActionManager::VerifyClient(ActionContext& ctx, const char* typeName) {
   if (!ctx.Client) {
     LogActionManagerError([&]() {
       return libcomp::String(
@@ -3179,8 +3191,7 @@ bool ActionManager::VerifyClient(ActionContext& ctx,
   return true;
 }
 
-bool ActionManager::VerifyZone(ActionContext& ctx,
-                               const libcomp::String& typeName) {
+bool ActionManager::VerifyZone(ActionContext& ctx, const char* typeName) {
   if (!ctx.CurrentZone) {
     LogActionManagerError([&]() {
       return libcomp::String("Attempted to execute a %1 with no current zone\n")
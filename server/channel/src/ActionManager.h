@@ -38,6 +38,9 @@
 // channel Includes
 #include "ChannelClientConnection.h"
 
+// Standard C++11 Includes
+#include <vector>
+
 namespace libhack {
 class ScriptEngine;
 }
@@ -400,7 +403,7 @@ class ActionManager {
    * @param typeName Name of the action type being verified
    * @return true if the client exists, false if it does not
    */
-  bool VerifyClient(ActionContext& ctx, const libcomp::String& typeName);
+  bool VerifyClient(ActionContext& ctx, const char* typeName);
 
   /**
    * Verify that a zone is on the context and print an error message
@@ -409,7 +412,7 @@ class ActionManager {
    * @param typeName Name of the action type being verified
    * @return true if a zone exists, false if it does not
    */
-  bool VerifyZone(ActionContext& ctx, const libcomp::String& typeName);
+  bool VerifyZone(ActionContext& ctx, const char* typeName);
 
   /**
    * Prepare the transformation script from the action on the supplied
@@ -434,10 +437,11 @@ class ActionManager {
   /// Pointer to the channel server.
   std::weak_ptr<ChannelServer> mServer;
 
-  /// List of action parsers.
-  libcomp::EnumMap<objects::Action::ActionType_t,
-                   std::function<bool(ActionManager&, ActionContext&)>>
-      mActionHandlers;
+  /// Action handler function
+  typedef bool (ActionManager::*ActionHandler_t)(ActionContext&);
+
+  /// Action handlers indexed by action type, null for unsupported types.
+  std::vector<ActionHandler_t> mActionHandlers;
 };
 
 }  // namespace channel
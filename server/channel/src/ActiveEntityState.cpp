@@ -774,7 +774,7 @@ std::set<uint32_t> ActiveEntityState::AddStatusEffects(
     uint32_t effectType = ePair.second.Type;
     int8_t stack = ePair.second.Stack;
 
-    auto def = definitionManager->GetStatusData(effectType);
+    auto def = definitionManager->GetStatusDataPtr(effectType);
     auto basic = def->GetBasic();
     auto cancel = def->GetCancel();
     auto maxStack = basic->GetMaxStack();
@@ -868,7 +868,7 @@ std::set<uint32_t> ActiveEntityState::AddStatusEffects(
 
       std::set<uint32_t> inverseEffects;
       for (auto pair : mStatusEffects) {
-        auto exDef = definitionManager->GetStatusData(pair.first);
+        auto exDef = definitionManager->GetStatusDataPtr(pair.first);
         auto exBasic = exDef->GetBasic();
         if (exBasic->GetGroupID() == basic->GetGroupID()) {
           if (basic->GetGroupRank() >= exBasic->GetGroupRank()) {
@@ -955,7 +955,8 @@ std::set<uint32_t> ActiveEntityState::AddStatusEffects(
 
           // Application logic 2 effects have their expirations reset
           // any time they are re-applied (barring "set" durations)
-          auto exDef = definitionManager->GetStatusData(exEffect->GetEffect());
+          auto exDef =
+              definitionManager->GetStatusDataPtr(exEffect->GetEffect());
           if (exDef->GetBasic()->GetApplicationLogic() == 2) {
             resetTime = true;
           }
@@ -2642,7 +2643,7 @@ void ActiveEntityState::GetAdditionalCorrectTbls(
 
   // 2) Gather status effect adjustments
   for (auto ePair : GetStatusEffects()) {
-    auto statusData = definitionManager->GetStatusData(ePair.first);
+    auto statusData = definitionManager->GetStatusDataPtr(ePair.first);
     for (auto ct : statusData->GetCommon()->GetCorrectTbl()) {
       uint8_t multiplier = (statusData->GetBasic()->GetStackType() == 2)
                                ? ePair.second->GetStack()
@@ -0,0 +1,176 @@
+/**
+ * @file server/channel/src/BazaarIndex.cpp
+ * @ingroup channel
+ *
+ * @author COMP Omega <compomega@tutanota.com>
+ *
+ * @brief Channel wide index of the items listed in open bazaar markets.
+ *
+ * This file is part of the Channel Server (channel).
+ *
+ * Copyright (C) 2012-2020 COMP_hack Team <compomega@tutanota.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "BazaarIndex.h"
+
+// objects Includes
+#include <BazaarData.h>
+#include <BazaarItem.h>
+
+using namespace channel;
+
+BazaarIndex::BazaarIndex() : mNextSequence(0) {}
+
+void BazaarIndex::AddMarket(
+    const std::shared_ptr<objects::BazaarData>& market) {
+  if (!market) {
+    return;
+  }
+
+  for (auto& itemRef : market->GetItems()) {
+    // Items are indexed as soon as they are loaded so unloaded items are
+    // simply skipped here
+    auto bItem = itemRef.Get();
+    if (bItem) {
+      AddItem(market, bItem);
+    }
+  }
+}
+
+void BazaarIndex::RemoveMarket(
+    const std::shared_ptr<objects::BazaarData>& market) {
+  if (!market) {
+    return;
+  }
+
+  std::lock_guard<std::mutex> lock(mLock);
+  for (auto& itemRef : market->GetItems()) {
+    if (!itemRef.IsNull()) {
+      Erase(itemRef.GetUUID());
+    }
+  }
+}
+
+void BazaarIndex::AddItem(const std::shared_ptr<objects::BazaarData>& market,
+                          const std::shared_ptr<objects::BazaarItem>& bItem) {
+  std::lock_guard<std::mutex> lock(mLock);
+  if (bItem->GetSold()) {
+    Erase(bItem->GetUUID());
+    return;
+  }
+
+  BazaarListing listing;
+  listing.UID = bItem->GetUUID();
+  listing.ItemType = bItem->GetType();
+  listing.StackSize = bItem->GetStackSize();
+  listing.Cost = bItem->GetCost();
+  listing.ZoneID = market->GetZone();
+  listing.MarketID = market->GetMarketID();
+
+  Insert(listing);
+}
+
+void BazaarIndex::UpdateItem(
+    const std::shared_ptr<objects::BazaarItem>& bItem) {
+  std::lock_guard<std::mutex> lock(mLock);
+  auto it = mListings.find(bItem->GetUUID());
+  if (it == mListings.end()) {
+    return;
+  }
+
+  if (bItem->GetSold()) {
+    Erase(bItem->GetUUID());
+    return;
+  }
+
+  // Keep the market location of the existing listing
+  BazaarListing listing = it->second;
+  listing.StackSize = bItem->GetStackSize();
+  listing.Cost = bItem->GetCost();
+
+  Insert(listing);
+}
+
+void BazaarIndex::RemoveItem(const libobjgen::UUID& uid) {
+  std::lock_guard<std::mutex> lock(mLock);
+  Erase(uid);
+}
+
+size_t BazaarIndex::GetLowestPrice(uint32_t itemType, BazaarListing& lowest) {
+  std::lock_guard<std::mutex> lock(mLock);
+  auto it = mByType.find(itemType);
+  if (it == mByType.end() || it->second.size() == 0) {
+    return 0;
+  }
+
+  lowest = *it->second.begin();
+
+  return it->second.size();
+}
+
+std::list<BazaarListing> BazaarIndex::Search(uint32_t itemType,
+                                             uint32_t maxUnitCost,
+                                             size_t maxCount) {
+  std::list<BazaarListing> results;
+
+  std::lock_guard<std::mutex> lock(mLock);
+  auto it = mByType.find(itemType);
+  if (it == mByType.end()) {
+    return results;
+  }
+
+  for (auto& listing : it->second) {
+    if (results.size() >= maxCount ||
+        (maxUnitCost && listing.UnitCost > maxUnitCost)) {
+      break;
+    }
+
+    results.push_back(listing);
+  }
+
+  return results;
+}
+
+void BazaarIndex::Insert(BazaarListing& listing) {
+  Erase(listing.UID);
+
+  listing.UnitCost = listing.StackSize > 1
+                         ? (uint32_t)(listing.Cost / listing.StackSize)
+                         : listing.Cost;
+  listing.Sequence = mNextSequence++;
+
+  mByType[listing.ItemType].insert(listing);
+  mListings[listing.UID] = listing;
+}
+
+bool BazaarIndex::Erase(const libobjgen::UUID& uid) {
+  auto it = mListings.find(uid);
+  if (it == mListings.end()) {
+    return false;
+  }
+
+  auto typeIter = mByType.find(it->second.ItemType);
+  if (typeIter != mByType.end()) {
+    typeIter->second.erase(it->second);
+    if (typeIter->second.size() == 0) {
+      mByType.erase(typeIter);
+    }
+  }
+
+  mListings.erase(it);
+
+  return true;
+}
@@ -0,0 +1,187 @@
+/**
+ * @file server/channel/src/BazaarIndex.h
+ * @ingroup channel
+ *
+ * @author COMP Omega <compomega@tutanota.com>
+ *
+ * @brief Channel wide index of the items listed in open bazaar markets.
+ *
+ * This file is part of the Channel Server (channel).
+ *
+ * Copyright (C) 2012-2020 COMP_hack Team <compomega@tutanota.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SERVER_CHANNEL_SRC_BAZAARINDEX_H
+#define SERVER_CHANNEL_SRC_BAZAARINDEX_H
+
+// libcomp Includes
+#include <UUID.h>
+
+// Standard C++11 Includes
+#include <list>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <unordered_map>
+
+namespace objects {
+class BazaarData;
+class BazaarItem;
+}  // namespace objects
+
+namespace channel {
+
+/**
+ * Item listed for sale in a bazaar market currently open on the channel.
+ */
+struct BazaarListing {
+  /// UUID of the bazaar item
+  libobjgen::UUID UID;
+
+  /// Item type being sold
+  uint32_t ItemType = 0;
+
+  /// Number of items in the stack being sold
+  uint16_t StackSize = 0;
+
+  /// Price of the entire stack
+  uint32_t Cost = 0;
+
+  /// Price of a single item in the stack
+  uint32_t UnitCost = 0;
+
+  /// Definition ID of the zone the market is in
+  uint32_t ZoneID = 0;
+
+  /// ID of the market the item is listed in
+  uint32_t MarketID = 0;
+
+  /// Order the item was listed in, used to break price ties
+  uint64_t Sequence = 0;
+};
+
+/**
+ * Index of every unsold item listed in a bazaar market that is currently
+ * open on the channel, grouped by item type and ordered by the price of a
+ * single item. Markets are added and removed as the bazaars set their
+ * current markets and single items are updated as they are added, dropped,
+ * repriced or bought so price checks and market searches never have to walk
+ * the markets themselves. All functions are thread safe.
+ */
+class BazaarIndex {
+ public:
+  /**
+   * Create an empty bazaar index
+   */
+  BazaarIndex();
+
+  /**
+   * Add every unsold item in an open market to the index. Items that are
+   * not loaded are skipped.
+   * @param market Pointer to the market that was opened
+   */
+  void AddMarket(const std::shared_ptr<objects::BazaarData>& market);
+
+  /**
+   * Remove every item in a market from the index
+   * @param market Pointer to the market that was closed
+   */
+  void RemoveMarket(const std::shared_ptr<objects::BazaarData>& market);
+
+  /**
+   * Add or update an item listed in an open market
+   * @param market Pointer to the market the item is listed in
+   * @param bItem Pointer to the item listed
+   */
+  void AddItem(const std::shared_ptr<objects::BazaarData>& market,
+               const std::shared_ptr<objects::BazaarItem>& bItem);
+
+  /**
+   * Update the price of an item if it is currently indexed
+   * @param bItem Pointer to the item that was updated
+   */
+  void UpdateItem(const std::shared_ptr<objects::BazaarItem>& bItem);
+
+  /**
+   * Remove an item from the index
+   * @param uid UUID of the bazaar item to remove
+   */
+  void RemoveItem(const libobjgen::UUID& uid);
+
+  /**
+   * Get the cheapest listing of the supplied item type
+   * @param itemType Item type to look up
+   * @param lowest Output parameter set to the listing with the lowest price
+   *  for a single item
+   * @return Number of listings of the item type, 0 if there are none and
+   *  the output parameter was not set
+   */
+  size_t GetLowestPrice(uint32_t itemType, BazaarListing& lowest);
+
+  /**
+   * Get the cheapest listings of the supplied item type
+   * @param itemType Item type to search for
+   * @param maxUnitCost Highest price for a single item to include, 0 for no
+   *  limit
+   * @param maxCount Maximum number of listings to return
+   * @return List of listings ordered from the lowest price to the highest
+   */
+  std::list<BazaarListing> Search(uint32_t itemType, uint32_t maxUnitCost,
+                                  size_t maxCount);
+
+ private:
+  /// Orders listings of the same item type from cheapest to most expensive
+  struct ListingOrder {
+    bool operator()(const BazaarListing& a, const BazaarListing& b) const {
+      if (a.UnitCost != b.UnitCost) {
+        return a.UnitCost < b.UnitCost;
+      }
+
+      return a.Sequence < b.Sequence;
+    }
+  };
+
+  /**
+   * Add a listing to the index, replacing the existing listing for the same
+   * item. The lock must already be held.
+   * @param listing Listing to add
+   */
+  void Insert(BazaarListing& listing);
+
+  /**
+   * Remove the listing for an item from the index. The lock must already be
+   * held.
+   * @param uid UUID of the bazaar item to remove
+   * @return true if the item was indexed
+   */
+  bool Erase(const libobjgen::UUID& uid);
+
+  /// Listings ordered by price, mapped by item type
+  std::unordered_map<uint32_t, std::set<BazaarListing, ListingOrder>> mByType;
+
+  /// Listings mapped by bazaar item UUID
+  std::unordered_map<libobjgen::UUID, BazaarListing> mListings;
+
+  /// Sequence number assigned to the next listing added
+  uint64_t mNextSequence;
+
+  /// Lock for the index
+  std::mutex mLock;
+};
+
+}  // namespace channel
+
+#endif  // SERVER_CHANNEL_SRC_BAZAARINDEX_H
@@ -46,8 +46,17 @@
 
 using namespace channel;
 
-BazaarState::BazaarState(const std::shared_ptr<objects::ServerBazaar>& bazaar)
-    : EntityState<objects::ServerBazaar>(bazaar) {}
+BazaarState::BazaarState(const std::shared_ptr<objects::ServerBazaar>& bazaar,
+                         const std::shared_ptr<BazaarIndex>& index)
+    : EntityState<objects::ServerBazaar>(bazaar), mIndex(index) {}
+
+BazaarState::~BazaarState() {
+  if (mIndex) {
+    for (auto& pair : mCurrentMarkets) {
+      mIndex->RemoveMarket(pair.second);
+    }
+  }
+}
 
 std::shared_ptr<objects::BazaarData> BazaarState::GetCurrentMarket(
     uint32_t marketID) {
@@ -60,7 +69,13 @@ void BazaarState::SetCurrentMarket(
     uint32_t marketID, const std::shared_ptr<objects::BazaarData>& data) {
   std::lock_guard<std::mutex> lock(mLock);
   if (GetEntity()->MarketIDsContains(marketID)) {
-    mCurrentMarkets[marketID] = data;
+    auto& current = mCurrentMarkets[marketID];
+    if (mIndex && current != data) {
+      mIndex->RemoveMarket(current);
+      mIndex->AddMarket(data);
+    }
+
+    current = data;
 
     // Clear reservation just in case
     mReservations.erase(marketID);
@@ -128,6 +143,10 @@ bool BazaarState::AddItem(
       dbChanges->Update(bazaarData);
       dbChanges->Update(item);
 
+      if (mIndex) {
+        mIndex->AddItem(bazaarData, bItem);
+      }
+
       return true;
     } else {
       LogBazaarError([&]() {
@@ -259,7 +278,14 @@ bool BazaarState::DropItem(
 
   std::lock_guard<std::mutex> lock(mLock);
   if (VerifyMarket(bazaarData)) {
-    return DropItemInternal(state, srcSlot, itemID, destSlot, dbChanges);
+    auto bItemUID = bazaarData->GetItems((size_t)srcSlot).GetUUID();
+    if (DropItemInternal(state, srcSlot, itemID, destSlot, dbChanges)) {
+      if (mIndex) {
+        mIndex->RemoveItem(bItemUID);
+      }
+
+      return true;
+    }
   }
 
   return false;
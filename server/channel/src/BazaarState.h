@@ -32,6 +32,9 @@
 #include <EntityState.h>
 #include <ServerBazaar.h>
 
+// channel Includes
+#include "BazaarIndex.h"
+
 namespace libcomp {
 class DatabaseChangeSet;
 }
@@ -47,13 +50,18 @@ class BazaarState : public EntityState<objects::ServerBazaar> {
  public:
   /**
    * Create a bazaar state.
+   * @param bazaar Pointer to the bazaar definition
+   * @param index Optional pointer to the channel's bazaar index to keep
+   *  updated with the items listed in the bazaar's current markets
    */
-  BazaarState(const std::shared_ptr<objects::ServerBazaar>& bazaar);
+  BazaarState(const std::shared_ptr<objects::ServerBazaar>& bazaar,
+              const std::shared_ptr<BazaarIndex>& index = nullptr);
 
   /**
-   * Clean up the bazaar state.
+   * Clean up the bazaar state, removing its current markets from the
+   * bazaar index.
    */
-  virtual ~BazaarState() {}
+  virtual ~BazaarState();
 
   /**
    * Get the current market associated to the supplied market ID
@@ -186,6 +194,9 @@ class BazaarState : public EntityState<objects::ServerBazaar> {
   /// Set of reserved market IDs
   std::set<uint32_t> mReservations;
 
+  /// Channel wide index of items listed in current markets
+  std::shared_ptr<BazaarIndex> mIndex;
+
   /// Lock for shared resources
   std::mutex mLock;
 };
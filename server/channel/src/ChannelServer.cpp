@@ -27,6 +27,8 @@
 #include "ChannelServer.h"
 
 // libcomp Includes
+#include <CaptureWriter.h>
+#include <CompressionPolicy.h>
 #include <Constants.h>
 #include <DefinitionManager.h>
 #include <Log.h>
@@ -36,6 +38,9 @@
 #include <ScriptEngine.h>
 #include <ServerDataManager.h>
 
+// Standard C++11 Includes
+#include <functional>
+
 // object Includes
 #include <Account.h>
 #include <ChannelConfig.h>
@@ -56,6 +61,7 @@
 #include "MatchManager.h"
 #include "Packets.h"
 #include "PerformanceTimer.h"
+#include "Simulation.h"
 #include "SkillManager.h"
 #include "TokuseiManager.h"
 #include "ZoneManager.h"
@@ -113,12 +119,29 @@ ChannelServer::ChannelServer(
       mRecalcTimeDependents(false),
       mMaxEntityID(0),
       mMaxObjectID(0),
+      mNextPacketStatsTime(0),
       mTicksPending(0),
-      mTickRunning(true) {}
+      mTickRunning(true),
+      mSimulationTickReady(true) {}
 
 bool ChannelServer::Initialize() {
   auto self = shared_from_this();
 
+  auto conf = std::dynamic_pointer_cast<objects::ChannelConfig>(mConfig);
+
+  // Switch to the virtual clock before anything reads the server time
+  if (conf->GetSimulationMode()) {
+    Simulation::Enable(conf->GetSimulationSeed());
+    sGetServerTime = &ChannelServer::GetServerTimeSimulated;
+
+    LogGeneralWarning([&]() {
+      return libcomp::String(
+                 "Simulation mode enabled with seed %1. Server time will only "
+                 "advance as ticks are processed.\n")
+          .Arg(conf->GetSimulationSeed());
+    });
+  }
+
   if (!BaseServer::Initialize()) {
     return false;
   }
@@ -134,8 +157,6 @@ bool ChannelServer::Initialize() {
         "nothing but chosen equipment and base expertise skills.\n");
   }
 
-  auto conf = std::dynamic_pointer_cast<objects::ChannelConfig>(mConfig);
-
   mDefinitionManager = new libhack::DefinitionManager();
   if (!mDefinitionManager->LoadAllData(GetDataStore())) {
     return false;
@@ -153,6 +174,19 @@ bool ChannelServer::Initialize() {
     }
   }
 
+  if (!conf->GetCaptureDirectory().IsEmpty()) {
+    if (!conf->GetCapturePath().IsEmpty()) {
+      LogGeneralWarningMsg(
+          "CapturePath and CaptureDirectory are both set. Incoming packets "
+          "will also be written to the CapturePath files.\n");
+    }
+
+    mCaptureWriter = std::make_shared<libhack::CaptureWriter>(
+        conf->GetCaptureDirectory(), (size_t)conf->GetCaptureMaxFileSize(),
+        (size_t)conf->GetCaptureQueueSize());
+    mCaptureWriter->Start();
+  }
+
   mManagerConnection = std::make_shared<ManagerConnection>(self);
 
   auto internalPacketManager = std::make_shared<libcomp::ManagerPacket>(self);
@@ -714,6 +748,17 @@ bool ChannelServer::Initialize() {
   clientPacketManager->AddParser<Parsers::Unsupported>(
       to_underlying(ClientToChannelPacketCode_t::PACKET_RECEIVED_LISTS));
 
+  // Collect client packet handler statistics if requested. This must be
+  // set before the workers start handling packets.
+  mClientPacketManager = clientPacketManager;
+  if (conf->GetPacketStatsEnabled()) {
+    clientPacketManager->EnableStats(
+        (uint64_t)conf->GetPacketStatsSlowThreshold());
+    mNextPacketStatsTime =
+        GetServerTime() +
+        (ServerTime)conf->GetPacketStatsInterval() * 1000000ULL;
+  }
+
   // Add the managers to the generic workers.
   for (auto worker : mWorkers) {
     worker->AddManager(clientPacketManager);
@@ -728,6 +773,10 @@ bool ChannelServer::Initialize() {
   mChatManager = new ChatManager(channelPtr);
   mEventManager = new EventManager(channelPtr);
   mFusionManager = new FusionManager(channelPtr);
+  if (!mFusionManager->Initialize()) {
+    return false;
+  }
+
   mMatchManager = new MatchManager(channelPtr);
   mSkillManager = new SkillManager(channelPtr);
   mSyncManager = new ChannelSyncManager(channelPtr);
@@ -739,6 +788,10 @@ bool ChannelServer::Initialize() {
 
   mZoneManager = new ZoneManager(channelPtr);
 
+  if (!mEventManager->Initialize()) {
+    return false;
+  }
+
   // Now connect to the world server.
   auto worldConnection =
       std::make_shared<libcomp::InternalConnection>(mService);
@@ -777,11 +830,26 @@ void ChannelServer::Cleanup() {
 
 ChannelServer::~ChannelServer() {
   mTickRunning = false;
+  mSimulationTickDone.notify_all();
 
   if (mTickThread.joinable()) {
     mTickThread.join();
   }
 
+  if (mCaptureWriter) {
+    mCaptureWriter->Stop();
+
+    uint64_t dropped = mCaptureWriter->GetDroppedCount();
+    if (dropped) {
+      LogGeneralWarning([&]() {
+        return libcomp::String(
+                   "%1 packet capture record(s) were dropped because the "
+                   "capture writer fell behind.\n")
+            .Arg(dropped);
+      });
+    }
+  }
+
   delete mAccountManager;
   delete mActionManager;
   delete mAIManager;
@@ -800,6 +868,8 @@ ChannelServer::~ChannelServer() {
 
 ServerTime ChannelServer::GetServerTime() { return sGetServerTime(); }
 
+ServerTime ChannelServer::GetRealServerTime() { return sGetRealServerTime(); }
+
 int32_t ChannelServer::GetExpirationInSeconds(uint32_t fixedTime,
                                               uint32_t relativeTo) {
   if (fixedTime == 0) {
@@ -1104,10 +1174,31 @@ void ChannelServer::Tick() {
   }
   perf.Stop("ScheduleWork");
 
+  // Log the client packet handler statistics summary
+  if (mNextPacketStatsTime && mNextPacketStatsTime <= tickTime) {
+    auto conf = std::dynamic_pointer_cast<objects::ChannelConfig>(mConfig);
+    mNextPacketStatsTime =
+        tickTime + (ServerTime)conf->GetPacketStatsInterval() * 1000000ULL;
+
+    mClientPacketManager->LogStats();
+    LogCompressionStats();
+  }
+
   tickPerf.Stop("Tick");
+
+  if (Simulation::IsEnabled()) {
+    std::lock_guard<std::mutex> lock(mTickLock);
+    mSimulationTickReady = true;
+    mSimulationTickDone.notify_one();
+  }
 }
 
 void ChannelServer::StartGameTick() {
+  if (Simulation::IsEnabled()) {
+    StartSimulationTick();
+    return;
+  }
+
   mTickThread = std::thread(
       [this](std::shared_ptr<libcomp::MessageQueue<libcomp::Message::Message*>>
                  queue,
@@ -1158,6 +1249,73 @@ void ChannelServer::StartGameTick() {
       mQueueWorker.GetMessageQueue(), &mTickRunning);
 }
 
+void ChannelServer::StartSimulationTick() {
+  auto conf = std::dynamic_pointer_cast<objects::ChannelConfig>(mConfig);
+  uint32_t tickLimit = conf->GetSimulationTicks();
+
+  mTickThread = std::thread(
+      [this, tickLimit](
+          std::shared_ptr<libcomp::MessageQueue<libcomp::Message::Message*>>
+              queue) {
+#if !defined(_WIN32) && !defined(__APPLE__)
+        pthread_setname_np(pthread_self(), "tick");
+#endif  // !defined(_WIN32) && !defined(__APPLE__)
+
+        // Same 100ms per tick as the real tick thread
+        const static ServerTime TICK_DELTA = 100000;
+
+        uint32_t tickCount = 0;
+        auto start = std::chrono::steady_clock::now();
+        while (mTickRunning && (!tickLimit || tickCount < tickLimit)) {
+          std::unique_lock<std::mutex> lock(mTickLock);
+
+          // Only queue the next tick once the last one is done so every
+          // tick sees the same virtual time regardless of how long the
+          // previous one took. Wake up now and then to check for shutdown.
+          if (!mSimulationTickDone.wait_for(
+                  lock, std::chrono::milliseconds(100),
+                  [this]() { return mSimulationTickReady; })) {
+            continue;
+          }
+
+          mSimulationTickReady = false;
+          Simulation::AdvanceTime(TICK_DELTA);
+
+          queue->Enqueue(new libcomp::Message::Tick);
+          mTicksPending++;
+          tickCount++;
+        }
+
+        if (tickLimit && tickCount == tickLimit) {
+          // Wait for the final tick before reporting the run time
+          std::unique_lock<std::mutex> lock(mTickLock);
+          while (mTickRunning && !mSimulationTickReady) {
+            mSimulationTickDone.wait_for(lock, std::chrono::milliseconds(100));
+          }
+
+          auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(
+                             std::chrono::steady_clock::now() - start)
+                             .count();
+
+          LogGeneralInfo([&]() {
+            return libcomp::String(
+                       "Simulated %1 tick(s) in %2 ms (%3 us per tick).\n")
+                .Arg(tickCount)
+                .Arg((uint64_t)(elapsed / 1000))
+                .Arg((uint64_t)(elapsed / tickCount));
+          });
+
+          // The run is complete so stop the server from the main worker
+          // since the tick thread is joined during cleanup
+          if (mTickRunning) {
+            QueueWork([](ChannelServer* pServer) { pServer->Shutdown(); },
+                      this);
+          }
+        }
+      },
+      mQueueWorker.GetMessageQueue());
+}
+
 bool ChannelServer::SendSystemMessage(
     const std::shared_ptr<channel::ChannelClientConnection>& client,
     libcomp::String message, int8_t type, bool sendToAll) {
@@ -1181,6 +1339,25 @@ int32_t ChannelServer::GetServerTimeOffset() {
   return offset;
 }
 
+bool ChannelServer::IsCaptureAccount(const libcomp::String& username) {
+  auto conf = std::dynamic_pointer_cast<objects::ChannelConfig>(mConfig);
+
+  libcomp::String lowerUsername = username.ToLower();
+  if (conf->CaptureAccountsCount() > 0) {
+    for (auto& captureAccount : conf->GetCaptureAccounts()) {
+      if (captureAccount.ToLower() == lowerUsername) {
+        return true;
+      }
+    }
+
+    return false;
+  }
+
+  uint16_t sampleRate = conf->GetCaptureAccountSampleRate();
+  return sampleRate <= 1 ||
+         std::hash<std::string>()(lowerUsername.C()) % sampleRate == 0;
+}
+
 int32_t ChannelServer::GetPAttributeDeadline() {
   auto clock = GetWorldClockTime();
 
@@ -1339,6 +1516,16 @@ std::shared_ptr<libcomp::TcpConnection> ChannelServer::CreateConnection(
   connection->SetServerConfig(mConfig);
   connection->SetName(libcomp::String("client:%1").Arg(connectionID++));
 
+  // Sampled captures wait for the account to log in before recording
+  auto conf = std::dynamic_pointer_cast<objects::ChannelConfig>(mConfig);
+  connection->SetCaptureEnabled(conf->CaptureAccountsCount() == 0 &&
+                                conf->GetCaptureAccountSampleRate() <= 1);
+  connection->SetCaptureCommandCodes(conf->GetCaptureCommandCodes());
+  if (mCaptureWriter) {
+    connection->SetCaptureStream(
+        mCaptureWriter->OpenStream(connection->GetRemoteAddress()));
+  }
+
   if (AssignMessageQueue(connection)) {
     // Make sure this is called after connecting.
     connection->ConnectionSuccess();
@@ -1359,6 +1546,11 @@ GET_SERVER_TIME ChannelServer::sGetServerTime =
         ? &ChannelServer::GetServerTimeHighResolution
         : &ChannelServer::GetServerTimeSteady;
 
+GET_SERVER_TIME ChannelServer::sGetRealServerTime =
+    std::chrono::high_resolution_clock::is_steady
+        ? &ChannelServer::GetServerTimeHighResolution
+        : &ChannelServer::GetServerTimeSteady;
+
 ServerTime ChannelServer::GetServerTimeSteady() {
   auto now = std::chrono::steady_clock::now();
   return (ServerTime)std::chrono::time_point_cast<std::chrono::microseconds>(
@@ -1375,6 +1567,46 @@ ServerTime ChannelServer::GetServerTimeHighResolution() {
       .count();
 }
 
+ServerTime ChannelServer::GetServerTimeSimulated() {
+  return Simulation::GetTime();
+}
+
+void ChannelServer::LogCompressionStats() {
+  auto totals = libhack::CompressionPolicy::GetTotals(true);
+  if (!totals.Flushes) {
+    return;
+  }
+
+  // Average the running ratio of the connections that compressed anything
+  float ratio = 0.f;
+  size_t compressing = 0;
+  uint64_t skipped = 0;
+  for (auto& client : mManagerConnection->GetAllConnections()) {
+    skipped += client->GetCompressionSkipCount();
+
+    if (client->GetCompressionTime()) {
+      ratio += client->GetCompressionRatio();
+      compressing++;
+    }
+  }
+
+  LogGeneralInfo([&]() {
+    return libcomp::String(
+               "PERF: Compression: %1 flushes, %2 compressed, %3 skipped, "
+               "%4 us compressing, %5 bytes in, %6 bytes out, %7 average "
+               "ratio over %8 connections, %9 skipped on open connections\n")
+        .Arg(totals.Flushes)
+        .Arg(totals.Attempts)
+        .Arg(totals.Skipped)
+        .Arg(totals.CompressTime / 1000)
+        .Arg(totals.BytesIn)
+        .Arg(totals.BytesOut)
+        .Arg(compressing ? ratio / (float)compressing : 0.f)
+        .Arg(compressing)
+        .Arg(skipped);
+  });
+}
+
 void ChannelServer::RecalcNextWorldEventTime() {
   if (mWorldClock.IsSet() && mWorldClockEvents.size() > 0) {
     uint32_t timeToMidnight = (uint32_t)(
@@ -35,6 +35,9 @@
 #include <ManagerConnection.h>
 #include <Worker.h>
 
+// Standard C++11 Includes
+#include <condition_variable>
+
 // object Includes
 #include <RegisteredChannel.h>
 #include <RegisteredWorld.h>
@@ -43,6 +46,7 @@
 #include "WorldClock.h"
 
 namespace libhack {
+class CaptureWriter;
 class DefinitionManager;
 class ServerDataManager;
 }  // namespace libhack
@@ -65,6 +69,7 @@ class CharacterManager;
 class ChatManager;
 class EventManager;
 class FusionManager;
+class ManagerClientPacket;
 class MatchManager;
 class SkillManager;
 class TokuseiManager;
@@ -118,6 +123,14 @@ class ChannelServer : public libhack::Server {
    */
   static ServerTime GetServerTime();
 
+  /**
+   * Get the current time from the real clock, even when simulation mode
+   * has replaced the server time with the virtual clock. Use this to
+   * measure how long work takes.
+   * @return Current time from the real clock
+   */
+  static ServerTime GetRealServerTime();
+
   /**
    * Get the amount of time left in an expiration relative to the server,
    * in seconds.
@@ -354,6 +367,17 @@ class ChannelServer : public libhack::Server {
    */
   int32_t GetServerTimeOffset();
 
+  /**
+   * Check if the outgoing packets of an account should be captured. Only
+   * the configured capture accounts are captured when any are listed.
+   * Otherwise every Nth account is captured based on the configured sample
+   * rate, picked from the username so the same accounts are captured on
+   * every login.
+   * @param username Username of the account logging in
+   * @return true if the account's packets should be captured
+   */
+  bool IsCaptureAccount(const libcomp::String& username);
+
   /**
    * Get the system time deadline for all punitive attributes
    * which matches midnight of the next Monday. Punitive atributes
@@ -454,10 +478,35 @@ class ChannelServer : public libhack::Server {
    */
   static ServerTime GetServerTimeHighResolution();
 
+  /**
+   * Get the current time of the simulation mode virtual clock.
+   * @return Current virtual time
+   */
+  static ServerTime GetServerTimeSimulated();
+
   /// Function pointer to the most accurate time detection code
-  /// available for the current machine.
+  /// available for the current machine or the virtual clock when
+  /// simulation mode is enabled.
   static GET_SERVER_TIME sGetServerTime;
 
+  /// Function pointer to the most accurate real clock available for the
+  /// current machine, never the virtual clock
+  static GET_SERVER_TIME sGetRealServerTime;
+
+  /**
+   * Generates simulation mode game ticks. Each tick is queued as soon as
+   * the previous one has finished processing and moves the virtual clock
+   * forward by one tick. When a tick limit is configured the run time is
+   * logged and the server shuts down once the last tick is processed.
+   */
+  void StartSimulationTick();
+
+  /**
+   * Log a summary of the outgoing packet compression since the last
+   * summary and reset the totals.
+   */
+  void LogCompressionStats();
+
   /**
    * Recalculate the next time the world clock will fire an event on.
    * This will be stored as a system timestamp for easy comparison.
@@ -479,6 +528,13 @@ class ChannelServer : public libhack::Server {
   /// Pointer to the manager in charge of connection messages.
   std::shared_ptr<ManagerConnection> mManagerConnection;
 
+  /// Pointer to the manager in charge of client packets.
+  std::shared_ptr<ManagerClientPacket> mClientPacketManager;
+
+  /// Background writer for the client packet captures, null if the
+  /// capture directory is not configured.
+  std::shared_ptr<libhack::CaptureWriter> mCaptureWriter;
+
   /// Pointer to the RegisteredWorld.
   std::shared_ptr<objects::RegisteredWorld> mRegisteredWorld;
 
@@ -559,6 +615,10 @@ class ChannelServer : public libhack::Server {
   /// Highest unique object ID currently assigned
   int64_t mMaxObjectID;
 
+  /// Server time the next client packet statistics summary will be
+  /// logged at, 0 if statistics are not being collected.
+  ServerTime mNextPacketStatsTime;
+
   /// Inidicates how many tick messages are sitting in the queue.
   /// Incremented by StartTick and decremented by Tick.
   uint8_t mTicksPending;
@@ -577,6 +637,12 @@ class ChannelServer : public libhack::Server {
 
   /// If the tick thread should continue running.
   volatile bool mTickRunning;
+
+  /// Signaled when a simulation mode tick finishes processing
+  std::condition_variable mSimulationTickDone;
+
+  /// Indicates if the last simulation mode tick finished processing
+  bool mSimulationTickReady;
 };
 
 }  // namespace channel
@@ -28,6 +28,7 @@
 #include "ChannelSyncManager.h"
 
 // libcomp Includes
+#include <Constants.h>
 #include <Log.h>
 #include <Packet.h>
 #include <PacketCodes.h>
@@ -204,17 +205,52 @@ bool ChannelSyncManager::Initialize() {
 libcomp::EnumMap<objects::SearchEntry::Type_t,
                  std::list<std::shared_ptr<objects::SearchEntry>>>
 ChannelSyncManager::GetSearchEntries() const {
-  return mSearchEntries;
+  libcomp::EnumMap<objects::SearchEntry::Type_t,
+                   std::list<std::shared_ptr<objects::SearchEntry>>>
+      result;
+  for (auto& pair : mSearchEntries) {
+    auto& entries = result[pair.first];
+    for (auto& ePair : pair.second.GetEntries()) {
+      entries.push_back(ePair.second);
+    }
+  }
+
+  return result;
 }
 
 std::list<std::shared_ptr<objects::SearchEntry>>
 ChannelSyncManager::GetSearchEntries(objects::SearchEntry::Type_t type) {
+  std::list<std::shared_ptr<objects::SearchEntry>> result;
+
+  std::lock_guard<std::mutex> lock(mLock);
+
+  auto it = mSearchEntries.find(type);
+  if (it != mSearchEntries.end()) {
+    for (auto& ePair : it->second.GetEntries()) {
+      result.push_back(ePair.second);
+    }
+  }
+
+  return result;
+}
+
+std::list<std::shared_ptr<objects::SearchEntry>>
+ChannelSyncManager::GetSearchEntryPage(
+    objects::SearchEntry::Type_t type, const SearchEntryFilter& filter,
+    int32_t pageID, size_t maxPageSize,
+    std::shared_ptr<objects::SearchEntry>& prev,
+    std::shared_ptr<objects::SearchEntry>& next) {
   std::lock_guard<std::mutex> lock(mLock);
 
   auto it = mSearchEntries.find(type);
-  return it != mSearchEntries.end()
-             ? it->second
-             : std::list<std::shared_ptr<objects::SearchEntry>>();
+  if (it == mSearchEntries.end()) {
+    prev = nullptr;
+    next = nullptr;
+
+    return {};
+  }
+
+  return it->second.GetPage(filter, pageID, maxPageSize, prev, next);
 }
 
 std::shared_ptr<objects::EventCounter> ChannelSyncManager::GetWorldEventCounter(
@@ -236,42 +272,21 @@ int8_t ChannelSyncManager::Update<objects::SearchEntry>(
 
   auto entry = std::dynamic_pointer_cast<objects::SearchEntry>(obj);
 
-  auto& entryList = mSearchEntries[entry->GetType()];
+  auto& index = mSearchEntries[entry->GetType()];
 
-  auto it = entryList.begin();
-  while (it != entryList.end()) {
-    if ((*it)->GetEntryID() == entry->GetEntryID()) {
-      it = entryList.erase(it);
-      if (!isRemove) {
-        // Replace the existing element
-        entryList.insert(it, entry);
-      }
-
-      success = true;
-      break;
-    }
-
-    it++;
-  }
-
-  if (!success) {
-    if (isRemove) {
-      LogDataSyncManagerWarning([&]() {
-        return libcomp::String(
-                   "No SearchEntry with ID '%1' found for sync removal\n")
-            .Arg(entry->GetEntryID());
-      });
-    } else {
-      entryList.push_front(entry);
+  if (!isRemove) {
+    // Add or replace the existing element
+    index.Set(entry);
 
-      // Re-sort by entry ID, highest first
-      entryList.sort([](const std::shared_ptr<objects::SearchEntry>& a,
-                        const std::shared_ptr<objects::SearchEntry>& b) {
-        return a->GetEntryID() > b->GetEntryID();
-      });
-
-      success = true;
-    }
+    success = true;
+  } else if (index.Remove(entry->GetEntryID())) {
+    success = true;
+  } else {
+    LogDataSyncManagerWarning([&]() {
+      return libcomp::String(
+                 "No SearchEntry with ID '%1' found for sync removal\n")
+          .Arg(entry->GetEntryID());
+    });
   }
 
   if (success) {
@@ -281,12 +296,7 @@ int8_t ChannelSyncManager::Update<objects::SearchEntry>(
     if (isApp) {
       auto parentType =
           (objects::SearchEntry::Type_t)((int8_t)entry->GetType() - 1);
-      for (auto entry2 : mSearchEntries[parentType]) {
-        if (entry2->GetEntryID() == entry->GetParentEntryID()) {
-          parent = entry2;
-          break;
-        }
-      }
+      parent = mSearchEntries[parentType].Get(entry->GetParentEntryID());
     }
 
     // If an app is being removed, inform both characters involved, otherwise
@@ -32,9 +32,15 @@
 #include <DataSyncManager.h>
 #include <EnumMap.h>
 
+// Standard C++11 Includes
+#include <unordered_map>
+
 // object Includes
 #include <SearchEntry.h>
 
+// channel Includes
+#include "SearchEntryIndex.h"
+
 namespace objects {
 class EventCounter;
 }
@@ -83,6 +89,26 @@ class ChannelSyncManager : public libcomp::DataSyncManager {
   std::list<std::shared_ptr<objects::SearchEntry>> GetSearchEntries(
       objects::SearchEntry::Type_t type);
 
+  /**
+   * Get a single page of search entries of a specified type that pass a
+   * filter, highest entry ID first. Entries are read from the secondary
+   * index matching the filter so the full list is never copied.
+   * @param type Type of search entries to retrieve
+   * @param filter Filter the entries must pass
+   * @param pageID Entry ID the page starts after, 0 for the first page
+   * @param maxPageSize Maximum number of entries to return
+   * @param prev Output parameter set to the filtered entry before the page
+   *  if one exists
+   * @param next Output parameter set to the filtered entry after the page
+   *  if one exists
+   * @return List of entries on the requested page
+   */
+  std::list<std::shared_ptr<objects::SearchEntry>> GetSearchEntryPage(
+      objects::SearchEntry::Type_t type, const SearchEntryFilter& filter,
+      int32_t pageID, size_t maxPageSize,
+      std::shared_ptr<objects::SearchEntry>& prev,
+      std::shared_ptr<objects::SearchEntry>& next);
+
   /**
    * Get the world level event counter of the specified type
    * @return Pointer to the world level event counter, can be null
@@ -120,8 +146,7 @@ class ChannelSyncManager : public libcomp::DataSyncManager {
 
  private:
   /// Map of all search entries on the world server by type
-  libcomp::EnumMap<objects::SearchEntry::Type_t,
-                   std::list<std::shared_ptr<objects::SearchEntry>>>
+  libcomp::EnumMap<objects::SearchEntry::Type_t, SearchEntryIndex>
       mSearchEntries;
 
   /// Map of world level event counters by type
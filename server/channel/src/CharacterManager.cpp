@@ -39,6 +39,7 @@
 #include <math.h>
 
 #include <limits>
+#include <vector>
 
 // object Includes
 #include <Account.h>
@@ -117,6 +118,7 @@
 #include "ChannelServer.h"
 #include "ChannelSyncManager.h"
 #include "CultureMachineState.h"
+#include "DropRoller.h"
 #include "EventManager.h"
 #include "FusionManager.h"
 #include "ManagerConnection.h"
@@ -917,14 +919,13 @@ void CharacterManager::ReviveCharacter(
       if (spotID) {
         auto definitionManager = server->GetDefinitionManager();
         auto zoneData = definitionManager->GetZoneData(zoneDef->GetID());
-        auto spots = definitionManager->GetSpotData(zoneDef->GetDynamicMapID());
-        auto spotIter = spots.find(spotID);
-        if (spotIter != spots.end()) {
-          Point point =
-              zoneManager->GetRandomSpotPoint(spotIter->second, zoneData);
+        auto spot =
+            definitionManager->GetSpotData(zoneDef->GetDynamicMapID(), spotID);
+        if (spot) {
+          Point point = zoneManager->GetRandomSpotPoint(spot, zoneData);
           newX = point.x;
           newY = point.y;
-          newRot = spotIter->second->GetRotation();
+          newRot = spot->GetRotation();
         }
       }
 
@@ -992,7 +993,7 @@ void CharacterManager::ReviveCharacter(
     for (size_t i = 0; i < 50; i++) {
       auto item = inventory->GetItems(i).Get();
       auto itemData =
-          item ? definitionManager->GetItemData(item->GetType()) : nullptr;
+          item ? definitionManager->GetItemDataPtr(item->GetType()) : nullptr;
       if (itemData && itemData->GetBasic()->GetBaseID() == baseItemID) {
         if (item->GetType() != baseItemID) {
           // Variant found, go with this
@@ -2444,7 +2445,7 @@ bool CharacterManager::CultureItemPickup(
         for (uint32_t skillID : definitionManager->GetFunctionIDSkills(
                  SVR_CONST.SKILL_CULTURE_SLOT_UP)) {
           if (cState->CurrentSkillsContains(skillID)) {
-            auto skillData = definitionManager->GetSkillData(skillID);
+            auto skillData = definitionManager->GetSkillDataPtr(skillID);
             int32_t boost =
                 skillData ? skillData->GetSpecial()->GetSpecialParams(0) : 0;
             slotRate = slotRate + ((double)boost * 0.01);
@@ -2525,49 +2526,21 @@ CharacterManager::DetermineDropSets(
   auto server = mServer.lock();
   auto serverDataManager = server->GetServerDataManager();
 
-  std::unordered_map<uint32_t, std::shared_ptr<objects::DropSet>> defs;
-  std::unordered_map<uint32_t, std::set<uint32_t>> mutexIDs;
+  // Look up each definition once, in the same order as the IDs
+  std::vector<std::shared_ptr<objects::DropSet>> defs;
+  defs.reserve(dropSetIDs.size());
   for (uint32_t dropSetID : dropSetIDs) {
-    auto dropSet = serverDataManager->GetDropSetData(dropSetID);
-    if (dropSet) {
-      defs[dropSetID] = dropSet;
-      if (dropSet->GetMutexID()) {
-        mutexIDs[dropSet->GetMutexID()].insert(dropSetID);
-      }
-    }
+    defs.push_back(serverDataManager->GetDropSetData(dropSetID));
   }
 
-  if (mutexIDs.size() > 0) {
-    for (auto& pair : mutexIDs) {
-      if (pair.second.size() > 1) {
-        // There can only be one at a time
-        uint32_t dropSetID = libcomp::Randomizer::GetEntry(pair.second);
-        pair.second.clear();
-        pair.second.insert(dropSetID);
-      }
+  for (auto& dropSet : DropRoller::SelectDropSets(dropSetIDs, defs, filter)) {
+    if (filter && dropSet->ConditionsCount() > 0 &&
+        !server->GetEventManager()->EvaluateEventConditions(zone, dropSet,
+                                                            client)) {
+      continue;
     }
-  }
 
-  for (uint32_t dropSetID : dropSetIDs) {
-    auto dropSet = defs[dropSetID];
-    if (dropSet) {
-      bool valid = true;
-      if (filter) {
-        if (dropSet->GetMutexID() &&
-            *mutexIDs[dropSet->GetMutexID()].begin() != dropSetID) {
-          valid = false;
-        } else if (dropSet->ConditionsCount() > 0) {
-          if (!server->GetEventManager()->EvaluateEventConditions(
-                  zone, dropSet->GetConditions(), client)) {
-            valid = false;
-          }
-        }
-      }
-
-      if (valid) {
-        dropSets.push_back(dropSet);
-      }
-    }
+    dropSets.push_back(dropSet);
   }
 
   return dropSets;
@@ -2576,49 +2549,15 @@ CharacterManager::DetermineDropSets(
 std::list<std::shared_ptr<objects::ItemDrop>> CharacterManager::DetermineDrops(
     const std::list<std::shared_ptr<objects::ItemDrop>>& drops, int16_t luck,
     bool minLast) {
-  std::list<std::shared_ptr<objects::ItemDrop>> results;
   if (drops.size() == 0) {
-    return results;
+    return std::list<std::shared_ptr<objects::ItemDrop>>();
   }
 
   auto sharedConfig = mServer.lock()->GetWorldSharedConfig();
-  float globalDropBonus = sharedConfig->GetDropRateBonus();
-  float scalingCap = sharedConfig->GetDropLuckScalingCap();
-
-  for (auto drop : drops) {
-    double baseRate = (double)drop->GetRate();
-    uint32_t dropRate = (uint32_t)(baseRate * 100.0);
-    if (luck > 0 && scalingCap != 0.f) {
-      // Scale drop rates based on luck, more for high drop rates and higher
-      // luck. Estimates roughly to: 75% base -> 76.47% at 10 luck, 87.26% at 30
-      // luck, 100+% at 44+ luck 50% base -> 51.83% at 20 luck, 57.05% at 40
-      // luck, 100+% at 114+ luck 10% base -> 10.57% at 40 luck, 22.7% at 200
-      // luck, 100+% at 600+ luck 1% base -> 3.33% at 300 luck, 6.83% at 500
-      // luck, 12.78% at 750 luck 0.1% base -> 0.89% at 600 luck, 1.39% at 800
-      // luck, 1.95% at 999 luck
-      double deltaDiff = (double)(100.0 - baseRate);
-      dropRate = (uint32_t)(
-          baseRate *
-          (100.f +
-           100.f * (float)(((double)luck / 30.0) * 10.0 * (double)luck) /
-               (1000.0 + 7.0 * (double)luck + (deltaDiff * deltaDiff))));
-
-      // Limit luck scaling based on cap
-      if (scalingCap > 0.f &&
-          (float)((double)dropRate / (baseRate * 100.0)) > (1.f + scalingCap)) {
-        dropRate = (uint32_t)(baseRate * 100.0 * (1.0 + (double)scalingCap));
-      }
-    }
-
-    dropRate = (uint32_t)((double)dropRate * (double)(1.f + globalDropBonus));
-
-    if (dropRate >= 10000 || RNG(uint16_t, 1, 10000) <= dropRate ||
-        (minLast && results.size() == 0 && drops.back() == drop)) {
-      results.push_back(drop);
-    }
-  }
+  DropRoller roller(luck, sharedConfig->GetDropRateBonus(),
+                    sharedConfig->GetDropLuckScalingCap());
 
-  return results;
+  return roller.Roll(drops, minLast);
 }
 
 bool CharacterManager::CreateLootFromDrops(
@@ -2698,7 +2637,7 @@ std::list<std::shared_ptr<objects::Loot>> CharacterManager::CreateLootFromDrops(
       // Remove it from the set so its not generated twice
       subset.erase(it);
 
-      auto itemDef = definitionManager->GetItemData(drop->GetItemType());
+      auto itemDef = definitionManager->GetItemDataPtr(drop->GetItemType());
       if (!itemDef) {
         LogCharacterManagerError([&]() {
           return libcomp::String(
@@ -5498,7 +5437,7 @@ bool CharacterManager::UpdateStatusEffects(
 
   uint32_t now = (uint32_t)std::time(0);
   for (auto effect : demon->GetStatusEffects()) {
-    auto se = definitionManager->GetStatusData(effect->GetEffect());
+    auto se = definitionManager->GetStatusDataPtr(effect->GetEffect());
 
     auto cancel = se->GetCancel();
     switch (cancel->GetDurationType()) {
@@ -5710,7 +5649,7 @@ void CharacterManager::CancelStatusEffects(
     std::set<uint32_t> cancelled;
     for (auto effect : effects) {
       auto cancel =
-          definitionManager->GetStatusData(effect->GetEffect())->GetCancel();
+          definitionManager->GetStatusDataPtr(effect->GetEffect())->GetCancel();
       if (cancel->GetCancelTypes() & cancelFlags) {
         compEffects.push_back(effect.Get());
         cancelled.insert(effect->GetEffect());
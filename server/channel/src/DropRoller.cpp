@@ -0,0 +1,139 @@
+/**
+ * @file server/channel/src/DropRoller.cpp
+ * @ingroup channel
+ *
+ * @author COMP Omega <compomega@tutanota.com>
+ *
+ * @brief Item drop rate and drop set rolls.
+ *
+ * This file is part of the Channel Server (channel).
+ *
+ * Copyright (C) 2012-2020 COMP_hack Team <compomega@tutanota.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "DropRoller.h"
+
+// libcomp Includes
+#include <Randomizer.h>
+
+// Standard C++11 Includes
+#include <set>
+#include <unordered_map>
+
+// object Includes
+#include <DropSet.h>
+#include <ItemDrop.h>
+
+using namespace channel;
+
+DropRoller::DropRoller(int16_t luck, float globalDropBonus, float scalingCap)
+    : mScalingCap(scalingCap),
+      mLuckScaled(luck > 0 && scalingCap != 0.f),
+      mLuckFactor(0.f),
+      mLuckDivisor(1000.0 + 7.0 * (double)luck),
+      mBonusScale((double)(1.f + globalDropBonus)) {
+  if (mLuckScaled) {
+    mLuckFactor = (float)(((double)luck / 30.0) * 10.0 * (double)luck);
+  }
+}
+
+uint32_t DropRoller::GetDropRate(float rate) const {
+  double baseRate = (double)rate;
+  uint32_t dropRate = (uint32_t)(baseRate * 100.0);
+  if (mLuckScaled) {
+    // Scale drop rates based on luck, more for high drop rates and higher
+    // luck. Estimates roughly to: 75% base -> 76.47% at 10 luck, 87.26% at 30
+    // luck, 100+% at 44+ luck 50% base -> 51.83% at 20 luck, 57.05% at 40
+    // luck, 100+% at 114+ luck 10% base -> 10.57% at 40 luck, 22.7% at 200
+    // luck, 100+% at 600+ luck 1% base -> 3.33% at 300 luck, 6.83% at 500
+    // luck, 12.78% at 750 luck 0.1% base -> 0.89% at 600 luck, 1.39% at 800
+    // luck, 1.95% at 999 luck
+    double deltaDiff = (double)(100.0 - baseRate);
+    dropRate = (uint32_t)(
+        baseRate * (100.f + 100.f * mLuckFactor /
+                                (mLuckDivisor + (deltaDiff * deltaDiff))));
+
+    // Limit luck scaling based on cap
+    if (mScalingCap > 0.f &&
+        (float)((double)dropRate / (baseRate * 100.0)) > (1.f + mScalingCap)) {
+      dropRate = (uint32_t)(baseRate * 100.0 * (1.0 + (double)mScalingCap));
+    }
+  }
+
+  return (uint32_t)((double)dropRate * mBonusScale);
+}
+
+std::list<std::shared_ptr<objects::ItemDrop>> DropRoller::Roll(
+    const std::list<std::shared_ptr<objects::ItemDrop>>& drops,
+    bool minLast) const {
+  std::list<std::shared_ptr<objects::ItemDrop>> results;
+  if (drops.size() == 0) {
+    return results;
+  }
+
+  auto& lastDrop = drops.back();
+  for (auto& drop : drops) {
+    uint32_t dropRate = GetDropRate(drop->GetRate());
+
+    // Drops that can never drop do not need a roll
+    if (dropRate >= 10000 ||
+        (dropRate && RNG(uint16_t, 1, 10000) <= dropRate) ||
+        (minLast && results.size() == 0 && lastDrop == drop)) {
+      results.push_back(drop);
+    }
+  }
+
+  return results;
+}
+
+std::list<std::shared_ptr<objects::DropSet>> DropRoller::SelectDropSets(
+    const std::list<uint32_t>& dropSetIDs,
+    const std::vector<std::shared_ptr<objects::DropSet>>& defs,
+    bool filter) {
+  // Most drop sets have no mutex so only group them when one is found
+  std::unordered_map<uint32_t, std::set<uint32_t>> mutexIDs;
+  if (filter) {
+    auto defIter = defs.begin();
+    for (uint32_t dropSetID : dropSetIDs) {
+      auto& dropSet = *defIter++;
+      if (dropSet && dropSet->GetMutexID()) {
+        mutexIDs[dropSet->GetMutexID()].insert(dropSetID);
+      }
+    }
+
+    for (auto& pair : mutexIDs) {
+      if (pair.second.size() > 1) {
+        // There can only be one at a time
+        uint32_t dropSetID = libcomp::Randomizer::GetEntry(pair.second);
+        pair.second.clear();
+        pair.second.insert(dropSetID);
+      }
+    }
+  }
+
+  std::list<std::shared_ptr<objects::DropSet>> dropSets;
+
+  auto defIter = defs.begin();
+  for (uint32_t dropSetID : dropSetIDs) {
+    auto& dropSet = *defIter++;
+    if (dropSet && (!filter || !dropSet->GetMutexID() ||
+                    *mutexIDs[dropSet->GetMutexID()].begin() == dropSetID)) {
+      dropSets.push_back(dropSet);
+    }
+  }
+
+  return dropSets;
+}
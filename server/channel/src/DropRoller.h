@@ -0,0 +1,114 @@
+/**
+ * @file server/channel/src/DropRoller.h
+ * @ingroup channel
+ *
+ * @author COMP Omega <compomega@tutanota.com>
+ *
+ * @brief Item drop rate and drop set rolls.
+ *
+ * This file is part of the Channel Server (channel).
+ *
+ * Copyright (C) 2012-2020 COMP_hack Team <compomega@tutanota.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SERVER_CHANNEL_SRC_DROPROLLER_H
+#define SERVER_CHANNEL_SRC_DROPROLLER_H
+
+// Standard C Includes
+#include <stdint.h>
+
+// Standard C++11 Includes
+#include <list>
+#include <memory>
+#include <vector>
+
+namespace objects {
+class DropSet;
+class ItemDrop;
+}  // namespace objects
+
+namespace channel {
+
+/**
+ * Rolls item drops for a single luck value and drop rate configuration.
+ * The parts of the luck scaling that are the same for every drop are
+ * calculated once when the roller is created. Each drop is still rolled
+ * on its own.
+ */
+class DropRoller {
+ public:
+  /**
+   * Create a new drop roller.
+   * @param luck Current luck value to use when calculating drop chances
+   * @param globalDropBonus Drop rate bonus applied to every drop
+   * @param scalingCap Maximum luck scaling of a drop rate, 0 to disable
+   *  luck scaling and negative for no maximum
+   */
+  DropRoller(int16_t luck, float globalDropBonus, float scalingCap);
+
+  /**
+   * Get the final rate of a drop after luck scaling and the global bonus.
+   * @param rate Base drop rate as a percentage
+   * @return Drop rate in hundredths of a percent, 10000 or more always
+   *  drops
+   */
+  uint32_t GetDropRate(float rate) const;
+
+  /**
+   * Roll each item drop in a set.
+   * @param drops List of pointers to the item drops to roll
+   * @param minLast true if the set needs at least one item in which case
+   *  the last item will be used
+   * @return List of item drops that should be "dropped"
+   */
+  std::list<std::shared_ptr<objects::ItemDrop>> Roll(
+      const std::list<std::shared_ptr<objects::ItemDrop>>& drops,
+      bool minLast) const;
+
+  /**
+   * Get the drop sets that exist and, if filtering, pick one set at random
+   * out of each group of sets that share a mutex ID.
+   * @param dropSetIDs List of drop set IDs
+   * @param defs Definition of each drop set in the same order as the IDs,
+   *  null if the definition does not exist
+   * @param filter true if mutually exclusive sets should be filtered
+   * @return List of drop set definitions in the same order as the IDs
+   */
+  static std::list<std::shared_ptr<objects::DropSet>> SelectDropSets(
+      const std::list<uint32_t>& dropSetIDs,
+      const std::vector<std::shared_ptr<objects::DropSet>>& defs,
+      bool filter);
+
+ private:
+  /// Maximum luck scaling of a drop rate
+  float mScalingCap;
+
+  /// Indicates if drop rates are scaled by luck
+  bool mLuckScaled;
+
+  /// Luck term of the scaling, the same for every drop
+  float mLuckFactor;
+
+  /// Luck part of the scaling divisor, the same for every drop
+  double mLuckDivisor;
+
+  /// Multiplier of the global drop rate bonus
+  double mBonusScale;
+};
+
+}  // namespace channel
+
+#endif  // SERVER_CHANNEL_SRC_DROPROLLER_H
@@ -0,0 +1,157 @@
+/**
+ * @file server/channel/src/EventConditionProgram.cpp
+ * @ingroup channel
+ *
+ * @author COMP Omega <compomega@tutanota.com>
+ *
+ * @brief Event condition lists lowered when the server data is loaded.
+ *
+ * This file is part of the Channel Server (channel).
+ *
+ * Copyright (C) 2012-2020 COMP_hack Team <compomega@tutanota.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "EventConditionProgram.h"
+
+// Standard C++11 Includes
+#include <algorithm>
+
+// object Includes
+#include <EventFlagCondition.h>
+#include <EventScriptCondition.h>
+
+using namespace channel;
+
+EventConditionProgram::EventConditionProgram(
+    const std::list<std::shared_ptr<objects::EventCondition>>& conditions) {
+  mConditions.reserve(conditions.size());
+  for (auto& condition : conditions) {
+    mConditions.push_back(Lower(condition));
+  }
+}
+
+std::vector<LoweredEventCondition>& EventConditionProgram::GetConditions() {
+  return mConditions;
+}
+
+const std::vector<LoweredEventCondition>&
+EventConditionProgram::GetConditions() const {
+  return mConditions;
+}
+
+bool EventConditionProgram::Matches(
+    const std::list<std::shared_ptr<objects::EventCondition>>& conditions)
+    const {
+  if (conditions.size() != mConditions.size()) {
+    return false;
+  }
+
+  auto it = mConditions.begin();
+  for (auto& condition : conditions) {
+    auto expected = Lower(condition);
+    auto& lowered = *it++;
+    if (lowered.Source != condition || lowered.Op != expected.Op ||
+        lowered.Negate != expected.Negate ||
+        lowered.CompareMode != expected.CompareMode ||
+        lowered.InstanceFlags != expected.InstanceFlags ||
+        lowered.CharacterFlags != expected.CharacterFlags ||
+        lowered.FlagStates != expected.FlagStates ||
+        lowered.Script != expected.Script) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+LoweredEventCondition EventConditionProgram::Lower(
+    const std::shared_ptr<objects::EventCondition>& condition) {
+  LoweredEventCondition lowered;
+  lowered.Source = condition;
+  if (!condition) {
+    return lowered;
+  }
+
+  lowered.Negate = condition->GetNegate();
+  lowered.CompareMode = condition->GetCompareMode();
+
+  std::shared_ptr<objects::EventFlagCondition> flagCon;
+  switch (condition->GetType()) {
+    case objects::EventCondition::Type_t::SCRIPT:
+      lowered.Script =
+          std::dynamic_pointer_cast<objects::EventScriptCondition>(condition);
+      if (lowered.Script) {
+        lowered.Op = EventConditionOp_t::SCRIPT;
+      }
+      break;
+    case objects::EventCondition::Type_t::ZONE_INSTANCE_CHARACTER_FLAGS:
+      lowered.CharacterFlags = true;
+      // Fall through
+    case objects::EventCondition::Type_t::ZONE_INSTANCE_FLAGS:
+      lowered.InstanceFlags = true;
+      flagCon =
+          std::dynamic_pointer_cast<objects::EventFlagCondition>(condition);
+      break;
+    case objects::EventCondition::Type_t::ZONE_CHARACTER_FLAGS:
+      lowered.CharacterFlags = true;
+      // Fall through
+    case objects::EventCondition::Type_t::ZONE_FLAGS:
+      flagCon =
+          std::dynamic_pointer_cast<objects::EventFlagCondition>(condition);
+      break;
+    case objects::EventCondition::Type_t::PARTNER_ALIVE:
+    case objects::EventCondition::Type_t::PARTNER_FAMILIARITY:
+    case objects::EventCondition::Type_t::PARTNER_LEVEL:
+    case objects::EventCondition::Type_t::PARTNER_LOCKED:
+    case objects::EventCondition::Type_t::PARTNER_SKILL_LEARNED:
+    case objects::EventCondition::Type_t::PARTNER_STAT_VALUE:
+    case objects::EventCondition::Type_t::SOUL_POINTS:
+      lowered.Op = EventConditionOp_t::PARTNER;
+      break;
+    case objects::EventCondition::Type_t::QUEST_AVAILABLE:
+    case objects::EventCondition::Type_t::QUEST_PHASE:
+    case objects::EventCondition::Type_t::QUEST_PHASE_REQUIREMENTS:
+      lowered.Op = EventConditionOp_t::QUEST;
+      break;
+    case objects::EventCondition::Type_t::QUEST_FLAGS:
+      flagCon =
+          std::dynamic_pointer_cast<objects::EventFlagCondition>(condition);
+      if (flagCon) {
+        lowered.Op = EventConditionOp_t::QUEST_FLAGS;
+      } else {
+        // Missing flags are reported when evaluated
+        lowered.Op = EventConditionOp_t::QUEST;
+      }
+      break;
+    default:
+      lowered.Op = EventConditionOp_t::DATA;
+      break;
+  }
+
+  if (flagCon) {
+    if (lowered.Op == EventConditionOp_t::INVALID) {
+      lowered.Op = EventConditionOp_t::ZONE_FLAGS;
+    }
+
+    for (auto& pair : flagCon->GetFlagStates()) {
+      lowered.FlagStates.push_back(pair);
+    }
+
+    std::sort(lowered.FlagStates.begin(), lowered.FlagStates.end());
+  }
+
+  return lowered;
+}
@@ -0,0 +1,217 @@
+/**
+ * @file server/channel/src/EventConditionProgram.h
+ * @ingroup channel
+ *
+ * @author COMP Omega <compomega@tutanota.com>
+ *
+ * @brief Event condition lists lowered when the server data is loaded.
+ *
+ * This file is part of the Channel Server (channel).
+ *
+ * Copyright (C) 2012-2020 COMP_hack Team <compomega@tutanota.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SERVER_CHANNEL_SRC_EVENTCONDITIONPROGRAM_H
+#define SERVER_CHANNEL_SRC_EVENTCONDITIONPROGRAM_H
+
+// object Includes
+#include <EventCondition.h>
+
+// Standard C++11 Includes
+#include <list>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace libhack {
+struct ServerScript;
+}  // namespace libhack
+
+namespace objects {
+class EventScriptCondition;
+}  // namespace objects
+
+typedef objects::EventCondition::CompareMode_t EventCompareMode;
+
+namespace channel {
+
+struct PreparedConditionScript;
+
+/**
+ * Operation an event condition is lowered to. Each operation maps to one
+ * evaluation path so the condition type is only inspected when it is
+ * lowered.
+ */
+enum class EventConditionOp_t : uint8_t {
+  INVALID,      //!< Malformed condition that always fails
+  SCRIPT,       //!< Condition script check function
+  ZONE_FLAGS,   //!< Zone or zone instance flag states
+  PARTNER,      //!< Partner demon or soul point condition
+  QUEST,        //!< Quest state other than quest flags
+  QUEST_FLAGS,  //!< Quest flag states
+  DATA,         //!< Entity, inventory or world state comparison
+};
+
+/**
+ * Event condition with its operation, casts and flag lookups resolved.
+ */
+struct LoweredEventCondition {
+  /// Operation the condition evaluates with
+  EventConditionOp_t Op = EventConditionOp_t::INVALID;
+
+  /// Indicates if the result is negated
+  bool Negate = false;
+
+  /// Compare mode of the condition
+  EventCompareMode CompareMode = EventCompareMode::DEFAULT_COMPARE;
+
+  /// Indicates if zone flags are read from the zone instance
+  bool InstanceFlags = false;
+
+  /// Indicates if zone flags are scoped to the character checking them
+  bool CharacterFlags = false;
+
+  /// Flag keys and the values they are compared to, in key order
+  std::vector<std::pair<int32_t, int32_t>> FlagStates;
+
+  /// Condition the operation was lowered from
+  std::shared_ptr<objects::EventCondition> Source;
+
+  /// Script condition, set for the SCRIPT operation
+  std::shared_ptr<objects::EventScriptCondition> Script;
+
+  /// Condition script definition, null if it does not exist or is not an
+  /// event condition script
+  std::shared_ptr<libhack::ServerScript> ScriptDefinition;
+
+  /// Shared prepared script, set when the script is not instantiated
+  /// per call
+  std::shared_ptr<PreparedConditionScript> PreparedScript;
+};
+
+/**
+ * List of event conditions lowered when the server data is loaded. The
+ * operation, object casts and flag keys of each condition are resolved
+ * once so evaluating a condition only reads the state it compares against.
+ * Programs are never modified after they are built.
+ */
+class EventConditionProgram {
+ public:
+  /**
+   * Lower a list of event conditions. Condition scripts are left unresolved
+   * and must be set by the caller.
+   * @param conditions Conditions to lower, in evaluation order
+   */
+  explicit EventConditionProgram(
+      const std::list<std::shared_ptr<objects::EventCondition>>& conditions);
+
+  /**
+   * Get the lowered conditions in evaluation order.
+   * @return Lowered conditions
+   */
+  std::vector<LoweredEventCondition>& GetConditions();
+
+  /**
+   * Get the lowered conditions in evaluation order.
+   * @return Lowered conditions
+   */
+  const std::vector<LoweredEventCondition>& GetConditions() const;
+
+  /**
+   * Check if the program still matches the conditions it was lowered from.
+   * @param conditions Conditions the program was lowered from
+   * @return true if every condition lowered to the expected operation
+   */
+  bool Matches(
+      const std::list<std::shared_ptr<objects::EventCondition>>& conditions)
+      const;
+
+  /**
+   * Lower a single event condition.
+   * @param condition Condition to lower
+   * @return Lowered condition
+   */
+  static LoweredEventCondition Lower(
+      const std::shared_ptr<objects::EventCondition>& condition);
+
+  /**
+   * Compare flag states with the same rules as
+   * EventManager::EvaluateFlagStates without building a map of the current
+   * values first.
+   * @param compareMode Compare mode of the flag condition
+   * @param flagStates Flag keys and the values they are compared to
+   * @param getFlag Callable with the signature bool(int32_t key,
+   *  int32_t& value) that returns false if the flag is not set
+   * @return true if the flag states match
+   */
+  template <typename T>
+  static bool EvaluateFlagStates(
+      EventCompareMode compareMode,
+      const std::vector<std::pair<int32_t, int32_t>>& flagStates,
+      T getFlag) {
+    int32_t value = 0;
+    switch (compareMode) {
+      case EventCompareMode::EXISTS:
+        for (auto& pair : flagStates) {
+          if (!getFlag(pair.first, value)) {
+            return false;
+          }
+        }
+        break;
+      case EventCompareMode::LT_OR_NAN:
+        // Flag specific less than or not a number (does not exist)
+        for (auto& pair : flagStates) {
+          if (getFlag(pair.first, value) && value >= pair.second) {
+            return false;
+          }
+        }
+        break;
+      case EventCompareMode::LT:
+        for (auto& pair : flagStates) {
+          if (!getFlag(pair.first, value) || value >= pair.second) {
+            return false;
+          }
+        }
+        break;
+      case EventCompareMode::GTE:
+        for (auto& pair : flagStates) {
+          if (!getFlag(pair.first, value) || value < pair.second) {
+            return false;
+          }
+        }
+        break;
+      case EventCompareMode::DEFAULT_COMPARE:
+      case EventCompareMode::EQUAL:
+      default:
+        for (auto& pair : flagStates) {
+          if (!getFlag(pair.first, value) || value != pair.second) {
+            return false;
+          }
+        }
+        break;
+    }
+
+    return true;
+  }
+
+ private:
+  /// Lowered conditions in evaluation order
+  std::vector<LoweredEventCondition> mConditions;
+};
+
+}  // namespace channel
+
+#endif  // SERVER_CHANNEL_SRC_EVENTCONDITIONPROGRAM_H
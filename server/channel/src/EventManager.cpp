@@ -67,6 +67,7 @@
 #include <EventPlayScene.h>
 #include <EventPrompt.h>
 #include <EventScriptCondition.h>
+#include <EventSequence.h>
 #include <EventState.h>
 #include <Expertise.h>
 #include <InstanceAccess.h>
@@ -127,10 +128,37 @@ const uint16_t EVENT_COMPARE_NUMERIC2 =
     EVENT_COMPARE_NUMERIC | (uint16_t)EventCompareMode::BETWEEN;
 
 EventManager::EventManager(const std::weak_ptr<ChannelServer>& server)
-    : mServer(server) {}
+    : mServer(server), mVerifyConditionPrograms(false) {}
 
 EventManager::~EventManager() {}
 
+bool EventManager::Initialize() {
+  auto server = mServer.lock();
+  auto serverDataManager = server->GetServerDataManager();
+
+  mVerifyConditionPrograms =
+      std::dynamic_pointer_cast<objects::ChannelConfig>(server->GetConfig())
+          ->GetVerifyLoweredConditions();
+
+  for (auto& pair : serverDataManager->GetEventData()) {
+    LowerEventConditions(pair.second);
+  }
+
+  for (auto& pair : serverDataManager->GetDropSetData()) {
+    auto& dropSet = pair.second;
+    if (dropSet->ConditionsCount() > 0) {
+      LowerConditions(dropSet, dropSet->GetConditions());
+    }
+  }
+
+  LogEventManagerDebug([&]() {
+    return libcomp::String("Lowered %1 event and drop set condition lists\n")
+        .Arg(mConditionPrograms.size());
+  });
+
+  return true;
+}
+
 bool EventManager::HandleEvent(
     const std::shared_ptr<ChannelClientConnection>& client,
     const libcomp::String& eventID, int32_t sourceEntityID,
@@ -835,37 +863,12 @@ bool EventManager::EvaluateEventCondition(
               .Arg(scriptCondition->GetScriptID());
         });
       } else if (script && script->Type.ToLower() == "eventcondition") {
-        auto engine = std::make_shared<libhack::ScriptEngine>();
-        engine->Using<CharacterState>();
-        engine->Using<DemonState>();
-        engine->Using<Zone>();
-        engine->Using<libcomp::Randomizer>();
-
-        if (engine->Eval(script->Source)) {
-          Sqrat::Function f(Sqrat::RootTable(engine->GetVM()), "check");
-
-          Sqrat::Array sqParams(engine->GetVM());
-          for (libcomp::String p : scriptCondition->GetParams()) {
-            sqParams.Append(p);
-          }
-
-          int32_t sourceEntityID = ctx.EventInstance->GetSourceEntityID();
-
-          auto state = client ? client->GetClientState() : nullptr;
-          auto scriptResult =
-              !f.IsNull()
-                  ? f.Evaluate<int32_t>(
-                        ctx.CurrentZone
-                            ? ctx.CurrentZone->GetActiveEntity(sourceEntityID)
-                            : nullptr,
-                        state ? state->GetCharacterState() : nullptr,
-                        state ? state->GetDemonState() : nullptr,
-                        ctx.CurrentZone, scriptCondition->GetValue1(),
-                        scriptCondition->GetValue2(), sqParams)
-                  : 0;
-          if (scriptResult) {
-            return negate != (*scriptResult == 0);
-          }
+        int32_t result = 0;
+        if (EvaluateConditionScript(
+                ctx, scriptCondition,
+                GetConditionScript(scriptCondition->GetScriptID(), script),
+                result)) {
+          return negate != (result == 0);
         }
       } else {
         LogEventManagerError([&]() {
@@ -983,6 +986,80 @@ bool EventManager::EvaluateEventCondition(
   return false;
 }
 
+bool EventManager::EvaluateConditionScript(
+    EventContext& ctx,
+    const std::shared_ptr<objects::EventScriptCondition>& condition,
+    const std::shared_ptr<PreparedConditionScript>& prepared,
+    int32_t& result) {
+  if (!prepared) {
+    return false;
+  }
+
+  std::lock_guard<std::mutex> lock(prepared->Lock);
+
+  Sqrat::Function f(Sqrat::RootTable(prepared->Engine->GetVM()), "check");
+
+  Sqrat::Array sqParams(prepared->Engine->GetVM());
+  for (libcomp::String p : condition->GetParams()) {
+    sqParams.Append(p);
+  }
+
+  int32_t sourceEntityID = ctx.EventInstance->GetSourceEntityID();
+
+  auto state = ctx.Client ? ctx.Client->GetClientState() : nullptr;
+  auto scriptResult =
+      !f.IsNull()
+          ? f.Evaluate<int32_t>(
+                ctx.CurrentZone
+                    ? ctx.CurrentZone->GetActiveEntity(sourceEntityID)
+                    : nullptr,
+                state ? state->GetCharacterState() : nullptr,
+                state ? state->GetDemonState() : nullptr, ctx.CurrentZone,
+                condition->GetValue1(), condition->GetValue2(), sqParams)
+          : 0;
+  if (scriptResult) {
+    result = *scriptResult;
+    return true;
+  }
+
+  return false;
+}
+
+std::shared_ptr<PreparedConditionScript> EventManager::GetConditionScript(
+    const libcomp::String& scriptID,
+    const std::shared_ptr<libhack::ServerScript>& script) {
+  if (!script->Instantiated) {
+    std::lock_guard<std::mutex> lock(mConditionScriptLock);
+
+    auto it = mConditionScripts.find(scriptID.C());
+    if (it != mConditionScripts.end()) {
+      return it->second;
+    }
+  }
+
+  auto prepared = std::make_shared<PreparedConditionScript>();
+  prepared->Engine = std::make_shared<libhack::ScriptEngine>();
+  prepared->Engine->Using<CharacterState>();
+  prepared->Engine->Using<DemonState>();
+  prepared->Engine->Using<Zone>();
+  prepared->Engine->Using<libcomp::Randomizer>();
+
+  if (!prepared->Engine->Eval(script->Source)) {
+    return nullptr;
+  }
+
+  if (!script->Instantiated) {
+    // If another thread prepared the same script first, use that one
+    std::lock_guard<std::mutex> lock(mConditionScriptLock);
+
+    auto result = mConditionScripts.insert(
+        std::make_pair(std::string(scriptID.C()), prepared));
+    return result.first->second;
+  }
+
+  return prepared;
+}
+
 bool EventManager::EvaluatePartnerCondition(
     const std::shared_ptr<ChannelClientConnection>& client,
     const std::shared_ptr<objects::EventCondition>& condition) {
@@ -1253,10 +1330,25 @@ bool EventManager::EvaluateEventConditions(
   return EvaluateEventConditions(ctx, conditions);
 }
 
+bool EventManager::EvaluateEventConditions(
+    const std::shared_ptr<Zone>& zone,
+    const std::shared_ptr<objects::DropSet>& dropSet,
+    const std::shared_ptr<ChannelClientConnection>& client) {
+  EventContext ctx;
+  ctx.Client = client;
+  ctx.EventInstance = std::make_shared<objects::EventInstance>();  // No event
+  ctx.CurrentZone = zone;
+  ctx.AutoOnly = true;
+
+  auto program = GetConditionProgram(dropSet.get());
+  return program ? EvaluateConditionProgram(ctx, *program)
+                 : EvaluateEventConditions(ctx, dropSet->GetConditions());
+}
+
 bool EventManager::EvaluateEventConditions(
     EventContext& ctx,
     const std::list<std::shared_ptr<objects::EventCondition>>& conditions) {
-  for (auto condition : conditions) {
+  for (auto& condition : conditions) {
     if (!EvaluateEventCondition(ctx, condition)) {
       return false;
     }
@@ -1265,6 +1357,240 @@ bool EventManager::EvaluateEventConditions(
   return true;
 }
 
+bool EventManager::EvaluateEventConditions(
+    EventContext& ctx, const std::shared_ptr<objects::EventBase>& owner) {
+  auto program = GetConditionProgram(owner.get());
+  return program ? EvaluateConditionProgram(ctx, *program)
+                 : EvaluateEventConditions(ctx, owner->GetConditions());
+}
+
+const EventConditionProgram* EventManager::GetConditionProgram(
+    const void* owner) const {
+  auto it = mConditionPrograms.find(owner);
+  return it != mConditionPrograms.end() ? it->second.get() : nullptr;
+}
+
+bool EventManager::EvaluateConditionProgram(
+    EventContext& ctx, const EventConditionProgram& program) {
+  for (auto& condition : program.GetConditions()) {
+    bool result = EvaluateLoweredCondition(ctx, condition);
+
+    // Scripts can roll random numbers so they are not compared
+    if (mVerifyConditionPrograms && condition.Source &&
+        condition.Op != EventConditionOp_t::SCRIPT) {
+      bool expected = EvaluateEventCondition(ctx, condition.Source);
+      if (result != expected) {
+        auto event = ctx.EventInstance->GetEvent();
+        LogEventManagerError([&]() {
+          return libcomp::String(
+                     "Lowered event condition of type %1 in event '%2' "
+                     "evaluated to %3 instead of %4\n")
+              .Arg(to_underlying(condition.Source->GetType()))
+              .Arg(event ? event->GetID() : libcomp::String("(none)"))
+              .Arg(result ? "true" : "false")
+              .Arg(expected ? "true" : "false");
+        });
+
+        result = expected;
+      }
+    }
+
+    if (!result) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+bool EventManager::EvaluateLoweredCondition(
+    EventContext& ctx, const LoweredEventCondition& condition) {
+  auto client = ctx.Client;
+  bool negate = condition.Negate;
+  switch (condition.Op) {
+    case EventConditionOp_t::SCRIPT: {
+      if (ctx.Client && !ctx.CurrentZone) {
+        LogEventManagerError([&]() {
+          return libcomp::String(
+                     "Attempted to execute a client targeted condition script "
+                     "ID outside of a zone: %1\n")
+              .Arg(condition.Script->GetScriptID());
+        });
+      } else if (condition.ScriptDefinition) {
+        auto prepared = condition.PreparedScript;
+        if (!prepared) {
+          // Instantiated or failed to prepare when lowered
+          prepared = GetConditionScript(condition.Script->GetScriptID(),
+                                        condition.ScriptDefinition);
+        }
+
+        int32_t result = 0;
+        if (EvaluateConditionScript(ctx, condition.Script, prepared, result)) {
+          return negate != (result == 0);
+        }
+      } else {
+        LogEventManagerError([&]() {
+          return libcomp::String("Invalid event condition script ID: %1\n")
+              .Arg(condition.Script->GetScriptID());
+        });
+      }
+    } break;
+    case EventConditionOp_t::ZONE_FLAGS: {
+      int32_t worldCID = 0;
+      if (condition.CharacterFlags) {
+        if (!client) {
+          auto eventID = ctx.EventInstance->GetEvent()->GetID();
+          bool instanceFlags = condition.InstanceFlags;
+          LogEventManagerError([eventID, instanceFlags]() {
+            return libcomp::String(
+                       "Attempted to check zone %1character flags with no "
+                       "associated client: %2\n")
+                .Arg(instanceFlags ? "instance " : "")
+                .Arg(eventID);
+          });
+
+          return false;
+        }
+
+        worldCID = client->GetClientState()->GetWorldCID();
+      }
+
+      auto zone = ctx.CurrentZone;
+      if (!zone) {
+        return false;
+      }
+
+      bool result = false;
+      if (condition.InstanceFlags) {
+        auto inst = zone->GetInstance();
+        if (!inst) {
+          return false;
+        }
+
+        result = EventConditionProgram::EvaluateFlagStates(
+            condition.CompareMode, condition.FlagStates,
+            [&inst, worldCID](int32_t key, int32_t& value) {
+              return inst->GetFlagState(key, value, worldCID);
+            });
+      } else {
+        result = EventConditionProgram::EvaluateFlagStates(
+            condition.CompareMode, condition.FlagStates,
+            [&zone, worldCID](int32_t key, int32_t& value) {
+              return zone->GetFlagState(key, value, worldCID);
+            });
+      }
+
+      return negate != result;
+    }
+    case EventConditionOp_t::PARTNER:
+      return negate !=
+             (client && EvaluatePartnerCondition(client, condition.Source));
+    case EventConditionOp_t::QUEST:
+      return negate !=
+             (client && EvaluateQuestCondition(ctx, condition.Source));
+    case EventConditionOp_t::QUEST_FLAGS: {
+      if (!client) {
+        return negate;
+      }
+
+      auto character =
+          client->GetClientState()->GetCharacterState()->GetEntity();
+      auto quest =
+          character->GetQuests((int16_t)condition.Source->GetValue1()).Get();
+
+      int8_t phase = (int8_t)condition.Source->GetValue2();
+      if (!quest || (phase > -1 && quest->GetPhase() != phase)) {
+        return negate;
+      }
+
+      return negate != EventConditionProgram::EvaluateFlagStates(
+                           condition.CompareMode, condition.FlagStates,
+                           [&quest](int32_t key, int32_t& value) {
+                             if (!quest->FlagStatesKeyExists(key)) {
+                               return false;
+                             }
+
+                             value = quest->GetFlagStates(key);
+                             return true;
+                           });
+    }
+    case EventConditionOp_t::DATA: {
+      std::shared_ptr<ActiveEntityState> eState;
+      if (client) {
+        // Entity is the character, never the demon
+        eState = client->GetClientState()->GetCharacterState();
+      } else if (ctx.CurrentZone) {
+        // Entity is the "event/action source"
+        eState = ctx.CurrentZone->GetActiveEntity(
+            ctx.EventInstance->GetSourceEntityID());
+      }
+
+      return negate != EvaluateCondition(ctx, eState, condition.Source,
+                                         condition.CompareMode);
+    }
+    case EventConditionOp_t::INVALID:
+    default:
+      break;
+  }
+
+  // Always return false when invalid
+  return false;
+}
+
+void EventManager::LowerEventConditions(
+    const std::shared_ptr<objects::EventBase>& owner) {
+  if (!owner) {
+    return;
+  }
+
+  if (owner->ConditionsCount() > 0) {
+    LowerConditions(owner, owner->GetConditions());
+  }
+
+  auto sequence = std::dynamic_pointer_cast<objects::EventSequence>(owner);
+  if (sequence) {
+    for (auto& branch : sequence->GetBranches()) {
+      LowerEventConditions(branch);
+    }
+  }
+
+  auto prompt = std::dynamic_pointer_cast<objects::EventPrompt>(owner);
+  if (prompt) {
+    for (auto& choice : prompt->GetChoices()) {
+      LowerEventConditions(choice);
+    }
+  }
+}
+
+void EventManager::LowerConditions(
+    const std::shared_ptr<void>& owner,
+    const std::list<std::shared_ptr<objects::EventCondition>>& conditions) {
+  auto serverDataManager = mServer.lock()->GetServerDataManager();
+
+  auto program = std::make_shared<EventConditionProgram>(conditions);
+  for (auto& condition : program->GetConditions()) {
+    if (condition.Op == EventConditionOp_t::INVALID) {
+      LogEventManagerError([&]() {
+        return libcomp::String("Invalid event condition of type %1 lowered\n")
+            .Arg(condition.Source ? to_underlying(condition.Source->GetType())
+                                  : 0);
+      });
+    } else if (condition.Op == EventConditionOp_t::SCRIPT) {
+      auto scriptID = condition.Script->GetScriptID();
+      auto script = serverDataManager->GetScript(scriptID);
+      if (script && script->Type.ToLower() == "eventcondition") {
+        condition.ScriptDefinition = script;
+        if (!script->Instantiated) {
+          condition.PreparedScript = GetConditionScript(scriptID, script);
+        }
+      }
+    }
+  }
+
+  mConditionPrograms[owner.get()] = program;
+  mConditionProgramOwners.push_back(owner);
+}
+
 bool EventManager::EvaluateCondition(
     EventContext& ctx, const std::shared_ptr<ActiveEntityState>& eState,
     const std::shared_ptr<objects::EventConditionData>& condition,
@@ -3567,8 +3893,7 @@ bool EventManager::HandleEvent(EventContext& ctx) {
   bool handled = false;
 
   // If the event is conditional, check it now and end if it fails
-  auto conditions = event->GetConditions();
-  if (conditions.size() > 0 && !EvaluateEventConditions(ctx, conditions)) {
+  if (event->ConditionsCount() > 0 && !EvaluateEventConditions(ctx, event)) {
     handled = true;
     if (!ctx.AutoOnly) {
       EndEvent(client);
@@ -3717,16 +4042,14 @@ void EventManager::HandleNext(EventContext& ctx) {
           nextEventID = iState->GetNext();
         }
 
-        auto engine = std::make_shared<libhack::ScriptEngine>();
-        engine->Using<CharacterState>();
-        engine->Using<DemonState>();
-        engine->Using<Zone>();
-        engine->Using<libcomp::Randomizer>();
+        auto prepared = GetConditionScript(branchScriptID, script);
+        if (prepared) {
+          std::lock_guard<std::mutex> lock(prepared->Lock);
 
-        if (engine->Eval(script->Source)) {
-          Sqrat::Function f(Sqrat::RootTable(engine->GetVM()), "check");
+          Sqrat::Function f(Sqrat::RootTable(prepared->Engine->GetVM()),
+                            "check");
 
-          Sqrat::Array sqParams(engine->GetVM());
+          Sqrat::Array sqParams(prepared->Engine->GetVM());
           for (libcomp::String p : iState->GetBranchScriptParams()) {
             sqParams.Append(p);
           }
@@ -3763,8 +4086,8 @@ void EventManager::HandleNext(EventContext& ctx) {
     } else {
       // Branch based on conditions
       for (auto branch : branches) {
-        auto conditions = branch->GetConditions();
-        if (conditions.size() > 0 && EvaluateEventConditions(ctx, conditions)) {
+        if (branch->ConditionsCount() > 0 &&
+            EvaluateEventConditions(ctx, branch)) {
           // Use the branch instead (first to pass is used)
           nextEventID = branch->GetNext();
           queueEventID = branch->GetQueueNext();
@@ -3924,9 +4247,8 @@ bool EventManager::Prompt(EventContext& ctx) {
       skip = !valid;
     }
 
-    auto conditions = choice->GetConditions();
-    if (!skip &&
-        (conditions.size() == 0 || EvaluateEventConditions(ctx, conditions))) {
+    if (!skip && (choice->ConditionsCount() == 0 ||
+                  EvaluateEventConditions(ctx, choice))) {
       choices.push_back(choice);
     } else {
       ctx.EventInstance->InsertDisabledChoices((uint8_t)i);
@@ -4131,10 +4453,9 @@ bool EventManager::ITime(EventContext& ctx) {
       // do not "bump" the others up
       auto choice = e->GetChoices(i);
       if (choice) {
-        auto conditions = choice->GetConditions();
         if (choice->GetMessageID() == 0 ||
-            (conditions.size() > 0 &&
-             !EvaluateEventConditions(ctx, conditions))) {
+            (choice->ConditionsCount() > 0 &&
+             !EvaluateEventConditions(ctx, choice))) {
           ctx.EventInstance->InsertDisabledChoices((uint8_t)i);
           choice = nullptr;
         }
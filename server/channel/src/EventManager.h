@@ -40,19 +40,25 @@
 
 // channel Includes
 #include "ChannelClientConnection.h"
+#include "EventConditionProgram.h"
+
+// Standard C++11 Includes
+#include <mutex>
 
 namespace libhack {
 class ScriptEngine;
-}
+struct ServerScript;
+}  // namespace libhack
 
 namespace objects {
+class DropSet;
+class EventBase;
 class EventConditionData;
 class EventFlagCondition;
 class EventInstance;
+class EventScriptCondition;
 }  // namespace objects
 
-typedef objects::EventCondition::CompareMode_t EventCompareMode;
-
 namespace channel {
 
 class ChannelServer;
@@ -78,6 +84,19 @@ struct EventOptions {
   std::list<libcomp::String> TransformScriptParams;
 };
 
+/**
+ * Event condition script that has already been evaluated on a script
+ * engine so its check function can be called again without rebuilding the
+ * engine. Calls are serialized since the script VM is not thread safe.
+ */
+struct PreparedConditionScript {
+  /// Script engine the condition script source was evaluated on
+  std::shared_ptr<libhack::ScriptEngine> Engine;
+
+  /// Lock held while the check function is being evaluated
+  std::mutex Lock;
+};
+
 /**
  * Manager class in charge of processing event sequences as well as quest
  * phase progression and condition evaluation. Events include things like
@@ -98,6 +117,16 @@ class EventManager {
    */
   ~EventManager();
 
+  /**
+   * Lower the conditions of every event, event branch, event choice and
+   * drop set so they are evaluated without inspecting each condition's
+   * type again. Must be called once after the server data is loaded and
+   * before any event is handled since the lowered conditions are read
+   * without a lock.
+   * @return true on success, false on failure
+   */
+  bool Initialize();
+
   /**
    * Handle a new event based upon the supplied ID, relative to an
    * optional entity
@@ -340,6 +369,18 @@ class EventManager {
       const std::list<std::shared_ptr<objects::EventCondition>>& conditions,
       const std::shared_ptr<ChannelClientConnection>& client = nullptr);
 
+  /**
+   * Evaluate the conditions of a drop set for a client
+   * @param zone Zone to evaluate the conditions in
+   * @param dropSet Drop set with the conditions to evaluate
+   * @param client Optional pointer to the client connection
+   * @return true if the event conditions evaluate to true, otherwise false
+   */
+  bool EvaluateEventConditions(
+      const std::shared_ptr<Zone>& zone,
+      const std::shared_ptr<objects::DropSet>& dropSet,
+      const std::shared_ptr<ChannelClientConnection>& client = nullptr);
+
  private:
   struct EventContext {
     std::shared_ptr<ChannelClientConnection> Client;
@@ -393,6 +434,75 @@ class EventManager {
       EventContext& ctx,
       const std::list<std::shared_ptr<objects::EventCondition>>& conditions);
 
+  /**
+   * Evaluate the conditions of an event, event branch or event choice
+   * using the conditions lowered by @ref Initialize. Conditions that were
+   * not lowered, such as those on transformed copies of an event, are
+   * evaluated directly.
+   * @param ctx Execution context of the event
+   * @param owner Event, branch or choice the conditions belong to
+   * @return true if the event conditions evaluate to true, otherwise false
+   */
+  bool EvaluateEventConditions(
+      EventContext& ctx, const std::shared_ptr<objects::EventBase>& owner);
+
+  /**
+   * Get the program lowered from the conditions of an object.
+   * @param owner Object the conditions belong to
+   * @return Pointer to the lowered program, null if the conditions of the
+   *  object were not lowered
+   */
+  const EventConditionProgram* GetConditionProgram(const void* owner) const;
+
+  /**
+   * Evaluate a lowered list of event conditions
+   * @param ctx Execution context of the event
+   * @param program Lowered event conditions to evaluate
+   * @return true if the event conditions evaluate to true, otherwise false
+   */
+  bool EvaluateConditionProgram(EventContext& ctx,
+                                const EventConditionProgram& program);
+
+  /**
+   * Evaluate a lowered event condition
+   * @param ctx Execution context of the event
+   * @param condition Lowered event condition to evaluate
+   * @return true if the event condition evaluates to true, otherwise false
+   */
+  bool EvaluateLoweredCondition(EventContext& ctx,
+                                const LoweredEventCondition& condition);
+
+  /**
+   * Evaluate the check function of an event condition script
+   * @param ctx Execution context of the event
+   * @param condition Script condition being evaluated
+   * @param prepared Prepared script to evaluate, can be null
+   * @param result Output parameter containing the check function result,
+   *  not set if the script failed to evaluate
+   * @return true if the check function was evaluated
+   */
+  bool EvaluateConditionScript(
+      EventContext& ctx,
+      const std::shared_ptr<objects::EventScriptCondition>& condition,
+      const std::shared_ptr<PreparedConditionScript>& prepared,
+      int32_t& result);
+
+  /**
+   * Lower the conditions of an event, event branch or event choice and
+   * every branch or choice under it.
+   * @param owner Event, branch or choice to lower the conditions of
+   */
+  void LowerEventConditions(const std::shared_ptr<objects::EventBase>& owner);
+
+  /**
+   * Lower a list of event conditions and resolve their condition scripts.
+   * @param owner Object the conditions belong to
+   * @param conditions Event conditions to lower
+   */
+  void LowerConditions(
+      const std::shared_ptr<void>& owner,
+      const std::list<std::shared_ptr<objects::EventCondition>>& conditions);
+
   /**
    * Evaluate a standard event condition
    * @param ctx Execution context of the event
@@ -643,8 +753,42 @@ class EventManager {
    */
   bool VerifyITime(EventContext& ctx, std::shared_ptr<objects::Event> e);
 
+  /**
+   * Get the script engine prepared with the supplied event condition or
+   * branch logic script. Engines are built once per script and reused
+   * unless the script is marked as instantiated, in which case a new engine
+   * is built for every call.
+   * @param scriptID ID of the script
+   * @param script Pointer to the script definition
+   * @return Pointer to the prepared script, null if the script failed to
+   *  evaluate
+   */
+  std::shared_ptr<PreparedConditionScript> GetConditionScript(
+      const libcomp::String& scriptID,
+      const std::shared_ptr<libhack::ServerScript>& script);
+
   /// Pointer to the channel server.
   std::weak_ptr<ChannelServer> mServer;
+
+  /// Map of event condition script IDs to their prepared script engines
+  std::unordered_map<std::string, std::shared_ptr<PreparedConditionScript>>
+      mConditionScripts;
+
+  /// Server lock for the prepared condition script map
+  std::mutex mConditionScriptLock;
+
+  /// Map of objects with event conditions to the program lowered from
+  /// them. Only written by @ref Initialize so it is read without a lock.
+  std::unordered_map<const void*, std::shared_ptr<EventConditionProgram>>
+      mConditionPrograms;
+
+  /// Objects the lowered programs belong to, kept so their addresses can
+  /// not be reused by a transformed copy of an event
+  std::list<std::shared_ptr<void>> mConditionProgramOwners;
+
+  /// Indicates if every lowered evaluation is checked against the direct
+  /// evaluation of the same conditions
+  bool mVerifyConditionPrograms;
 };
 
 }  // namespace channel
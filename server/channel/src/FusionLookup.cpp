@@ -0,0 +1,116 @@
+/**
+ * @file server/channel/src/FusionLookup.cpp
+ * @ingroup channel
+ *
+ * @author COMP Omega <compomega@tutanota.com>
+ *
+ * @brief Fusion result and rank lookup tables built from the fusion ranges.
+ *
+ * This file is part of the Channel Server (channel).
+ *
+ * Copyright (C) 2012-2020 COMP_hack Team <compomega@tutanota.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "FusionLookup.h"
+
+// Standard C++11 Includes
+#include <vector>
+
+// channel Includes
+#include "FusionTables.h"
+
+using namespace channel;
+
+FusionLookup::FusionLookup() {
+  mRaceIndexes.fill(-1);
+
+  for (size_t i = 0; i < 34; i++) {
+    mRaceIndexes[FUSION_RACE_MAP[0][i]] = (int8_t)i;
+  }
+}
+
+void FusionLookup::AddRace(
+    uint8_t raceID,
+    const std::list<std::pair<uint8_t, uint32_t>>& fusionRanges) {
+  if (fusionRanges.size() == 0) {
+    return;
+  }
+
+  // For every possible adjusted level sum, traverse the pre-sorted list
+  // and take the highest range accessible
+  auto& results = mResults[raceID];
+  for (int16_t level = -128; level < 128; level++) {
+    uint32_t resultID = fusionRanges.front().second;
+    for (auto pair : fusionRanges) {
+      resultID = pair.second;
+
+      if ((int16_t)pair.first >= level) {
+        break;
+      }
+    }
+
+    results[(size_t)(level + 128)] = resultID;
+  }
+
+  // Default to the current demon for up/down fusion at limit already. If
+  // the same demon is listed more than once the first entry is used.
+  std::vector<uint32_t> types;
+  for (auto pair : fusionRanges) {
+    types.push_back(pair.second);
+  }
+
+  auto& steps = mRankSteps[raceID];
+  for (size_t i = 0; i < types.size(); i++) {
+    uint32_t down = i > 0 ? types[i - 1] : types[i];
+    uint32_t up = (i + 1) < types.size() ? types[i + 1] : types[i];
+    steps.emplace(types[i], std::pair<uint32_t, uint32_t>(down, up));
+  }
+}
+
+size_t FusionLookup::GetRaceCount() const { return mResults.size(); }
+
+bool FusionLookup::GetResult(uint8_t raceID, int8_t adjustedLevelSum,
+                             uint32_t& resultID) const {
+  auto it = mResults.find(raceID);
+  if (it == mResults.end()) {
+    return false;
+  }
+
+  resultID = it->second[(size_t)(adjustedLevelSum + 128)];
+
+  return true;
+}
+
+uint32_t FusionLookup::RankUpDown(uint8_t raceID, uint32_t demonType,
+                                  bool up) const {
+  auto raceIt = mRankSteps.find(raceID);
+  if (raceIt != mRankSteps.end()) {
+    auto it = raceIt->second.find(demonType);
+    if (it != raceIt->second.end()) {
+      return up ? it->second.second : it->second.first;
+    }
+  }
+
+  return demonType;
+}
+
+size_t FusionLookup::GetRaceIndex(uint8_t raceID, bool& found) const {
+  int8_t raceIdx = mRaceIndexes[raceID];
+
+  found = raceIdx >= 0;
+
+  return found ? (size_t)raceIdx : 0;
+}
@@ -0,0 +1,116 @@
+/**
+ * @file server/channel/src/FusionLookup.h
+ * @ingroup channel
+ *
+ * @author COMP Omega <compomega@tutanota.com>
+ *
+ * @brief Fusion result and rank lookup tables built from the fusion ranges.
+ *
+ * This file is part of the Channel Server (channel).
+ *
+ * Copyright (C) 2012-2020 COMP_hack Team <compomega@tutanota.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SERVER_CHANNEL_SRC_FUSIONLOOKUP_H
+#define SERVER_CHANNEL_SRC_FUSIONLOOKUP_H
+
+// Standard C Includes
+#include <stddef.h>
+#include <stdint.h>
+
+// Standard C++11 Includes
+#include <array>
+#include <list>
+#include <unordered_map>
+#include <utility>
+
+namespace channel {
+
+/**
+ * Read-only tables answering the normal fusion result, rank up/down and
+ * race index lookups. Each race's fusion ranges are traversed once when
+ * the race is added instead of on every fusion.
+ */
+class FusionLookup {
+ public:
+  /**
+   * Create an empty lookup. Only the race indexes are filled in.
+   */
+  FusionLookup();
+
+  /**
+   * Build the tables of a race from its fusion ranges.
+   * @param raceID Race the ranges belong to
+   * @param fusionRanges Minimum level and demon type of each range in
+   *  the order DefinitionManager::GetFusionRanges returns them
+   */
+  void AddRace(uint8_t raceID,
+               const std::list<std::pair<uint8_t, uint32_t>>& fusionRanges);
+
+  /**
+   * Get the number of races with fusion ranges.
+   * @return Number of races added
+   */
+  size_t GetRaceCount() const;
+
+  /**
+   * Get the normal fusion result of a race by taking the highest range
+   * accessible at the adjusted level sum.
+   * @param raceID Race of the result
+   * @param adjustedLevelSum Adjusted level sum of the fusion
+   * @param resultID Output demon type of the result
+   * @return false if the race has no fusion ranges
+   */
+  bool GetResult(uint8_t raceID, int8_t adjustedLevelSum,
+                 uint32_t& resultID) const;
+
+  /**
+   * Get the type of the demon directly above or below the supplied type
+   * in the fusion ranges by one rank.
+   * @param raceID Race of the demon to adjust
+   * @param demonType Type of the demon to adjust
+   * @param up true if checking higher, false if checking lower
+   * @return Demon type directly above or below the supplied type or the
+   *  supplied type if it is already at the limit or not in the ranges
+   */
+  uint32_t RankUpDown(uint8_t raceID, uint32_t demonType, bool up) const;
+
+  /**
+   * Get the index of a race in the fusion tables.
+   * @param raceID Race ID to find
+   * @param found Output parameter set to true if the race is in the tables
+   * @return Index of the race in the fusion tables
+   */
+  size_t GetRaceIndex(uint8_t raceID, bool& found) const;
+
+ private:
+  /// Normal 2-way fusion result demon type by race ID then adjusted level
+  /// sum offset by 128 so negative sums can be indexed
+  std::unordered_map<uint8_t, std::array<uint32_t, 256>> mResults;
+
+  /// Pair of rank down and rank up demon types by race ID then demon type
+  std::unordered_map<
+      uint8_t, std::unordered_map<uint32_t, std::pair<uint32_t, uint32_t>>>
+      mRankSteps;
+
+  /// Index of each race ID in the fusion tables, -1 if the race is not in
+  /// the tables
+  std::array<int8_t, 256> mRaceIndexes;
+};
+
+}  // namespace channel
+
+#endif  // SERVER_CHANNEL_SRC_FUSIONLOOKUP_H
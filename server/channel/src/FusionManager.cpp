@@ -74,6 +74,23 @@ FusionManager::FusionManager(const std::weak_ptr<ChannelServer>& server)
 
 FusionManager::~FusionManager() {}
 
+bool FusionManager::Initialize() {
+  auto definitionManager = mServer.lock()->GetDefinitionManager();
+
+  mLookup = FusionLookup();
+  for (uint16_t race = 1; race < 256; race++) {
+    mLookup.AddRace((uint8_t)race,
+                    definitionManager->GetFusionRanges((uint8_t)race));
+  }
+
+  LogFusionManagerDebug([&]() {
+    return libcomp::String("Precomputed fusion results for %1 race(s).\n")
+        .Arg(mLookup.GetRaceCount());
+  });
+
+  return true;
+}
+
 bool FusionManager::HandleFusion(
     const std::shared_ptr<ChannelClientConnection>& client, int64_t demonID1,
     int64_t demonID2, uint32_t costItemType) {
@@ -1923,9 +1940,8 @@ std::shared_ptr<objects::MiDevilData> FusionManager::GetResultDemon(
   }
 
   // Normal race selection adjusted for level range
-  auto definitionManager = mServer.lock()->GetDefinitionManager();
-  auto fusionRanges = definitionManager->GetFusionRanges(race);
-  if (fusionRanges.size() == 0) {
+  uint32_t resultID = 0;
+  if (!mLookup.GetResult(race, adjustedLevelSum, resultID)) {
     LogFusionManagerError([&]() {
       return libcomp::String("No valid fusion range found for race ID: %1\n")
           .Arg(race);
@@ -1934,17 +1950,9 @@ std::shared_ptr<objects::MiDevilData> FusionManager::GetResultDemon(
     return nullptr;
   }
 
-  // Traverse the pre-sorted list and take the highest range accessible
-  uint32_t resultID = fusionRanges.front().second;
-  for (auto pair : fusionRanges) {
-    resultID = pair.second;
-
-    if (pair.first >= adjustedLevelSum) {
-      break;
-    }
-  }
-
-  return resultID ? definitionManager->GetDevilData(resultID) : nullptr;
+  return resultID
+             ? mServer.lock()->GetDefinitionManager()->GetDevilData(resultID)
+             : nullptr;
 }
 
 uint32_t FusionManager::GetElementalType(size_t elementalIndex) const {
@@ -1981,16 +1989,7 @@ uint32_t FusionManager::GetElementalFuseResult(uint32_t elementalType,
 }
 
 size_t FusionManager::GetRaceIndex(uint8_t raceID, bool& found) {
-  found = false;
-
-  for (size_t i = 0; i < 34; i++) {
-    if (FUSION_RACE_MAP[0][i] == raceID) {
-      found = true;
-      return i;
-    }
-  }
-
-  return false;
+  return mLookup.GetRaceIndex(raceID, found);
 }
 
 size_t FusionManager::GetElementalIndex(uint32_t elemType, bool& found) {
@@ -2040,25 +2039,5 @@ bool FusionManager::IsTriFusionValid(
 
 uint32_t FusionManager::RankUpDown(uint8_t raceID, uint32_t demonType,
                                    bool up) {
-  auto fusionRanges =
-      mServer.lock()->GetDefinitionManager()->GetFusionRanges(raceID);
-
-  // Default to the current demon for up/down fusion at limit already
-  for (auto it = fusionRanges.begin(); it != fusionRanges.end(); it++) {
-    if (it->second == demonType) {
-      if (up) {
-        it++;
-        if (it != fusionRanges.end()) {
-          return it->second;
-        }
-      } else if (it != fusionRanges.begin()) {
-        it--;
-        return it->second;
-      }
-
-      break;
-    }
-  }
-
-  return demonType;
+  return mLookup.RankUpDown(raceID, demonType, up);
 }
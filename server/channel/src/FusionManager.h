@@ -29,6 +29,7 @@
 
 // channel Includes
 #include "ChannelClientConnection.h"
+#include "FusionLookup.h"
 
 namespace objects {
 class Demon;
@@ -55,6 +56,14 @@ class FusionManager {
    */
   virtual ~FusionManager();
 
+  /**
+   * Initialize the manager by precomputing the fusion result and rank
+   * up/down tables from the loaded devil definitions. This must be called
+   * after the definitions are loaded and before any fusion is handled.
+   * @return false if any errors were encountered
+   */
+  bool Initialize();
+
   /**
    * Perform a normal 2-way fusion and respond to the client with the
    * results
@@ -271,6 +280,10 @@ class FusionManager {
 
   /// Pointer to the channel server.
   std::weak_ptr<ChannelServer> mServer;
+
+  /// Normal fusion result, rank up/down and race index tables. Built
+  /// once by Initialize and read-only afterwards.
+  FusionLookup mLookup;
 };
 
 }  // namespace channel
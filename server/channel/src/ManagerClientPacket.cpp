@@ -28,19 +28,155 @@
 
 // channel Includes
 #include <ChannelClientConnection.h>
+#include <ChannelServer.h>
 
 // libcomp Includes
 #include <Log.h>
+#include <MessagePacket.h>
 #include <PacketCodes.h>
 
+// Standard C++11 Includes
+#include <algorithm>
+#include <list>
+#include <vector>
+
 using namespace channel;
 
+/// Upper bound in microseconds of each packet handler latency bucket but
+/// the last
+static const std::array<uint64_t, PACKET_STATS_BUCKET_COUNT - 1>
+    PACKET_STATS_BUCKETS = {
+        {100, 500, 1000, 5000, 10000, 50000, 100000}};
+
+/// Number of command codes listed in each statistics summary
+static const size_t PACKET_STATS_SUMMARY_COUNT = 20;
+
 ManagerClientPacket::ManagerClientPacket(
     std::weak_ptr<libcomp::BaseServer> server)
-    : libcomp::ManagerPacket(server) {}
+    : libcomp::ManagerPacket(server),
+      mStatsEnabled(false),
+      mSlowThreshold(0) {}
 
 ManagerClientPacket::~ManagerClientPacket() {}
 
+bool ManagerClientPacket::ProcessMessage(
+    const libcomp::Message::Message* pMessage) {
+  if (!mStatsEnabled) {
+    return libcomp::ManagerPacket::ProcessMessage(pMessage);
+  }
+
+  auto pPacket = dynamic_cast<const libcomp::Message::Packet*>(pMessage);
+  if (!pPacket) {
+    return libcomp::ManagerPacket::ProcessMessage(pMessage);
+  }
+
+  libcomp::CommandCode_t commandCode = pPacket->GetCommandCode();
+  uint64_t size = (uint64_t)pPacket->GetPacket().Size();
+
+  ServerTime start = ChannelServer::GetRealServerTime();
+
+  bool result = libcomp::ManagerPacket::ProcessMessage(pMessage);
+
+  uint64_t elapsed = (uint64_t)(ChannelServer::GetRealServerTime() - start);
+
+  size_t bucket = (size_t)(std::lower_bound(PACKET_STATS_BUCKETS.begin(),
+                                            PACKET_STATS_BUCKETS.end(),
+                                            elapsed) -
+                           PACKET_STATS_BUCKETS.begin());
+
+  {
+    std::lock_guard<std::mutex> lock(mStatsLock);
+
+    auto& stats = mStats[commandCode];
+    stats.Count++;
+    stats.TotalTime += elapsed;
+    stats.BytesIn += size;
+    stats.Histogram[bucket]++;
+    if (elapsed > stats.MaxTime) {
+      stats.MaxTime = elapsed;
+    }
+  }
+
+  if (mSlowThreshold && elapsed >= mSlowThreshold) {
+    auto client = std::dynamic_pointer_cast<ChannelClientConnection>(
+        pPacket->GetConnection());
+    auto state = client ? client->GetClientState() : nullptr;
+
+    LogGeneralWarning([&]() {
+      return libcomp::String(
+                 "Slow handler for client packet %1 (%2 bytes) took %3 us "
+                 "for account: %4\n")
+          .Arg(commandCode)
+          .Arg(size)
+          .Arg(elapsed)
+          .Arg(state ? state->GetAccountUID().ToString() : "unknown");
+    });
+  }
+
+  return result;
+}
+
+void ManagerClientPacket::EnableStats(uint64_t slowThreshold) {
+  mSlowThreshold = slowThreshold;
+  mStatsEnabled = true;
+}
+
+bool ManagerClientPacket::StatsEnabled() const { return mStatsEnabled; }
+
+std::unordered_map<libcomp::CommandCode_t, PacketStats>
+ManagerClientPacket::GetStats(bool reset) {
+  std::lock_guard<std::mutex> lock(mStatsLock);
+
+  auto stats = mStats;
+  if (reset) {
+    mStats.clear();
+  }
+
+  return stats;
+}
+
+void ManagerClientPacket::LogStats() {
+  auto stats = GetStats(true);
+  if (stats.size() == 0) {
+    return;
+  }
+
+  // List the command codes that took the most time in total first
+  std::vector<std::pair<libcomp::CommandCode_t, PacketStats>> sorted(
+      stats.begin(), stats.end());
+  std::sort(sorted.begin(), sorted.end(),
+            [](const std::pair<libcomp::CommandCode_t, PacketStats>& a,
+               const std::pair<libcomp::CommandCode_t, PacketStats>& b) {
+              return a.second.TotalTime > b.second.TotalTime;
+            });
+
+  if (sorted.size() > PACKET_STATS_SUMMARY_COUNT) {
+    sorted.resize(PACKET_STATS_SUMMARY_COUNT);
+  }
+
+  for (auto& pair : sorted) {
+    auto& s = pair.second;
+
+    std::list<libcomp::String> histogram;
+    for (uint64_t count : s.Histogram) {
+      histogram.push_back(libcomp::String("%1").Arg(count));
+    }
+
+    LogGeneralInfo([&]() {
+      return libcomp::String(
+                 "PERF: Packet %1: %2 calls, %3 us total, %4 us avg, %5 us "
+                 "max, %6 bytes in, histogram [%7]\n")
+          .Arg(pair.first)
+          .Arg(s.Count)
+          .Arg(s.TotalTime)
+          .Arg(s.TotalTime / s.Count)
+          .Arg(s.MaxTime)
+          .Arg(s.BytesIn)
+          .Arg(libcomp::String::Join(histogram, " "));
+    });
+  }
+}
+
 bool ManagerClientPacket::ValidateConnectionState(
     const std::shared_ptr<libcomp::TcpConnection>& connection,
     libcomp::CommandCode_t commandCode) const {
@@ -30,8 +30,38 @@
 // libcomp Includes
 #include <ManagerPacket.h>
 
+// Standard C++11 Includes
+#include <array>
+#include <mutex>
+#include <unordered_map>
+
 namespace channel {
 
+/// Number of buckets in a packet handler latency histogram
+const size_t PACKET_STATS_BUCKET_COUNT = 8;
+
+/**
+ * Handler statistics collected for a single client packet command code.
+ */
+struct PacketStats {
+  /// Number of packets handled
+  uint64_t Count = 0;
+
+  /// Total time spent in the handler in microseconds
+  uint64_t TotalTime = 0;
+
+  /// Longest time spent handling a single packet in microseconds
+  uint64_t MaxTime = 0;
+
+  /// Total size of the packets handled in bytes
+  uint64_t BytesIn = 0;
+
+  /// Number of packets handled within each latency bucket. The upper
+  /// bound of each bucket is listed in PACKET_STATS_BUCKETS, the last
+  /// bucket holds every packet slower than that.
+  std::array<uint64_t, PACKET_STATS_BUCKET_COUNT> Histogram = {};
+};
+
 /**
  * Manager class responsible for handling client side packets.
  */
@@ -48,10 +78,54 @@ class ManagerClientPacket : public libcomp::ManagerPacket {
    */
   virtual ~ManagerClientPacket();
 
+  virtual bool ProcessMessage(const libcomp::Message::Message* pMessage);
+
+  /**
+   * Start collecting handler statistics for every client packet. Until
+   * this is called no statistics are collected.
+   * @param slowThreshold Time in microseconds a handler can take before
+   *  the packet is logged as slow, 0 to never log slow packets
+   */
+  void EnableStats(uint64_t slowThreshold);
+
+  /**
+   * Check if handler statistics are being collected.
+   * @return true if statistics are being collected
+   */
+  bool StatsEnabled() const;
+
+  /**
+   * Get the handler statistics collected since they were last reset.
+   * @param reset If true, the statistics will be cleared after they are
+   *  retrieved
+   * @return Map of handler statistics by command code
+   */
+  std::unordered_map<libcomp::CommandCode_t, PacketStats> GetStats(
+      bool reset = false);
+
+  /**
+   * Log a summary of the handler statistics collected since the last
+   * summary and reset them.
+   */
+  void LogStats();
+
  protected:
   virtual bool ValidateConnectionState(
       const std::shared_ptr<libcomp::TcpConnection>& connection,
       libcomp::CommandCode_t commandCode) const;
+
+ private:
+  /// Indicates if handler statistics are being collected
+  bool mStatsEnabled;
+
+  /// Time in microseconds a handler can take before it is logged as slow
+  uint64_t mSlowThreshold;
+
+  /// Handler statistics by command code
+  std::unordered_map<libcomp::CommandCode_t, PacketStats> mStats;
+
+  /// Lock for access to the handler statistics
+  std::mutex mStatsLock;
 };
 
 }  // namespace channel
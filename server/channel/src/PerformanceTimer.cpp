@@ -46,13 +46,13 @@ PerformanceTimer::PerformanceTimer(ChannelServer* pServer)
 
 void PerformanceTimer::Start() {
   if (mEnabled) {
-    mStart = mServer->GetServerTime();
+    mStart = mServer->GetRealServerTime();
   }
 }
 
 void PerformanceTimer::Stop(const libcomp::String& metric) {
   if (mEnabled) {
-    ServerTime diff = mServer->GetServerTime() - mStart;
+    ServerTime diff = mServer->GetRealServerTime() - mStart;
 
     LogGeneralDebug([&]() {
       return libcomp::String("PERF: %1 in %2 us\n").Arg(metric).Arg(diff);
@@ -0,0 +1,165 @@
+/**
+ * @file server/channel/src/SearchEntryIndex.cpp
+ * @ingroup channel
+ *
+ * @author COMP Omega <compomega@tutanota.com>
+ *
+ * @brief Search entries of one type indexed on the values searches filter on.
+ *
+ * This file is part of the Channel Server (channel).
+ *
+ * Copyright (C) 2012-2020 COMP_hack Team <compomega@tutanota.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "SearchEntryIndex.h"
+
+// libcomp Includes
+#include <Constants.h>
+
+using namespace channel;
+
+bool SearchEntryFilter::Matches(
+    const std::shared_ptr<objects::SearchEntry>& entry) const {
+  return (Goal == 0 || entry->GetData(SEARCH_IDX_GOAL) == Goal) &&
+         (Location == 0 ||
+          entry->GetData(SEARCH_IDX_LOCATION) == Location) &&
+         (ItemType == 0 ||
+          entry->GetData(SEARCH_IDX_ITEM_TYPE) == ItemType) &&
+         (MainCategory == 0 ||
+          entry->GetData(SEARCH_IDX_MAIN_CATEGORY) == MainCategory) &&
+         (SubCategory == 0 ||
+          entry->GetData(SEARCH_IDX_SUB_CATEGORY) == SubCategory) &&
+         (ParentEntryID == 0 || entry->GetParentEntryID() == ParentEntryID);
+}
+
+bool SearchEntryIndex::Set(const std::shared_ptr<objects::SearchEntry>& entry) {
+  // Drop the existing element from the indexes as the values it was
+  // indexed on may have changed
+  bool replaced = Remove(entry->GetEntryID());
+
+  mEntries[entry->GetEntryID()] = entry;
+  IndexEntry(entry, true);
+
+  return replaced;
+}
+
+bool SearchEntryIndex::Remove(int32_t entryID) {
+  auto it = mEntries.find(entryID);
+  if (it == mEntries.end()) {
+    return false;
+  }
+
+  IndexEntry(it->second, false);
+  mEntries.erase(it);
+
+  return true;
+}
+
+std::shared_ptr<objects::SearchEntry> SearchEntryIndex::Get(
+    int32_t entryID) const {
+  auto it = mEntries.find(entryID);
+  return it != mEntries.end() ? it->second : nullptr;
+}
+
+const SearchEntrySet& SearchEntryIndex::GetEntries() const {
+  return mEntries;
+}
+
+std::list<std::shared_ptr<objects::SearchEntry>> SearchEntryIndex::GetPage(
+    const SearchEntryFilter& filter, int32_t pageID, size_t maxPageSize,
+    std::shared_ptr<objects::SearchEntry>& prev,
+    std::shared_ptr<objects::SearchEntry>& next) const {
+  std::list<std::shared_ptr<objects::SearchEntry>> current;
+
+  prev = nullptr;
+  next = nullptr;
+
+  // Read from the narrowest index that applies to the filter, the rest of
+  // the filter is checked per entry
+  const SearchEntrySet* entries = &mEntries;
+  const std::unordered_map<int32_t, SearchEntrySet>* keyed = nullptr;
+  int32_t key = 0;
+  if (filter.ParentEntryID != 0) {
+    keyed = &mByParent;
+    key = filter.ParentEntryID;
+  } else if (filter.ItemType != 0) {
+    keyed = &mByItemType;
+    key = filter.ItemType;
+  } else if (filter.Goal != 0) {
+    keyed = &mByGoal;
+    key = filter.Goal;
+  }
+
+  if (keyed) {
+    auto kIter = keyed->find(key);
+    if (kIter == keyed->end()) {
+      return current;
+    }
+
+    entries = &kIter->second;
+  }
+
+  // If the page ID is not zero, the page starts with the first entry with
+  // a lower ID and the previous entry is the closest one at or above it
+  auto start = pageID != 0 ? entries->upper_bound(pageID) : entries->begin();
+  if (pageID != 0) {
+    auto rIter = SearchEntrySet::const_reverse_iterator(start);
+    for (; rIter != entries->rend(); rIter++) {
+      if (filter.Matches(rIter->second)) {
+        prev = rIter->second;
+        break;
+      }
+    }
+  }
+
+  for (auto eIter = start; eIter != entries->end(); eIter++) {
+    if (!filter.Matches(eIter->second)) {
+      continue;
+    }
+
+    if (current.size() >= maxPageSize) {
+      next = eIter->second;
+      break;
+    }
+
+    current.push_back(eIter->second);
+  }
+
+  return current;
+}
+
+void SearchEntryIndex::IndexEntry(
+    const std::shared_ptr<objects::SearchEntry>& entry, bool add) {
+  int32_t entryID = entry->GetEntryID();
+
+  std::list<std::pair<std::unordered_map<int32_t, SearchEntrySet>*, int32_t>>
+      keys = {{&mByGoal, entry->GetData(SEARCH_IDX_GOAL)},
+              {&mByItemType, entry->GetData(SEARCH_IDX_ITEM_TYPE)},
+              {&mByParent, entry->GetParentEntryID()}};
+  for (auto& pair : keys) {
+    if (add) {
+      (*pair.first)[pair.second][entryID] = entry;
+    } else {
+      auto it = pair.first->find(pair.second);
+      if (it != pair.first->end()) {
+        it->second.erase(entryID);
+        if (it->second.size() == 0) {
+          pair.first->erase(it);
+        }
+      }
+    }
+  }
+}
@@ -0,0 +1,157 @@
+/**
+ * @file server/channel/src/SearchEntryIndex.h
+ * @ingroup channel
+ *
+ * @author COMP Omega <compomega@tutanota.com>
+ *
+ * @brief Search entries of one type indexed on the values searches filter on.
+ *
+ * This file is part of the Channel Server (channel).
+ *
+ * Copyright (C) 2012-2020 COMP_hack Team <compomega@tutanota.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SERVER_CHANNEL_SRC_SEARCHENTRYINDEX_H
+#define SERVER_CHANNEL_SRC_SEARCHENTRYINDEX_H
+
+// Standard C++11 Includes
+#include <functional>
+#include <list>
+#include <map>
+#include <memory>
+#include <unordered_map>
+
+// object Includes
+#include <SearchEntry.h>
+
+namespace channel {
+
+/**
+ * Filter values used when searching for a page of search entries. Any
+ * value left at zero is not filtered on.
+ */
+struct SearchEntryFilter {
+  /// Required SEARCH_IDX_GOAL value
+  int32_t Goal = 0;
+
+  /// Required SEARCH_IDX_LOCATION value
+  int32_t Location = 0;
+
+  /// Required SEARCH_IDX_ITEM_TYPE value
+  int32_t ItemType = 0;
+
+  /// Required SEARCH_IDX_MAIN_CATEGORY value
+  int32_t MainCategory = 0;
+
+  /// Required SEARCH_IDX_SUB_CATEGORY value
+  int32_t SubCategory = 0;
+
+  /// Required parent entry ID
+  int32_t ParentEntryID = 0;
+
+  /**
+   * Check if a search entry passes every filter value that is set.
+   * @param entry Search entry to check
+   * @return true if the entry passes the filter
+   */
+  bool Matches(const std::shared_ptr<objects::SearchEntry>& entry) const;
+};
+
+/// Search entries sorted by entry ID, highest (most recent) first
+typedef std::map<int32_t, std::shared_ptr<objects::SearchEntry>,
+                 std::greater<int32_t>>
+    SearchEntrySet;
+
+/**
+ * Search entries of one type along with secondary indexes on the values
+ * searches filter on most. Each index is kept in the same order as the
+ * full set so a page can be read straight from the smallest index that
+ * applies to a search. The index is not thread safe, the owner must lock
+ * around every call.
+ */
+class SearchEntryIndex {
+ public:
+  /**
+   * Add a search entry or replace the entry with the same ID.
+   * @param entry Search entry to add
+   * @return true if an entry with the same ID was replaced
+   */
+  bool Set(const std::shared_ptr<objects::SearchEntry>& entry);
+
+  /**
+   * Remove the search entry with the specified ID.
+   * @param entryID ID of the entry to remove
+   * @return true if the entry existed
+   */
+  bool Remove(int32_t entryID);
+
+  /**
+   * Get a search entry by ID.
+   * @param entryID ID of the entry to retrieve
+   * @return Pointer to the entry, null if it does not exist
+   */
+  std::shared_ptr<objects::SearchEntry> Get(int32_t entryID) const;
+
+  /**
+   * Get every entry of the type, highest entry ID first.
+   * @return Set of every entry
+   */
+  const SearchEntrySet& GetEntries() const;
+
+  /**
+   * Get a single page of search entries that pass a filter, highest entry
+   * ID first. Entries are read from the secondary index matching the
+   * filter so the full set is never copied.
+   * @param filter Filter the entries must pass
+   * @param pageID Entry ID the page starts after, 0 for the first page
+   * @param maxPageSize Maximum number of entries to return
+   * @param prev Output parameter set to the filtered entry before the page
+   *  if one exists
+   * @param next Output parameter set to the filtered entry after the page
+   *  if one exists
+   * @return List of entries on the requested page
+   */
+  std::list<std::shared_ptr<objects::SearchEntry>> GetPage(
+      const SearchEntryFilter& filter, int32_t pageID, size_t maxPageSize,
+      std::shared_ptr<objects::SearchEntry>& prev,
+      std::shared_ptr<objects::SearchEntry>& next) const;
+
+ private:
+  /**
+   * Add or remove a search entry from the secondary indexes.
+   * @param entry Search entry to add or remove
+   * @param add true if the entry should be added, false if it should be
+   *  removed
+   */
+  void IndexEntry(const std::shared_ptr<objects::SearchEntry>& entry,
+                  bool add);
+
+  /// Every entry of the type
+  SearchEntrySet mEntries;
+
+  /// Entries by SEARCH_IDX_GOAL value
+  std::unordered_map<int32_t, SearchEntrySet> mByGoal;
+
+  /// Entries by SEARCH_IDX_ITEM_TYPE value
+  std::unordered_map<int32_t, SearchEntrySet> mByItemType;
+
+  /// Entries by parent entry ID
+  std::unordered_map<int32_t, SearchEntrySet> mByParent;
+};
+
+}  // namespace channel
+
+#endif  // SERVER_CHANNEL_SRC_SEARCHENTRYINDEX_H
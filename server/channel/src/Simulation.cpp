@@ -0,0 +1,52 @@
+/**
+ * @file server/channel/src/Simulation.cpp
+ * @ingroup channel
+ *
+ * @author COMP Omega <compomega@tutanota.com>
+ *
+ * @brief Virtual clock and seeded random numbers for deterministic ticks.
+ *
+ * This file is part of the Channel Server (channel).
+ *
+ * Copyright (C) 2012-2020 COMP_hack Team <compomega@tutanota.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "Simulation.h"
+
+using namespace channel;
+
+/// Time the virtual clock starts at. This is far enough from zero that
+/// times calculated in the past from the start do not wrap around.
+static const uint64_t SIMULATION_START_TIME = 1000000000000ULL;
+
+std::atomic<bool> Simulation::sEnabled(false);
+std::atomic<uint64_t> Simulation::sTime(SIMULATION_START_TIME);
+std::mt19937 Simulation::sEngine;
+std::mutex Simulation::sLock;
+
+void Simulation::Enable(uint32_t seed) {
+  {
+    std::lock_guard<std::mutex> lock(sLock);
+    sEngine.seed(seed);
+  }
+
+  sTime = SIMULATION_START_TIME;
+  sEnabled = true;
+}
+
+uint64_t Simulation::GetTime() { return sTime; }
+
+void Simulation::AdvanceTime(uint64_t delta) { sTime += delta; }
@@ -0,0 +1,179 @@
+/**
+ * @file server/channel/src/Simulation.h
+ * @ingroup channel
+ *
+ * @author COMP Omega <compomega@tutanota.com>
+ *
+ * @brief Virtual clock and seeded random numbers for deterministic ticks.
+ *
+ * This file is part of the Channel Server (channel).
+ *
+ * Copyright (C) 2012-2020 COMP_hack Team <compomega@tutanota.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SERVER_CHANNEL_SRC_SIMULATION_H
+#define SERVER_CHANNEL_SRC_SIMULATION_H
+
+// libcomp Includes
+#include <Randomizer.h>
+
+// Standard C++11 Includes
+#include <atomic>
+#include <cmath>
+#include <iterator>
+#include <mutex>
+#include <random>
+
+/**
+ * Get a random integer between A and B (inclusive) from the seeded
+ * simulation generator when simulation mode is enabled or from the normal
+ * random number generator otherwise.
+ */
+#define SIM_RNG(T, A, B)                                                       \
+  (channel::Simulation::IsEnabled()                                            \
+       ? channel::Simulation::GetRandomNumber<T>((T)(A), (T)(B))               \
+       : RNG(T, A, B))
+
+/**
+ * Get a random decimal between A and B rounded to P decimal places from the
+ * seeded simulation generator when simulation mode is enabled or from the
+ * normal random number generator otherwise.
+ */
+#define SIM_RNG_DEC(T, A, B, P)                                                \
+  (channel::Simulation::IsEnabled()                                            \
+       ? channel::Simulation::GetRandomDecimal<T>((T)(A), (T)(B), P)           \
+       : RNG_DEC(T, A, B, P))
+
+namespace channel {
+
+/**
+ * Deterministic simulation mode for the channel. When enabled the server
+ * time no longer follows a real clock but only moves forward when a tick is
+ * simulated and the random numbers used by tick processing come from a
+ * single generator seeded from the channel configuration. Running the same
+ * zone population with the same seed then produces the same ticks, which
+ * allows tick processing changes to be benchmarked without wall clock noise.
+ */
+class Simulation {
+ public:
+  /**
+   * Enable simulation mode and reset the virtual clock
+   * @param seed Seed for the simulation random number generator
+   */
+  static void Enable(uint32_t seed);
+
+  /**
+   * Check if simulation mode is enabled
+   * @return true if simulation mode is enabled
+   */
+  static bool IsEnabled() { return sEnabled; }
+
+  /**
+   * Get the current time of the virtual clock
+   * @return Current virtual time in microseconds
+   */
+  static uint64_t GetTime();
+
+  /**
+   * Move the virtual clock forward
+   * @param delta Number of microseconds to move the clock forward
+   */
+  static void AdvanceTime(uint64_t delta);
+
+  /**
+   * Get a random integer from the simulation generator
+   * @param minVal Lowest value that can be returned
+   * @param maxVal Highest value that can be returned
+   * @return Random integer between the two values (inclusive)
+   */
+  template <typename T>
+  static T GetRandomNumber(T minVal, T maxVal) {
+    if (maxVal < minVal) {
+      return minVal;
+    }
+
+    std::uniform_int_distribution<int64_t> dist((int64_t)minVal,
+                                                (int64_t)maxVal);
+
+    std::lock_guard<std::mutex> lock(sLock);
+    return (T)dist(sEngine);
+  }
+
+  /**
+   * Get a random decimal from the simulation generator
+   * @param minVal Lowest value that can be returned
+   * @param maxVal Highest value that can be returned
+   * @param precision Number of decimal places to round the value to
+   * @return Random decimal between the two values
+   */
+  template <typename T>
+  static T GetRandomDecimal(T minVal, T maxVal, int precision) {
+    if (maxVal <= minVal) {
+      return minVal;
+    }
+
+    std::uniform_real_distribution<double> dist((double)minVal,
+                                                (double)maxVal);
+
+    double val = 0.0;
+    {
+      std::lock_guard<std::mutex> lock(sLock);
+      val = dist(sEngine);
+    }
+
+    double scale = std::pow(10.0, precision);
+    return (T)(std::round(val * scale) / scale);
+  }
+
+  /**
+   * Get a random entry from the supplied container, using the simulation
+   * generator when simulation mode is enabled
+   * @param container Container to pick the entry from
+   * @return Random entry from the container
+   */
+  template <typename C>
+  static typename C::value_type GetEntry(const C& container) {
+    if (!sEnabled) {
+      return libcomp::Randomizer::GetEntry(container);
+    }
+
+    if (container.size() == 0) {
+      return typename C::value_type();
+    }
+
+    auto it = container.begin();
+    std::advance(it, GetRandomNumber<int64_t>(
+                         0, (int64_t)container.size() - 1));
+    return *it;
+  }
+
+ private:
+  /// Indicates if simulation mode is enabled
+  static std::atomic<bool> sEnabled;
+
+  /// Current time of the virtual clock in microseconds
+  static std::atomic<uint64_t> sTime;
+
+  /// Seeded random number generator
+  static std::mt19937 sEngine;
+
+  /// Lock for the random number generator
+  static std::mutex sLock;
+};
+
+}  // namespace channel
+
+#endif  // SERVER_CHANNEL_SRC_SIMULATION_H
@@ -141,6 +141,7 @@
 #include "EventManager.h"
 #include "ManagerConnection.h"
 #include "MatchManager.h"
+#include "Simulation.h"
 #include "TokuseiManager.h"
 #include "Zone.h"
 #include "ZoneInstance.h"
@@ -3568,7 +3569,7 @@ void SkillManager::ProcessSkillResultFinal(
           100;
 
       if (!kbRemove ||
-          !(kbRemove >= 10000 || RNG(int32_t, 1, 10000) <= kbRemove)) {
+          !(kbRemove >= 10000 || SIM_RNG(int32_t, 1, 10000) <= kbRemove)) {
         // Source does not remove knockback, so continue
         float kbRecoverBoost =
             (float)(tokuseiManager->GetAspectSum(
@@ -3593,7 +3594,7 @@ void SkillManager::ProcessSkillResultFinal(
 
           if (!target.EntityState->StatusRestrictKnockbackCount() &&
               (!kbNull ||
-               !(kbNull >= 10000 || RNG(int32_t, 1, 10000) <= kbNull))) {
+               !(kbNull >= 10000 || SIM_RNG(int32_t, 1, 10000) <= kbNull))) {
             // Knockback not restricted by target's status or nullified by the
             // target, apply knockback itself
             target.Flags1 |= FLAG1_KNOCKBACK;
@@ -3755,7 +3756,7 @@ void SkillManager::ProcessSkillResultFinal(
         target.CanHitstun =
             hitstunNull != 10000 && (target.Flags1 & FLAG1_GUARDED) == 0 &&
             !target.HitAbsorb &&
-            (hitstunNull < 0 || RNG(int32_t, 1, 10000) > hitstunNull);
+            (hitstunNull < 0 || SIM_RNG(int32_t, 1, 10000) > hitstunNull);
       }
     }
 
@@ -5496,7 +5497,7 @@ bool SkillManager::HandleSkillInterrupt(
 
           applyInterrupt =
               interruptNull < 10000 &&
-              (interruptNull < 0 || RNG(int32_t, 1, 10000) > interruptNull);
+              (interruptNull < 0 || SIM_RNG(int32_t, 1, 10000) > interruptNull);
         }
       } else if (target.CanHitstun && tDischarge->GetShotInterruptible() &&
                  !pSkill->IsProjectile) {
@@ -5568,7 +5569,7 @@ std::set<uint32_t> SkillManager::HandleStatusEffects(
     if (pSkill->FunctionID == SVR_CONST.SKILL_STATUS_RANDOM ||
         pSkill->FunctionID == SVR_CONST.SKILL_STATUS_RANDOM2) {
       // Randomly pick one
-      auto entry = libcomp::Randomizer::GetEntry(directStatuses);
+      auto entry = Simulation::GetEntry(directStatuses);
       directStatuses.clear();
       directStatuses.push_back(entry);
     } else if (pSkill->FunctionID == SVR_CONST.SKILL_STATUS_SCALE) {
@@ -5662,7 +5663,7 @@ std::set<uint32_t> SkillManager::HandleStatusEffects(
                     addStatus->GetMaxStack() == 0;
     bool isReplace = addStatus && addStatus->GetIsReplace();
 
-    auto statusDef = definitionManager->GetStatusData(effectID);
+    auto statusDef = definitionManager->GetStatusDataPtr(effectID);
     if (!statusDef) continue;
 
     uint8_t affinity = statusDef->GetCommon()->GetAffinity();
@@ -5703,7 +5704,7 @@ std::set<uint32_t> SkillManager::HandleStatusEffects(
               eState->GetNRAChance((uint8_t)nraIdx, nraType, targetCalc);
           if (chance >= 100 ||
               (chance > 0 &&
-               (nraStatusNull || RNG(int16_t, 1, 100) <= chance))) {
+               (nraStatusNull || SIM_RNG(int16_t, 1, 100) <= chance))) {
             nraSuccess = true;
             break;
           }
@@ -5804,7 +5805,7 @@ std::set<uint32_t> SkillManager::HandleStatusEffects(
     // Check if the status effect hits
     if (successRate >= 100.0 ||
         (successRate > 0.0 &&
-         RNG(int32_t, 1, 10000) <= (int32_t)(successRate * 100.0))) {
+         SIM_RNG(int32_t, 1, 10000) <= (int32_t)(successRate * 100.0))) {
       // If the status was added by the skill itself, use that for
       // application logic, otherwise default to 1 non-replace
       int8_t minStack = addStatus ? addStatus->GetMinStack() : 1;
@@ -6240,7 +6241,7 @@ void SkillManager::HandleKills(
             case objects::Party::DropRule_t::RANDOM_LOOT: {
               // Randomly pick a member
               auto it = sourcePartyMembers.begin();
-              size_t offset = (size_t)RNG(
+              size_t offset = (size_t)SIM_RNG(
                   uint16_t, 0, (uint16_t)(sourcePartyMembers.size() - 1));
               std::advance(it, offset);
 
@@ -6311,7 +6312,7 @@ void SkillManager::HandleKills(
         // Always add at least one item
         auto filtered = characterManager->DetermineDrops(dDrops, 0, false);
         if (filtered.size() == 0) {
-          filtered = {libcomp::Randomizer::GetEntry(dDrops)};
+          filtered = {Simulation::GetEntry(dDrops)};
         }
 
         if (filtered.size() > 0) {
@@ -6940,7 +6941,7 @@ void SkillManager::UpdatePvPStats(
     for (auto& sPair : target.AddedStatuses) {
       auto& change = sPair.second;
       if (change.Stack) {
-        auto effect = definitionManager->GetStatusData(change.Type);
+        auto effect = definitionManager->GetStatusDataPtr(change.Type);
         switch (effect->GetCommon()->GetCategory()->GetMainCategory()) {
           case STATUS_CATEGORY_BAD:
             if (bStatus.find(entityID) != bStatus.end()) {
@@ -7157,7 +7158,7 @@ bool SkillManager::ApplyNegotiationDamage(
     }
 
     success =
-        talkSuccess > 0.0 && RNG(uint16_t, 1, 100) <= (uint16_t)talkSuccess;
+        talkSuccess > 0.0 && SIM_RNG(uint16_t, 1, 100) <= (uint16_t)talkSuccess;
     int16_t aff =
         (int16_t)(talkPoints.first +
                   (success ? pSkill->TalkAffSuccess : pSkill->TalkAffFailure));
@@ -7246,7 +7247,7 @@ bool SkillManager::ApplyNegotiationDamage(
       }
     }
 
-    int32_t outcome = RNG(int32_t, minVal, maxVal);
+    int32_t outcome = SIM_RNG(int32_t, minVal, maxVal);
 
     if (!autoJoin) {
       // Shift the outcome to the proper position if some
@@ -7577,7 +7578,7 @@ void SkillManager::HandleSkillLearning(
 
   std::list<std::pair<uint32_t, int16_t>> updateMap;
   for (auto iSkill : learningSkills) {
-    auto iSkillData = definitionManager->GetSkillData(iSkill->GetSkill());
+    auto iSkillData = definitionManager->GetSkillDataPtr(iSkill->GetSkill());
     auto iMod2 =
         iSkillData
             ? (double)iSkillData->GetAcquisition()->GetInheritanceModifier()
@@ -8262,7 +8263,7 @@ bool SkillManager::CalculateDamage(
         int32_t pursuitPow = (int32_t)floor(tokuseiManager->GetAspectSum(
             source, TokuseiAspectType::PURSUIT_POWER, calcState));
         if (pursuitRate > 0 &&
-            (pursuitRate >= 100 || RNG(int32_t, 1, 100) <= pursuitRate)) {
+            (pursuitRate >= 100 || SIM_RNG(int32_t, 1, 100) <= pursuitRate)) {
           // Take the lowest value applied tokusei affinity override if one
           // exists
           auto affinityOverrides = tokuseiManager->GetAspectValueList(
@@ -8322,7 +8323,7 @@ bool SkillManager::CalculateDamage(
         double techPow = floor(tokuseiManager->GetAspectSum(
             source, TokuseiAspectType::TECH_ATTACK_POWER, calcState));
         if (techPow > 0.0 && techRate > 0 &&
-            (techRate >= 100 || RNG(int32_t, 1, 100) <= techRate)) {
+            (techRate >= 100 || SIM_RNG(int32_t, 1, 100) <= techRate)) {
           // Calculate relative damage
           target.TechnicalDamage =
               (int32_t)floor((double)target.Damage1 * techPow * 0.01);
@@ -8428,10 +8429,10 @@ uint8_t SkillManager::GetCritLevel(
 
   if (critRate > 0.f &&
       (critRate >= 100.f ||
-       RNG(int16_t, 1, 10000) <= (int16_t)(critRate * 100.f))) {
+       SIM_RNG(int16_t, 1, 10000) <= (int16_t)(critRate * 100.f))) {
     critLevel = 1;
 
-    if (lbChance > 0 && RNG(int16_t, 1, 100) <= lbChance) {
+    if (lbChance > 0 && SIM_RNG(int16_t, 1, 100) <= lbChance) {
       critLevel = 2;
     }
   }
@@ -8575,7 +8576,7 @@ int32_t SkillManager::CalculateDamage_Normal(
             0.01f;
         break;
       default:  // Normal hit, 80%-99% damage
-        scale = RNG_DEC(float, 0.8f, 0.99f, 2);
+        scale = SIM_RNG_DEC(float, 0.8f, 0.99f, 2);
         break;
     }
 
@@ -8969,7 +8970,7 @@ uint8_t SkillManager::GetNRAResult(SkillTargetResult& target,
       // If no shield exists, check natural chances
       int16_t chance = target.EntityState->GetNRAChance(
           (uint8_t)nraIdx, affinity, target.CalcState);
-      if (chance >= 100 || (chance > 0 && RNG(int16_t, 1, 100) <= chance)) {
+      if (chance >= 100 || (chance > 0 && SIM_RNG(int16_t, 1, 100) <= chance)) {
         resultAffinity = (uint8_t)((uint8_t)affinity - NRA_OFFSET);
         return (uint8_t)nraIdx;
       }
@@ -8988,7 +8989,7 @@ int8_t SkillManager::CalculateStatusEffectStack(int8_t minStack,
 
   return minStack == maxStack
              ? maxStack
-             : (int8_t)RNG(int16_t, (int16_t)minStack, (int16_t)maxStack);
+             : (int8_t)SIM_RNG(int16_t, (int16_t)minStack, (int16_t)maxStack);
 }
 
 std::unordered_map<uint8_t, std::list<std::shared_ptr<objects::ItemDrop>>>
@@ -9505,7 +9506,7 @@ bool SkillManager::Cameo(
 
   uint32_t effectID = 0;
   if (transformIter->second.size() > 1) {
-    effectID = libcomp::Randomizer::GetEntry(transformIter->second);
+    effectID = Simulation::GetEntry(transformIter->second);
   } else {
     effectID = transformIter->second.front();
   }
@@ -9915,7 +9916,7 @@ bool SkillManager::DirectStatus(
       int8_t stackSize = 1;
       if (!limited) {
         // Add 30% of max stack
-        auto statusData = definitionManager->GetStatusData(effectID);
+        auto statusData = definitionManager->GetStatusDataPtr(effectID);
         uint8_t maxStack = statusData->GetBasic()->GetMaxStack();
         stackSize = (int8_t)ceil((float)maxStack / 30.f);
       }
@@ -10383,7 +10384,7 @@ bool SkillManager::MinionSpawn(
     auto server = mServer.lock();
     auto zoneManager = server->GetZoneManager();
 
-    uint32_t sgID = libcomp::Randomizer::GetEntry(slg->GetGroupIDs());
+    uint32_t sgID = Simulation::GetEntry(slg->GetGroupIDs());
 
     auto spawnGroup = zoneDef->GetSpawnGroups(sgID);
     if (!spawnGroup) {
@@ -10402,7 +10403,7 @@ bool SkillManager::MinionSpawn(
                                 : 0;
     uint32_t spotID = sourceSpotID && slg->SpotIDsContains(sourceSpotID)
                           ? sourceSpotID
-                          : libcomp::Randomizer::GetEntry(slg->GetSpotIDs());
+                          : Simulation::GetEntry(slg->GetSpotIDs());
 
     // If no spot currently selected, default to the summoner's spot
     // regardless
@@ -10756,7 +10757,7 @@ bool SkillManager::RandomItem(
 
   // Get one drop from the set
   auto drops = characterManager->DetermineDrops(dropSet->GetDrops(), 0, true);
-  auto drop = libcomp::Randomizer::GetEntry(drops);
+  auto drop = Simulation::GetEntry(drops);
   if (!drop) {
     SendFailure(activated, client, (uint8_t)SkillErrorCodes_t::ITEM_USE);
     return false;
@@ -10764,7 +10765,7 @@ bool SkillManager::RandomItem(
 
   // Item valid
 
-  uint16_t count = RNG(uint16_t, drop->GetMinStack(), drop->GetMaxStack());
+  uint16_t count = SIM_RNG(uint16_t, drop->GetMinStack(), drop->GetMaxStack());
 
   // Should only be one
   for (auto& pair : activated->GetItemCosts()) {
@@ -10813,12 +10814,12 @@ bool SkillManager::Randomize(
   if (params[0] == 0 && params[1] == 1) {
     // Coin flip
     notify.WriteS8(1);
-    notify.WriteU32Little(RNG(uint32_t, 0, 1));
+    notify.WriteU32Little(SIM_RNG(uint32_t, 0, 1));
   } else {
     // Dice roll
     notify.WriteS8(0);
     notify.WriteU32Little(
-        RNG(uint32_t, (uint32_t)params[0], (uint32_t)params[1]));
+        SIM_RNG(uint32_t, (uint32_t)params[0], (uint32_t)params[1]));
   }
 
   mServer.lock()->GetZoneManager()->BroadcastPacket(client, notify);
@@ -11014,7 +11015,7 @@ bool SkillManager::Spawn(
   uint32_t sgID = (uint32_t)params[0];
   auto slg = globalDef ? globalDef->GetSpawnLocationGroups(sgID) : nullptr;
   if (slg) {
-    sgID = libcomp::Randomizer::GetEntry(slg->GetGroupIDs());
+    sgID = Simulation::GetEntry(slg->GetGroupIDs());
   }
 
   auto spawnGroup = globalDef ? globalDef->GetSpawnGroups(sgID) : nullptr;
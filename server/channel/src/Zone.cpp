@@ -48,6 +48,7 @@
 #include <ServerNPC.h>
 #include <ServerObject.h>
 #include <ServerZone.h>
+#include <ServerZoneTrigger.h>
 #include <Spawn.h>
 #include <SpawnGroup.h>
 #include <SpawnLocationGroup.h>
@@ -201,6 +202,19 @@ void Zone::SetDynamicMap(const std::shared_ptr<DynamicMap>& map) {
   mDynamicMap = map;
 }
 
+const std::list<std::shared_ptr<objects::ServerZoneTrigger>>&
+Zone::GetTriggers(uint8_t triggerType) const {
+  static const std::list<std::shared_ptr<objects::ServerZoneTrigger>> none;
+
+  auto it = mTriggers.find(triggerType);
+  return it != mTriggers.end() ? it->second : none;
+}
+
+void Zone::AddTrigger(
+    const std::shared_ptr<objects::ServerZoneTrigger>& trigger) {
+  mTriggers[(uint8_t)trigger->GetTrigger()].push_back(trigger);
+}
+
 bool Zone::AddConnection(
     const std::shared_ptr<ChannelClientConnection>& client) {
   auto state = client->GetClientState();
@@ -56,6 +56,7 @@ class PvPBase;
 class ServerNPC;
 class ServerObject;
 class ServerZone;
+class ServerZoneTrigger;
 class SpawnRestriction;
 class UBMatch;
 }  // namespace objects
@@ -155,6 +156,22 @@ class Zone : public objects::ZoneObject {
    */
   void SetDynamicMap(const std::shared_ptr<DynamicMap>& map);
 
+  /**
+   * Get the zone triggers of a specific type
+   * @param triggerType Type of trigger to retrieve
+   * @return List of zone triggers of the specified type in the order they
+   *  were defined
+   */
+  const std::list<std::shared_ptr<objects::ServerZoneTrigger>>& GetTriggers(
+      uint8_t triggerType) const;
+
+  /**
+   * Add a zone trigger to the triggers indexed by type. All triggers must
+   * be added before the zone is registered with the manager.
+   * @param trigger Pointer to the zone trigger to add
+   */
+  void AddTrigger(const std::shared_ptr<objects::ServerZoneTrigger>& trigger);
+
   /**
    * Check if the zone has respawnable entities associated to it
    * @return true if the zone has respawnable entities associated to it
@@ -972,6 +989,11 @@ class Zone : public objects::ZoneObject {
   /// Dynamic map information bound to the zone
   std::shared_ptr<DynamicMap> mDynamicMap;
 
+  /// Zone triggers by trigger type
+  std::unordered_map<uint8_t,
+                     std::list<std::shared_ptr<objects::ServerZoneTrigger>>>
+      mTriggers;
+
   /// Zone instance pointer for non-global zones
   std::shared_ptr<ZoneInstance> mZoneInstance;
 
@@ -36,6 +36,24 @@
 
 using namespace channel;
 
+/// Width and height of each cell in the dynamic map spot grid
+static const float SPOT_GRID_CELL_SIZE = 1000.f;
+
+/// Number of cells on either axis a spot can span before it is considered
+/// too large to be listed in the grid
+static const int32_t SPOT_GRID_MAX_SPAN = 32;
+
+/// Number of cells on either axis of a spot's sample grid
+static const uint16_t SPOT_SAMPLE_GRID_SIZE = 8;
+
+static int32_t GetSpotGridCell(float coord) {
+  return (int32_t)std::floor(coord / SPOT_GRID_CELL_SIZE);
+}
+
+static uint64_t GetSpotGridKey(int32_t cellX, int32_t cellY) {
+  return ((uint64_t)(uint32_t)cellX << 32) | (uint64_t)(uint32_t)cellY;
+}
+
 Point::Point() : x(0.f), y(0.f) {}
 
 Point::Point(float xCoord, float yCoord) : x(xCoord), y(yCoord) {}
@@ -142,6 +160,11 @@ bool ZoneShape::Collides(const Line& path, Point& point, Line& surface) const {
   }
 }
 
+bool ZoneShape::InBoundaries(const Point& p) const {
+  return p.x >= Boundaries[0].x && p.x <= Boundaries[1].x &&
+         p.y >= Boundaries[0].y && p.y <= Boundaries[1].y;
+}
+
 ZoneQmpShape::ZoneQmpShape() : ShapeID(0), InstanceID(0), Active(true) {}
 
 ZoneQmpShape::~ZoneQmpShape() {}
@@ -159,6 +182,67 @@ ZoneSpotShape::ZoneSpotShape() {}
 
 ZoneSpotShape::~ZoneSpotShape() {}
 
+const std::vector<uint16_t>& ZoneSpotShape::GetSampleCells(
+    const std::shared_ptr<ZoneGeometry>& geometry) {
+  std::string key = geometry ? geometry->QmpFilename.C() : "";
+
+  std::lock_guard<std::mutex> lock(mSampleLock);
+
+  auto it = mSampleCells.find(key);
+  if (it != mSampleCells.end()) {
+    return it->second;
+  }
+
+  auto& cells = mSampleCells[key];
+
+  Point center(SampleOrigin.x + (SampleAxisX.x + SampleAxisY.x) * 0.5f,
+               SampleOrigin.y + (SampleAxisX.y + SampleAxisY.y) * 0.5f);
+
+  uint16_t cellCount =
+      (uint16_t)(SPOT_SAMPLE_GRID_SIZE * SPOT_SAMPLE_GRID_SIZE);
+  for (uint16_t cell = 0; cell < cellCount; cell++) {
+    bool valid = true;
+    if (geometry) {
+      // Check the cell's center and corners from the spot center
+      Point collision;
+      for (auto& offset : {std::make_pair(0.5f, 0.5f),
+                           std::make_pair(0.f, 0.f), std::make_pair(1.f, 0.f),
+                           std::make_pair(1.f, 1.f),
+                           std::make_pair(0.f, 1.f)}) {
+        Point p = GetSamplePoint(cell, offset.first, offset.second);
+        if (center != p && geometry->Collides(Line(center, p), collision)) {
+          valid = false;
+          break;
+        }
+      }
+    }
+
+    if (valid) {
+      cells.push_back(cell);
+    }
+  }
+
+  if (cells.size() == 0) {
+    // The spot is not usable without collisions, fall back to all of it
+    for (uint16_t cell = 0; cell < cellCount; cell++) {
+      cells.push_back(cell);
+    }
+  }
+
+  return cells;
+}
+
+Point ZoneSpotShape::GetSamplePoint(uint16_t cell, float xOffset,
+                                    float yOffset) const {
+  float u = ((float)(cell % SPOT_SAMPLE_GRID_SIZE) + xOffset) /
+            (float)SPOT_SAMPLE_GRID_SIZE;
+  float v = ((float)(cell / SPOT_SAMPLE_GRID_SIZE) + yOffset) /
+            (float)SPOT_SAMPLE_GRID_SIZE;
+
+  return Point(SampleOrigin.x + SampleAxisX.x * u + SampleAxisY.x * v,
+               SampleOrigin.y + SampleAxisX.y * u + SampleAxisY.y * v);
+}
+
 bool ZoneGeometry::Collides(const Line& path, Point& point, Line& surface,
                             std::shared_ptr<ZoneShape>& shape,
                             const std::set<uint32_t> disabledBarriers) const {
@@ -197,3 +281,53 @@ bool ZoneGeometry::Collides(const Line& path, Point& point) const {
   std::shared_ptr<ZoneShape> shape;
   return Collides(path, point, surface, shape);
 }
+
+void DynamicMap::BuildSpotIndex() {
+  SpotGrid.clear();
+  LargeSpots.clear();
+
+  for (auto& pair : Spots) {
+    auto& spot = pair.second;
+
+    int32_t minX = GetSpotGridCell(spot->Boundaries[0].x);
+    int32_t minY = GetSpotGridCell(spot->Boundaries[0].y);
+    int32_t maxX = GetSpotGridCell(spot->Boundaries[1].x);
+    int32_t maxY = GetSpotGridCell(spot->Boundaries[1].y);
+
+    if ((maxX - minX) >= SPOT_GRID_MAX_SPAN ||
+        (maxY - minY) >= SPOT_GRID_MAX_SPAN) {
+      LargeSpots.push_back(spot);
+      continue;
+    }
+
+    for (int32_t cellX = minX; cellX <= maxX; cellX++) {
+      for (int32_t cellY = minY; cellY <= maxY; cellY++) {
+        SpotGrid[GetSpotGridKey(cellX, cellY)].push_back(spot);
+      }
+    }
+  }
+}
+
+std::list<std::shared_ptr<ZoneSpotShape>> DynamicMap::GetSpotCandidates(
+    const Point& p) const {
+  std::list<std::shared_ptr<ZoneSpotShape>> candidates;
+
+  auto it = SpotGrid.find(
+      GetSpotGridKey(GetSpotGridCell(p.x), GetSpotGridCell(p.y)));
+  if (it != SpotGrid.end()) {
+    for (auto& spot : it->second) {
+      candidates.push_back(spot);
+    }
+  }
+
+  for (auto& spot : LargeSpots) {
+    candidates.push_back(spot);
+  }
+
+  // Only keep the spots that contain the point within their boundaries
+  candidates.remove_if([p](const std::shared_ptr<ZoneSpotShape>& spot) {
+    return !spot->InBoundaries(p);
+  });
+
+  return candidates;
+}
@@ -34,8 +34,10 @@
 // Standard C++11 includes
 #include <array>
 #include <list>
+#include <mutex>
 #include <set>
 #include <unordered_map>
+#include <vector>
 
 namespace objects {
 class MiSpotData;
@@ -45,6 +47,8 @@ class QmpNavPoint;
 
 namespace channel {
 
+class ZoneGeometry;
+
 /**
  * Simple X, Y coordinate point.
  */
@@ -161,6 +165,14 @@ class ZoneShape {
    */
   virtual bool Collides(const Line& path, Point& point, Line& surface) const;
 
+  /**
+   * Determines if the supplied point is within the shape's boundary
+   * rectangle. Points outside of it cannot be in the shape itself.
+   * @param p Point to check
+   * @return true if the point is within the boundaries, false if it is not
+   */
+  bool InBoundaries(const Point& p) const;
+
   /// List of all lines that make up the shape.
   std::list<Line> Lines;
 
@@ -226,8 +238,50 @@ class ZoneSpotShape : public ZoneShape {
    */
   virtual ~ZoneSpotShape();
 
+  /**
+   * Get the cells of the spot's sample grid whose center and corners can
+   * be reached from the spot center without colliding with the supplied
+   * geometry. The cells are built the first time they are requested for
+   * each geometry and are shared afterwards. If no cell can be reached
+   * every cell is returned so the spot can still be used.
+   * @param geometry Geometry the spot is used with, can be null
+   * @return List of cell indexes that points can be sampled from
+   */
+  const std::vector<uint16_t>& GetSampleCells(
+      const std::shared_ptr<ZoneGeometry>& geometry);
+
+  /**
+   * Get the point at the supplied offset within one cell of the spot's
+   * sample grid. Every cell covers the same area of the spot so picking a
+   * cell and offset uniformly picks a point in the spot uniformly.
+   * @param cell Index of the cell in the sample grid
+   * @param xOffset Offset along the spot's X axis within the cell from 0
+   *  to 1
+   * @param yOffset Offset along the spot's Y axis within the cell from 0
+   *  to 1
+   * @return X, Y coordinates of the point
+   */
+  Point GetSamplePoint(uint16_t cell, float xOffset, float yOffset) const;
+
   /// Pointer to the binary data spot definition
   std::shared_ptr<objects::MiSpotData> Definition;
+
+  /// Corner of the spot the sample grid starts from
+  Point SampleOrigin;
+
+  /// Offset from the origin to the end of the spot's X axis
+  Point SampleAxisX;
+
+  /// Offset from the origin to the end of the spot's Y axis
+  Point SampleAxisY;
+
+ private:
+  /// Sample cells that can be reached from the spot center by the QMP
+  /// filename of the geometry they were built for
+  std::unordered_map<std::string, std::vector<uint16_t>> mSampleCells;
+
+  /// Lock for access to the sample cells
+  std::mutex mSampleLock;
 };
 
 /**
@@ -281,12 +335,37 @@ class ZoneGeometry {
  */
 class DynamicMap {
  public:
+  /**
+   * Build the spatial index of every spot's boundaries. This must be
+   * called once all spots have been added and before any spot lookups
+   * by point are made.
+   */
+  void BuildSpotIndex();
+
+  /**
+   * Get every spot whose boundaries contain the supplied point. The point
+   * still needs to be checked against the vertices of each spot returned.
+   * @param p Point to check
+   * @return List of spots that could contain the point
+   */
+  std::list<std::shared_ptr<ZoneSpotShape>> GetSpotCandidates(
+      const Point& p) const;
+
   /// Map of spots by spot ID
   std::unordered_map<uint32_t, std::shared_ptr<ZoneSpotShape>> Spots;
 
   /// Map of spot types to list of spots
   std::unordered_map<uint8_t, std::list<std::shared_ptr<ZoneSpotShape>>>
       SpotTypes;
+
+  /// Grid of spots by packed cell X and Y coordinates. Each spot is listed
+  /// in every cell its boundaries overlap.
+  std::unordered_map<uint64_t, std::list<std::shared_ptr<ZoneSpotShape>>>
+      SpotGrid;
+
+  /// Spots with boundaries too large to be listed in the grid. These are
+  /// always returned as candidates.
+  std::list<std::shared_ptr<ZoneSpotShape>> LargeSpots;
 };
 
 }  // namespace channel
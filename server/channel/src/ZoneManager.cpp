@@ -44,6 +44,7 @@
 #include <ActionStartEvent.h>
 #include <ActivatedAbility.h>
 #include <Ally.h>
+#include <BazaarItem.h>
 #include <ChannelLogin.h>
 #include <CharacterLogin.h>
 #include <CharacterProgress.h>
@@ -112,6 +113,7 @@
 #include "MatchManager.h"
 #include "PerformanceTimer.h"
 #include "PlasmaState.h"
+#include "Simulation.h"
 #include "SkillManager.h"
 #include "TokuseiManager.h"
 #include "Zone.h"
@@ -156,7 +158,8 @@ BaseScriptEngine& BaseScriptEngine::Using<ZoneManager>() {
 }  // namespace libcomp
 
 ZoneManager::ZoneManager(const std::weak_ptr<ChannelServer>& server)
-    : mTrackingRefresh(0),
+    : mBazaarIndex(std::make_shared<BazaarIndex>()),
+      mTrackingRefresh(0),
       mNextZoneID(1),
       mNextZoneInstanceID(1),
       mServer(server) {}
@@ -246,6 +249,11 @@ void ZoneManager::LoadGeometry() {
             }
 
             shape->Definition = spotPair.second;
+            shape->SampleOrigin = points[0];
+            shape->SampleAxisX =
+                Point(points[1].x - points[0].x, points[1].y - points[0].y);
+            shape->SampleAxisY =
+                Point(points[3].x - points[0].x, points[3].y - points[0].y);
             shape->Lines.push_back(Line(points[0], points[1]));
             shape->Lines.push_back(Line(points[1], points[2]));
             shape->Lines.push_back(Line(points[2], points[3]));
@@ -274,6 +282,8 @@ void ZoneManager::LoadGeometry() {
                 shape);
           }
 
+          dMap->BuildSpotIndex();
+
           mDynamicMaps[dynamicMapID] = dMap;
         }
       }
@@ -675,22 +685,15 @@ bool ZoneManager::EnterZone(
     auto dynamicMap = nextZone->GetDynamicMap();
 
     if (dynamicMap) {
-      auto spots = server->GetDefinitionManager()->GetSpotData(
-          zoneDef->GetDynamicMapID());
-      for (auto spotPair : spots) {
-        auto spot = spotPair.second;
-        auto spotIter = dynamicMap->Spots.find(spotPair.first);
+      for (auto& spot : GetSpotsAtPoint(dynamicMap, Point(xCoord, yCoord))) {
+        auto spotDef = spot->Definition;
 
         // Filter valid zone-in spots only
-        if ((spot->GetType() == objects::MiSpotData::Type_t::ZONE_IN_POINT ||
-             spot->GetType() ==
-                 objects::MiSpotData::Type_t::DIASPORA_ZONE_IN) &&
-            spotIter != dynamicMap->Spots.end()) {
-          if (PointInPolygon(Point(xCoord, yCoord),
-                             spotIter->second->Vertices)) {
-            state->SetZoneInSpotID(spotPair.first);
-            break;
-          }
+        if (spotDef->GetType() == objects::MiSpotData::Type_t::ZONE_IN_POINT ||
+            spotDef->GetType() ==
+                objects::MiSpotData::Type_t::DIASPORA_ZONE_IN) {
+          state->SetZoneInSpotID(spotDef->GetID());
+          break;
         }
       }
     }
@@ -1273,6 +1276,28 @@ uint8_t ZoneManager::CreateInstance(
   // will receive messages when the access is added)
   SendAccessMessage(access, false);
 
+  if (channelID == ownerChannelID) {
+    // Build the zone definitions of the instance after this request is done
+    // so neither the creation nor the first character entering each zone
+    // waits on the zone partials being applied
+    std::set<uint32_t> partialIDs;
+    if (variant) {
+      partialIDs = variant->GetZonePartialIDs();
+    }
+
+    server->QueueWork(
+        [](libhack::ServerDataManager* pServerDataManager,
+           const std::shared_ptr<objects::ServerZoneInstance>& instDef,
+           const std::set<uint32_t>& instPartialIDs) {
+          for (size_t i = 0; i < instDef->ZoneIDsCount(); i++) {
+            pServerDataManager->GetZoneData(instDef->GetZoneIDs(i),
+                                            instDef->GetDynamicMapIDs(i), true,
+                                            instPartialIDs);
+          }
+        },
+        serverDataManager, def, partialIDs);
+  }
+
   std::lock_guard<libcomp::Mutex> lock(mLock);
 
   std::set<std::shared_ptr<objects::InstanceAccess>> existing;
@@ -1497,22 +1522,21 @@ bool ZoneManager::GetMatchStartPosition(
       }
     }
 
-    spotID = libcomp::Randomizer::GetEntry(teamSpotIDs[(uint8_t)groupIdx]);
+    spotID = Simulation::GetEntry(teamSpotIDs[(uint8_t)groupIdx]);
   } else if (state->GetZone() == zone) {
     spotID = state->GetZoneInSpotID();
   }
 
   if (spotID) {
     auto definitionManager = mServer.lock()->GetDefinitionManager();
-    auto spots = definitionManager->GetSpotData(def->GetDynamicMapID());
-    auto spotIter = spots.find(spotID);
-    if (spotIter != spots.end()) {
+    auto spot = definitionManager->GetSpotData(def->GetDynamicMapID(), spotID);
+    if (spot) {
       auto zoneData = definitionManager->GetZoneData(def->GetID());
 
-      Point p = GetRandomSpotPoint(spotIter->second, zoneData);
+      Point p = GetRandomSpotPoint(spot, zoneData);
       x = p.x;
       y = p.y;
-      rot = spotIter->second->GetRotation();
+      rot = spot->GetRotation();
       return true;
     }
   }
@@ -2134,6 +2158,10 @@ void ZoneManager::SendLootBoxData(
   }
 }
 
+std::shared_ptr<BazaarIndex> ZoneManager::GetBazaarIndex() const {
+  return mBazaarIndex;
+}
+
 void ZoneManager::SendBazaarMarketData(
     const std::shared_ptr<Zone>& zone,
     const std::shared_ptr<BazaarState>& bState, uint32_t marketID) {
@@ -2851,15 +2879,15 @@ std::shared_ptr<ActiveEntityState> ZoneManager::CreateAlly(
 
   if (spotID) {
     auto definitionManager = mServer.lock()->GetDefinitionManager();
-    auto spots = definitionManager->GetSpotData(zone->GetDynamicMapID());
-    auto spotIter = spots.find(spotID);
-    if (spotIter != spots.end()) {
+    auto spot =
+        definitionManager->GetSpotData(zone->GetDynamicMapID(), spotID);
+    if (spot) {
       auto zoneData = definitionManager->GetZoneData(zone->GetDefinitionID());
 
-      Point p = GetRandomSpotPoint(spotIter->second, zoneData);
+      Point p = GetRandomSpotPoint(spot, zoneData);
       x = p.x;
       y = p.y;
-      rot = spotIter->second->GetRotation();
+      rot = spot->GetRotation();
     } else {
       LogZoneManagerError([zone, spotID]() {
         return libcomp::String(
@@ -2903,15 +2931,15 @@ std::shared_ptr<ActiveEntityState> ZoneManager::CreateEnemy(
 
   if (spotID) {
     auto definitionManager = mServer.lock()->GetDefinitionManager();
-    auto spots = definitionManager->GetSpotData(zone->GetDynamicMapID());
-    auto spotIter = spots.find(spotID);
-    if (spotIter != spots.end()) {
+    auto spot =
+        definitionManager->GetSpotData(zone->GetDynamicMapID(), spotID);
+    if (spot) {
       auto zoneData = definitionManager->GetZoneData(zone->GetDefinitionID());
 
-      Point p = GetRandomSpotPoint(spotIter->second, zoneData);
+      Point p = GetRandomSpotPoint(spot, zoneData);
       x = p.x;
       y = p.y;
-      rot = spotIter->second->GetRotation();
+      rot = spot->GetRotation();
     } else {
       LogZoneManagerError([zone, spotID]() {
         return libcomp::String(
@@ -3301,7 +3329,7 @@ bool ZoneManager::UpdateSpawnGroups(
 
     if (mode == objects::ActionSpawn::Mode_t::ONE_TIME_RANDOM &&
         groups.size() > 1) {
-      auto g = libcomp::Randomizer::GetEntry(groups);
+      auto g = Simulation::GetEntry(groups);
       groups.clear();
       groups.push_back(g);
     }
@@ -3384,7 +3412,7 @@ bool ZoneManager::UpdateSpawnGroups(
       }
 
       if (groupIDs.size() > 0) {
-        sgID = libcomp::Randomizer::GetEntry(groupIDs);
+        sgID = Simulation::GetEntry(groupIDs);
       }
     }
 
@@ -3483,7 +3511,7 @@ bool ZoneManager::UpdateSpawnGroups(
         float x = 0.f, y = 0.f, rot = 0.f;
         if (useSpotID && !location) {
           // Get a random point in the polygon
-          Point p = GetRandomSpotPoint(spot->Definition);
+          Point p = GetRandomSpotPoint(spot, zone);
           Point center(spot->Definition->GetCenterX(),
                        spot->Definition->GetCenterY());
 
@@ -3612,7 +3640,7 @@ bool ZoneManager::SelectSpotAndLocation(
 
   if (useSpotID) {
     if (!spotID) {
-      spotID = libcomp::Randomizer::GetEntry(spotIDs);
+      spotID = Simulation::GetEntry(spotIDs);
     }
 
     auto spotPair = dynamicMap->Spots.find(spotID);
@@ -3629,7 +3657,7 @@ bool ZoneManager::SelectSpotAndLocation(
       return false;
     }
   } else {
-    location = libcomp::Randomizer::GetEntry(locations);
+    location = Simulation::GetEntry(locations);
   }
 
   return true;
@@ -5683,30 +5711,7 @@ ZoneManager::GetZoneTriggers(const std::shared_ptr<Zone>& zone,
     return triggers;
   }
 
-  switch (trigger) {
-    case objects::ServerZoneTrigger::Trigger_t::ON_ZONE_IN:
-    case objects::ServerZoneTrigger::Trigger_t::ON_ZONE_OUT:
-    case objects::ServerZoneTrigger::Trigger_t::PRE_ZONE_IN:
-    case objects::ServerZoneTrigger::Trigger_t::ON_LOGIN:
-      triggers = zone->GetZoneChangeTriggers();
-      break;
-    case objects::ServerZoneTrigger::Trigger_t::ON_SPAWN:
-    case objects::ServerZoneTrigger::Trigger_t::ON_RESPAWN:
-      triggers = zone->GetSpawnTriggers();
-      break;
-    case objects::ServerZoneTrigger::Trigger_t::ON_DEATH:
-    case objects::ServerZoneTrigger::Trigger_t::ON_REVIVAL:
-      triggers = zone->GetDeathTriggers();
-      break;
-    default:
-      triggers = zone->GetMiscTriggers();
-      break;
-  }
-
-  triggers.remove_if(
-      [trigger](const std::shared_ptr<objects::ServerZoneTrigger>& t) {
-        return t->GetTrigger() != trigger;
-      });
+  triggers = zone->GetTriggers((uint8_t)trigger);
 
   // Add global triggers to the end of the list if they exist
   auto globalDef =
@@ -5796,13 +5801,12 @@ bool ZoneManager::GetSpotPosition(uint32_t dynamicMapID, uint32_t spotID,
     return false;
   }
 
-  auto spots =
-      mServer.lock()->GetDefinitionManager()->GetSpotData(dynamicMapID);
-  auto spotIter = spots.find(spotID);
-  if (spotIter != spots.end()) {
-    x = spotIter->second->GetCenterX();
-    y = spotIter->second->GetCenterY();
-    rot = spotIter->second->GetRotation();
+  auto spot = mServer.lock()->GetDefinitionManager()->GetSpotData(
+      dynamicMapID, spotID);
+  if (spot) {
+    x = spot->GetCenterX();
+    y = spot->GetCenterY();
+    rot = spot->GetRotation();
 
     return true;
   }
@@ -5811,8 +5815,8 @@ bool ZoneManager::GetSpotPosition(uint32_t dynamicMapID, uint32_t spotID,
 }
 
 Point ZoneManager::GetRandomPoint(float width, float height) const {
-  return Point(RNG_DEC(float, 0.f, (float)fabs(width), 2),
-               RNG_DEC(float, 0.f, (float)fabs(height), 2));
+  return Point(SIM_RNG_DEC(float, 0.f, (float)fabs(width), 2),
+               SIM_RNG_DEC(float, 0.f, (float)fabs(height), 2));
 }
 
 Point ZoneManager::GetRandomSpotPoint(
@@ -5857,8 +5861,18 @@ Point ZoneManager::GetRandomSpotPoint(
   return transformed;
 }
 
+Point ZoneManager::GetRandomSpotPoint(
+    const std::shared_ptr<ZoneSpotShape>& spot,
+    const std::shared_ptr<Zone>& zone) {
+  auto& cells = spot->GetSampleCells(zone ? zone->GetGeometry() : nullptr);
+
+  uint16_t cell = cells[(size_t)SIM_RNG(int32_t, 0, (int32_t)cells.size() - 1)];
+  return spot->GetSamplePoint(cell, SIM_RNG_DEC(float, 0.f, 1.f, 2),
+                              SIM_RNG_DEC(float, 0.f, 1.f, 2));
+}
+
 float ZoneManager::GetRandomRotation() {
-  return (float)RNG_DEC(double, -libhack::PI, libhack::PI, 2);
+  return (float)SIM_RNG_DEC(double, -libhack::PI, libhack::PI, 2);
 }
 
 Point ZoneManager::GetLinearPoint(float sourceX, float sourceY, float targetX,
@@ -6314,7 +6328,7 @@ Point ZoneManager::GetNearestPoint(const Line& line, const Point& point) {
 }
 
 bool ZoneManager::PointInPolygon(const Point& p,
-                                 const std::list<Point> vertices,
+                                 const std::list<Point>& vertices,
                                  float overlapRadius) {
   auto p1 = vertices.begin();
   auto p2 = vertices.begin();
@@ -6360,6 +6374,20 @@ bool ZoneManager::PointInPolygon(const Point& p,
   return (crosses % 2) == 1;
 }
 
+std::list<std::shared_ptr<ZoneSpotShape>> ZoneManager::GetSpotsAtPoint(
+    const std::shared_ptr<DynamicMap>& dynamicMap, const Point& p) {
+  std::list<std::shared_ptr<ZoneSpotShape>> spots;
+  if (dynamicMap) {
+    for (auto& spot : dynamicMap->GetSpotCandidates(p)) {
+      if (PointInPolygon(p, spot->Vertices)) {
+        spots.push_back(spot);
+      }
+    }
+  }
+
+  return spots;
+}
+
 std::list<std::shared_ptr<ActiveEntityState>> ZoneManager::GetEntitiesInFoV(
     const std::list<std::shared_ptr<ActiveEntityState>>& entities, float x,
     float y, float rot, float maxAngle, bool useHitbox) {
@@ -7025,12 +7053,17 @@ std::shared_ptr<Zone> ZoneManager::CreateZone(
              server->GetWorldDatabase(), zoneID)) {
       if (m->GetState() == objects::BazaarData::State_t::BAZAAR_ACTIVE &&
           (distributedZones || m->GetChannelID() == channelID)) {
+        // Load the items now so they can be added to the bazaar index
+        for (auto& itemRef : m->GetItems()) {
+          itemRef.Get(server->GetWorldDatabase());
+        }
+
         activeMarkets.push_back(m);
       }
     }
 
     for (auto bazaar : definition->GetBazaars()) {
-      auto state = std::make_shared<BazaarState>(bazaar);
+      auto state = std::make_shared<BazaarState>(bazaar, mBazaarIndex);
 
       float x = bazaar->GetX();
       float y = bazaar->GetY();
@@ -7117,31 +7150,30 @@ std::shared_ptr<Zone> ZoneManager::CreateZone(
     ExpireRentals(zone);
   }
 
-  // Gather setup triggers and sort all other types from the definition
+  // Gather setup triggers and index all other types from the definition
   std::list<std::shared_ptr<objects::ServerZoneTrigger>> setupTriggers;
   for (auto trigger : definition->GetTriggers()) {
     switch (trigger->GetTrigger()) {
       case objects::ServerZoneTrigger::Trigger_t::ON_SETUP:
         setupTriggers.push_back(trigger);
+        continue;
+      case objects::ServerZoneTrigger::Trigger_t::ON_FLAG_SET:
+        zone->AppendFlagSetTriggers(trigger);
+        zone->InsertFlagSetKeys(trigger->GetValue());
+        break;
+      case objects::ServerZoneTrigger::Trigger_t::ON_TIME:
+      case objects::ServerZoneTrigger::Trigger_t::ON_SYSTEMTIME:
+      case objects::ServerZoneTrigger::Trigger_t::ON_MOONPHASE:
+        zone->AppendTimeTriggers(trigger);
         break;
       case objects::ServerZoneTrigger::Trigger_t::ON_ZONE_IN:
       case objects::ServerZoneTrigger::Trigger_t::ON_ZONE_OUT:
       case objects::ServerZoneTrigger::Trigger_t::PRE_ZONE_IN:
       case objects::ServerZoneTrigger::Trigger_t::ON_LOGIN:
-        zone->AppendZoneChangeTriggers(trigger);
-        break;
       case objects::ServerZoneTrigger::Trigger_t::ON_SPAWN:
       case objects::ServerZoneTrigger::Trigger_t::ON_RESPAWN:
-        zone->AppendSpawnTriggers(trigger);
-        break;
       case objects::ServerZoneTrigger::Trigger_t::ON_DEATH:
       case objects::ServerZoneTrigger::Trigger_t::ON_REVIVAL:
-        zone->AppendDeathTriggers(trigger);
-        break;
-      case objects::ServerZoneTrigger::Trigger_t::ON_FLAG_SET:
-        zone->AppendFlagSetTriggers(trigger);
-        zone->InsertFlagSetKeys(trigger->GetValue());
-        break;
       case objects::ServerZoneTrigger::Trigger_t::ON_PHASE:
       case objects::ServerZoneTrigger::Trigger_t::ON_PVP_START:
       case objects::ServerZoneTrigger::Trigger_t::ON_PVP_BASE_CAPTURE:
@@ -7152,16 +7184,12 @@ std::shared_ptr<Zone> ZoneManager::CreateZone(
       case objects::ServerZoneTrigger::Trigger_t::ON_UB_TICK:
       case objects::ServerZoneTrigger::Trigger_t::ON_UB_GAUGE_OVER:
       case objects::ServerZoneTrigger::Trigger_t::ON_UB_GAUGE_UNDER:
-        zone->AppendMiscTriggers(trigger);
-        break;
-      case objects::ServerZoneTrigger::Trigger_t::ON_TIME:
-      case objects::ServerZoneTrigger::Trigger_t::ON_SYSTEMTIME:
-      case objects::ServerZoneTrigger::Trigger_t::ON_MOONPHASE:
-        zone->AppendTimeTriggers(trigger);
         break;
       default:
-        break;
+        continue;
     }
+
+    zone->AddTrigger(trigger);
   }
 
   // Zone successfully created, register with the manager
@@ -7223,7 +7251,7 @@ void ZoneManager::AddPvPBases(
     std::list<uint8_t> ranks;
     for (uint8_t rank : baseRanks) {
       if (rankSpots[rank].size() > 0) {
-        uint32_t spotID = libcomp::Randomizer::GetEntry(rankSpots[rank]);
+        uint32_t spotID = Simulation::GetEntry(rankSpots[rank]);
         rankSpots[rank].erase(spotID);
         validSpotIDs.erase(spotID);
 
@@ -7247,7 +7275,7 @@ void ZoneManager::AddPvPBases(
 
   // Bind the rest of the spots
   for (uint8_t rank : baseRanks) {
-    uint32_t spotID = libcomp::Randomizer::GetEntry(validSpotIDs);
+    uint32_t spotID = Simulation::GetEntry(validSpotIDs);
     if (spotID) {
       boundSpots.push_back(std::pair<uint8_t, uint32_t>(rank, spotID));
     }
@@ -7277,7 +7305,7 @@ void ZoneManager::AddPvPBases(
           break;
         default:
           // Random value between 1 and 3
-          pvpBase->SetSpeed((uint8_t)RNG(int32_t, 1, 3));
+          pvpBase->SetSpeed((uint8_t)SIM_RNG(int32_t, 1, 3));
           break;
       }
 
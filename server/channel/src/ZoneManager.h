@@ -459,6 +459,12 @@ class ZoneManager {
                        const std::shared_ptr<ActiveEntityState>& eState,
                        bool sendToAll, bool queue = false);
 
+  /**
+   * Get the channel wide index of items listed in open bazaar markets
+   * @return Pointer to the bazaar index
+   */
+  std::shared_ptr<BazaarIndex> GetBazaarIndex() const;
+
   /**
    * Send information about the current market matching the supplied ID in a
    * bazaar to clients in the same zone
@@ -994,6 +1000,17 @@ class ZoneManager {
       const std::shared_ptr<objects::MiSpotData>& spot,
       const std::shared_ptr<objects::MiZoneData>& zoneData = nullptr);
 
+  /**
+   * Get a random point within the supplied zone spot that can be reached
+   * from the spot center in the zone's geometry. Points are picked
+   * uniformly from the parts of the spot the center can reach.
+   * @param spot Pointer to the spot shape to get a random point within
+   * @param zone Pointer to the zone the spot belongs to, can be null
+   * @return X, Y coordinates of the random point
+   */
+  Point GetRandomSpotPoint(const std::shared_ptr<ZoneSpotShape>& spot,
+                           const std::shared_ptr<Zone>& zone);
+
   /**
    * Get a random rotation value (in radians)
    * @return Rotation value (in radians)
@@ -1113,9 +1130,19 @@ class ZoneManager {
    *  using this value as the radius and checking if it overlaps anywhere
    * @return true if the point is within the polygon, false if it is not
    */
-  static bool PointInPolygon(const Point& p, const std::list<Point> vertices,
+  static bool PointInPolygon(const Point& p, const std::list<Point>& vertices,
                              float overlapRadius = 0.f);
 
+  /**
+   * Get every spot in a dynamic map that contains the specified point
+   * using the dynamic map's spot index
+   * @param dynamicMap Pointer to the dynamic map to check
+   * @param p Point to check
+   * @return List of spots that contain the point
+   */
+  static std::list<std::shared_ptr<ZoneSpotShape>> GetSpotsAtPoint(
+      const std::shared_ptr<DynamicMap>& dynamicMap, const Point& p);
+
   /**
    * Filter the list of supplied entities to only those visible in the
    * specified field of view
@@ -1475,6 +1502,9 @@ class ZoneManager {
   /// any zone
   std::list<std::shared_ptr<objects::ServerZoneTrigger>> mGlobalTimeTriggers;
 
+  /// Channel wide index of items listed in open bazaar markets
+  std::shared_ptr<BazaarIndex> mBazaarIndex;
+
   /// Next server time that tracked zones will be refreshed during
   ServerTime mTrackingRefresh;
 
@@ -29,6 +29,7 @@
 #include "ChannelServer.h"
 
 // libcomp Includes
+#include <AsyncLogWriter.h>
 #include <Config.h>
 #include <Constants.h>
 #include <Exception.h>
@@ -83,6 +84,55 @@ int main(int argc, const char *argv[])
         "used.\n");
   }
 
+  // Write the log from its own thread so logging never waits on the
+  // file or console from the tick or worker threads
+  std::shared_ptr<libhack::AsyncLogWriter> logWriter;
+  if (!config->GetAsyncLogFile().IsEmpty()) {
+    logWriter = std::make_shared<libhack::AsyncLogWriter>(
+        config->GetAsyncLogFile(), (size_t)config->GetAsyncLogMaxSize(),
+        (size_t)config->GetAsyncLogMaxFiles(),
+        (size_t)config->GetAsyncLogQueueSize(),
+        config->GetAsyncLogBlock()
+            ? libhack::AsyncLogWriter::Policy_t::BLOCK
+            : libhack::AsyncLogWriter::Policy_t::DROP);
+    logWriter->SetStandardOutput(true);
+    if (logWriter->Open()) {
+      // Replace the log so the synchronous standard output hook is gone
+      // and the writer thread is the only sink
+      delete libhack::Log::GetSingletonPtr();
+      logWriter->AddHook(libhack::Log::GetSingletonPtr());
+
+      // The writer replaces the synchronous log file as well
+      if (!config->GetLogFile().IsEmpty()) {
+        LogGeneralInfo([&]() {
+          return libcomp::String(
+                     "Ignoring log file %1 in favor of the async log file.\n")
+              .Arg(config->GetLogFile());
+        });
+
+        config->SetLogFile("");
+      }
+    } else {
+      LogGeneralError([&]() {
+        return libcomp::String("Failed to open the async log file: %1\n")
+            .Arg(config->GetAsyncLogFile());
+      });
+
+      logWriter = nullptr;
+    }
+  }
+
+  // Stop the writer on every return so the queued messages are written
+  struct LogWriterStop {
+    std::shared_ptr<libhack::AsyncLogWriter>& Writer;
+
+    ~LogWriterStop() {
+      if (Writer) {
+        Writer->Stop();
+      }
+    }
+  } logWriterStop{logWriter};
+
   if (!libhack::PersistentObjectInitialize()) {
     LogGeneralCriticalMsg(
         "One or more persistent object definition failed to load.\n");
@@ -110,7 +160,7 @@ int main(int argc, const char *argv[])
 
   LogGeneralInfoMsg("Bye!\n");
 
-  // Stop the logger
+  // Stop the logger, the async writer is stopped when it goes out of scope
   delete libhack::Log::GetSingletonPtr();
 
   return returnCode;
@@ -45,6 +45,7 @@
 #include "ChannelServer.h"
 #include "CharacterManager.h"
 #include "ManagerConnection.h"
+#include "ZoneManager.h"
 
 using namespace channel;
 
@@ -170,6 +171,9 @@ bool Parsers::BazaarItemBuy::Parse(
           return true;
         }
 
+        server->GetZoneManager()->GetBazaarIndex()->RemoveItem(
+            bItem->GetUUID());
+
         reply.WriteS8(destSlot);
         reply.WriteS32Little(0);  // Success
         success = true;
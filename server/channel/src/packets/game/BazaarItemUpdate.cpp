@@ -39,6 +39,7 @@
 
 // channel Includes
 #include "ChannelServer.h"
+#include "ZoneManager.h"
 
 using namespace channel;
 
@@ -87,6 +88,8 @@ bool Parsers::BazaarItemUpdate::Parse(
       client->Kill();
       return true;
     }
+
+    server->GetZoneManager()->GetBazaarIndex()->UpdateItem(bItem);
   }
 
   libcomp::Packet reply;
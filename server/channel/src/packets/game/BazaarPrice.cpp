@@ -33,6 +33,10 @@
 #include <Packet.h>
 #include <PacketCodes.h>
 
+// Standard C++11 Includes
+#include <algorithm>
+#include <limits>
+
 // objects Includes
 #include <Item.h>
 #include <MiItemBasicData.h>
@@ -40,6 +44,7 @@
 
 // channel Includes
 #include "ChannelServer.h"
+#include "ZoneManager.h"
 
 using namespace channel;
 
@@ -77,8 +82,25 @@ bool Parsers::BazaarPrice::Parse(
     reply.WriteS32Little(refPrice);  // Reference
 
     // High/low suggestions default to +/-20% the reference price
-    reply.WriteS32Little((int32_t)((double)refPrice * 1.2));
-    reply.WriteS32Little((int32_t)((double)refPrice * 0.8));
+    int32_t highPrice = (int32_t)((double)refPrice * 1.2);
+    int32_t lowPrice = (int32_t)((double)refPrice * 0.8);
+
+    // If the item is currently listed in any open market, suggest the
+    // cheapest listing's price for the same quantity as the low price
+    BazaarListing lowest;
+    if (server->GetZoneManager()->GetBazaarIndex()->GetLowestPrice(
+            item->GetType(), lowest)) {
+      uint64_t stackPrice =
+          (uint64_t)lowest.UnitCost * (uint64_t)item->GetStackSize();
+      lowPrice = (int32_t)std::min<uint64_t>(
+          stackPrice, (uint64_t)std::numeric_limits<int32_t>::max());
+      if (lowPrice > highPrice) {
+        highPrice = lowPrice;
+      }
+    }
+
+    reply.WriteS32Little(highPrice);
+    reply.WriteS32Little(lowPrice);
   } else {
     reply.WriteS32Little(-1);  // Failure
   }
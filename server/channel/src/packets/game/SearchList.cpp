@@ -63,12 +63,10 @@ bool Parsers::SearchList::Parse(
   int32_t unused = p.ReadS32Little();  // Always zero?
   (void)unused;
 
-  auto entries =
-      syncManager->GetSearchEntries((objects::SearchEntry::Type_t)type);
-
   bool success = false;
 
-  // Verify the filters and apply to the list of entries
+  // Verify the filters to apply to the list of entries
+  SearchEntryFilter entryFilter;
   bool clanEventView = false;
   size_t maxPageSize = 8;
   switch ((objects::SearchEntry::Type_t)type) {
@@ -77,12 +75,7 @@ bool Parsers::SearchList::Parse(
       if (p.Left() == 1) {
         int8_t filter = p.ReadS8();
 
-        if (filter != 0) {
-          entries.remove_if(
-              [filter](const std::shared_ptr<objects::SearchEntry>& entry) {
-                return entry->GetData(SEARCH_IDX_GOAL) != filter;
-              });
-        }
+        entryFilter.Goal = filter;
 
         success = true;
       }
@@ -92,12 +85,7 @@ bool Parsers::SearchList::Parse(
         int8_t filter = p.ReadS8();
         int8_t viewMode = p.ReadS8();
 
-        if (filter != 0) {
-          entries.remove_if(
-              [filter](const std::shared_ptr<objects::SearchEntry>& entry) {
-                return entry->GetData(SEARCH_IDX_GOAL) != filter;
-              });
-        }
+        entryFilter.Goal = filter;
 
         clanEventView = viewMode == 0;
 
@@ -113,12 +101,7 @@ bool Parsers::SearchList::Parse(
         int8_t filter = p.ReadS8();
         int8_t viewMode = p.ReadS8();
 
-        if (filter != 0) {
-          entries.remove_if(
-              [filter](const std::shared_ptr<objects::SearchEntry>& entry) {
-                return entry->GetData(SEARCH_IDX_GOAL) != filter;
-              });
-        }
+        entryFilter.Goal = filter;
 
         clanEventView = viewMode == 0;
         if (clanEventView) {
@@ -128,13 +111,7 @@ bool Parsers::SearchList::Parse(
           auto state = client->GetClientState();
           auto current = state->GetEventState()->GetCurrent();
           int32_t eventZoneID = state->GetCurrentMenuShopID();
-          if (eventZoneID != 0) {
-            entries.remove_if(
-                [eventZoneID](
-                    const std::shared_ptr<objects::SearchEntry>& entry) {
-                  return entry->GetData(SEARCH_IDX_LOCATION) != eventZoneID;
-                });
-          }
+          entryFilter.Location = eventZoneID;
 
           maxPageSize = 4;
         }
@@ -149,17 +126,9 @@ bool Parsers::SearchList::Parse(
         int32_t itemType = p.ReadS32Little();
         int8_t mainCategory = p.ReadS8();
 
-        entries.remove_if(
-            [itemType, mainCategory,
-             subCategory](const std::shared_ptr<objects::SearchEntry>& entry) {
-              return (itemType != 0 &&
-                      entry->GetData(SEARCH_IDX_ITEM_TYPE) != itemType) ||
-                     (mainCategory != 0 &&
-                      entry->GetData(SEARCH_IDX_MAIN_CATEGORY) !=
-                          mainCategory) ||
-                     (subCategory != 0 &&
-                      entry->GetData(SEARCH_IDX_SUB_CATEGORY) != subCategory);
-            });
+        entryFilter.ItemType = itemType;
+        entryFilter.MainCategory = mainCategory;
+        entryFilter.SubCategory = subCategory;
 
         maxPageSize = 10;
 
@@ -170,12 +139,7 @@ bool Parsers::SearchList::Parse(
       if (p.Left() == 4) {
         int32_t filter = p.ReadS32Little();
 
-        if (filter != 0) {
-          entries.remove_if(
-              [filter](const std::shared_ptr<objects::SearchEntry>& entry) {
-                return entry->GetData(SEARCH_IDX_GOAL) != filter;
-              });
-        }
+        entryFilter.Goal = filter;
 
         success = true;
       }
@@ -189,12 +153,7 @@ bool Parsers::SearchList::Parse(
       if (p.Left() == 4) {
         int32_t parentID = p.ReadS32Little();
 
-        if (parentID != 0) {
-          entries.remove_if(
-              [parentID](const std::shared_ptr<objects::SearchEntry>& entry) {
-                return entry->GetParentEntryID() != parentID;
-              });
-        }
+        entryFilter.ParentEntryID = parentID;
 
         maxPageSize = 10;
 
@@ -216,22 +175,11 @@ bool Parsers::SearchList::Parse(
   if (success) {
     reply.WriteS32Little(0);  // Success
 
-    std::list<std::shared_ptr<objects::SearchEntry>> current;
     std::shared_ptr<objects::SearchEntry> prev;
     std::shared_ptr<objects::SearchEntry> next;
-    for (auto entry : entries) {
-      // If page ID is not zero, current starts after that value
-      if (current.size() >= maxPageSize) {
-        next = entry;
-        break;
-      } else if (current.size() > 0 || pageID == 0) {
-        current.push_back(entry);
-      } else if (entry->GetEntryID() >= pageID) {
-        prev = entry;
-      } else {
-        current.push_back(entry);
-      }
-    }
+    auto current = syncManager->GetSearchEntryPage(
+        (objects::SearchEntry::Type_t)type, entryFilter, pageID, maxPageSize,
+        prev, next);
 
     // Write previous (or first) entry ID
     if (!prev && current.size() > 0) {
@@ -0,0 +1,296 @@
+/**
+ * @file server/channel/tests/AIUpdateSchedule.cpp
+ * @ingroup channel
+ *
+ * @author COMP Omega <compomega@tutanota.com>
+ *
+ * @brief Test and benchmark the distance based AI update rates.
+ *
+ * This file is part of the Channel Server (channel).
+ *
+ * Copyright (C) 2012-2020 COMP_hack Team <compomega@tutanota.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <PopIgnore.h>
+#include <PushIgnore.h>
+#include <gtest/gtest.h>
+
+// libcomp Includes
+#include <Constants.h>
+
+// channel Includes
+#include "AIUpdateSchedule.h"
+
+// Standard C++11 Includes
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <list>
+#include <random>
+#include <utility>
+#include <vector>
+
+using namespace channel;
+
+/// Length of a server tick in microseconds
+static const uint64_t TICK_DELTA = 100000;
+
+/**
+ * Distance check as it was done per entity before the schedule was
+ * split out of AIManager::IsUpdateDue, starting after the engaged checks.
+ */
+static bool ReferenceIsUpdateDue(
+    const std::list<std::pair<float, float>>& anchors, float x, float y,
+    bool moving, uint64_t& nextUpdate, uint64_t now) {
+  float nearest = -1.f;
+  for (auto& p : anchors) {
+    float dist =
+        (p.first - x) * (p.first - x) + (p.second - y) * (p.second - y);
+    if (nearest < 0.f || dist < nearest) {
+      nearest = dist;
+    }
+  }
+
+  if (nearest >= 0.f &&
+      nearest <= AI_LOD_FULL_DISTANCE * AI_LOD_FULL_DISTANCE) {
+    nextUpdate = 0;
+    return true;
+  }
+
+  if ((nearest < 0.f ||
+       nearest > AI_LOD_SUSPEND_DISTANCE * AI_LOD_SUSPEND_DISTANCE) &&
+      !moving) {
+    return false;
+  }
+
+  if (nextUpdate > now) {
+    return false;
+  }
+
+  nextUpdate = now + (uint64_t)AI_LOD_REDUCED_INTERVAL;
+  return true;
+}
+
+TEST(AIUpdateSchedule, Rates) {
+  AIUpdateSchedule schedule;
+
+  // Nobody to be near
+  EXPECT_EQ(schedule.GetRate(0.f, 0.f, false), AIUpdateRate_t::SUSPENDED);
+  EXPECT_EQ(schedule.GetRate(0.f, 0.f, true), AIUpdateRate_t::REDUCED);
+
+  schedule.AddAnchor(0.f, 0.f);
+  schedule.AddAnchor(100000.f, 0.f);
+  EXPECT_EQ(schedule.AnchorCount(), (size_t)2);
+
+  EXPECT_EQ(schedule.GetRate(AI_LOD_FULL_DISTANCE, 0.f, false),
+            AIUpdateRate_t::FULL);
+  EXPECT_EQ(schedule.GetRate(100000.f - AI_LOD_FULL_DISTANCE, 0.f, false),
+            AIUpdateRate_t::FULL);
+  EXPECT_EQ(schedule.GetRate(AI_LOD_FULL_DISTANCE + 1.f, 0.f, false),
+            AIUpdateRate_t::REDUCED);
+  EXPECT_EQ(schedule.GetRate(0.f, AI_LOD_SUSPEND_DISTANCE, false),
+            AIUpdateRate_t::REDUCED);
+  EXPECT_EQ(schedule.GetRate(0.f, AI_LOD_SUSPEND_DISTANCE + 1.f, false),
+            AIUpdateRate_t::SUSPENDED);
+
+  // Anything moving keeps being updated so it does not freeze mid path
+  EXPECT_EQ(schedule.GetRate(0.f, AI_LOD_SUSPEND_DISTANCE + 1.f, true),
+            AIUpdateRate_t::REDUCED);
+}
+
+TEST(AIUpdateSchedule, IsDue) {
+  uint64_t next = 5000000;
+  EXPECT_TRUE(AIUpdateSchedule::IsDue(AIUpdateRate_t::FULL, next, 1000000));
+  EXPECT_EQ(next, 0);
+
+  EXPECT_FALSE(
+      AIUpdateSchedule::IsDue(AIUpdateRate_t::SUSPENDED, next, 1000000));
+  EXPECT_EQ(next, 0);
+
+  EXPECT_TRUE(AIUpdateSchedule::IsDue(AIUpdateRate_t::REDUCED, next, 1000000));
+  EXPECT_EQ(next, 1000000 + (uint64_t)AI_LOD_REDUCED_INTERVAL);
+
+  EXPECT_FALSE(AIUpdateSchedule::IsDue(AIUpdateRate_t::REDUCED, next,
+                                       1000000 + TICK_DELTA));
+  EXPECT_TRUE(AIUpdateSchedule::IsDue(
+      AIUpdateRate_t::REDUCED, next,
+      1000000 + (uint64_t)AI_LOD_REDUCED_INTERVAL));
+}
+
+TEST(AIUpdateSchedule, MatchesReference) {
+  std::mt19937 rng(1234);
+  std::uniform_real_distribution<float> coord(-30000.f, 30000.f);
+  std::uniform_int_distribution<int> anchorCount(0, 8);
+  std::bernoulli_distribution moving(0.2);
+
+  for (int i = 0; i < 20000; i++) {
+    AIUpdateSchedule schedule;
+    std::list<std::pair<float, float>> anchors;
+    for (int a = anchorCount(rng); a > 0; a--) {
+      float x = coord(rng);
+      float y = coord(rng);
+      schedule.AddAnchor(x, y);
+      anchors.push_back(std::make_pair(x, y));
+    }
+
+    float x = coord(rng);
+    float y = coord(rng);
+    bool isMoving = moving(rng);
+    uint64_t now = (uint64_t)(rng() % 100) * TICK_DELTA;
+    uint64_t next = (uint64_t)(rng() % 100) * TICK_DELTA;
+    uint64_t referenceNext = next;
+
+    bool due = AIUpdateSchedule::IsDue(schedule.GetRate(x, y, isMoving),
+                                       next, now);
+    bool referenceDue =
+        ReferenceIsUpdateDue(anchors, x, y, isMoving, referenceNext, now);
+
+    ASSERT_EQ(due, referenceDue);
+    ASSERT_EQ(next, referenceNext);
+  }
+}
+
+/**
+ * Entity walking around a large field, used for both the players the
+ * enemies are scheduled around and the enemies themselves.
+ */
+struct FieldEntity {
+  float X;
+  float Y;
+  float DestX;
+  float DestY;
+  uint64_t NextUpdate;
+};
+
+TEST(AIUpdateSchedule, LargeFieldBenchmark) {
+  const float fieldSize = 60000.f;
+  const int hubCount = 4;
+  const int playerCount = 100;
+  const int enemyCount = 3000;
+  const int ticks = 600;
+  const float playerSpeed = 300.f;  // Units per tick
+  const float enemySpeed = 100.f;   // Units per tick
+
+  std::mt19937 rng(42);
+  std::uniform_real_distribution<float> coord(0.f, fieldSize);
+  std::normal_distribution<float> spread(0.f, 3000.f);
+  std::bernoulli_distribution startWander(0.01);
+
+  // Players gather around a few hubs and walk between them
+  std::vector<std::pair<float, float>> hubs;
+  for (int i = 0; i < hubCount; i++) {
+    hubs.push_back(std::make_pair(coord(rng), coord(rng)));
+  }
+
+  std::vector<FieldEntity> players;
+  for (int i = 0; i < playerCount; i++) {
+    auto& hub = hubs[(size_t)i % hubs.size()];
+    auto& dest = hubs[(size_t)(i + 1) % hubs.size()];
+    players.push_back({hub.first + spread(rng), hub.second + spread(rng),
+                       dest.first + spread(rng), dest.second + spread(rng),
+                       0});
+  }
+
+  std::vector<FieldEntity> enemies;
+  for (int i = 0; i < enemyCount; i++) {
+    float x = coord(rng);
+    float y = coord(rng);
+    enemies.push_back({x, y, x, y, 0});
+  }
+
+  auto step = [](FieldEntity& e, float speed) {
+    float dx = e.DestX - e.X;
+    float dy = e.DestY - e.Y;
+    float dist = std::sqrt(dx * dx + dy * dy);
+    if (dist <= speed) {
+      e.X = e.DestX;
+      e.Y = e.DestY;
+      return false;
+    }
+
+    e.X += dx / dist * speed;
+    e.Y += dy / dist * speed;
+    return true;
+  };
+
+  uint64_t updates = 0;
+  uint64_t scheduleNanos = 0;
+  for (int tick = 0; tick < ticks; tick++) {
+    uint64_t now = (uint64_t)(tick + 1) * TICK_DELTA;
+
+    for (auto& p : players) {
+      if (!step(p, playerSpeed)) {
+        auto& hub = hubs[rng() % hubs.size()];
+        p.DestX = hub.first + spread(rng);
+        p.DestY = hub.second + spread(rng);
+      }
+    }
+
+    auto start = std::chrono::steady_clock::now();
+
+    AIUpdateSchedule schedule;
+    for (auto& p : players) {
+      schedule.AddAnchor(p.X, p.Y);
+    }
+
+    std::vector<bool> due((size_t)enemyCount);
+    for (size_t i = 0; i < enemies.size(); i++) {
+      auto& e = enemies[i];
+      bool isMoving = e.X != e.DestX || e.Y != e.DestY;
+      due[i] = AIUpdateSchedule::IsDue(schedule.GetRate(e.X, e.Y, isMoving),
+                                       e.NextUpdate, now);
+    }
+
+    scheduleNanos += (uint64_t)std::chrono::duration_cast<
+                         std::chrono::nanoseconds>(
+                         std::chrono::steady_clock::now() - start)
+                         .count();
+
+    // Only updated enemies pick somewhere new to wander to, moving ones
+    // keep walking either way
+    for (size_t i = 0; i < enemies.size(); i++) {
+      auto& e = enemies[i];
+      if (due[i]) {
+        updates++;
+        if (e.X == e.DestX && e.Y == e.DestY && startWander(rng)) {
+          e.DestX = e.X + spread(rng) * 0.3f;
+          e.DestY = e.Y + spread(rng) * 0.3f;
+        }
+      }
+
+      step(e, enemySpeed);
+    }
+  }
+
+  uint64_t everyTick = (uint64_t)enemyCount * (uint64_t)ticks;
+  EXPECT_LT(updates, everyTick);
+
+  std::cout << "Large field with " << playerCount << " players and "
+            << enemyCount << " enemies over " << ticks << " ticks: "
+            << scheduleNanos / (uint64_t)ticks << " ns per tick scheduling, "
+            << (double)updates * 100.0 / (double)everyTick
+            << "% of AI updates run compared to every tick" << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+  try {
+    ::testing::InitGoogleTest(&argc, argv);
+
+    return RUN_ALL_TESTS();
+  } catch (...) {
+    return EXIT_FAILURE;
+  }
+}
@@ -0,0 +1,343 @@
+/**
+ * @file server/channel/tests/DropRoller.cpp
+ * @ingroup channel
+ *
+ * @author COMP Omega <compomega@tutanota.com>
+ *
+ * @brief Test the item drop and drop set rolls against the old rolls.
+ *
+ * This file is part of the Channel Server (channel).
+ *
+ * Copyright (C) 2012-2020 COMP_hack Team <compomega@tutanota.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <PopIgnore.h>
+#include <PushIgnore.h>
+#include <gtest/gtest.h>
+
+// libcomp Includes
+#include <Randomizer.h>
+
+// object Includes
+#include <DropSet.h>
+#include <ItemDrop.h>
+
+// channel Includes
+#include "DropRoller.h"
+
+// Standard C++11 Includes
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <set>
+#include <unordered_map>
+
+using namespace channel;
+
+/// Number of times each set is rolled when comparing frequencies
+static const int ROLL_COUNT = 200000;
+
+/**
+ * Final drop rate as it was calculated before the luck terms were hoisted
+ * out of the loop. This is the per drop body of
+ * CharacterManager::DetermineDrops.
+ */
+static uint32_t ReferenceDropRate(float rate, int16_t luck,
+                                  float globalDropBonus, float scalingCap) {
+  double baseRate = (double)rate;
+  uint32_t dropRate = (uint32_t)(baseRate * 100.0);
+  if (luck > 0 && scalingCap != 0.f) {
+    double deltaDiff = (double)(100.0 - baseRate);
+    dropRate = (uint32_t)(
+        baseRate *
+        (100.f +
+         100.f * (float)(((double)luck / 30.0) * 10.0 * (double)luck) /
+             (1000.0 + 7.0 * (double)luck + (deltaDiff * deltaDiff))));
+
+    // Limit luck scaling based on cap
+    if (scalingCap > 0.f &&
+        (float)((double)dropRate / (baseRate * 100.0)) > (1.f + scalingCap)) {
+      dropRate = (uint32_t)(baseRate * 100.0 * (1.0 + (double)scalingCap));
+    }
+  }
+
+  return (uint32_t)((double)dropRate * (double)(1.f + globalDropBonus));
+}
+
+/**
+ * Item drop roll as it was done before. This is the body of
+ * CharacterManager::DetermineDrops.
+ */
+static std::list<std::shared_ptr<objects::ItemDrop>> ReferenceDetermineDrops(
+    const std::list<std::shared_ptr<objects::ItemDrop>>& drops, int16_t luck,
+    float globalDropBonus, float scalingCap, bool minLast) {
+  std::list<std::shared_ptr<objects::ItemDrop>> results;
+  if (drops.size() == 0) {
+    return results;
+  }
+
+  for (auto drop : drops) {
+    uint32_t dropRate =
+        ReferenceDropRate(drop->GetRate(), luck, globalDropBonus, scalingCap);
+
+    if (dropRate >= 10000 || RNG(uint16_t, 1, 10000) <= dropRate ||
+        (minLast && results.size() == 0 && drops.back() == drop)) {
+      results.push_back(drop);
+    }
+  }
+
+  return results;
+}
+
+/**
+ * Drop set selection as it was done before, without the condition checks.
+ * This is the body of CharacterManager::DetermineDropSets.
+ */
+static std::list<std::shared_ptr<objects::DropSet>> ReferenceDetermineDropSets(
+    const std::list<uint32_t>& dropSetIDs,
+    const std::unordered_map<uint32_t, std::shared_ptr<objects::DropSet>>&
+        allDefs,
+    bool filter) {
+  std::list<std::shared_ptr<objects::DropSet>> dropSets;
+
+  std::unordered_map<uint32_t, std::shared_ptr<objects::DropSet>> defs;
+  std::unordered_map<uint32_t, std::set<uint32_t>> mutexIDs;
+  for (uint32_t dropSetID : dropSetIDs) {
+    auto it = allDefs.find(dropSetID);
+    auto dropSet = it != allDefs.end() ? it->second : nullptr;
+    if (dropSet) {
+      defs[dropSetID] = dropSet;
+      if (dropSet->GetMutexID()) {
+        mutexIDs[dropSet->GetMutexID()].insert(dropSetID);
+      }
+    }
+  }
+
+  if (mutexIDs.size() > 0) {
+    for (auto& pair : mutexIDs) {
+      if (pair.second.size() > 1) {
+        // There can only be one at a time
+        uint32_t dropSetID = libcomp::Randomizer::GetEntry(pair.second);
+        pair.second.clear();
+        pair.second.insert(dropSetID);
+      }
+    }
+  }
+
+  for (uint32_t dropSetID : dropSetIDs) {
+    auto dropSet = defs[dropSetID];
+    if (dropSet) {
+      bool valid = true;
+      if (filter) {
+        if (dropSet->GetMutexID() &&
+            *mutexIDs[dropSet->GetMutexID()].begin() != dropSetID) {
+          valid = false;
+        }
+      }
+
+      if (valid) {
+        dropSets.push_back(dropSet);
+      }
+    }
+  }
+
+  return dropSets;
+}
+
+/**
+ * Check that two observed frequencies could come from the same rate.
+ * @param expected Number of times the reference picked the outcome
+ * @param actual Number of times the new code picked the outcome
+ * @param trials Number of trials of each
+ */
+static void ExpectSameFrequency(int expected, int actual, int trials,
+                                const std::string& what) {
+  double p = (double)(expected + actual) / (2.0 * (double)trials);
+  double sigma = std::sqrt(2.0 * p * (1.0 - p) / (double)trials);
+  double delta = std::fabs((double)(expected - actual) / (double)trials);
+
+  // Six standard deviations keeps the test from ever flaking while still
+  // catching a rate that is off by a fraction of a percent
+  EXPECT_LE(delta, 6.0 * sigma + 1e-9)
+      << what << ": " << expected << " vs " << actual << " of " << trials;
+}
+
+/**
+ * Build an item drop.
+ * @param itemType Item type of the drop
+ * @param rate Drop rate as a percentage
+ */
+static std::shared_ptr<objects::ItemDrop> MakeDrop(uint32_t itemType,
+                                                    float rate) {
+  auto drop = std::make_shared<objects::ItemDrop>();
+  drop->SetItemType(itemType);
+  drop->SetRate(rate);
+  return drop;
+}
+
+TEST(DropRoller, RatesMatchReference) {
+  const float rates[] = {0.f,  0.001f, 0.01f, 0.1f, 1.f,    5.f,   10.f,
+                         25.f, 50.f,   75.f,  99.f, 99.99f, 100.f, 150.f};
+  const int16_t lucks[] = {-5, 0, 1, 10, 50, 200, 600, 999};
+  const float bonuses[] = {-0.5f, 0.f, 0.25f, 1.f};
+  const float caps[] = {-1.f, 0.f, 0.1f, 0.5f, 2.f};
+
+  for (auto luck : lucks) {
+    for (auto bonus : bonuses) {
+      for (auto cap : caps) {
+        DropRoller roller(luck, bonus, cap);
+        for (auto rate : rates) {
+          ASSERT_EQ(ReferenceDropRate(rate, luck, bonus, cap),
+                    roller.GetDropRate(rate))
+              << "Rate " << rate << " luck " << luck << " bonus " << bonus
+              << " cap " << cap;
+        }
+      }
+    }
+  }
+}
+
+TEST(DropRoller, DropFrequenciesMatchReference) {
+  std::list<std::shared_ptr<objects::ItemDrop>> drops = {
+      MakeDrop(1, 0.f),  MakeDrop(2, 0.5f),  MakeDrop(3, 10.f),
+      MakeDrop(4, 50.f), MakeDrop(5, 100.f), MakeDrop(6, 2.f)};
+
+  // An empty set and a set that can only drop through minLast
+  std::list<std::shared_ptr<objects::ItemDrop>> empty;
+  std::list<std::shared_ptr<objects::ItemDrop>> never = {MakeDrop(7, 0.f),
+                                                          MakeDrop(8, 0.f)};
+
+  const int16_t lucks[] = {0, 50, 500};
+  for (auto luck : lucks) {
+    for (bool minLast : {false, true}) {
+      DropRoller roller(luck, 0.25f, 0.5f);
+
+      EXPECT_EQ(0u, roller.Roll(empty, minLast).size());
+
+      auto neverDrops = roller.Roll(never, minLast);
+      ASSERT_EQ(minLast ? 1u : 0u, neverDrops.size());
+      if (minLast) {
+        EXPECT_EQ(never.back(), neverDrops.front());
+      }
+
+      std::map<uint32_t, int> expected, actual;
+      int expectedEmpty = 0, actualEmpty = 0;
+      for (int i = 0; i < ROLL_COUNT; i++) {
+        auto reference =
+            ReferenceDetermineDrops(drops, luck, 0.25f, 0.5f, minLast);
+        expectedEmpty += reference.empty() ? 1 : 0;
+        for (auto& drop : reference) {
+          expected[drop->GetItemType()]++;
+        }
+
+        auto result = roller.Roll(drops, minLast);
+        actualEmpty += result.empty() ? 1 : 0;
+        for (auto& drop : result) {
+          actual[drop->GetItemType()]++;
+        }
+      }
+
+      std::string what = "luck " + std::to_string(luck) + " minLast " +
+                         std::to_string(minLast);
+      for (auto& drop : drops) {
+        uint32_t itemType = drop->GetItemType();
+        ExpectSameFrequency(expected[itemType], actual[itemType], ROLL_COUNT,
+                            what + " item " + std::to_string(itemType));
+      }
+
+      ExpectSameFrequency(expectedEmpty, actualEmpty, ROLL_COUNT,
+                          what + " no drops");
+
+      // Drops that can never drop are never picked by either
+      EXPECT_EQ(0, expected[1]);
+      EXPECT_EQ(0, actual[1]);
+    }
+  }
+}
+
+TEST(DropRoller, DropSetFrequenciesMatchReference) {
+  // Sets 1-3 and 4-5 are mutually exclusive, 6 always applies and 7 does
+  // not exist
+  std::unordered_map<uint32_t, std::shared_ptr<objects::DropSet>> allDefs;
+  const uint32_t mutexes[] = {10, 10, 10, 20, 20, 0};
+  for (uint32_t id = 1; id <= 6; id++) {
+    auto dropSet = std::make_shared<objects::DropSet>();
+    dropSet->SetID(id);
+    dropSet->SetMutexID(mutexes[id - 1]);
+    allDefs[id] = dropSet;
+  }
+
+  std::list<uint32_t> dropSetIDs = {6, 3, 7, 1, 4, 2, 5};
+
+  std::vector<std::shared_ptr<objects::DropSet>> defs;
+  for (uint32_t id : dropSetIDs) {
+    auto it = allDefs.find(id);
+    defs.push_back(it != allDefs.end() ? it->second : nullptr);
+  }
+
+  // Without filtering every set that exists is returned in order
+  auto unfiltered = DropRoller::SelectDropSets(dropSetIDs, defs, false);
+  auto expectedUnfiltered =
+      ReferenceDetermineDropSets(dropSetIDs, allDefs, false);
+  EXPECT_EQ(expectedUnfiltered, unfiltered);
+  EXPECT_EQ(6u, unfiltered.size());
+
+  std::map<uint32_t, int> expected, actual;
+  for (int i = 0; i < ROLL_COUNT; i++) {
+    for (auto& dropSet :
+         ReferenceDetermineDropSets(dropSetIDs, allDefs, true)) {
+      expected[dropSet->GetID()]++;
+    }
+
+    auto result = DropRoller::SelectDropSets(dropSetIDs, defs, true);
+    ASSERT_EQ(3u, result.size());
+
+    // The order of the IDs is kept
+    std::list<uint32_t> order;
+    for (auto& dropSet : result) {
+      actual[dropSet->GetID()]++;
+      order.push_back(dropSet->GetID());
+    }
+
+    std::list<uint32_t> expectedOrder;
+    for (uint32_t id : dropSetIDs) {
+      if (std::find(order.begin(), order.end(), id) != order.end()) {
+        expectedOrder.push_back(id);
+      }
+    }
+
+    ASSERT_EQ(expectedOrder, order);
+  }
+
+  for (uint32_t id = 1; id <= 6; id++) {
+    ExpectSameFrequency(expected[id], actual[id], ROLL_COUNT,
+                        "drop set " + std::to_string(id));
+  }
+
+  EXPECT_EQ(ROLL_COUNT, actual[6]);
+  EXPECT_EQ(ROLL_COUNT, actual[1] + actual[2] + actual[3]);
+  EXPECT_EQ(ROLL_COUNT, actual[4] + actual[5]);
+}
+
+int main(int argc, char* argv[]) {
+  try {
+    ::testing::InitGoogleTest(&argc, argv);
+
+    return RUN_ALL_TESTS();
+  } catch (...) {
+    return EXIT_FAILURE;
+  }
+}
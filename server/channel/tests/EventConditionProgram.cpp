@@ -0,0 +1,323 @@
+/**
+ * @file server/channel/tests/EventConditionProgram.cpp
+ * @ingroup channel
+ *
+ * @author COMP Omega <compomega@tutanota.com>
+ *
+ * @brief Test and benchmark the lowered event conditions.
+ *
+ * This file is part of the Channel Server (channel).
+ *
+ * Copyright (C) 2012-2020 COMP_hack Team <compomega@tutanota.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <PopIgnore.h>
+#include <PushIgnore.h>
+#include <gtest/gtest.h>
+
+// object Includes
+#include <EventFlagCondition.h>
+#include <EventScriptCondition.h>
+
+// channel Includes
+#include "EventConditionProgram.h"
+
+// Standard C++11 Includes
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <unordered_map>
+
+using namespace channel;
+
+/// Every compare mode a flag condition can use
+static const EventCompareMode COMPARE_MODES[] = {
+    EventCompareMode::DEFAULT_COMPARE, EventCompareMode::EQUAL,
+    EventCompareMode::EXISTS,          EventCompareMode::LT_OR_NAN,
+    EventCompareMode::LT,              EventCompareMode::GTE,
+    EventCompareMode::BETWEEN,
+};
+
+/**
+ * Flag state comparison as it was done before conditions were lowered:
+ * the set flags are copied into a map first and then compared. This is
+ * the body of EventManager::EvaluateFlagStates.
+ */
+static bool ReferenceEvaluateFlagStates(
+    const std::unordered_map<int32_t, int32_t>& current,
+    const std::shared_ptr<objects::EventFlagCondition>& condition) {
+  std::unordered_map<int32_t, int32_t> flagStates;
+  for (auto pair : condition->GetFlagStates()) {
+    auto it = current.find(pair.first);
+    if (it != current.end()) {
+      flagStates[pair.first] = it->second;
+    }
+  }
+
+  bool result = true;
+  switch (condition->GetCompareMode()) {
+    case EventCompareMode::EXISTS:
+      for (auto pair : condition->GetFlagStates()) {
+        if (flagStates.find(pair.first) == flagStates.end()) {
+          result = false;
+          break;
+        }
+      }
+      break;
+    case EventCompareMode::LT_OR_NAN:
+      for (auto pair : condition->GetFlagStates()) {
+        auto it = flagStates.find(pair.first);
+        if (it != flagStates.end() && it->second >= pair.second) {
+          result = false;
+          break;
+        }
+      }
+      break;
+    case EventCompareMode::LT:
+      for (auto pair : condition->GetFlagStates()) {
+        auto it = flagStates.find(pair.first);
+        if (it == flagStates.end() || it->second >= pair.second) {
+          result = false;
+          break;
+        }
+      }
+      break;
+    case EventCompareMode::GTE:
+      for (auto pair : condition->GetFlagStates()) {
+        auto it = flagStates.find(pair.first);
+        if (it == flagStates.end() || it->second < pair.second) {
+          result = false;
+          break;
+        }
+      }
+      break;
+    case EventCompareMode::DEFAULT_COMPARE:
+    case EventCompareMode::EQUAL:
+    default:
+      for (auto pair : condition->GetFlagStates()) {
+        auto it = flagStates.find(pair.first);
+        if (it == flagStates.end() || it->second != pair.second) {
+          result = false;
+          break;
+        }
+      }
+      break;
+  }
+
+  return result;
+}
+
+/**
+ * Build a random flag condition and a random set of current flags that
+ * overlaps with it.
+ */
+static std::shared_ptr<objects::EventFlagCondition> RandomFlagCondition(
+    std::mt19937& rng, std::unordered_map<int32_t, int32_t>& current) {
+  std::uniform_int_distribution<int32_t> key(0, 7);
+  std::uniform_int_distribution<int32_t> value(-2, 2);
+  std::uniform_int_distribution<size_t> count(0, 4);
+  std::uniform_int_distribution<size_t> mode(
+      0, sizeof(COMPARE_MODES) / sizeof(COMPARE_MODES[0]) - 1);
+
+  auto condition = std::make_shared<objects::EventFlagCondition>();
+  condition->SetType(objects::EventCondition::Type_t::ZONE_FLAGS);
+  condition->SetCompareMode(COMPARE_MODES[mode(rng)]);
+  for (size_t i = count(rng); i > 0; i--) {
+    condition->SetFlagStates(key(rng), value(rng));
+  }
+
+  current.clear();
+  for (size_t i = count(rng); i > 0; i--) {
+    current[key(rng)] = value(rng);
+  }
+
+  return condition;
+}
+
+TEST(EventConditionProgram, LowerOperations) {
+  std::list<std::shared_ptr<objects::EventCondition>> conditions;
+
+  auto script = std::make_shared<objects::EventScriptCondition>();
+  script->SetScriptID("test");
+  script->SetNegate(true);
+  conditions.push_back(script);
+
+  auto zoneFlags = std::make_shared<objects::EventFlagCondition>();
+  zoneFlags->SetType(objects::EventCondition::Type_t::ZONE_CHARACTER_FLAGS);
+  zoneFlags->SetCompareMode(EventCompareMode::GTE);
+  zoneFlags->SetFlagStates(5, 1);
+  zoneFlags->SetFlagStates(2, 3);
+  conditions.push_back(zoneFlags);
+
+  auto instFlags = std::make_shared<objects::EventFlagCondition>();
+  instFlags->SetType(
+      objects::EventCondition::Type_t::ZONE_INSTANCE_CHARACTER_FLAGS);
+  conditions.push_back(instFlags);
+
+  auto questFlags = std::make_shared<objects::EventFlagCondition>();
+  questFlags->SetType(objects::EventCondition::Type_t::QUEST_FLAGS);
+  conditions.push_back(questFlags);
+
+  auto partner = std::make_shared<objects::EventCondition>();
+  partner->SetType(objects::EventCondition::Type_t::PARTNER_LEVEL);
+  conditions.push_back(partner);
+
+  auto quest = std::make_shared<objects::EventCondition>();
+  quest->SetType(objects::EventCondition::Type_t::QUEST_PHASE);
+  conditions.push_back(quest);
+
+  auto level = std::make_shared<objects::EventCondition>();
+  level->SetType(objects::EventCondition::Type_t::LEVEL);
+  level->SetCompareMode(EventCompareMode::BETWEEN);
+  conditions.push_back(level);
+
+  // Zone flags without flag states can not be evaluated
+  auto badFlags = std::make_shared<objects::EventCondition>();
+  badFlags->SetType(objects::EventCondition::Type_t::ZONE_FLAGS);
+  conditions.push_back(badFlags);
+
+  EventConditionProgram program(conditions);
+  auto& lowered = program.GetConditions();
+  ASSERT_EQ(lowered.size(), conditions.size());
+
+  EXPECT_EQ(lowered[0].Op, EventConditionOp_t::SCRIPT);
+  EXPECT_EQ(lowered[0].Script, script);
+  EXPECT_TRUE(lowered[0].Negate);
+
+  EXPECT_EQ(lowered[1].Op, EventConditionOp_t::ZONE_FLAGS);
+  EXPECT_TRUE(lowered[1].CharacterFlags);
+  EXPECT_FALSE(lowered[1].InstanceFlags);
+  EXPECT_EQ(lowered[1].CompareMode, EventCompareMode::GTE);
+  ASSERT_EQ(lowered[1].FlagStates.size(), 2u);
+  EXPECT_EQ(lowered[1].FlagStates[0], std::make_pair(2, 3));
+  EXPECT_EQ(lowered[1].FlagStates[1], std::make_pair(5, 1));
+
+  EXPECT_EQ(lowered[2].Op, EventConditionOp_t::ZONE_FLAGS);
+  EXPECT_TRUE(lowered[2].CharacterFlags);
+  EXPECT_TRUE(lowered[2].InstanceFlags);
+
+  EXPECT_EQ(lowered[3].Op, EventConditionOp_t::QUEST_FLAGS);
+  EXPECT_EQ(lowered[4].Op, EventConditionOp_t::PARTNER);
+  EXPECT_EQ(lowered[5].Op, EventConditionOp_t::QUEST);
+
+  EXPECT_EQ(lowered[6].Op, EventConditionOp_t::DATA);
+  EXPECT_EQ(lowered[6].CompareMode, EventCompareMode::BETWEEN);
+
+  EXPECT_EQ(lowered[7].Op, EventConditionOp_t::INVALID);
+
+  EXPECT_TRUE(program.Matches(conditions));
+
+  conditions.pop_back();
+  EXPECT_FALSE(program.Matches(conditions));
+}
+
+TEST(EventConditionProgram, FlagStatesMatchReference) {
+  std::mt19937 rng(1234);
+  std::unordered_map<int32_t, int32_t> current;
+
+  for (int i = 0; i < 200000; i++) {
+    auto condition = RandomFlagCondition(rng, current);
+    auto lowered = EventConditionProgram::Lower(condition);
+
+    bool expected = ReferenceEvaluateFlagStates(current, condition);
+    bool result = EventConditionProgram::EvaluateFlagStates(
+        lowered.CompareMode, lowered.FlagStates,
+        [&current](int32_t key, int32_t& value) {
+          auto it = current.find(key);
+          if (it == current.end()) {
+            return false;
+          }
+
+          value = it->second;
+          return true;
+        });
+
+    ASSERT_EQ(result, expected)
+        << "Compare mode " << (int)condition->GetCompareMode();
+  }
+}
+
+TEST(EventConditionProgram, Benchmark) {
+  const int count = 1000;
+  const int passes = 200;
+
+  std::mt19937 rng(5678);
+  std::vector<std::shared_ptr<objects::EventFlagCondition>> conditions;
+  std::vector<LoweredEventCondition> lowered;
+  std::vector<std::unordered_map<int32_t, int32_t>> current(count);
+  for (int i = 0; i < count; i++) {
+    conditions.push_back(RandomFlagCondition(rng, current[(size_t)i]));
+    lowered.push_back(EventConditionProgram::Lower(conditions.back()));
+  }
+
+  size_t referencePassed = 0;
+  auto start = std::chrono::steady_clock::now();
+  for (int pass = 0; pass < passes; pass++) {
+    for (size_t i = 0; i < (size_t)count; i++) {
+      // The old path also cast each condition before comparing it
+      std::shared_ptr<objects::EventCondition> condition = conditions[i];
+      auto flagCon =
+          std::dynamic_pointer_cast<objects::EventFlagCondition>(condition);
+      referencePassed += ReferenceEvaluateFlagStates(current[i], flagCon);
+    }
+  }
+  auto referenceTime = std::chrono::steady_clock::now() - start;
+
+  size_t loweredPassed = 0;
+  start = std::chrono::steady_clock::now();
+  for (int pass = 0; pass < passes; pass++) {
+    for (size_t i = 0; i < (size_t)count; i++) {
+      auto& flags = current[i];
+      loweredPassed += EventConditionProgram::EvaluateFlagStates(
+          lowered[i].CompareMode, lowered[i].FlagStates,
+          [&flags](int32_t key, int32_t& value) {
+            auto it = flags.find(key);
+            if (it == flags.end()) {
+              return false;
+            }
+
+            value = it->second;
+            return true;
+          });
+    }
+  }
+  auto loweredTime = std::chrono::steady_clock::now() - start;
+
+  EXPECT_EQ(referencePassed, loweredPassed);
+
+  auto total = (int64_t)count * passes;
+  std::cout << "Flag conditions: "
+            << std::chrono::duration_cast<std::chrono::nanoseconds>(
+                   referenceTime)
+                       .count() /
+                   total
+            << " ns per check before lowering, "
+            << std::chrono::duration_cast<std::chrono::nanoseconds>(
+                   loweredTime)
+                       .count() /
+                   total
+            << " ns per check lowered" << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+  try {
+    ::testing::InitGoogleTest(&argc, argv);
+
+    return RUN_ALL_TESTS();
+  } catch (...) {
+    return EXIT_FAILURE;
+  }
+}
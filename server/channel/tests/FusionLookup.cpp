@@ -0,0 +1,262 @@
+/**
+ * @file server/channel/tests/FusionLookup.cpp
+ * @ingroup channel
+ *
+ * @author COMP Omega <compomega@tutanota.com>
+ *
+ * @brief Test and benchmark the precomputed fusion lookup tables.
+ *
+ * This file is part of the Channel Server (channel).
+ *
+ * Copyright (C) 2012-2020 COMP_hack Team <compomega@tutanota.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <PopIgnore.h>
+#include <PushIgnore.h>
+#include <gtest/gtest.h>
+
+// channel Includes
+#include "FusionLookup.h"
+#include "FusionTables.h"
+
+// Standard C++11 Includes
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+using namespace channel;
+
+typedef std::list<std::pair<uint8_t, uint32_t>> FusionRanges;
+
+/**
+ * Normal fusion result lookup as it was done before the tables were
+ * precomputed. This is the body of FusionManager::GetResultDemon.
+ */
+static uint32_t ReferenceResult(const FusionRanges& fusionRanges,
+                                int8_t adjustedLevelSum) {
+  // Traverse the pre-sorted list and take the highest range accessible
+  uint32_t resultID = fusionRanges.front().second;
+  for (auto pair : fusionRanges) {
+    resultID = pair.second;
+
+    if (pair.first >= adjustedLevelSum) {
+      break;
+    }
+  }
+
+  return resultID;
+}
+
+/**
+ * Rank up/down lookup as it was done before the tables were precomputed.
+ * This is the body of FusionManager::RankUpDown.
+ */
+static uint32_t ReferenceRankUpDown(const FusionRanges& fusionRanges,
+                                    uint32_t demonType, bool up) {
+  // Default to the current demon for up/down fusion at limit already
+  for (auto it = fusionRanges.begin(); it != fusionRanges.end(); it++) {
+    if (it->second == demonType) {
+      if (up) {
+        it++;
+        if (it != fusionRanges.end()) {
+          return it->second;
+        }
+      } else if (it != fusionRanges.begin()) {
+        it--;
+        return it->second;
+      }
+
+      break;
+    }
+  }
+
+  return demonType;
+}
+
+/**
+ * Race index lookup as it was done before the tables were precomputed.
+ * This is the body of FusionManager::GetRaceIndex.
+ */
+static size_t ReferenceRaceIndex(uint8_t raceID, bool& found) {
+  found = false;
+
+  for (size_t i = 0; i < 34; i++) {
+    if (FUSION_RACE_MAP[0][i] == raceID) {
+      found = true;
+      return i;
+    }
+  }
+
+  return false;
+}
+
+/**
+ * Build random fusion ranges sorted by level like the definitions are.
+ * Levels and demon types are drawn from small pools so ranges share
+ * levels and the same demon can be listed more than once.
+ */
+static FusionRanges RandomFusionRanges(std::mt19937& rng) {
+  std::uniform_int_distribution<size_t> count(1, 24);
+  std::uniform_int_distribution<int> level(1, 99);
+  std::uniform_int_distribution<uint32_t> type(1, 40);
+
+  std::vector<std::pair<uint8_t, uint32_t>> ranges;
+  for (size_t i = count(rng); i > 0; i--) {
+    ranges.push_back(std::make_pair((uint8_t)level(rng), type(rng)));
+  }
+
+  std::stable_sort(ranges.begin(), ranges.end(),
+                   [](const std::pair<uint8_t, uint32_t>& a,
+                      const std::pair<uint8_t, uint32_t>& b) {
+                     return a.first < b.first;
+                   });
+
+  return FusionRanges(ranges.begin(), ranges.end());
+}
+
+TEST(FusionLookup, RaceIndexMatchesReference) {
+  FusionLookup lookup;
+
+  for (uint16_t race = 0; race < 256; race++) {
+    bool expectedFound = false, found = false;
+    size_t expected = ReferenceRaceIndex((uint8_t)race, expectedFound);
+    size_t result = lookup.GetRaceIndex((uint8_t)race, found);
+
+    EXPECT_EQ(expectedFound, found) << "Race " << race;
+    EXPECT_EQ(expected, result) << "Race " << race;
+  }
+}
+
+TEST(FusionLookup, ResultsAndRanksMatchReference) {
+  for (uint32_t seed = 0; seed < 50; seed++) {
+    std::mt19937 rng(seed);
+
+    // Every fusion race plus races that are not in the fusion tables
+    std::vector<uint8_t> races(FUSION_RACE_MAP[0], FUSION_RACE_MAP[0] + 34);
+    races.push_back(0);
+    races.push_back(200);
+
+    FusionLookup lookup;
+    std::unordered_map<uint8_t, FusionRanges> allRanges;
+    for (auto race : races) {
+      allRanges[race] = RandomFusionRanges(rng);
+      lookup.AddRace(race, allRanges[race]);
+    }
+
+    // Races without ranges have no result
+    lookup.AddRace(201, FusionRanges());
+
+    uint32_t resultID = 0;
+    EXPECT_FALSE(lookup.GetResult(201, 0, resultID));
+    EXPECT_FALSE(lookup.GetResult(202, 0, resultID));
+    EXPECT_EQ(7u, lookup.RankUpDown(202, 7, true));
+    EXPECT_EQ(races.size(), lookup.GetRaceCount());
+
+    for (auto race : races) {
+      auto& fusionRanges = allRanges[race];
+
+      for (int16_t level = -128; level < 128; level++) {
+        ASSERT_TRUE(lookup.GetResult(race, (int8_t)level, resultID));
+        ASSERT_EQ(ReferenceResult(fusionRanges, (int8_t)level), resultID)
+            << "Race " << (int)race << " level " << level;
+      }
+
+      // Every listed demon and one that is not listed, in both directions
+      std::vector<uint32_t> types = {0};
+      for (auto pair : fusionRanges) {
+        types.push_back(pair.second);
+      }
+
+      for (auto type : types) {
+        for (bool up : {false, true}) {
+          ASSERT_EQ(ReferenceRankUpDown(fusionRanges, type, up),
+                    lookup.RankUpDown(race, type, up))
+              << "Race " << (int)race << " type " << type << " up " << up;
+        }
+      }
+    }
+  }
+}
+
+TEST(FusionLookup, Benchmark) {
+  const int passes = 2000;
+
+  std::mt19937 rng(42);
+
+  FusionLookup lookup;
+  std::vector<std::pair<uint8_t, FusionRanges>> allRanges;
+  for (size_t i = 0; i < 34; i++) {
+    uint8_t race = FUSION_RACE_MAP[0][i];
+    allRanges.push_back(std::make_pair(race, RandomFusionRanges(rng)));
+    lookup.AddRace(race, allRanges.back().second);
+  }
+
+  // The old path copied the race's ranges out of the definitions on every
+  // call before scanning them
+  uint64_t referenceSum = 0;
+  auto start = std::chrono::steady_clock::now();
+  for (int pass = 0; pass < passes; pass++) {
+    for (auto& pair : allRanges) {
+      FusionRanges fusionRanges = pair.second;
+      int8_t level = (int8_t)(pass % 100);
+      referenceSum += ReferenceResult(fusionRanges, level);
+      referenceSum += ReferenceRankUpDown(fusionRanges, (uint32_t)pass % 40,
+                                          (pass & 1) != 0);
+    }
+  }
+  auto referenceTime = std::chrono::steady_clock::now() - start;
+
+  uint64_t lookupSum = 0;
+  start = std::chrono::steady_clock::now();
+  for (int pass = 0; pass < passes; pass++) {
+    for (auto& pair : allRanges) {
+      uint32_t resultID = 0;
+      lookup.GetResult(pair.first, (int8_t)(pass % 100), resultID);
+      lookupSum += resultID;
+      lookupSum += lookup.RankUpDown(pair.first, (uint32_t)pass % 40,
+                                     (pass & 1) != 0);
+    }
+  }
+  auto lookupTime = std::chrono::steady_clock::now() - start;
+
+  EXPECT_EQ(referenceSum, lookupSum);
+
+  auto total = (int64_t)passes * (int64_t)allRanges.size();
+  std::cout << "Fusion lookups: "
+            << std::chrono::duration_cast<std::chrono::nanoseconds>(
+                   referenceTime)
+                       .count() /
+                   total
+            << " ns per result and rank scanning the ranges, "
+            << std::chrono::duration_cast<std::chrono::nanoseconds>(
+                   lookupTime)
+                       .count() /
+                   total
+            << " ns precomputed" << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+  try {
+    ::testing::InitGoogleTest(&argc, argv);
+
+    return RUN_ALL_TESTS();
+  } catch (...) {
+    return EXIT_FAILURE;
+  }
+}
@@ -0,0 +1,397 @@
+/**
+ * @file server/channel/tests/SearchEntryIndex.cpp
+ * @ingroup channel
+ *
+ * @author COMP Omega <compomega@tutanota.com>
+ *
+ * @brief Test and benchmark the indexed search entry pages.
+ *
+ * This file is part of the Channel Server (channel).
+ *
+ * Copyright (C) 2012-2020 COMP_hack Team <compomega@tutanota.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <PopIgnore.h>
+#include <PushIgnore.h>
+#include <gtest/gtest.h>
+
+// libcomp Includes
+#include <Constants.h>
+
+// channel Includes
+#include "SearchEntryIndex.h"
+
+// Standard C++11 Includes
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <vector>
+
+using namespace channel;
+
+typedef std::list<std::shared_ptr<objects::SearchEntry>> EntryList;
+
+/**
+ * Filters a SearchList request can apply, one per group of search entry
+ * types that share a request layout.
+ */
+enum class FilterKind_t {
+  GOAL,          //!< Party, clan join and free recruit goal filter
+  CLAN_EVENT,    //!< Clan recruit goal and event zone filter
+  TRADE,         //!< Trade item type and category filters
+  APPLICATIONS,  //!< Applications to a parent entry
+};
+
+/**
+ * Add, replace or remove an entry the way ChannelSyncManager did before
+ * the entries were indexed.
+ */
+static void ReferenceUpdate(EntryList& entryList,
+                            const std::shared_ptr<objects::SearchEntry>& entry,
+                            bool isRemove) {
+  bool success = false;
+
+  auto it = entryList.begin();
+  while (it != entryList.end()) {
+    if ((*it)->GetEntryID() == entry->GetEntryID()) {
+      it = entryList.erase(it);
+      if (!isRemove) {
+        // Replace the existing element
+        entryList.insert(it, entry);
+      }
+
+      success = true;
+      break;
+    }
+
+    it++;
+  }
+
+  if (!success && !isRemove) {
+    entryList.push_front(entry);
+
+    // Re-sort by entry ID, highest first
+    entryList.sort([](const std::shared_ptr<objects::SearchEntry>& a,
+                      const std::shared_ptr<objects::SearchEntry>& b) {
+      return a->GetEntryID() > b->GetEntryID();
+    });
+  }
+}
+
+/**
+ * Read a page the way SearchList did before the entries were indexed: the
+ * full list is copied, filtered with remove_if and then paged.
+ */
+static EntryList ReferencePage(const EntryList& all, FilterKind_t kind,
+                               const SearchEntryFilter& f, int32_t pageID,
+                               size_t maxPageSize,
+                               std::shared_ptr<objects::SearchEntry>& prev,
+                               std::shared_ptr<objects::SearchEntry>& next) {
+  auto entries = all;
+
+  switch (kind) {
+    case FilterKind_t::GOAL:
+    case FilterKind_t::CLAN_EVENT: {
+      int32_t filter = f.Goal;
+      if (filter != 0) {
+        entries.remove_if(
+            [filter](const std::shared_ptr<objects::SearchEntry>& entry) {
+              return entry->GetData(SEARCH_IDX_GOAL) != filter;
+            });
+      }
+
+      int32_t eventZoneID = f.Location;
+      if (kind == FilterKind_t::CLAN_EVENT && eventZoneID != 0) {
+        entries.remove_if(
+            [eventZoneID](const std::shared_ptr<objects::SearchEntry>& entry) {
+              return entry->GetData(SEARCH_IDX_LOCATION) != eventZoneID;
+            });
+      }
+    } break;
+    case FilterKind_t::TRADE: {
+      int32_t itemType = f.ItemType;
+      int32_t mainCategory = f.MainCategory;
+      int32_t subCategory = f.SubCategory;
+      entries.remove_if(
+          [itemType, mainCategory,
+           subCategory](const std::shared_ptr<objects::SearchEntry>& entry) {
+            return (itemType != 0 &&
+                    entry->GetData(SEARCH_IDX_ITEM_TYPE) != itemType) ||
+                   (mainCategory != 0 &&
+                    entry->GetData(SEARCH_IDX_MAIN_CATEGORY) !=
+                        mainCategory) ||
+                   (subCategory != 0 &&
+                    entry->GetData(SEARCH_IDX_SUB_CATEGORY) != subCategory);
+          });
+    } break;
+    case FilterKind_t::APPLICATIONS: {
+      int32_t parentID = f.ParentEntryID;
+      if (parentID != 0) {
+        entries.remove_if(
+            [parentID](const std::shared_ptr<objects::SearchEntry>& entry) {
+              return entry->GetParentEntryID() != parentID;
+            });
+      }
+    } break;
+  }
+
+  prev = nullptr;
+  next = nullptr;
+
+  EntryList current;
+  for (auto entry : entries) {
+    // If page ID is not zero, current starts after that value
+    if (current.size() >= maxPageSize) {
+      next = entry;
+      break;
+    } else if (current.size() > 0 || pageID == 0) {
+      current.push_back(entry);
+    } else if (entry->GetEntryID() >= pageID) {
+      prev = entry;
+    } else {
+      current.push_back(entry);
+    }
+  }
+
+  return current;
+}
+
+/**
+ * Build a random entry with a small range of filter values so filters
+ * match often.
+ */
+static std::shared_ptr<objects::SearchEntry> RandomEntry(std::mt19937& rng,
+                                                         int32_t entryID) {
+  std::uniform_int_distribution<int32_t> value(0, 4);
+  std::uniform_int_distribution<int32_t> parent(0, 20);
+
+  auto entry = std::make_shared<objects::SearchEntry>();
+  entry->SetEntryID(entryID);
+  entry->SetParentEntryID(parent(rng));
+  entry->SetData(SEARCH_IDX_GOAL, value(rng));
+  entry->SetData(SEARCH_IDX_LOCATION, value(rng));
+  entry->SetData(SEARCH_IDX_ITEM_TYPE, value(rng));
+  entry->SetData(SEARCH_IDX_MAIN_CATEGORY, value(rng));
+  entry->SetData(SEARCH_IDX_SUB_CATEGORY, value(rng));
+
+  return entry;
+}
+
+/**
+ * Build a random filter of the specified kind. Zero values, which do not
+ * filter, are included.
+ */
+static SearchEntryFilter RandomFilter(std::mt19937& rng, FilterKind_t kind) {
+  std::uniform_int_distribution<int32_t> value(0, 5);
+  std::uniform_int_distribution<int32_t> parent(0, 21);
+
+  SearchEntryFilter filter;
+  switch (kind) {
+    case FilterKind_t::GOAL:
+      filter.Goal = value(rng);
+      break;
+    case FilterKind_t::CLAN_EVENT:
+      filter.Goal = value(rng);
+      filter.Location = value(rng);
+      break;
+    case FilterKind_t::TRADE:
+      filter.ItemType = value(rng);
+      filter.MainCategory = value(rng);
+      filter.SubCategory = value(rng);
+      break;
+    case FilterKind_t::APPLICATIONS:
+      filter.ParentEntryID = parent(rng);
+      break;
+  }
+
+  return filter;
+}
+
+/**
+ * Check random pages of each filter kind against the reference paging.
+ */
+static void ComparePages(std::mt19937& rng, const SearchEntryIndex& index,
+                         const EntryList& reference, int32_t maxEntryID) {
+  std::uniform_int_distribution<int32_t> pageID(0, maxEntryID + 1);
+  std::uniform_int_distribution<size_t> pageSize(1, 16);
+
+  for (auto kind : {FilterKind_t::GOAL, FilterKind_t::CLAN_EVENT,
+                    FilterKind_t::TRADE, FilterKind_t::APPLICATIONS}) {
+    for (int i = 0; i < 20; i++) {
+      auto filter = RandomFilter(rng, kind);
+      size_t maxPageSize = pageSize(rng);
+
+      // Start from the first page, a random ID and an ID in the list
+      std::list<int32_t> pageIDs = {0, pageID(rng)};
+      if (!reference.empty()) {
+        std::uniform_int_distribution<size_t> pick(0, reference.size() - 1);
+        pageIDs.push_back((*std::next(reference.begin(),
+                                      (std::ptrdiff_t)pick(rng)))
+                              ->GetEntryID());
+      }
+
+      for (int32_t id : pageIDs) {
+        std::shared_ptr<objects::SearchEntry> expectedPrev, expectedNext;
+        auto expected = ReferencePage(reference, kind, filter, id,
+                                      maxPageSize, expectedPrev, expectedNext);
+
+        std::shared_ptr<objects::SearchEntry> prev, next;
+        auto page = index.GetPage(filter, id, maxPageSize, prev, next);
+
+        ASSERT_EQ(page, expected) << "Filter kind " << (int)kind << " page "
+                                  << id;
+        ASSERT_EQ(prev, expectedPrev);
+        ASSERT_EQ(next, expectedNext);
+      }
+    }
+  }
+}
+
+TEST(SearchEntryIndex, SetGetRemove) {
+  std::mt19937 rng(1234);
+  SearchEntryIndex index;
+
+  auto a = RandomEntry(rng, 5);
+  auto b = RandomEntry(rng, 9);
+  EXPECT_FALSE(index.Set(a));
+  EXPECT_FALSE(index.Set(b));
+  EXPECT_EQ(index.Get(5), a);
+  EXPECT_EQ(index.Get(7), nullptr);
+
+  // Entries are kept highest ID first
+  ASSERT_EQ(index.GetEntries().size(), 2u);
+  EXPECT_EQ(index.GetEntries().begin()->second, b);
+
+  // Replacing an entry re-indexes it on its new values
+  auto c = RandomEntry(rng, 5);
+  c->SetData(SEARCH_IDX_GOAL, 100);
+  EXPECT_TRUE(index.Set(c));
+  EXPECT_EQ(index.Get(5), c);
+
+  SearchEntryFilter filter;
+  filter.Goal = 100;
+
+  std::shared_ptr<objects::SearchEntry> prev, next;
+  EXPECT_EQ(index.GetPage(filter, 0, 10, prev, next), EntryList({c}));
+
+  EXPECT_TRUE(index.Remove(5));
+  EXPECT_FALSE(index.Remove(5));
+  EXPECT_EQ(index.Get(5), nullptr);
+  EXPECT_TRUE(index.GetPage(filter, 0, 10, prev, next).empty());
+  EXPECT_EQ(index.GetEntries().size(), 1u);
+}
+
+TEST(SearchEntryIndex, PagesMatchReference) {
+  std::mt19937 rng(5678);
+  std::uniform_int_distribution<int> action(0, 9);
+
+  SearchEntryIndex index;
+  EntryList reference;
+  int32_t nextEntryID = 1;
+
+  for (int step = 0; step < 2000; step++) {
+    int a = action(rng);
+    if (a < 6 || reference.empty()) {
+      // Post a new entry
+      auto entry = RandomEntry(rng, nextEntryID++);
+      index.Set(entry);
+      ReferenceUpdate(reference, entry, false);
+    } else {
+      std::uniform_int_distribution<size_t> pick(0, reference.size() - 1);
+      int32_t entryID = (*std::next(reference.begin(),
+                                    (std::ptrdiff_t)pick(rng)))
+                            ->GetEntryID();
+      auto entry = RandomEntry(rng, entryID);
+      if (a < 8) {
+        // Update an entry with new values
+        index.Set(entry);
+        ReferenceUpdate(reference, entry, false);
+      } else {
+        index.Remove(entryID);
+        ReferenceUpdate(reference, entry, true);
+      }
+    }
+
+    ASSERT_EQ(index.GetEntries().size(), reference.size());
+
+    if (step % 50 == 0) {
+      ComparePages(rng, index, reference, nextEntryID);
+    }
+  }
+
+  ComparePages(rng, index, reference, nextEntryID);
+}
+
+TEST(SearchEntryIndex, Benchmark) {
+  const int32_t count = 5000;
+  const int passes = 2000;
+
+  std::mt19937 rng(9012);
+  SearchEntryIndex index;
+  EntryList reference;
+  for (int32_t i = 1; i <= count; i++) {
+    auto entry = RandomEntry(rng, i);
+    index.Set(entry);
+    reference.push_front(entry);
+  }
+
+  std::vector<std::pair<FilterKind_t, SearchEntryFilter>> filters;
+  for (int i = 0; i < passes; i++) {
+    auto kind = (FilterKind_t)(i % 4);
+    filters.push_back(std::make_pair(kind, RandomFilter(rng, kind)));
+  }
+
+  size_t referenceCount = 0;
+  std::shared_ptr<objects::SearchEntry> prev, next;
+  auto start = std::chrono::steady_clock::now();
+  for (auto& pair : filters) {
+    referenceCount +=
+        ReferencePage(reference, pair.first, pair.second, 0, 10, prev, next)
+            .size();
+  }
+  auto referenceTime = std::chrono::steady_clock::now() - start;
+
+  size_t indexCount = 0;
+  start = std::chrono::steady_clock::now();
+  for (auto& pair : filters) {
+    indexCount += index.GetPage(pair.second, 0, 10, prev, next).size();
+  }
+  auto indexTime = std::chrono::steady_clock::now() - start;
+
+  EXPECT_EQ(referenceCount, indexCount);
+
+  std::cout << "Search pages of " << count << " entries: "
+            << std::chrono::duration_cast<std::chrono::nanoseconds>(
+                   referenceTime)
+                       .count() /
+                   passes
+            << " ns per page copied and filtered, "
+            << std::chrono::duration_cast<std::chrono::nanoseconds>(
+                   indexTime)
+                       .count() /
+                   passes
+            << " ns per page indexed" << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+  try {
+    ::testing::InitGoogleTest(&argc, argv);
+
+    return RUN_ALL_TESTS();
+  } catch (...) {
+    return EXIT_FAILURE;
+  }
+}
@@ -39,7 +39,10 @@
 #include <AccountLogin.h>
 #include <Character.h>
 #include <CharacterLogin.h>
+#include <EntityStats.h>
+#include <Item.h>
 #include <LobbyConfig.h>
+#include <RegisteredWorld.h>
 #include <WebGameSession.h>
 
 // lobby Includes
@@ -694,6 +697,10 @@ bool AccountManager::Logout(const libcomp::String& username) {
     return false;
   }
 
+  // Characters may have changed while playing so always reload the
+  // character list the next time it is requested.
+  ClearCharacterListCache(login->GetAccount().GetUUID());
+
   // If the account is offline ignore this logout.
   if (objects::AccountLogin::State_t::OFFLINE == login->GetState()) {
     // Remove the entry to save memory.
@@ -1088,6 +1095,8 @@ bool AccountManager::SetCharacterOnAccount(
     return false;
   }
 
+  ClearCharacterListCache(account->GetUUID());
+
   return true;
 }
 
@@ -1172,6 +1181,8 @@ bool AccountManager::DeleteCharacter(
     return false;
   }
 
+  ClearCharacterListCache(account->GetUUID());
+
   // Now that the account has had the character removed, send them to
   // the world to cleanup
   mServer->GetLobbySyncManager()->RemoveRecord(character, "Character");
@@ -1179,6 +1190,144 @@ bool AccountManager::DeleteCharacter(
   return true;
 }
 
+std::set<std::shared_ptr<objects::Character>>
+AccountManager::LoadCharacterList(
+    const std::shared_ptr<objects::Account>& account) {
+  auto config =
+      std::dynamic_pointer_cast<objects::LobbyConfig>(mServer->GetConfig());
+
+  libcomp::String lookup = account->GetUUID().ToString();
+  uint32_t now = (uint32_t)std::time(0);
+  uint32_t cacheTime = config->GetCharacterListCacheTime();
+
+  if (cacheTime) {
+    std::lock_guard<std::mutex> lock(mCharacterListLock);
+
+    auto it = mCharacterLists.find(lookup);
+    if (it != mCharacterLists.end()) {
+      if ((now - it->second.LoadTime) < cacheTime) {
+        LogAccountManagerDebug([&]() {
+          return libcomp::String(
+                     "Character list for account %1 served from cache.\n")
+              .Arg(lookup);
+        });
+
+        return it->second.Characters;
+      }
+
+      mCharacterLists.erase(it);
+    }
+  }
+
+  CharacterListCache entry;
+  entry.LoadTime = now;
+
+  // Count the database round trips so the cost of the list can be
+  // monitored. Stats and equipment are loaded in one query per character
+  // each rather than once per equipped item.
+  size_t queryCount = 0;
+
+  for (auto world : mServer->GetWorlds()) {
+    if (world->GetRegisteredWorld()->GetStatus() ==
+        objects::RegisteredWorld::Status_t::INACTIVE)
+      continue;
+
+    auto worldDB = world->GetWorldDatabase();
+    auto characterList = objects::Character::LoadCharacterListByAccount(
+        worldDB, account->GetUUID());
+    queryCount++;
+
+    for (auto character : characterList) {
+      // Always reload
+      bool loaded = character->GetCoreStats().Get(worldDB, true) != nullptr;
+      queryCount++;
+
+      if (!loaded) {
+        // If stats can't load, we need to exclude the character
+        LogAccountManagerError([&]() {
+          return libcomp::String("Character stats could not be loaded: %1\n")
+              .Arg(character->GetUUID().ToString());
+        });
+
+        continue;
+      }
+
+      entry.Stats.push_back(character->GetCoreStats().Get());
+
+      // Equipment is always in the inventory so load the whole box at once
+      // instead of requesting each equipped item individually
+      auto inventoryUUID = character->GetItemBoxes(0).GetUUID();
+      if (!inventoryUUID.IsNull()) {
+        for (auto item :
+             objects::Item::LoadItemListByItemBox(worldDB, inventoryUUID)) {
+          entry.Items.push_back(item);
+        }
+
+        queryCount++;
+      }
+
+      for (auto equip : character->GetEquippedItems()) {
+        loaded &= equip.IsNull() || equip.Get() != nullptr;
+        if (!loaded) break;
+      }
+
+      if (!loaded) {
+        // Fallback to loading individually in case the item was moved
+        // from the inventory without the equipment being updated
+        loaded = true;
+        for (auto equip : character->GetEquippedItems()) {
+          if (!equip.IsNull() && !equip.Get()) {
+            auto item = equip.Get(worldDB);
+            queryCount++;
+
+            if (item) {
+              entry.Items.push_back(item);
+            } else {
+              loaded = false;
+              break;
+            }
+          }
+        }
+      }
+
+      if (!loaded) {
+        // This is not a hard failure, let the channel correct
+        LogAccountManagerError([&]() {
+          return libcomp::String(
+                     "One or more equipped items failed to load: %1\n")
+              .Arg(character->GetUUID().ToString());
+        });
+      }
+
+      entry.Characters.insert(character);
+    }
+  }
+
+  LogAccountManagerDebug([&]() {
+    return libcomp::String(
+               "Character list for account %1 loaded %2 character(s) in %3 "
+               "database request(s).\n")
+        .Arg(lookup)
+        .Arg(entry.Characters.size())
+        .Arg(queryCount);
+  });
+
+  auto characters = entry.Characters;
+
+  if (cacheTime) {
+    std::lock_guard<std::mutex> lock(mCharacterListLock);
+    mCharacterLists[lookup] = entry;
+  }
+
+  return characters;
+}
+
+void AccountManager::ClearCharacterListCache(
+    const libobjgen::UUID& accountUUID) {
+  std::lock_guard<std::mutex> lock(mCharacterListLock);
+  mCharacterLists.erase(accountUUID.ToString());
+}
+
 bool AccountManager::StartWebGameSession(
     const libcomp::String& username,
     const std::shared_ptr<objects::WebGameSession>& gameSession) {
@@ -32,7 +32,9 @@
 #include <ErrorCodes.h>
 
 // Standard C++11 Includes
+#include <list>
 #include <mutex>
+#include <set>
 #include <unordered_map>
 
 // object Includes
@@ -40,7 +42,10 @@
 
 namespace objects {
 
+class Account;
 class Character;
+class EntityStats;
+class Item;
 class WebGameSession;
 
 }  // namespace objects
@@ -323,6 +328,27 @@ class AccountManager {
   bool DeleteCharacter(const std::shared_ptr<objects::Account>& account,
                        const std::shared_ptr<objects::Character>& character);
 
+  /**
+   * Load every character on the supplied account from all active worlds
+   * along with the core stats and equipment needed to display the lobby
+   * character list. Results are cached for a short time per account and
+   * the cache is cleared when a character is created, deleted or the
+   * account logs out.
+   * @param account Pointer to the account to load characters for
+   * @return Set of characters that loaded successfully
+   * @note This function is thread safe.
+   */
+  std::set<std::shared_ptr<objects::Character>> LoadCharacterList(
+      const std::shared_ptr<objects::Account>& account);
+
+  /**
+   * Clear the cached character list for the supplied account so the
+   * next request reloads it from the world databases.
+   * @param accountUUID UUID of the account to clear the cache for
+   * @note This function is thread safe.
+   */
+  void ClearCharacterListCache(const libobjgen::UUID& accountUUID);
+
   /**
    * Start a web-game session for the specified user who is currently playing
    * that remains valid until a remove request is received or the account
@@ -402,6 +428,25 @@ class AccountManager {
   void UpdateDebugStatus() const;
 
  private:
+  /**
+   * Cached character list data for one account. The loaded stats and
+   * items are held here so the weak object references on each character
+   * remain valid for as long as the entry does.
+   */
+  struct CharacterListCache {
+    /// System time (in seconds) the entry was loaded at
+    uint32_t LoadTime = 0;
+
+    /// Characters loaded from all active worlds
+    std::set<std::shared_ptr<objects::Character>> Characters;
+
+    /// Core stats loaded for each character
+    std::list<std::shared_ptr<objects::EntityStats>> Stats;
+
+    /// Inventory items loaded for each character
+    std::list<std::shared_ptr<objects::Item>> Items;
+  };
+
   /// Pointer to the lobby server.
   LobbyServer* mServer;
 
@@ -424,6 +469,12 @@ class AccountManager {
 
   /// List of clients connected for each machine UUID.
   std::unordered_map<libcomp::String, int32_t> mMachineUUIDs;
+
+  /// Mutex to lock access to the character list cache.
+  std::mutex mCharacterListLock;
+
+  /// Map of account UUID strings to cached character list data
+  std::unordered_map<libcomp::String, CharacterListCache> mCharacterLists;
 };
 
 }  // namespace lobby
@@ -67,44 +67,9 @@ bool Parsers::CharacterList::Parse(
       std::dynamic_pointer_cast<LobbyClientConnection>(connection);
   auto account = lobbyConnection->GetClientState()->GetAccount().Get();
 
-  std::set<std::shared_ptr<objects::Character>> characters;
-  for (auto world : server->GetWorlds()) {
-    if (world->GetRegisteredWorld()->GetStatus() ==
-        objects::RegisteredWorld::Status_t::INACTIVE)
-      continue;
-
-    auto worldDB = world->GetWorldDatabase();
-    auto characterList = objects::Character::LoadCharacterListByAccount(
-        worldDB, account->GetUUID());
-    for (auto character : characterList) {
-      // Always reload
-      bool loaded = character->GetCoreStats().Get(worldDB, true) != nullptr;
-
-      if (loaded) {
-        for (auto equip : character->GetEquippedItems()) {
-          loaded &= equip.IsNull() || equip.Get(worldDB) != nullptr;
-          if (!loaded) break;
-        }
-
-        if (!loaded) {
-          // This is not a hard failure, let the channel correct
-          LogGeneralError([&]() {
-            return libcomp::String(
-                       "One or more equipped items failed to load: %1\n")
-                .Arg(character->GetUUID().ToString());
-          });
-        }
-
-        characters.insert(character);
-      } else {
-        // If stats can't load, we need to exclude the character
-        LogGeneralError([&]() {
-          return libcomp::String("Character stats coul not be loaded: %1\n")
-              .Arg(character->GetUUID().ToString());
-        });
-      }
-    }
-  }
+  // Characters along with their stats and equipment are loaded (or pulled
+  // from the short-lived cache) by the account manager
+  auto characters = accountManager->LoadCharacterList(account);
 
   auto deletes = accountManager->GetCharactersForDeletion(account);
   if (deletes.size() > 0) {
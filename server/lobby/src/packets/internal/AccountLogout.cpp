@@ -34,6 +34,7 @@
 #include <ReadOnlyPacket.h>
 
 // libcomp Includes
+#include <Account.h>
 #include <AccountLogin.h>
 #include <CharacterLogin.h>
 
@@ -86,6 +87,11 @@ bool Parsers::AccountLogout::Parse(
       });
     }
   } else {
+    // The character's level, stats and equipment may have changed on the
+    // channel so the character list must be reloaded, even when the user
+    // returns to the lobby and is not logged out
+    accountManager->ClearCharacterListCache(login->GetAccount().GetUUID());
+
     // Do not log out the user if they connected back to the lobby
     if (cLogin->GetWorldID() != -1) {
       LogGeneralDebug([&]() {
@@ -1270,6 +1270,9 @@ void AccountManager::Cleanup(
   cLogin->SetChannelID(-1);
   cLogin->SetZoneID(0);
 
+  mServer.lock()->GetCharacterManager()->EvictFriendLinks(
+      cLogin->GetWorldCID());
+
   // Leave the character once loaded but drop other data referenced by it
   Cleanup<objects::FriendSettings>(
       cLogin->GetCharacter()->GetFriendSettings().Get());
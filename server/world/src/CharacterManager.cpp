@@ -91,6 +91,13 @@ bool CharacterManager::UnregisterCharacter(
         break;
       }
     }
+
+    // Drop the character from every cached friend list. Its own list may
+    // not be cached so it cannot be used to find the other lists.
+    mFriendLinks.erase(cLogin->GetWorldCID());
+    for (auto& pair : mFriendLinks) {
+      pair.second.erase(cLogin->GetWorldCID());
+    }
   }
 
   return removed;
@@ -178,24 +185,40 @@ bool CharacterManager::SendToCharacters(
     }
   }
 
+  if (channelMap.size() == 0) {
+    return true;
+  }
+
   if (cidOffset > (p.Size() - 2)) {
     cidOffset = (p.Size() - 2);
   }
 
+  // Split the packet into the header (packet code and anything before the
+  // CID list) and the payload once. Each channel packet is then written
+  // from these two segments and its own CID list instead of copying the
+  // whole packet and shifting the payload over for every channel.
+  uint32_t headerSize = (uint32_t)(cidOffset + 2);
+
+  p.Rewind();
+  auto header = p.ReadArray(headerSize);
+  auto payload = p.ReadArray(p.Left());
+
   auto server = mServer.lock();
-  auto channels = server->GetChannels();
-  for (auto pair : channelMap) {
+  for (auto& pair : channelMap) {
     auto channel = server->GetChannelConnectionByID(pair.first);
 
     // If the channel is not valid, move on and clean it up later
     if (!channel) continue;
 
-    libcomp::Packet p2(p);
-    ConvertToTargetCIDPacket(p2, cidOffset, pair.second.size());
+    libcomp::Packet p2;
+    p2.WriteArray(header);
+    p2.WriteU16Little((uint16_t)pair.second.size());
     for (int32_t fCID : pair.second) {
       p2.WriteS32Little(fCID);
     }
 
+    p2.WriteArray(payload);
+
     channel->SendPacket(p2);
   }
 
@@ -254,34 +277,10 @@ bool CharacterManager::SendToRelatedCharacters(
 std::list<std::shared_ptr<objects::CharacterLogin>>
 CharacterManager::GetRelatedCharacterLogins(
     std::shared_ptr<objects::CharacterLogin> cLogin, uint8_t relatedTypes) {
-  auto server = mServer.lock();
-  auto worldDB = server->GetWorldDatabase();
-
   std::list<int32_t> targetCIDs;
-  std::list<libobjgen::UUID> targetUUIDs;
   if (relatedTypes & RELATED_FRIENDS) {
-    std::shared_ptr<objects::FriendSettings> fSettings;
-
-    // If the character is currently loaded on the server, pull the friend
-    // settings directly from it so we don't need to load every time
-    auto character = cLogin->GetCharacter().Get();
-    if (character &&
-        cLogin->GetStatus() != objects::CharacterLogin::Status_t::OFFLINE) {
-      fSettings = character->GetFriendSettings().Get(worldDB);
-      if (!fSettings && !character->GetFriendSettings().IsNull()) {
-        LogCharacterManagerError([&]() {
-          return libcomp::String(
-                     "Failed to get friend settings. Character UUID: %1\n")
-              .Arg(cLogin->GetCharacter().GetUUID().ToString());
-        });
-      }
-    } else {
-      fSettings = objects::FriendSettings::LoadFriendSettingsByCharacter(
-          worldDB, cLogin->GetCharacter().GetUUID());
-    }
-
-    if (fSettings) {
-      targetUUIDs = fSettings->GetFriends();
+    for (int32_t friendCID : GetFriendCIDs(cLogin)) {
+      targetCIDs.push_back(friendCID);
     }
   }
 
@@ -315,21 +314,117 @@ CharacterManager::GetRelatedCharacterLogins(
   }
 
   std::list<std::shared_ptr<objects::CharacterLogin>> cLogins;
-  for (auto targetUUID : targetUUIDs) {
-    if (targetUUID != cLogin->GetCharacter().GetUUID()) {
-      cLogins.push_back(GetCharacterLogin(targetUUID));
-    }
-  }
-
   for (auto cid : targetCIDs) {
     if (cid != cLogin->GetWorldCID()) {
-      cLogins.push_back(GetCharacterLogin(cid));
+      // Skip characters that are no longer registered (ex: deleted)
+      auto targetLogin = GetCharacterLogin(cid);
+      if (targetLogin) {
+        cLogins.push_back(targetLogin);
+      }
     }
   }
 
   return cLogins;
 }
 
+std::set<int32_t> CharacterManager::GetFriendCIDs(
+    const std::shared_ptr<objects::CharacterLogin>& cLogin) {
+  int32_t worldCID = cLogin->GetWorldCID();
+  {
+    std::lock_guard<std::mutex> lock(mLock);
+    auto it = mFriendLinks.find(worldCID);
+    if (it != mFriendLinks.end()) {
+      return it->second;
+    }
+  }
+
+  auto server = mServer.lock();
+  auto worldDB = server->GetWorldDatabase();
+
+  std::shared_ptr<objects::FriendSettings> fSettings;
+
+  // If the character is currently loaded on the server, pull the friend
+  // settings directly from it so we don't need to load them
+  auto character = cLogin->GetCharacter().Get();
+  if (character &&
+      cLogin->GetStatus() != objects::CharacterLogin::Status_t::OFFLINE) {
+    fSettings = character->GetFriendSettings().Get(worldDB);
+    if (!fSettings && !character->GetFriendSettings().IsNull()) {
+      LogCharacterManagerError([&]() {
+        return libcomp::String(
+                   "Failed to get friend settings. Character UUID: %1\n")
+            .Arg(cLogin->GetCharacter().GetUUID().ToString());
+      });
+
+      // Do not cache a failure
+      return {};
+    }
+  } else {
+    fSettings = objects::FriendSettings::LoadFriendSettingsByCharacter(
+        worldDB, cLogin->GetCharacter().GetUUID());
+  }
+
+  std::set<int32_t> friendCIDs;
+  if (fSettings) {
+    for (auto& friendUUID : fSettings->GetFriends()) {
+      if (friendUUID != cLogin->GetCharacter().GetUUID()) {
+        auto friendLogin = GetCharacterLogin(friendUUID);
+        if (friendLogin) {
+          friendCIDs.insert(friendLogin->GetWorldCID());
+        }
+      }
+    }
+  }
+
+  // Only cache the lists of online characters so the cache stays bounded
+  // by the number of characters logged in
+  if (cLogin->GetStatus() == objects::CharacterLogin::Status_t::OFFLINE) {
+    return friendCIDs;
+  }
+
+  std::lock_guard<std::mutex> lock(mLock);
+
+  // If another request loaded the list first, keep that one as it may
+  // already contain link updates
+  auto result = mFriendLinks.insert(std::make_pair(worldCID, friendCIDs));
+  return result.first->second;
+}
+
+void CharacterManager::EvictFriendLinks(int32_t worldCID) {
+  std::lock_guard<std::mutex> lock(mLock);
+  mFriendLinks.erase(worldCID);
+}
+
+void CharacterManager::AddFriendLink(int32_t worldCID1, int32_t worldCID2) {
+  std::lock_guard<std::mutex> lock(mLock);
+
+  // Only update lists that have already been loaded, any others will load
+  // the change from the database when requested
+  auto it = mFriendLinks.find(worldCID1);
+  if (it != mFriendLinks.end()) {
+    it->second.insert(worldCID2);
+  }
+
+  it = mFriendLinks.find(worldCID2);
+  if (it != mFriendLinks.end()) {
+    it->second.insert(worldCID1);
+  }
+}
+
+void CharacterManager::RemoveFriendLink(int32_t worldCID1, int32_t worldCID2) {
+  std::lock_guard<std::mutex> lock(mLock);
+
+  auto it = mFriendLinks.find(worldCID1);
+  if (it != mFriendLinks.end()) {
+    it->second.erase(worldCID2);
+  }
+
+  it = mFriendLinks.find(worldCID2);
+  if (it != mFriendLinks.end()) {
+    it->second.erase(worldCID1);
+  }
+}
+
 void CharacterManager::SendStatusToRelatedCharacters(
     const std::list<std::shared_ptr<objects::CharacterLogin>>& cLogins,
     uint8_t updateFlags, bool zoneRestrict) {
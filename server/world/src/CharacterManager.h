@@ -28,6 +28,7 @@
 #define SERVER_WORLD_SRC_CHARACTERMANAGER_H
 
 // Standard C++11 Includes
+#include <set>
 #include <unordered_map>
 
 // object Includes
@@ -188,6 +189,43 @@ class CharacterManager {
   std::list<std::shared_ptr<objects::CharacterLogin>> GetRelatedCharacterLogins(
       std::shared_ptr<objects::CharacterLogin> cLogin, uint8_t relatedTypes);
 
+  /**
+   * Get the world CIDs of every friend of the supplied CharacterLogin. The
+   * friend list is loaded from the character's FriendSettings the first
+   * time it is requested and is kept current by AddFriendLink and
+   * RemoveFriendLink from then on so no further loads are needed. Only the
+   * lists of online characters are cached.
+   * @param cLogin CharacterLogin to get the friends of
+   * @return Set of friend world CIDs
+   */
+  std::set<int32_t> GetFriendCIDs(
+      const std::shared_ptr<objects::CharacterLogin>& cLogin);
+
+  /**
+   * Drop the cached friend list of a character that logged off. The lists
+   * of other characters keep its CID as the friendship is unchanged.
+   * @param worldCID World CID of the character that logged off
+   */
+  void EvictFriendLinks(int32_t worldCID);
+
+  /**
+   * Register a mutual friend link between two characters with the cached
+   * friend lists. This should be called after the FriendSettings for both
+   * characters have been updated.
+   * @param worldCID1 World CID of the first character
+   * @param worldCID2 World CID of the second character
+   */
+  void AddFriendLink(int32_t worldCID1, int32_t worldCID2);
+
+  /**
+   * Remove a mutual friend link between two characters from the cached
+   * friend lists. This should be called after the FriendSettings for both
+   * characters have been updated.
+   * @param worldCID1 World CID of the first character
+   * @param worldCID2 World CID of the second character
+   */
+  void RemoveFriendLink(int32_t worldCID1, int32_t worldCID2);
+
   /**
    * Send packets containing CharacterLogin information about the supplied
    * logins contextual to other related characters
@@ -612,6 +650,11 @@ class CharacterManager {
 
   std::unordered_map<int32_t, std::shared_ptr<objects::Team>> mTeams;
 
+  /// Map of world CIDs to the world CIDs of each of their friends. Entries
+  /// are loaded on first use for online characters, updated in place as
+  /// friends are added or removed and evicted when the character logs off.
+  std::unordered_map<int32_t, std::set<int32_t>> mFriendLinks;
+
   /// Highest CID registered for a logged in character
   int32_t mMaxCID;
 
@@ -37,6 +37,7 @@
 
 // Standard C++11 Includes
 #include <algorithm>
+#include <iterator>
 
 // object Includes
 #include <Account.h>
@@ -67,6 +68,7 @@ using namespace world;
 WorldSyncManager::WorldSyncManager(const std::weak_ptr<WorldServer>& server)
     : libcomp::DataSyncManager(
           to_underlying(InternalPacketCode_t::PACKET_DATA_SYNC)),
+      mUBRanksLoaded(false),
       mNextMatchID(0),
       mServer(server) {
   mPvPReadyTimes[0] = {{0, 0}};
@@ -493,7 +495,11 @@ int8_t WorldSyncManager::Update<objects::MatchEntry>(
   auto entry = std::dynamic_pointer_cast<objects::MatchEntry>(obj);
 
   if (isRemove) {
-    mMatchEntries.erase(entry->GetWorldCID());
+    auto it = mMatchEntries.find(entry->GetWorldCID());
+    if (it != mMatchEntries.end()) {
+      DequeueMatchEntry(it->second);
+      mMatchEntries.erase(it);
+    }
   } else {
     auto cLogin = mServer.lock()->GetCharacterManager()->GetCharacterLogin(
         entry->GetWorldCID());
@@ -507,7 +513,13 @@ int8_t WorldSyncManager::Update<objects::MatchEntry>(
       entry->SetEntryTime((uint32_t)std::time(0));
     }
 
+    auto it = mMatchEntries.find(entry->GetWorldCID());
+    if (it != mMatchEntries.end()) {
+      DequeueMatchEntry(it->second);
+    }
+
     mMatchEntries[entry->GetWorldCID()] = entry;
+    QueueMatchEntry(entry);
   }
 
   return SYNC_UPDATED;
@@ -805,6 +817,8 @@ void WorldSyncManager::SyncComplete<objects::UBResult>(
     std::lock_guard<std::mutex> lock(mLock);
     for (auto& objPair : objs) {
       auto result = std::dynamic_pointer_cast<objects::UBResult>(objPair.first);
+      IndexUBResult(result, objPair.second);
+
       if (result->GetTournament().IsNull()) {
         if (result->GetPoints() >= mUBRecalcMin[1] ||
             result->GetTopPoints() >= mUBRecalcMin[2] || result->GetRanked()) {
@@ -853,6 +867,16 @@ void WorldSyncManager::SyncComplete<objects::UBTournament>(
   {
     std::lock_guard<std::mutex> lock(mLock);
     if (mUBTournament && mUBTournament->GetEndTime()) {
+      // Rankings are final, drop the index
+      auto it = mUBTournamentRanks.find(mUBTournament->GetUUID().ToString());
+      if (it != mUBTournamentRanks.end()) {
+        for (auto& pair : it->second.Points) {
+          mUBResults.erase(pair.first);
+        }
+
+        mUBTournamentRanks.erase(it);
+      }
+
       mUBTournament = nullptr;
       mUBRecalcMin = {{0, 0, 0}};
     }
@@ -1038,9 +1062,13 @@ bool WorldSyncManager::RemoveRecord(
       auto entry = std::dynamic_pointer_cast<objects::MatchEntry>(record);
       if (entry->GetTeamID()) {
         std::lock_guard<std::mutex> lock(mLock);
-        for (auto& ePair : mMatchEntries) {
-          if (ePair.second->GetTeamID() == entry->GetTeamID()) {
-            additionalRemoves.push_back(ePair.second);
+        auto qIter = mMatchQueues.find((uint8_t)entry->GetMatchType());
+        if (qIter != mMatchQueues.end()) {
+          auto tIter = qIter->second.find(entry->GetTeamID());
+          if (tIter != qIter->second.end()) {
+            for (auto e : tIter->second) {
+              additionalRemoves.push_back(e);
+            }
           }
         }
 
@@ -1313,12 +1341,7 @@ void WorldSyncManager::StartPvPMatch(uint32_t time, uint8_t type) {
                         ->GetWorldSharedConfig()
                         ->GetPvPGhosts((size_t)type);
     if (entries.size() >= 2 && (size_t)(entries.size() + ghost) >= minCount) {
-      // First in, first out
-      entries.sort([](const std::shared_ptr<objects::MatchEntry>& a,
-                      const std::shared_ptr<objects::MatchEntry>& b) {
-        return a->GetEntryTime() < b->GetEntryTime();
-      });
-
+      // First in, first out (queues are already in entry time order)
       size_t teamCount = entries.size();
       if (teamCount > maxCount) {
         teamCount = maxCount;
@@ -1419,14 +1442,9 @@ void WorldSyncManager::StartTeamPvPMatch(uint32_t time, uint8_t type) {
 
     std::list<std::list<std::shared_ptr<objects::MatchEntry>>> readyTeams;
     for (auto& pair : teamEntries) {
-      auto team = pair.second;
+      // Team queues are already sorted by first registered
+      auto& team = pair.second;
       if ((size_t)(team.size() + gAdjust) >= minCount) {
-        // Sort by first registered
-        team.sort([](const std::shared_ptr<objects::MatchEntry>& a,
-                     const std::shared_ptr<objects::MatchEntry>& b) {
-          return a->GetEntryTime() < b->GetEntryTime();
-        });
-
         readyTeams.push_back(team);
       }
     }
@@ -1717,16 +1735,56 @@ std::unordered_map<int32_t, std::list<std::shared_ptr<objects::MatchEntry>>>
 WorldSyncManager::GetMatchEntryTeams(uint8_t type) {
   std::unordered_map<int32_t, std::list<std::shared_ptr<objects::MatchEntry>>>
       entryTeams;
-  for (auto& pair : mMatchEntries) {
-    auto entry = pair.second;
-    if ((uint8_t)entry->GetMatchType() == type && !entry->GetMatchID()) {
-      entryTeams[entry->GetTeamID()].push_back(entry);
+
+  auto qIter = mMatchQueues.find(type);
+  if (qIter != mMatchQueues.end()) {
+    for (auto& pair : qIter->second) {
+      for (auto& entry : pair.second) {
+        if (!entry->GetMatchID()) {
+          entryTeams[pair.first].push_back(entry);
+        }
+      }
     }
   }
 
   return entryTeams;
 }
 
+void WorldSyncManager::QueueMatchEntry(
+    const std::shared_ptr<objects::MatchEntry>& entry) {
+  auto& queue =
+      mMatchQueues[(uint8_t)entry->GetMatchType()][entry->GetTeamID()];
+
+  // Entries almost always arrive in order so search from the back
+  auto it = queue.end();
+  while (it != queue.begin()) {
+    auto prev = std::prev(it);
+    if ((*prev)->GetEntryTime() <= entry->GetEntryTime()) {
+      break;
+    }
+
+    it = prev;
+  }
+
+  queue.insert(it, entry);
+}
+
+void WorldSyncManager::DequeueMatchEntry(
+    const std::shared_ptr<objects::MatchEntry>& entry) {
+  auto qIter = mMatchQueues.find((uint8_t)entry->GetMatchType());
+  if (qIter == mMatchQueues.end()) {
+    return;
+  }
+
+  auto tIter = qIter->second.find(entry->GetTeamID());
+  if (tIter != qIter->second.end()) {
+    tIter->second.remove(entry);
+    if (tIter->second.size() == 0) {
+      qIter->second.erase(tIter);
+    }
+  }
+}
+
 bool WorldSyncManager::EndMatch(
     const std::shared_ptr<objects::PentalphaMatch>& match) {
   LogDataSyncManagerDebug([match]() {
@@ -1876,43 +1934,17 @@ bool WorldSyncManager::RecalculateTournamentRankings(
 
   auto server = mServer.lock();
 
-  auto results = objects::UBResult::LoadUBResultListByTournament(
-      server->GetWorldDatabase(), tournamentUID);
-
-  results.sort([](const std::shared_ptr<objects::UBResult>& a,
-                  const std::shared_ptr<objects::UBResult>& b) {
-    return a->GetPoints() > b->GetPoints();
-  });
-
-  std::list<std::shared_ptr<objects::UBResult>> updated;
+  bool exists = false;
+  std::set<std::shared_ptr<objects::UBResult>> updated;
   {
     std::lock_guard<std::mutex> lock(mLock);
 
-    mUBRecalcMin[0] = 0;
+    LoadUBRankIndex(tournamentUID);
 
-    size_t idx = 0;
-    uint8_t rank = 0;
-    int32_t points = -1;
-    for (auto result : results) {
-      if (rank <= 10 && points != (int32_t)result->GetPoints()) {
-        rank = (uint8_t)(rank + 1);
-        points = (int32_t)result->GetPoints();
-      }
+    auto& index = mUBTournamentRanks[tournamentUID.ToString()];
+    exists = index.Order.size() > 0;
 
-      if (rank <= 10) {
-        if (result->GetTournamentRank() != rank) {
-          result->SetTournamentRank(rank);
-          updated.push_back(result);
-        }
-      } else if (result->GetTournamentRank()) {
-        result->SetTournamentRank(0);
-        updated.push_back(result);
-      }
-
-      if (idx++ == 10) {
-        mUBRecalcMin[0] = (uint32_t)points;
-      }
-    }
+    mUBRecalcMin[0] = RankUBResults(index, 0, updated);
   }
 
   if (updated.size() > 0) {
@@ -1927,100 +1959,224 @@ bool WorldSyncManager::RecalculateTournamentRankings(
     server->GetWorldDatabase()->ProcessChangeSet(dbChanges);
   }
 
-  return results.size() > 0;
+  return exists;
 }
 
 bool WorldSyncManager::RecalculateUBRankings() {
   auto server = mServer.lock();
 
-  auto results = objects::UBResult::LoadUBResultListByTournament(
-      server->GetWorldDatabase(), NULLUUID);
-
   std::set<std::shared_ptr<objects::UBResult>> updated;
   {
     std::lock_guard<std::mutex> lock(mLock);
 
-    mUBRecalcMin[1] = 0;
-    mUBRecalcMin[2] = 0;
+    LoadUBRankIndex(NULLUUID);
 
-    // Calculate all time ranks
-    results.sort([](const std::shared_ptr<objects::UBResult>& a,
-                    const std::shared_ptr<objects::UBResult>& b) {
-      return a->GetPoints() > b->GetPoints();
-    });
+    // Calculate all time ranks then top point ranks
+    mUBRecalcMin[1] = RankUBResults(mUBRanks[0], 1, updated);
+    mUBRecalcMin[2] = RankUBResults(mUBRanks[1], 2, updated);
+  }
 
-    size_t idx = 0;
-    uint8_t rank = 0;
-    int32_t points = -1;
-    for (auto result : results) {
-      if (rank <= 10 && points != (int32_t)result->GetPoints()) {
-        rank = (uint8_t)(rank + 1);
-        points = (int32_t)result->GetPoints();
-      }
+  if (updated.size() > 0) {
+    auto dbChanges = libcomp::DatabaseChangeSet::Create();
 
-      if (rank <= 10) {
-        if (result->GetAllTimeRank() != rank) {
-          result->SetAllTimeRank(rank);
-          updated.insert(result);
-        }
-      } else if (result->GetAllTimeRank()) {
-        result->SetAllTimeRank(0);
-        updated.insert(result);
-      }
+    for (auto update : updated) {
+      update->SetRanked(update->GetAllTimeRank() || update->GetTopPointRank());
 
-      if (idx++ == 10) {
-        mUBRecalcMin[1] = (uint32_t)points;
-      }
+      dbChanges->Update(update);
+
+      UpdateRecord(update, "UBResult");
     }
 
-    // Calculate top point ranks
-    results.sort([](const std::shared_ptr<objects::UBResult>& a,
-                    const std::shared_ptr<objects::UBResult>& b) {
-      return a->GetTopPoints() > b->GetTopPoints();
-    });
+    server->GetWorldDatabase()->ProcessChangeSet(dbChanges);
 
-    idx = 0;
-    rank = 0;
-    points = -1;
-    for (auto result : results) {
-      if (rank <= 10 && points != (int32_t)result->GetTopPoints()) {
-        rank = (uint8_t)(rank + 1);
-        points = (int32_t)result->GetPoints();
-      }
+    return true;
+  }
 
-      if (rank <= 10) {
-        if (result->GetTopPointRank() != rank) {
-          result->SetTopPointRank(rank);
-          updated.insert(result);
-        }
-      } else if (result->GetTopPointRank()) {
-        result->SetTopPointRank(0);
-        updated.insert(result);
+  return false;
+}
+
+void WorldSyncManager::LoadUBRankIndex(const libobjgen::UUID& tournamentUID) {
+  bool allTime = tournamentUID.IsNull();
+  if (allTime ? mUBRanksLoaded
+              : mUBTournamentRanks.find(tournamentUID.ToString()) !=
+                    mUBTournamentRanks.end()) {
+    // Already loaded
+    return;
+  }
+
+  LogDataSyncManagerDebug([tournamentUID]() {
+    return libcomp::String("Loading UB results for ranking: %1\n")
+        .Arg(tournamentUID.ToString());
+  });
+
+  auto results = objects::UBResult::LoadUBResultListByTournament(
+      mServer.lock()->GetWorldDatabase(), tournamentUID);
+
+  if (allTime) {
+    mUBRanksLoaded = true;
+  } else {
+    // Make sure the index exists even if there are no results
+    mUBTournamentRanks[tournamentUID.ToString()];
+  }
+
+  for (auto result : results) {
+    IndexUBResult(result);
+  }
+
+  // Seed the ranked sets from the stored ranks so stale ranks are cleared
+  // on the first recalculation
+  for (auto result : results) {
+    libcomp::String uuid = result->GetUUID().ToString();
+    if (allTime) {
+      if (result->GetAllTimeRank()) {
+        mUBRanks[0].Ranked.insert(uuid);
       }
 
-      if (idx++ == 10) {
-        mUBRecalcMin[2] = (uint32_t)points;
+      if (result->GetTopPointRank()) {
+        mUBRanks[1].Ranked.insert(uuid);
       }
+    } else if (result->GetTournamentRank()) {
+      mUBTournamentRanks[tournamentUID.ToString()].Ranked.insert(uuid);
     }
   }
+}
 
-  if (updated.size() > 0) {
-    auto dbChanges = libcomp::DatabaseChangeSet::Create();
+void WorldSyncManager::IndexUBResult(
+    const std::shared_ptr<objects::UBResult>& result, bool remove) {
+  libcomp::String uuid = result->GetUUID().ToString();
 
-    for (auto update : updated) {
-      update->SetRanked(update->GetAllTimeRank() || update->GetTopPointRank());
+  std::list<std::pair<UBRankIndex*, uint32_t>> indexes;
+  if (result->GetTournament().IsNull()) {
+    if (!mUBRanksLoaded) {
+      // Will be loaded from the DB when needed
+      return;
+    }
 
-      dbChanges->Update(update);
+    indexes.push_back(std::make_pair(&mUBRanks[0], result->GetPoints()));
+    indexes.push_back(std::make_pair(&mUBRanks[1], result->GetTopPoints()));
+  } else {
+    auto it = mUBTournamentRanks.find(result->GetTournament().ToString());
+    if (it == mUBTournamentRanks.end()) {
+      // Will be loaded from the DB when needed
+      return;
+    }
 
-      UpdateRecord(update, "UBResult");
+    indexes.push_back(std::make_pair(&it->second, result->GetPoints()));
+  }
+
+  for (auto& pair : indexes) {
+    auto& index = *pair.first;
+
+    auto it = index.Points.find(uuid);
+    if (it != index.Points.end()) {
+      index.Order.erase(std::make_pair(it->second, uuid));
+      index.Points.erase(it);
     }
 
-    server->GetWorldDatabase()->ProcessChangeSet(dbChanges);
+    if (remove) {
+      index.Ranked.erase(uuid);
+    } else {
+      index.Order.insert(std::make_pair(pair.second, uuid));
+      index.Points[uuid] = pair.second;
+    }
+  }
 
-    return true;
+  if (remove) {
+    mUBResults.erase(uuid);
+  } else {
+    mUBResults[uuid] = result;
   }
+}
 
-  return false;
+uint32_t WorldSyncManager::RankUBResults(
+    UBRankIndex& index, uint8_t rankType,
+    std::set<std::shared_ptr<objects::UBResult>>& updated) {
+  uint32_t recalcMin = 0;
+
+  // Visit the top entries until every entry ranked 10 or better and the
+  // 11th entry (which sets the recalculation minimum) have been seen
+  std::set<libcomp::String> ranked;
+  size_t idx = 0;
+  uint8_t rank = 0;
+  int32_t points = -1;
+  for (auto it = index.Order.begin(); it != index.Order.end(); it++) {
+    if (rank <= 10 && points != (int32_t)it->first) {
+      rank = (uint8_t)(rank + 1);
+      points = (int32_t)it->first;
+    }
+
+    if (rank > 10 && idx > 10) {
+      break;
+    }
+
+    if (idx++ == 10) {
+      recalcMin = (uint32_t)points;
+    }
+
+    auto rIter = mUBResults.find(it->second);
+    if (rank > 10 || rIter == mUBResults.end()) {
+      continue;
+    }
+
+    auto result = rIter->second;
+    ranked.insert(it->second);
+
+    uint8_t current = 0;
+    switch (rankType) {
+      case 0:
+        current = result->GetTournamentRank();
+        break;
+      case 1:
+        current = result->GetAllTimeRank();
+        break;
+      default:
+        current = result->GetTopPointRank();
+        break;
+    }
+
+    if (current != rank) {
+      switch (rankType) {
+        case 0:
+          result->SetTournamentRank(rank);
+          break;
+        case 1:
+          result->SetAllTimeRank(rank);
+          break;
+        default:
+          result->SetTopPointRank(rank);
+          break;
+      }
+
+      updated.insert(result);
+    }
+  }
+
+  // Clear the rank on anything that dropped out of the top 10
+  for (auto& uuid : index.Ranked) {
+    auto rIter = mUBResults.find(uuid);
+    if (ranked.find(uuid) != ranked.end() || rIter == mUBResults.end()) {
+      continue;
+    }
+
+    auto result = rIter->second;
+    switch (rankType) {
+      case 0:
+        result->SetTournamentRank(0);
+        break;
+      case 1:
+        result->SetAllTimeRank(0);
+        break;
+      default:
+        result->SetTopPointRank(0);
+        break;
+    }
+
+    updated.insert(result);
+  }
+
+  index.Ranked = ranked;
+
+  return recalcMin;
 }
 
 bool WorldSyncManager::EndTournament(
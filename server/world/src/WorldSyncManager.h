@@ -35,6 +35,10 @@
 // object Includes
 #include <SearchEntry.h>
 
+// Standard C++11 Includes
+#include <functional>
+#include <set>
+
 namespace objects {
 class ChannelLogin;
 class Character;
@@ -42,6 +46,7 @@ class InstanceAccess;
 class MatchEntry;
 class PentalphaMatch;
 class PvPMatch;
+class UBResult;
 class UBTournament;
 }  // namespace objects
 
@@ -178,6 +183,23 @@ class WorldSyncManager : public libcomp::DataSyncManager {
   void StartTeamPvPMatch(uint32_t time, uint8_t type);
 
  private:
+  /**
+   * In memory ordering of UBResults for one ranking category used to
+   * recalculate the top ranks without reloading and sorting every result.
+   */
+  struct UBRankIndex {
+    /// Points and result UUIDs ordered from highest points to lowest
+    std::set<std::pair<uint32_t, libcomp::String>,
+             std::greater<std::pair<uint32_t, libcomp::String>>>
+        Order;
+
+    /// Points currently indexed for each result UUID
+    std::unordered_map<libcomp::String, uint32_t> Points;
+
+    /// UUIDs of each indexed result that currently has a rank set
+    std::set<libcomp::String> Ranked;
+  };
+
   /**
    * Update the number of search entries associated to a specific character
    * for quick access operations later. This function is NOT thread safe
@@ -229,6 +251,22 @@ class WorldSyncManager : public libcomp::DataSyncManager {
   std::unordered_map<int32_t, std::list<std::shared_ptr<objects::MatchEntry>>>
   GetMatchEntryTeams(uint8_t type);
 
+  /**
+   * Add a match entry to the queue index for its match type and team,
+   * ordered by entry time. This function is NOT thread safe and requires
+   * the caller to lock mutex access before calling.
+   * @param entry Pointer to the match entry to add
+   */
+  void QueueMatchEntry(const std::shared_ptr<objects::MatchEntry>& entry);
+
+  /**
+   * Remove a match entry from the queue index for its match type and
+   * team. This function is NOT thread safe and requires the caller to
+   * lock mutex access before calling.
+   * @param entry Pointer to the match entry to remove
+   */
+  void DequeueMatchEntry(const std::shared_ptr<objects::MatchEntry>& entry);
+
   /**
    * End the supplied PentalphaMatch by properly updating all participating
    * players and closing out their match entries
@@ -252,6 +290,43 @@ class WorldSyncManager : public libcomp::DataSyncManager {
    */
   bool RecalculateUBRankings();
 
+  /**
+   * Load all UBResults for the specified tournament (or all time results
+   * if null) into the UB ranking indexes if they have not been loaded yet.
+   * Once loaded, the indexes are kept current by IndexUBResult. This
+   * function is NOT thread safe and requires the caller to lock mutex
+   * access before calling.
+   * @param tournamentUID UID of the tournament to load or NULLUUID for
+   *  the tournament independent results
+   */
+  void LoadUBRankIndex(const libobjgen::UUID& tournamentUID);
+
+  /**
+   * Add, update or remove a UBResult from any loaded UB ranking index it
+   * belongs to. This function is NOT thread safe and requires the caller
+   * to lock mutex access before calling.
+   * @param result Pointer to the UBResult that was updated
+   * @param remove true if the result is being removed
+   */
+  void IndexUBResult(const std::shared_ptr<objects::UBResult>& result,
+                     bool remove = false);
+
+  /**
+   * Recalculate the top 10 ranks of one UB ranking category from its
+   * index. Only the top entries and entries that were previously ranked
+   * are visited. This function is NOT thread safe and requires the
+   * caller to lock mutex access before calling.
+   * @param index UB ranking index to recalculate
+   * @param rankType Ranking category: 0 for tournament rank, 1 for all
+   *  time rank and 2 for top point rank
+   * @param updated Output set of results with changed ranks
+   * @return Points of the 11th highest entry or 0 if there is none, used
+   *  to determine when the next recalculation is needed
+   */
+  uint32_t RankUBResults(
+      UBRankIndex& index, uint8_t rankType,
+      std::set<std::shared_ptr<objects::UBResult>>& updated);
+
   /**
    * End the supplied UBTournament by properly updating the rankings and
    * send the results to the channels
@@ -288,6 +363,14 @@ class WorldSyncManager : public libcomp::DataSyncManager {
   std::unordered_map<int32_t, std::shared_ptr<objects::MatchEntry>>
       mMatchEntries;
 
+  /// Queued match entries indexed by match type then team ID (0 for solo
+  /// entries). Each list is kept in entry time order so match checks only
+  /// need to look at the queue for the type being checked.
+  std::unordered_map<
+      uint8_t, std::unordered_map<
+                   int32_t, std::list<std::shared_ptr<objects::MatchEntry>>>>
+      mMatchQueues;
+
   /// Pointer to the currently active pentalpha match
   std::shared_ptr<objects::PentalphaMatch> mPentalphaMatch;
 
@@ -309,6 +392,21 @@ class WorldSyncManager : public libcomp::DataSyncManager {
   /// index order)
   std::array<uint32_t, 3> mUBRecalcMin;
 
+  /// UBResults in any loaded UB ranking index by UUID string
+  std::unordered_map<libcomp::String, std::shared_ptr<objects::UBResult>>
+      mUBResults;
+
+  /// UB ranking indexes of tournament points by tournament UUID string
+  std::unordered_map<libcomp::String, UBRankIndex> mUBTournamentRanks;
+
+  /// UB ranking indexes of tournament independent results ordered by
+  /// all time points (0) and top points (1)
+  std::array<UBRankIndex, 2> mUBRanks;
+
+  /// Indicates that the tournament independent results have been loaded
+  /// into mUBRanks
+  bool mUBRanksLoaded;
+
   /// Next match ID to use for any matches prepared by the server
   uint32_t mNextMatchID;
 
@@ -161,6 +161,11 @@ void FriendRequestAccepted(
       failed = true;
     }
 
+    if (!failed) {
+      characterManager->AddFriendLink(cLogin->GetWorldCID(),
+                                      targetLogin->GetWorldCID());
+    }
+
     auto channel =
         server->GetChannelConnectionByID(targetLogin->GetChannelID());
     if (!failed) {
@@ -277,6 +282,9 @@ void FriendRemoved(std::shared_ptr<WorldServer> server,
     }
 
     if (!failed) {
+      server->GetCharacterManager()->RemoveFriendLink(
+          cLogin->GetWorldCID(), targetLogin->GetWorldCID());
+
       libcomp::Packet request;
       request.WritePacketCode(InternalPacketCode_t::PACKET_FRIENDS_UPDATE);
       request.WriteU8((uint8_t)InternalPacketAction_t::PACKET_ACTION_REMOVE);
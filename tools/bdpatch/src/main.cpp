@@ -28,13 +28,21 @@
 #include "BinaryData.h"
 
 // Standard C++11 Includes
+#include <algorithm>
+#include <atomic>
 #include <fstream>
 #include <iostream>
 #include <map>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <vector>
 
 // libcomp Includes
 #include <ArgumentParser.h>
 #include <Constants.h>
+#include <Crypto.h>
 #include <Log.h>
 #include <Object.h>
 
@@ -54,15 +62,27 @@ class CommandLineParser : public libcomp::ArgumentParser {
  public:
   CommandLineParser();
   virtual ~CommandLineParser();
+
+  /// Number of tables to convert at the same time in batch mode.
+  size_t mJobCount;
+
+  /// Character encoding set on the command line, empty for the default.
+  libcomp::String mEncoding;
 };
 
-CommandLineParser::CommandLineParser() : libcomp::ArgumentParser() {
+typedef std::map<
+    std::string,
+    std::pair<std::string, std::function<libhack::BinaryDataSet*(void)>>>
+    BinaryTypeMap;
+
+CommandLineParser::CommandLineParser()
+    : libcomp::ArgumentParser(),
+      mJobCount(std::thread::hardware_concurrency()) {
   RegisterArgument(
       'e', "encoding", ArgumentType::REQUIRED,
       std::bind(
           [](CommandLineParser* pParser, ArgumentParser::Argument* pArg,
              const libcomp::String& arg) -> bool {
-            (void)pParser;
             (void)pArg;
 
             libcomp::Convert::Encoding_t encoding =
@@ -73,6 +93,7 @@ CommandLineParser::CommandLineParser() : libcomp::ArgumentParser() {
 
             if (ok) {
               libcomp::Convert::SetDefaultEncoding(encoding);
+              pParser->mEncoding = arg;
             } else {
               std::cerr << "Unknown character encoding: " << arg << std::endl;
               std::cerr << "Valid encodings: " << arg << std::endl;
@@ -87,22 +108,39 @@ CommandLineParser::CommandLineParser() : libcomp::ArgumentParser() {
             return ok;
           },
           this, std::placeholders::_1, std::placeholders::_2));
+
+  RegisterArgument(
+      'j', "jobs", ArgumentType::REQUIRED,
+      std::bind(
+          [](CommandLineParser* pParser, ArgumentParser::Argument* pArg,
+             const libcomp::String& arg) -> bool {
+            (void)pArg;
+
+            bool ok = false;
+            pParser->mJobCount = arg.ToInteger<size_t>(&ok);
+
+            if (!ok || 0 == pParser->mJobCount) {
+              std::cerr << "Invalid job count: " << arg << std::endl;
+
+              return false;
+            }
+
+            return true;
+          },
+          this, std::placeholders::_1, std::placeholders::_2));
 }
 
 CommandLineParser::~CommandLineParser() {}
 
-int Usage(
-    const char* szAppName,
-    const std::map<
-        std::string,
-        std::pair<std::string, std::function<libhack::BinaryDataSet*(void)>>>&
-        binaryTypes) {
+int Usage(const char* szAppName, const BinaryTypeMap& binaryTypes) {
   std::cerr << "USAGE: " << szAppName << " [OPTION]... load TYPE IN OUT"
             << std::endl;
   std::cerr << "USAGE: " << szAppName << " [OPTION]... save TYPE IN OUT"
             << std::endl;
   std::cerr << "USAGE: " << szAppName << " [OPTION]... flatten TYPE IN OUT"
             << std::endl;
+  std::cerr << "USAGE: " << szAppName << " [OPTION]... batch MANIFEST"
+            << std::endl;
   std::cerr << std::endl;
   std::cerr << "TYPE indicates the format of the BinaryData and can "
             << "be one of:" << std::endl;
@@ -120,6 +158,13 @@ int Usage(
   std::cerr << std::endl;
   std::cerr << "Mode 'flatten' will take the input BinaryData file and "
             << "write the output text file." << std::endl;
+  std::cerr << std::endl;
+  std::cerr << "Mode 'batch' will run every 'MODE TYPE IN OUT' line of the "
+            << "manifest file. Lines starting with '#' are ignored. The "
+            << "hash of each input is saved to MANIFEST.state and tables "
+            << "with an unchanged input and an existing output are skipped. "
+            << "Delete the state file to convert every table again."
+            << std::endl;
 
   std::cerr << std::endl;
   std::cerr << "Mandatory arguments to long options are mandatory for short "
@@ -128,6 +173,9 @@ int Usage(
   std::cerr << "  -e, --encoding=ENC          set encoding used for conversion "
                "(default=cp932)"
             << std::endl;
+  std::cerr << "  -j, --jobs=N                number of tables to convert at "
+               "the same time in batch mode"
+            << std::endl;
   std::cerr << std::endl;
   std::cerr << "Valid encodings:" << std::endl;
 
@@ -138,37 +186,32 @@ int Usage(
   return EXIT_FAILURE;
 }
 
-int main(int argc, char* argv[]) {
-  CommandLineParser args;
-
-  auto binaryTypes = EnumerateBinaryDataTypes();
-
-  if (!args.Parse(argc, argv) || (4 != args.GetStandardArguments().size())) {
-    return Usage(argv[0], binaryTypes);
-  }
-
-  libhack::Log::GetSingletonPtr()->AddStandardOutputHook();
-
-  auto standardArgs = args.GetStandardArguments();
-  libcomp::String mode = standardArgs[0];
-  libcomp::String bdType = standardArgs[1];
-  libcomp::String inPath = standardArgs[2];
-  libcomp::String outPath = standardArgs[3];
-
-  if ("load" != mode && "save" != mode && "flatten" != mode) {
-    return Usage(argv[0], binaryTypes);
-  }
-
-  libhack::BinaryDataSet* pSet = nullptr;
+/**
+ * Convert a single table.
+ * @param mode Conversion mode (load, save or flatten)
+ * @param bdType Type of the BinaryData
+ * @param inPath Path to the input file
+ * @param outPath Path to the output file
+ * @param binaryTypes Map of every BinaryData type
+ * @param err Stream to write any errors to
+ * @return true if the table was converted
+ */
+bool ConvertTable(const libcomp::String& mode, const libcomp::String& bdType,
+                  const libcomp::String& inPath,
+                  const libcomp::String& outPath,
+                  const BinaryTypeMap& binaryTypes, std::ostream& err) {
+  std::unique_ptr<libhack::BinaryDataSet> pSet;
 
   auto match = binaryTypes.find(bdType.ToUtf8());
 
   if (binaryTypes.end() != match) {
-    pSet = (match->second.second)();
+    pSet.reset((match->second.second)());
   }
 
   if (!pSet) {
-    return Usage(argv[0], binaryTypes);
+    err << "Unknown BinaryData type: " << bdType << std::endl;
+
+    return false;
   }
 
   if ("qmp" == bdType && ("load" == mode || "flatten" == mode)) {
@@ -181,19 +224,19 @@ int main(int argc, char* argv[]) {
     file.read(reinterpret_cast<char*>(&magic), sizeof(magic));
 
     if (magic != QMP_FORMAT_MAGIC) {
-      std::cerr << "File magic invlalid for Qmp file: " << inPath << std::endl;
+      err << "File magic invlalid for Qmp file: " << inPath << std::endl;
 
-      return EXIT_FAILURE;
+      return false;
     }
 
     auto qmp = std::make_shared<objects::QmpFile>();
     if (!qmp->Load(file)) {
-      std::cerr << "Failed to load Qmp file: " << inPath << std::endl;
+      err << "Failed to load Qmp file: " << inPath << std::endl;
 
-      return EXIT_FAILURE;
+      return false;
     }
 
-    ((ManualBinaryDataSet*)pSet)->AddRecord(qmp);
+    ((ManualBinaryDataSet*)pSet.get())->AddRecord(qmp);
   }
 
   if ("load" == mode) {
@@ -202,21 +245,20 @@ int main(int argc, char* argv[]) {
       file.open(inPath.C(), std::ifstream::binary);
 
       if (!pSet->Load(file)) {
-        std::cerr << "Failed to load file: " << inPath << std::endl;
+        err << "Failed to load file: " << inPath << std::endl;
 
-        return EXIT_FAILURE;
+        return false;
       }
     }
 
     std::ofstream out;
     out.open(outPath.C());
 
-    out << pSet->GetXml().c_str();
+    // Stream the XML instead of building it as one string.
+    if (!pSet->WriteXml(out)) {
+      err << "Failed to save file: " << outPath << std::endl;
 
-    if (!out.good()) {
-      std::cerr << "Failed to save file: " << outPath << std::endl;
-
-      return EXIT_FAILURE;
+      return false;
     }
   } else if ("flatten" == mode) {
     if ("qmp" != bdType) {
@@ -224,9 +266,9 @@ int main(int argc, char* argv[]) {
       file.open(inPath.C(), std::ifstream::binary);
 
       if (!pSet->Load(file)) {
-        std::cerr << "Failed to load file: " << inPath << std::endl;
+        err << "Failed to load file: " << inPath << std::endl;
 
-        return EXIT_FAILURE;
+        return false;
       }
     }
 
@@ -236,23 +278,23 @@ int main(int argc, char* argv[]) {
     out << pSet->GetTabular().c_str();
 
     if (!out.good()) {
-      std::cerr << "Failed to save file: " << outPath << std::endl;
+      err << "Failed to save file: " << outPath << std::endl;
 
-      return EXIT_FAILURE;
+      return false;
     }
   } else if ("save" == mode) {
     tinyxml2::XMLDocument doc;
 
     if (tinyxml2::XML_SUCCESS != doc.LoadFile(inPath.C())) {
-      std::cerr << "Failed to parse file: " << inPath << std::endl;
+      err << "Failed to parse file: " << inPath << std::endl;
 
-      return EXIT_FAILURE;
+      return false;
     }
 
     if (!pSet->LoadXml(doc)) {
-      std::cerr << "Failed to load file: " << inPath << std::endl;
+      err << "Failed to load file: " << inPath << std::endl;
 
-      return EXIT_FAILURE;
+      return false;
     }
 
     std::ofstream out;
@@ -266,18 +308,250 @@ int main(int argc, char* argv[]) {
       // Write (single) entry manually
       for (auto obj : pSet->GetObjects()) {
         if (!obj->Save(out) || !out.good()) {
-          std::cerr << "Failed to save QMP file: " << outPath << std::endl;
+          err << "Failed to save QMP file: " << outPath << std::endl;
 
-          return EXIT_FAILURE;
+          return false;
         }
       }
     } else {
       if (!pSet->Save(out)) {
-        std::cerr << "Failed to save file: " << outPath << std::endl;
+        err << "Failed to save file: " << outPath << std::endl;
 
-        return EXIT_FAILURE;
+        return false;
       }
     }
+  } else {
+    err << "Unknown mode: " << mode << std::endl;
+
+    return false;
+  }
+
+  return true;
+}
+
+/**
+ * Single table conversion listed in a batch manifest.
+ */
+class BatchJob {
+ public:
+  libcomp::String mode;
+  libcomp::String bdType;
+  libcomp::String inPath;
+  libcomp::String outPath;
+
+  /// Key used to find the job in the state file.
+  libcomp::String key;
+
+  /// Hash of the input file.
+  libcomp::String hash;
+
+  /// If the conversion was skipped or succeeded.
+  bool ok = false;
+};
+
+/**
+ * Convert every table listed in a manifest file.
+ * @param manifestPath Path to the manifest file
+ * @param jobCount Number of tables to convert at the same time
+ * @param encoding Character encoding set on the command line, empty for
+ *  the default
+ * @param binaryTypes Map of every BinaryData type
+ * @return Exit code for the application
+ */
+int RunBatch(const libcomp::String& manifestPath, size_t jobCount,
+             const libcomp::String& encoding,
+             const BinaryTypeMap& binaryTypes) {
+  std::ifstream manifest(manifestPath.C());
+
+  if (!manifest.good()) {
+    std::cerr << "Failed to open manifest: " << manifestPath << std::endl;
+
+    return EXIT_FAILURE;
+  }
+
+  std::vector<BatchJob> jobs;
+  std::map<std::string, int> outputLines;
+  std::string line;
+  int lineNumber = 0;
+
+  while (std::getline(manifest, line)) {
+    lineNumber++;
+
+    std::istringstream ss(line);
+    std::string mode, bdType, inPath, outPath, extra;
+
+    if (!(ss >> mode) || '#' == mode[0]) {
+      continue;
+    }
+
+    if (!(ss >> bdType >> inPath >> outPath) || (ss >> extra) ||
+        ("load" != mode && "save" != mode && "flatten" != mode) ||
+        binaryTypes.end() == binaryTypes.find(bdType)) {
+      std::cerr << "Invalid manifest line " << lineNumber << ": " << line
+                << std::endl;
+
+      return EXIT_FAILURE;
+    }
+
+    // Two jobs writing the same file would race across the workers.
+    auto output = outputLines.find(outPath);
+
+    if (outputLines.end() != output) {
+      std::cerr << "Manifest line " << lineNumber << " writes the same output "
+                << "as line " << output->second << ": " << outPath
+                << std::endl;
+
+      return EXIT_FAILURE;
+    }
+
+    outputLines[outPath] = lineNumber;
+
+    BatchJob job;
+    job.mode = mode;
+    job.bdType = bdType;
+    job.inPath = inPath;
+    job.outPath = outPath;
+    // The encoding changes the output so it is part of the key too.
+    job.key = libcomp::String("%1 %2 %3 %4 %5")
+                  .Arg(encoding.IsEmpty() ? libcomp::String("default")
+                                          : encoding)
+                  .Arg(job.mode)
+                  .Arg(job.bdType)
+                  .Arg(job.inPath)
+                  .Arg(job.outPath);
+
+    jobs.push_back(job);
+  }
+
+  // Load the input hashes from the last run.
+  libcomp::String statePath = manifestPath + ".state";
+  std::map<libcomp::String, libcomp::String> lastHashes;
+
+  {
+    std::ifstream state(statePath.C());
+
+    while (std::getline(state, line)) {
+      auto pos = line.find(' ');
+
+      if (std::string::npos != pos) {
+        lastHashes[line.substr(pos + 1)] = line.substr(0, pos);
+      }
+    }
+  }
+
+  std::mutex errorLock;
+  std::atomic<size_t> nextJob(0);
+  std::atomic<size_t> skipped(0);
+
+  auto worker = [&]() {
+    for (size_t idx = nextJob++; idx < jobs.size(); idx = nextJob++) {
+      auto& job = jobs[idx];
+
+      auto data = libcomp::Crypto::LoadFile(job.inPath.ToUtf8());
+      job.hash = libcomp::Crypto::MD5(data);
+
+      // Skip tables with the same input as the last run if the output is
+      // still there.
+      auto it = lastHashes.find(job.key);
+
+      if (!data.empty() && lastHashes.end() != it && it->second == job.hash &&
+          std::ifstream(job.outPath.C()).good()) {
+        job.ok = true;
+        skipped++;
+
+        continue;
+      }
+
+      std::stringstream err;
+      job.ok = ConvertTable(job.mode, job.bdType, job.inPath, job.outPath,
+                            binaryTypes, err);
+
+      if (!job.ok) {
+        std::lock_guard<std::mutex> lock(errorLock);
+        std::cerr << err.str();
+      }
+    }
+  };
+
+  std::vector<std::thread> workers;
+
+  for (size_t i = 1; i < std::min(jobCount, jobs.size()); i++) {
+    workers.push_back(std::thread(worker));
+  }
+
+  worker();
+
+  for (auto& t : workers) {
+    t.join();
+  }
+
+  // Save the input hashes of the tables that were converted. Failed tables
+  // are left out so they are converted again next time.
+  size_t failed = 0;
+
+  std::ofstream state(statePath.C());
+
+  for (auto& job : jobs) {
+    if (job.ok) {
+      state << job.hash << " " << job.key << std::endl;
+    } else {
+      failed++;
+    }
+  }
+
+  std::cout << "Converted " << (jobs.size() - skipped - failed)
+            << " table(s), skipped " << skipped << " unchanged table(s)";
+
+  if (failed) {
+    std::cout << ", failed to convert " << failed << " table(s)";
+  }
+
+  std::cout << "." << std::endl;
+
+  return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+
+int main(int argc, char* argv[]) {
+  CommandLineParser args;
+
+  auto binaryTypes = EnumerateBinaryDataTypes();
+
+  if (!args.Parse(argc, argv)) {
+    return Usage(argv[0], binaryTypes);
+  }
+
+  auto standardArgs = args.GetStandardArguments();
+
+  bool isBatch = 2 == standardArgs.size() && "batch" == standardArgs[0];
+
+  if (!isBatch && 4 != standardArgs.size()) {
+    return Usage(argv[0], binaryTypes);
+  }
+
+  libhack::Log::GetSingletonPtr()->AddStandardOutputHook();
+
+  int result = EXIT_SUCCESS;
+
+  if (isBatch) {
+    result = RunBatch(standardArgs[1], args.mJobCount, args.mEncoding,
+                      binaryTypes);
+  } else {
+    libcomp::String mode = standardArgs[0];
+    libcomp::String bdType = standardArgs[1];
+    libcomp::String inPath = standardArgs[2];
+    libcomp::String outPath = standardArgs[3];
+
+    if ("load" != mode && "save" != mode && "flatten" != mode) {
+      return Usage(argv[0], binaryTypes);
+    }
+
+    if (binaryTypes.end() == binaryTypes.find(bdType.ToUtf8())) {
+      return Usage(argv[0], binaryTypes);
+    }
+
+    if (!ConvertTable(mode, bdType, inPath, outPath, binaryTypes, std::cerr)) {
+      result = EXIT_FAILURE;
+    }
   }
 
 #ifndef EXOTIC_PLATFORM
@@ -285,5 +559,5 @@ int main(int argc, char* argv[]) {
   delete libhack::Log::GetSingletonPtr();
 #endif  // !EXOTIC_PLATFORM
 
-  return EXIT_SUCCESS;
+  return result;
 }
@@ -0,0 +1,184 @@
+/**
+ * @file tools/capgrep/src/CaptureFile.cpp
+ * @ingroup capgrep
+ *
+ * @author COMP Omega <compomega@tutanota.com>
+ *
+ * @brief Memory mapped capture file with a record index.
+ *
+ * Copyright (C) 2010-2020 COMP_hack Team <compomega@tutanota.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "CaptureFile.h"
+
+// Standard C Includes
+#include <string.h>
+
+static const uint32_t FORMAT_MAGIC = 0x4B434148;   // HACK
+static const uint32_t FORMAT_MAGIC2 = 0x504D4F43;  // COMP
+static const uint32_t FORMAT_VER1 = 0x00010000;  // Major, Minor, Patch (1.0.0)
+static const uint32_t FORMAT_VER2 = 0x00010100;  // Major, Minor, Patch (1.1.0)
+
+CaptureFile::CaptureFile()
+    : mData(0),
+      mSize(0),
+      mFirstRecord(0),
+      mMapped(false),
+      mMagic(0),
+      mVersion(0) {}
+
+CaptureFile::~CaptureFile() { close(); }
+
+bool CaptureFile::open(const QString &path) {
+  close();
+
+  mFile.setFileName(path);
+
+  if (!mFile.open(QIODevice::ReadOnly)) return false;
+
+  mSize = mFile.size();
+
+  // Map the whole file. If the file can't be mapped (it's not a regular
+  // file, etc.) fall back to reading it into memory in one shot.
+  uchar *mapped = mSize > 0 ? mFile.map(0, mSize) : 0;
+
+  if (mapped) {
+    mData = (const char *)mapped;
+    mMapped = true;
+  } else {
+    mBuffer = mFile.readAll();
+    mData = mBuffer.constData();
+    mSize = mBuffer.size();
+  }
+
+  qint64 offset = 0;
+
+  if (mSize < 8) {
+    close();
+
+    return false;
+  }
+
+  memcpy(&mMagic, mData, 4);
+  memcpy(&mVersion, mData + 4, 4);
+  offset += 8;
+
+  if ((mMagic != FORMAT_MAGIC && mMagic != FORMAT_MAGIC2) ||
+      (mVersion != FORMAT_VER1 && mVersion != FORMAT_VER2)) {
+    close();
+
+    return false;
+  }
+
+  // Skip the capture time stamp.
+  offset += (mVersion == FORMAT_VER1) ? 4 : 8;
+
+  uint32_t addrlen = 0;
+
+  if ((offset + 4) > mSize) {
+    close();
+
+    return false;
+  }
+
+  memcpy(&addrlen, mData + offset, 4);
+  offset += 4;
+
+  // Skip the server address.
+  if ((offset + addrlen) > mSize) {
+    close();
+
+    return false;
+  }
+
+  mFirstRecord = offset + addrlen;
+
+  return true;
+}
+
+void CaptureFile::close() {
+  if (mMapped) mFile.unmap((uchar *)mData);
+
+  mFile.close();
+  mBuffer.clear();
+  mRecords.clear();
+
+  mData = 0;
+  mSize = 0;
+  mFirstRecord = 0;
+  mMapped = false;
+  mMagic = 0;
+  mVersion = 0;
+}
+
+bool CaptureFile::buildIndex() {
+  mRecords.clear();
+
+  if (!mData) return false;
+
+  qint64 headerSize = (mVersion == FORMAT_VER1) ? (1 + 4 + 4) : (1 + 8 + 8 + 4);
+  qint64 offset = mFirstRecord;
+
+  while (offset < mSize) {
+    if ((offset + headerSize) > mSize) return false;
+
+    CaptureRecord record;
+    record.stamp = 0;
+    record.micro = 0;
+
+    const char *header = mData + offset;
+
+    memcpy(&record.source, header, 1);
+    header += 1;
+
+    if (mVersion == FORMAT_VER1) {
+      memcpy(&record.stamp, header, 4);
+      header += 4;
+    } else {
+      memcpy(&record.stamp, header, 8);
+      header += 8;
+
+      memcpy(&record.micro, header, 8);
+      header += 8;
+    }
+
+    memcpy(&record.size, header, 4);
+
+    record.offset = offset + headerSize;
+
+    if ((record.offset + record.size) > mSize) return false;
+
+    mRecords.append(record);
+
+    offset = record.offset + record.size;
+  }
+
+  return true;
+}
+
+QString CaptureFile::path() const { return mFile.fileName(); }
+
+bool CaptureFile::isLobby() const { return FORMAT_MAGIC2 == mMagic; }
+
+uint32_t CaptureFile::version() const { return mVersion; }
+
+const QVector<CaptureRecord> &CaptureFile::records() const { return mRecords; }
+
+const char *CaptureFile::recordData(const CaptureRecord &record) const {
+  return mData + record.offset;
+}
+
+bool CaptureFile::isMapped() const { return mMapped; }
@@ -0,0 +1,140 @@
+/**
+ * @file tools/capgrep/src/CaptureFile.h
+ * @ingroup capgrep
+ *
+ * @author COMP Omega <compomega@tutanota.com>
+ *
+ * @brief Memory mapped capture file with a record index.
+ *
+ * Copyright (C) 2010-2020 COMP_hack Team <compomega@tutanota.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TOOLS_CAPGREP_SRC_CAPTUREFILE_H
+#define TOOLS_CAPGREP_SRC_CAPTUREFILE_H
+
+#include <stdint.h>
+
+// Ignore warnings
+#include <PushIgnore.h>
+
+#include <QByteArray>
+#include <QFile>
+#include <QString>
+#include <QVector>
+
+// Stop ignoring warnings
+#include <PopIgnore.h>
+
+/**
+ * Location and header values of a single record in a capture file. The
+ * record data itself stays in the mapped file until it is decoded.
+ */
+class CaptureRecord {
+ public:
+  qint64 offset;
+  uint64_t stamp;
+  uint64_t micro;
+  uint32_t size;
+  uint8_t source;
+};
+
+/**
+ * Capture file written by the logger. The file is memory mapped (or read in
+ * one shot if mapping is not possible) and an index of every record is built
+ * so the records can be walked without copying them into a read buffer. The
+ * data returned by @ref recordData stays valid until the capture is closed
+ * or destroyed.
+ */
+class CaptureFile {
+ public:
+  CaptureFile();
+  ~CaptureFile();
+
+  /**
+   * Open and map the capture file and check the file header. The record
+   * index is not built until @ref buildIndex is called.
+   * @param path Path to the capture file.
+   * @returns true if the file was opened and has a valid header.
+   */
+  bool open(const QString &path);
+
+  /**
+   * Unmap and close the capture file and clear the record index.
+   */
+  void close();
+
+  /**
+   * Build the record index. This only reads the mapped file so it may be
+   * called from a thread other than the one that opened the file. A record
+   * cut short at the end of the file is left out of the index.
+   * @returns true if every record in the file was indexed.
+   */
+  bool buildIndex();
+
+  /**
+   * Get the path the capture was opened from.
+   * @returns Path to the capture file.
+   */
+  QString path() const;
+
+  /**
+   * Check if the capture was written by the lobby logger.
+   * @returns true if the capture contains lobby traffic.
+   */
+  bool isLobby() const;
+
+  /**
+   * Get the capture format version.
+   * @returns Capture format version.
+   */
+  uint32_t version() const;
+
+  /**
+   * Get the record index built by @ref buildIndex.
+   * @returns List of every complete record in the capture.
+   */
+  const QVector<CaptureRecord> &records() const;
+
+  /**
+   * Get a pointer to the data of a record.
+   * @param record Record from the index of this capture.
+   * @returns Pointer to the record data inside the mapped file.
+   */
+  const char *recordData(const CaptureRecord &record) const;
+
+  /**
+   * Check if the record data points into a memory mapped file. If it does
+   * the data may be shared with QByteArray::fromRawData instead of copied.
+   * @returns true if the capture file is memory mapped.
+   */
+  bool isMapped() const;
+
+ private:
+  QFile mFile;
+  QByteArray mBuffer;
+
+  const char *mData;
+  qint64 mSize;
+  qint64 mFirstRecord;
+  bool mMapped;
+
+  uint32_t mMagic;
+  uint32_t mVersion;
+
+  QVector<CaptureRecord> mRecords;
+};
+
+#endif  // TOOLS_CAPGREP_SRC_CAPTUREFILE_H
@@ -0,0 +1,287 @@
+/**
+ * @file tools/capgrep/src/CaptureLoader.cpp
+ * @ingroup capgrep
+ *
+ * @author COMP Omega <compomega@tutanota.com>
+ *
+ * @brief Thread that indexes and decodes capture files.
+ *
+ * Copyright (C) 2010-2020 COMP_hack Team <compomega@tutanota.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "CaptureLoader.h"
+
+// Standard C Includes
+#include <string.h>
+
+// libcomp
+#include <Endian.h>
+#include <zlib.h>
+
+// Standard C++11 Includes
+#include <thread>
+#include <vector>
+
+static int uncompressChunk(const void *src, void *dest, int in_size,
+                           int chunk_size) {
+  z_stream strm;
+
+  strm.zalloc = Z_NULL;
+  strm.zfree = Z_NULL;
+  strm.opaque = Z_NULL;
+
+  strm.avail_in = static_cast<uInt>(in_size);
+  strm.next_in = (Bytef *)src;
+
+  if (inflateInit(&strm) != Z_OK) return 0;
+
+  strm.avail_out = static_cast<uInt>(chunk_size);
+  strm.next_out = (Bytef *)dest;
+
+  if (inflate(&strm, Z_FINISH) != Z_STREAM_END) return 0;
+
+  int written = chunk_size - static_cast<int>(strm.avail_out);
+
+  if (inflateEnd(&strm) != Z_OK) return 0;
+
+  return written;
+}
+
+static uint16_t readU16Little(const char *data) {
+  uint16_t value;
+  memcpy(&value, data, sizeof(value));
+
+  return le16toh(value);
+}
+
+static uint32_t readU32Big(const char *data) {
+  uint32_t value;
+  memcpy(&value, data, sizeof(value));
+
+  return be32toh(value);
+}
+
+static int32_t readS32Little(const char *data) {
+  uint32_t value;
+  memcpy(&value, data, sizeof(value));
+
+  return (int32_t)le32toh(value);
+}
+
+CaptureLoader::CaptureLoader(int id, const QList<CaptureLoadData *> &captures,
+                             QObject *p)
+    : QThread(p), mID(id), mCaptures(captures), mCancelled(false) {}
+
+CaptureLoader::~CaptureLoader() {
+  // The packets may point into the captures so delete them first.
+  foreach (PacketData *d, mPacketData)
+    delete d;
+
+  foreach (CaptureLoadData *cap, mCaptures)
+    delete cap;
+}
+
+void CaptureLoader::cancel() { mCancelled = true; }
+
+QList<PacketData *> CaptureLoader::takePacketData() {
+  QList<PacketData *> packetData = mPacketData;
+  mPacketData.clear();
+
+  return packetData;
+}
+
+QList<CaptureFile *> CaptureLoader::takeCaptures() {
+  QList<CaptureFile *> captures;
+
+  foreach (CaptureLoadData *cap, mCaptures) {
+    captures << cap->capture;
+    cap->capture = 0;
+
+    delete cap;
+  }
+
+  mCaptures.clear();
+
+  return captures;
+}
+
+QStringList CaptureLoader::truncatedPaths() const { return mTruncated; }
+
+void CaptureLoader::run() {
+  // Index each capture on its own thread. The index only reads the mapped
+  // file so the captures do not share anything.
+  std::vector<std::thread> indexers;
+
+  foreach (CaptureLoadData *cap, mCaptures) {
+    indexers.push_back(std::thread([cap]() {
+      if (!cap->capture->buildIndex()) {
+        cap->truncated = true;
+      }
+    }));
+  }
+
+  for (auto &indexer : indexers) {
+    indexer.join();
+  }
+
+  foreach (CaptureLoadData *cap, mCaptures) {
+    if (cap->truncated) mTruncated << cap->capture->path();
+  }
+
+  // Merge the records of every capture in time stamp order.
+  QList<CaptureLoadData *> pending;
+  int recordCount = 0;
+
+  foreach (CaptureLoadData *cap, mCaptures) {
+    if (!cap->capture->records().isEmpty()) pending << cap;
+
+    recordCount += cap->capture->records().count();
+  }
+
+  mPacketData.reserve(recordCount);
+
+  while (!pending.isEmpty()) {
+    if (mCancelled) return;
+
+    int index = 0;
+    uint64_t stamp = pending.first()->current().stamp;
+
+    for (int i = 1; i < pending.count(); i++) {
+      uint64_t nextStamp = pending.at(i)->current().stamp;
+      if (nextStamp >= stamp) continue;
+
+      stamp = nextStamp;
+      index = i;
+    }
+
+    CaptureLoadData *cap = pending.at(index);
+    const CaptureRecord &record = cap->current();
+
+    decode(mPacketData, record.source, record.stamp, record.micro,
+           cap->capture->recordData(record), record.size,
+           cap->capture->isLobby(), cap->state, cap->capture->isMapped());
+
+    // Move on to the next record
+    if (++cap->next >= cap->capture->records().count()) {
+      pending.removeAt(index);
+    }
+  }
+
+  if (!mCancelled) emit loaded(mID);
+}
+
+void CaptureLoader::decode(QList<PacketData *> &packetData, uint8_t source,
+                           uint64_t stamp, uint64_t micro, const char *data,
+                           uint32_t size, bool isLobby,
+                           CaptureLoadState *state, bool shared) {
+  // Decompressed packets are owned by this buffer instead of the capture.
+  QByteArray decompressed;
+
+  // Check for compression
+  if (!isLobby && size >= 24 && readU32Big(data + 8) == 0x677A6970) {
+    int32_t uncompressed_size = readS32Little(data + 12);
+    int32_t compressed_size = readS32Little(data + 16);
+
+    uint32_t lv6 = readU32Big(data + 20);
+
+    (void)lv6;
+
+    Q_ASSERT(lv6 == 0x6C763600);  // lv6
+
+    if (compressed_size != uncompressed_size && uncompressed_size > 0 &&
+        compressed_size > 0 && (24 + (uint32_t)compressed_size) <= size) {
+      decompressed.resize(24 + uncompressed_size);
+      memcpy(decompressed.data(), data, 24);
+
+      int written =
+          uncompressChunk(data + 24, decompressed.data() + 24,
+                          compressed_size, uncompressed_size);
+
+      decompressed.resize(24 + written);
+
+      data = decompressed.constData();
+      size = static_cast<uint32_t>(decompressed.size());
+      shared = false;
+    }
+  }
+
+  uint32_t offset = isLobby ? 8 : 24;
+
+  while (size >= offset && (size - offset) >= 6) {
+    offset += 2;  // Big endian size
+
+    uint32_t cmd_start = offset;
+    uint16_t cmd_size = readU16Little(data + offset);
+    offset += 2;
+
+    if (cmd_size < 4) continue;
+
+    // Stop at a command that runs past the end of the packet
+    if ((cmd_start + cmd_size) > size) break;
+
+    PacketData *d = new PacketData;
+    d->cmd = readU16Little(data + offset);
+    d->source = source;
+    d->micro = micro;
+
+    // Share the command data with the mapped capture when possible so the
+    // capture is not held in memory twice.
+    if (shared) {
+      d->data = QByteArray::fromRawData(data + cmd_start + 4, cmd_size - 4);
+    } else {
+      d->data = QByteArray(data + cmd_start + 4, cmd_size - 4);
+    }
+
+    if (d->cmd == 0x00F3 && d->data.size() >= 4) {
+      memcpy(&state->nextUpdate, d->data.constData(), 4);
+    } else if (d->cmd == 0x00F4 && d->data.size() >= 8) {
+      memcpy(&state->nextTicks, d->data.constData() + 4, 4);
+
+      if ((state->nextUpdate - state->lastUpdate) != 0) {
+        state->servRate =
+            (float)(state->nextTicks - state->lastTicks) /
+            (float)((state->nextUpdate - state->lastUpdate) * 1000);
+      }
+
+      state->lastTicks = state->nextTicks;
+      state->lastUpdate = state->nextUpdate;
+
+      state->nextTicks = 0;
+      state->nextUpdate = 0;
+    }
+
+    d->servRate = state->servRate;
+    d->servTime =
+        (uint32_t)((float)state->lastTicks +
+                   (((float)stamp - (float)state->lastUpdate) * d->servRate));
+
+    if (source == 0)
+      d->seq = state->packetSeqA;
+    else
+      d->seq = state->packetSeqB;
+
+    d->client = state->client;
+
+    packetData.append(d);
+
+    offset = cmd_start + cmd_size;
+  }
+
+  if (source == 0)
+    state->packetSeqA++;
+  else
+    state->packetSeqB++;
+}
@@ -0,0 +1,158 @@
+/**
+ * @file tools/capgrep/src/CaptureLoader.h
+ * @ingroup capgrep
+ *
+ * @author COMP Omega <compomega@tutanota.com>
+ *
+ * @brief Thread that indexes and decodes capture files.
+ *
+ * Copyright (C) 2010-2020 COMP_hack Team <compomega@tutanota.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TOOLS_CAPGREP_SRC_CAPTURELOADER_H
+#define TOOLS_CAPGREP_SRC_CAPTURELOADER_H
+
+#include <stdint.h>
+#include <time.h>
+
+// Standard C++11 Includes
+#include <atomic>
+
+// Ignore warnings
+#include <PushIgnore.h>
+
+#include <QList>
+#include <QStringList>
+#include <QThread>
+
+// Stop ignoring warnings
+#include <PopIgnore.h>
+
+#include "CaptureFile.h"
+#include "PacketData.h"
+
+class CaptureLoadState {
+ public:
+  float servRate;
+  uint16_t packetSeqA, packetSeqB;
+  uint32_t lastTicks, nextTicks;
+  time_t lastUpdate, nextUpdate;
+  int client;
+};
+
+class CaptureLoadData {
+ public:
+  CaptureFile *capture;
+  CaptureLoadState *state;
+  int next;
+  bool truncated;
+
+  CaptureLoadData() : capture(0), state(0), next(0), truncated(false) {}
+
+  ~CaptureLoadData() {
+    delete capture;
+    delete state;
+  }
+
+  const CaptureRecord &current() const { return capture->records().at(next); }
+};
+
+/**
+ * Thread that indexes a set of opened capture files and decodes their
+ * records in time stamp order. The loaded signal is emitted from the thread
+ * when every record has been decoded; the packets and captures may then be
+ * taken by the receiver. The loader never touches the packet list model.
+ */
+class CaptureLoader : public QThread {
+  Q_OBJECT
+
+ public:
+  /**
+   * Create a loader for a set of opened capture files.
+   * @param id ID passed to the loaded signal so stale results can be told
+   * apart from the current load.
+   * @param captures Captures to load. The loader takes ownership of them.
+   * @param parent Parent object.
+   */
+  CaptureLoader(int id, const QList<CaptureLoadData *> &captures,
+                QObject *parent = 0);
+  virtual ~CaptureLoader();
+
+  /**
+   * Ask the thread to stop decoding. Call wait() to wait for it to stop.
+   */
+  void cancel();
+
+  /**
+   * Take the decoded packets. Only call this after the loaded signal.
+   * @returns Decoded packets in time stamp order.
+   */
+  QList<PacketData *> takePacketData();
+
+  /**
+   * Take the capture files. The packets may point into the mapped captures
+   * so they must be kept open until the packets are deleted. Only call this
+   * after the loaded signal.
+   * @returns Capture files that were loaded.
+   */
+  QList<CaptureFile *> takeCaptures();
+
+  /**
+   * Get the paths of the captures that ended with a truncated record.
+   * @returns Paths of the truncated captures.
+   */
+  QStringList truncatedPaths() const;
+
+  /**
+   * Split a captured packet into its commands.
+   * @param packetData List to append a PacketData object per command to.
+   * @param source Source of the packet (0 = client, 1 = server).
+   * @param stamp Time stamp of the packet.
+   * @param micro Micro time stamp of the packet.
+   * @param data Packet data.
+   * @param size Size of the packet data.
+   * @param isLobby If the packet was captured by the lobby logger.
+   * @param state Decoding state of the capture the packet belongs to.
+   * @param shared If the command data may point into @p data instead of
+   * being copied.
+   */
+  static void decode(QList<PacketData *> &packetData, uint8_t source,
+                     uint64_t stamp, uint64_t micro, const char *data,
+                     uint32_t size, bool isLobby, CaptureLoadState *state,
+                     bool shared);
+
+ signals:
+  /**
+   * Emitted from the loader thread when every capture is decoded. It is
+   * not emitted if the loader was cancelled.
+   * @param id ID the loader was created with.
+   */
+  void loaded(int id);
+
+ protected:
+  virtual void run();
+
+ private:
+  int mID;
+
+  QList<CaptureLoadData *> mCaptures;
+  QList<PacketData *> mPacketData;
+  QStringList mTruncated;
+
+  std::atomic<bool> mCancelled;
+};
+
+#endif  // TOOLS_CAPGREP_SRC_CAPTURELOADER_H
@@ -54,37 +54,6 @@
 // libcomp
 #include <Convert.h>
 #include <Endian.h>
-#include <zlib.h>
-
-static const uint32_t FORMAT_MAGIC = 0x4B434148;   // HACK
-static const uint32_t FORMAT_MAGIC2 = 0x504D4F43;  // COMP
-static const uint32_t FORMAT_VER1 = 0x00010000;  // Major, Minor, Patch (1.0.0)
-static const uint32_t FORMAT_VER2 = 0x00010100;  // Major, Minor, Patch (1.1.0)
-
-static int uncompressChunk(const void *src, void *dest, int in_size,
-                           int chunk_size) {
-  z_stream strm;
-
-  strm.zalloc = Z_NULL;
-  strm.zfree = Z_NULL;
-  strm.opaque = Z_NULL;
-
-  strm.avail_in = static_cast<uInt>(in_size);
-  strm.next_in = (Bytef *)src;
-
-  if (inflateInit(&strm) != Z_OK) return 0;
-
-  strm.avail_out = static_cast<uInt>(chunk_size);
-  strm.next_out = (Bytef *)dest;
-
-  if (inflate(&strm, Z_FINISH) != Z_STREAM_END) return 0;
-
-  int written = chunk_size - static_cast<int>(strm.avail_out);
-
-  if (inflateEnd(&strm) != Z_OK) return 0;
-
-  return written;
-}
 
 static MainWindow *g_mainwindow = 0;
 
@@ -130,7 +99,9 @@ MainWindow::MainWindow(QWidget *p)
     : QMainWindow(p),
       mFilter(new PacketListFilter),
       mModel(new PacketListModel),
-      mLiveServer(0) {
+      mLiveServer(0),
+      mLoader(0),
+      mLoadID(0) {
   Q_ASSERT(g_mainwindow == 0);
 
   g_mainwindow = this;
@@ -146,6 +117,13 @@ MainWindow::MainWindow(QWidget *p)
   mDefaultState.packetSeqB = 0;
   mDefaultState.client = -1;
 
+  mCopyActions[0x0014] = &action0014;
+  mCopyActions[0x0015] = &action0015;
+  mCopyActions[0x0023] = &action0023;
+  mCopyActions[0x00A7] = &action00A7;
+  mCopyActions[0x00AC] = &action00AC;
+  mCopyActions[0x00B9] = &action00B9;
+
   mFilter->setSourceModel(mModel);
 
   ui.packetData->setContextMenuPolicy(Qt::CustomContextMenu);
@@ -297,6 +275,13 @@ MainWindow::MainWindow(QWidget *p)
   ui.statusbar->addPermanentWidget(mStatusBar, 1);
 }
 
+MainWindow::~MainWindow() {
+  stopLoading();
+
+  // Unmap the capture files still backing the loaded packets
+  releaseCaptures();
+}
+
 void MainWindow::updateRecentFiles() {
   QSettings settings;
   QStringList recentFiles;
@@ -370,10 +355,13 @@ void MainWindow::startLiveMode() {
   mLiveSockets.clear();
   mLiveStates.clear();
 
+  stopLoading();
+
   mModel->clear();
   ui.packetData->setData(QByteArray());
   ui.packetDetails->clear();
 
+  releaseCaptures();
   updateValues();
 
   mLiveServer = new QTcpServer;
@@ -488,177 +476,63 @@ void MainWindow::loadCaptures(const QStringList &inPaths) {
   mLiveSockets.clear();
   mLiveStates.clear();
 
+  stopLoading();
+
   mModel->clear();
   ui.packetData->setData(QByteArray());
   ui.packetDetails->clear();
 
+  releaseCaptures();
   updateValues();
 
   QList<CaptureLoadData *> capData;
 
-  // Variable to store list of loaded PacketData objects
-  QList<PacketData *> packetData;
-
   for (int i = 0; i < inPaths.count(); i++) {
     QString path = inPaths.at(i);
     if (path.isEmpty()) continue;
 
     addRecentFile(path);
 
-    CaptureLoadState *state = new CaptureLoadState;
-    state->servRate = 0;
-    state->lastTicks = 0;
-    state->nextTicks = 0;
-    state->lastUpdate = 0;
-    state->nextUpdate = 0;
-    state->packetSeqA = 0;
-    state->packetSeqB = 0;
-    state->client = i;
+    CaptureFile *capture = new CaptureFile;
 
-    QFile *file = new QFile(path);
-    if (!file->open(QIODevice::ReadOnly)) {
-      foreach (CaptureLoadData *cap, capData) {
-        delete cap->file;
-        cap->file = nullptr;
-
-        delete cap->state;
-        cap->state = nullptr;
+    if (!capture->open(path)) {
+      delete capture;
 
+      foreach (CaptureLoadData *cap, capData)
         delete cap;
-        cap = nullptr;
-      }
 
       QMessageBox::critical(this, tr("Capture File Error"),
-                            tr("Failed to open the capture file."));
+                            tr("Failed to open the capture file or the "
+                               "capture file is invalid or corrupt."));
 
       return;
     }
 
-    uint32_t magic = 0, ver = 0;
-
-    file->read((char *)&magic, 4);
-    file->read((char *)&ver, 4);
-
-    if ((magic != FORMAT_MAGIC && magic != FORMAT_MAGIC2) ||
-        (ver != FORMAT_VER1 && ver != FORMAT_VER2)) {
-      foreach (CaptureLoadData *cap, capData) { delete cap; }
-
-      QMessageBox::critical(this, tr("Capture File Error"),
-                            tr("Invalid or corrupt capture file."));
-
-      return;
-    }
-
-    uint64_t stamp = 0;
-    uint32_t addrlen = 0;
-    char address[1024];
-
-    memset(address, 0, 1024);
-
-    if (ver == FORMAT_VER1)
-      file->read((char *)&stamp, 4);
-    else
-      file->read((char *)&stamp, 8);
-
-    file->read((char *)&addrlen, 4);
-    file->read(address, addrlen);
+    CaptureLoadState *state = new CaptureLoadState;
+    state->servRate = 0;
+    state->lastTicks = 0;
+    state->nextTicks = 0;
+    state->lastUpdate = 0;
+    state->nextUpdate = 0;
+    state->packetSeqA = 0;
+    state->packetSeqB = 0;
+    state->client = i;
 
     CaptureLoadData *cap = new CaptureLoadData;
-    cap->path = path;
-    cap->file = file;
+    cap->capture = capture;
     cap->state = state;
-    cap->ver = ver;
-
-    if (!loadCapturePacket(cap))
-      delete cap;
-    else
-      capData << cap;
-  }
-
-  while (!capData.isEmpty()) {
-    int index = 0;
-    uint64_t stamp = capData.first()->stamp;
-
-    for (int i = 1; i < capData.count(); i++) {
-      if (capData.at(i)->stamp >= stamp) continue;
-
-      stamp = capData.at(i)->stamp;
-      index = i;
-    }
-
-    CaptureLoadData *cap = capData.at(index);
-    if (!cap) {
-      capData.removeAt(index);
 
-      continue;
-    }
-
-    libcomp::Packet p;
-
-    p.Clear();
-    p.WriteArray(cap->buffer, cap->sz);
-
-    createPacketData(packetData, cap->source, cap->stamp, cap->micro, p,
-                     cap->state);
-
-    // Read in the next packet
-    if (!loadCapturePacket(cap)) {
-      capData.removeAt(index);
-
-      delete cap;
-    }
+    capData << cap;
   }
 
-  // This should be empty, but let's be safe
-  foreach (CaptureLoadData *cap, capData)
-    delete cap;
-
-  // Add the final list of PacketData objects to the model in one shot
-  mModel->addPacketData(packetData);
+  startLoading(capData);
 
   setWindowTitle(tr("Capture Grep - Multiple Captures"));
 }
 
-bool MainWindow::loadCapturePacket(CaptureLoadData *d) {
-  if (!d) return false;
-
-  d->stamp = 0;
-  d->micro = 0;
-
-  if (d->file->atEnd()) return false;
-
-  if (d->file->read((char *)&d->source, sizeof(d->source)) !=
-      (qint64)sizeof(d->source))
-    return false;
-
-  if (d->ver == FORMAT_VER1) {
-    if (d->file->read((char *)&d->stamp, 4) != 4) return false;
-  } else {
-    if (d->file->read((char *)&d->stamp, 8) != 8) return false;
-
-    if (d->file->read((char *)&d->micro, 8) != 8) return false;
-  }
-
-  if (d->file->read((char *)&d->sz, sizeof(d->sz)) != (qint64)sizeof(d->sz))
-    return false;
-
-  if (d->file->read((char *)d->buffer, d->sz) != d->sz) return false;
-
-  return true;
-}
-
 void MainWindow::loadCapture(const QString &path) {
   ui.action_Live_mode->setEnabled(true);
 
-  mDefaultState.servRate = 0;
-  mDefaultState.lastTicks = 0;
-  mDefaultState.nextTicks = 0;
-  mDefaultState.lastUpdate = 0;
-  mDefaultState.nextUpdate = 0;
-  mDefaultState.packetSeqA = 0;
-  mDefaultState.packetSeqB = 0;
-  mDefaultState.client = -1;
-
   // Clear the log.
   mLog->clear();
 
@@ -676,93 +550,99 @@ void MainWindow::loadCapture(const QString &path) {
   mLiveSockets.clear();
   mLiveStates.clear();
 
+  stopLoading();
+
   mModel->clear();
   ui.packetData->setData(QByteArray());
   ui.packetDetails->clear();
 
+  releaseCaptures();
   updateValues();
 
-  QFile log(path);
-
-  // Open the log
-  if (!log.open(QIODevice::ReadOnly)) {
-    QMessageBox::critical(this, tr("Capture File Error"),
-                          tr("Failed to open the capture file."));
-
-    return;
-  }
+  CaptureFile *capture = new CaptureFile;
 
-  uint32_t magic = 0, ver = 0;
+  // Open and map the log
+  if (!capture->open(path)) {
+    delete capture;
 
-  log.read((char *)&magic, 4);
-  log.read((char *)&ver, 4);
-
-  if ((magic != FORMAT_MAGIC && magic != FORMAT_MAGIC2) ||
-      (ver != FORMAT_VER1 && ver != FORMAT_VER2)) {
     QMessageBox::critical(this, tr("Capture File Error"),
-                          tr("Invalid or corrupt capture file."));
+                          tr("Failed to open the capture file or the capture "
+                             "file is invalid or corrupt."));
 
     return;
   }
 
-  bool isLobby = (FORMAT_MAGIC2 == magic);
+  CaptureLoadState *state = new CaptureLoadState;
+  state->servRate = 0;
+  state->lastTicks = 0;
+  state->nextTicks = 0;
+  state->lastUpdate = 0;
+  state->nextUpdate = 0;
+  state->packetSeqA = 0;
+  state->packetSeqB = 0;
+  state->client = -1;
 
-  uint64_t stamp = 0;
-  uint64_t micro = 0;
-  uint32_t addrlen = 0;
-  char address[1024];
+  CaptureLoadData *cap = new CaptureLoadData;
+  cap->capture = capture;
+  cap->state = state;
 
-  memset(address, 0, 1024);
+  startLoading(QList<CaptureLoadData *>() << cap);
 
-  if (ver == FORMAT_VER1)
-    log.read((char *)&stamp, 4);
-  else
-    log.read((char *)&stamp, 8);
+  setWindowTitle(tr("Capture Grep - %1").arg(QFileInfo(path).fileName()));
 
-  log.read((char *)&addrlen, 4);
-  log.read(address, addrlen);
+  mStatusBar->setText(QDir::toNativeSeparators(path));
+}
 
-  uint8_t *pBuffer = new uint8_t[1048576];
-  uint8_t source;
-  uint32_t sz;
+void MainWindow::startLoading(const QList<CaptureLoadData *> &captures) {
+  mLoader = new CaptureLoader(++mLoadID, captures);
 
-  libcomp::Packet p;
+  // The loaded signal is emitted from the loader thread so the packets are
+  // added to the model on the GUI thread.
+  connect(mLoader, SIGNAL(loaded(int)), this, SLOT(capturesLoaded(int)),
+          Qt::QueuedConnection);
 
-  // Variable to store list of loaded PacketData objects
-  QList<PacketData *> packetData;
+  mLoader->start();
+}
 
-  while (!log.atEnd()) {
-    stamp = 0;
-    micro = 0;
+void MainWindow::stopLoading() {
+  if (!mLoader) return;
 
-    log.read((char *)&source, sizeof(source));
+  mLoader->cancel();
+  mLoader->wait();
 
-    if (ver == FORMAT_VER1) {
-      log.read((char *)&stamp, 4);
-    } else {
-      log.read((char *)&stamp, 8);
-      log.read((char *)&micro, 8);
-    }
+  delete mLoader;
+  mLoader = 0;
+}
 
-    log.read((char *)&sz, sizeof(sz));
-    log.read((char *)pBuffer, sz);
+void MainWindow::capturesLoaded(int id) {
+  // Ignore a load that was cancelled after it finished.
+  if (!mLoader || id != mLoadID) return;
 
-    p.Clear();
-    p.WriteArray(pBuffer, sz);
+  // The signal is the last thing the loader does so this returns right away.
+  mLoader->wait();
 
-    createPacketData(packetData, source, stamp, micro, p, isLobby);
+  foreach (QString path, mLoader->truncatedPaths()) {
+    addLogMessage(tr("Capture file %1 is truncated; the last record was "
+                     "not loaded.")
+                      .arg(QDir::toNativeSeparators(path)));
   }
 
-  log.close();
+  // The packet data may point into the mapped captures so keep them open
+  // until the model is cleared.
+  mCaptures << mLoader->takeCaptures();
 
   // Add the final list of PacketData objects to the model in one shot
-  mModel->addPacketData(packetData);
+  mModel->addPacketData(mLoader->takePacketData());
 
-  setWindowTitle(tr("Capture Grep - %1").arg(QFileInfo(path).fileName()));
+  delete mLoader;
+  mLoader = 0;
+}
 
-  mStatusBar->setText(QDir::toNativeSeparators(path));
+void MainWindow::releaseCaptures() {
+  foreach (CaptureFile *capture, mCaptures)
+    delete capture;
 
-  delete[] pBuffer;
+  mCaptures.clear();
 }
 
 void MainWindow::addPacket(uint8_t source, uint64_t stamp, uint64_t micro,
@@ -771,137 +651,24 @@ void MainWindow::addPacket(uint8_t source, uint64_t stamp, uint64_t micro,
   QList<PacketData *> packetData;
 
   // Create the PacketData objects
-  createPacketData(packetData, source, stamp, micro, p, false, state);
+  CaptureLoader::decode(packetData, source, stamp, micro, p.Data(), p.Size(),
+                        false, state ? state : &mDefaultState, false);
 
   // Add the PacketData objects into the list model
   mModel->addPacketData(packetData);
 }
 
-void MainWindow::createPacketData(QList<PacketData *> &packetData,
-                                  uint8_t source, uint64_t stamp,
-                                  uint64_t micro, libcomp::Packet &p,
-                                  bool isLobby, CaptureLoadState *state) {
-  if (!state) state = &mDefaultState;
-
-  if (mCopyActions.isEmpty()) {
-    mCopyActions[0x0014] = &action0014;
-    mCopyActions[0x0015] = &action0015;
-    mCopyActions[0x0023] = &action0023;
-    mCopyActions[0x00A7] = &action00A7;
-    mCopyActions[0x00AC] = &action00AC;
-    mCopyActions[0x00B9] = &action00B9;
-  }
-
-  p.Seek(8);
-
-  // Check for compression
-  if (!isLobby && p.ReadU32Big() == 0x677A6970) {
-    int32_t uncompressed_size = p.ReadS32Little();
-    int32_t compressed_size = p.ReadS32Little();
-
-    uint32_t lv6 = p.ReadU32Big();
-
-    (void)lv6;
-
-    Q_ASSERT(lv6 == 0x6C763600);  // lv6
-
-    if (compressed_size != uncompressed_size) {
-      uint8_t *decomp = new uint8_t[uncompressed_size];
-
-      int written = uncompressChunk(p.Data() + p.Tell(), decomp,
-                                    compressed_size, uncompressed_size);
-
-      libcomp::Packet dpacket;
-      dpacket.WriteArray(p.Data(), p.Tell());
-      dpacket.WriteArray(decomp, static_cast<uint32_t>(written));
-
-      p.Clear();
-      p.WriteArray(dpacket.Data(), dpacket.Size());
-
-      delete[] decomp;
-    }
-  }
-
-  p.Rewind();
-  p.Skip(isLobby ? 8 : 24);
-
-  while (p.Left() >= 6) {
-    p.Skip(2);  // Big endian size
-
-    uint32_t cmd_start = p.Tell();
-    uint16_t cmd_size = p.ReadU16Little();
-    if (cmd_size < 4) continue;
-
-    PacketData *d = new PacketData;
-    d->cmd = p.ReadU16Little();
-    d->source = source;
-    d->data = QByteArray(p.Data() + cmd_start + 4, cmd_size - 4);
-    d->copyAction = 0;
-    d->micro = micro;
-
-    if (d->cmd == 0x00F3) {
-      memcpy(&state->nextUpdate, d->data.constData(), 4);
-    } else if (d->cmd == 0x00F4) {
-      memcpy(&state->nextTicks, d->data.constData() + 4, 4);
-
-      if ((state->nextUpdate - state->lastUpdate) != 0) {
-        state->servRate =
-            (float)(state->nextTicks - state->lastTicks) /
-            (float)((state->nextUpdate - state->lastUpdate) * 1000);
-      }
-
-      state->lastTicks = state->nextTicks;
-      state->lastUpdate = state->nextUpdate;
-
-      state->nextTicks = 0;
-      state->nextUpdate = 0;
-    }
-
-    d->servRate = state->servRate;
-    d->servTime =
-        (uint32_t)((float)state->lastTicks +
-                   (((float)stamp - (float)state->lastUpdate) * d->servRate));
-
-    if (mCopyActions.contains(d->cmd))
-      d->copyAction = mCopyActions.value(d->cmd);
-
-    if (d->shortName.isEmpty())
-      d->text = tr("CMD%1").arg(d->cmd, 4, 16, QLatin1Char('0'));
-    else
-      d->text = d->shortName;
-
-    if (d->desc.isEmpty()) {
-      const PacketInfo *info = PacketListModel::getPacketInfo(d->cmd);
-
-      if (info) d->desc = info->desc;
-    }
-
-    if (source == 0)
-      d->seq = state->packetSeqA;
-    else
-      d->seq = state->packetSeqB;
-
-    d->client = state->client;
-
-    packetData.append(d);
-
-    p.Seek(cmd_start + cmd_size);
-  }
-
-  if (source == 0)
-    state->packetSeqA++;
-  else
-    state->packetSeqB++;
-}
-
 void MainWindow::itemSelectionChanged() {
   PacketData *d = currentPacket();
 
   if (!d) return;
 
+  const PacketInfo *info = PacketListModel::getPacketInfo(d->cmd);
+  QString desc = info ? info->desc : QString();
+
   ui.packetData->setData(d->data);
-  ui.packetDetails->setText(d->desc);
-  ui.packetDetails->setVisible(!d->desc.isEmpty());
+  ui.packetDetails->setText(desc);
+  ui.packetDetails->setVisible(!desc.isEmpty());
 }
 
 void MainWindow::showFindWindow() {
@@ -1432,7 +1199,7 @@ void MainWindow::listContextMenu(const QPoint &pt) {
   PacketData *d = mModel->packetAt(mListContextItem.row());
   if (!d) return;
 
-  ui.actionCopyToClipboard->setVisible(nullptr != d->copyAction);
+  ui.actionCopyToClipboard->setVisible(mCopyActions.contains(d->cmd));
 
   mListContextMenu->popup(ui.packetList->mapToGlobal(pt));
 }
@@ -1461,7 +1228,8 @@ void MainWindow::actionCopyToClipboard() {
   PacketData *d = mModel->packetAt(mListContextItem.row());
   if (!d) return;
 
-  if (!d->copyAction) return;
+  CopyFunc copyAction = mCopyActions.value(d->cmd);
+  if (!copyAction) return;
 
   libcomp::Packet packet;
   packet.WriteArray(d->data.constData(), static_cast<uint32_t>(d->data.size()));
@@ -1476,7 +1244,7 @@ void MainWindow::actionCopyToClipboard() {
     packetBefore.Rewind();
   }
 
-  (*d->copyAction)(d, packet, packetBefore);
+  (*copyAction)(d, packet, packetBefore);
 }
 
 void MainWindow::actionClipboardU32Array() {
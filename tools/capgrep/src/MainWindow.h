@@ -37,6 +37,7 @@
 // Stop ignoring warnings
 #include <PopIgnore.h>
 
+#include "CaptureLoader.h"
 #include "Find.h"
 #include "Packet.h"
 #include "PacketData.h"
@@ -53,40 +54,12 @@ class QTcpSocket;
 class QDockWidget;
 class QListWidgetItem;
 
-class CaptureLoadState {
- public:
-  float servRate;
-  uint16_t packetSeqA, packetSeqB;
-  uint32_t lastTicks, nextTicks;
-  time_t lastUpdate, nextUpdate;
-  int client;
-};
-
-class CaptureLoadData {
- public:
-  QFile *file;
-  QString path;
-  uint32_t ver;
-  uint64_t stamp;
-  uint64_t micro;
-  CaptureLoadState *state;
-  uint8_t buffer[1048576];
-  uint8_t source;
-  uint32_t sz;
-
-  CaptureLoadData() : file(0), state(0) {}
-
-  ~CaptureLoadData() {
-    delete file;
-    delete state;
-  }
-};
-
 class MainWindow : public QMainWindow {
   Q_OBJECT
 
  public:
   MainWindow(QWidget *parent = 0);
+  ~MainWindow();
 
   static MainWindow *getSingletonPtr();
 
@@ -101,15 +74,31 @@ class MainWindow : public QMainWindow {
 
  protected slots:
   void loadCaptures(const QStringList &paths);
-  bool loadCapturePacket(CaptureLoadData *d);
   void packetContextMenu(const QPoint &pt);
   void listContextMenu(const QPoint &pt);
 
   void addPacket(uint8_t source, uint64_t stamp, uint64_t micro,
                  libcomp::Packet &p, CaptureLoadState *state = 0);
-  void createPacketData(QList<PacketData *> &packetData, uint8_t source,
-                        uint64_t stamp, uint64_t micro, libcomp::Packet &p,
-                        bool isLobby, CaptureLoadState *state = 0);
+  void releaseCaptures();
+
+  /**
+   * Index and decode opened captures on a loader thread. The packets are
+   * added to the model by @ref capturesLoaded when the loader is done.
+   * @param captures Captures to load. The loader takes ownership of them.
+   */
+  void startLoading(const QList<CaptureLoadData *> &captures);
+
+  /**
+   * Cancel the capture load in progress, if any, and wait for the loader
+   * thread to stop.
+   */
+  void stopLoading();
+
+  /**
+   * Add the packets decoded by the loader thread to the model.
+   * @param id ID of the load that finished.
+   */
+  void capturesLoaded(int id);
 
   void packetLimitChanged(int limit);
 
@@ -174,6 +163,13 @@ class MainWindow : public QMainWindow {
   QActionGroup *mStringEncodingGroup;
   QHash<uint32_t, CopyFunc> mCopyActions;
   QMap<int32_t, CaptureLoadState *> mLiveStates;
+  QList<CaptureFile *> mCaptures;
+
+  /// Thread loading the captures, null if no load is in progress.
+  CaptureLoader *mLoader;
+
+  /// ID of the last load that was started.
+  int mLoadID;
 
   CaptureLoadState mDefaultState;
 };
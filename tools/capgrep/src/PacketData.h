@@ -36,7 +36,6 @@
 
 #include <QByteArray>
 #include <QMetaType>
-#include <QString>
 
 // Stop ignoring warnings
 #include <PopIgnore.h>
@@ -46,6 +45,11 @@ class PacketData;
 typedef void (*CopyFunc)(PacketData* data, libcomp::Packet& packet,
                          libcomp::Packet& packetBefore);
 
+/**
+ * Single command decoded from a captured packet. Only what framing the
+ * packet yields is stored; the name, description and copy action of the
+ * command are looked up by command code when they are needed.
+ */
 class PacketData {
  public:
   uint16_t seq;
@@ -54,11 +58,7 @@ class PacketData {
   uint32_t servTime;
   uint64_t micro;
   float servRate;
-  QString text;
-  QString desc;
-  QString shortName;
   QByteArray data;
-  CopyFunc copyAction;
   int client;  // -1 = default, 0 = A, 1 = B, etc.
 };
 
@@ -64,12 +64,13 @@ QVariant PacketListModel::data(const QModelIndex &idx, int role) const {
     case Qt::DisplayRole: {
       const PacketInfo *info = getPacketInfo(d->cmd);
 
-      return info ? info->name : d->text;
+      return info ? info->name
+                  : tr("CMD%1").arg(d->cmd, 4, 16, QLatin1Char('0'));
     }
     case Qt::ToolTipRole: {
       const PacketInfo *info = getPacketInfo(d->cmd);
 
-      return info ? info->desc : d->desc;
+      return info ? info->desc : QString();
     }
     case Qt::ForegroundRole: {
       if (d->source == 0)
@@ -160,12 +161,14 @@ void PacketListModel::addPacketData(const QList<PacketData *> &packetData) {
 }
 
 void PacketListModel::clear() {
+  // Start the reset first so views and searches let go of the packets.
+  beginResetModel();
+
   foreach (PacketData *d, mPacketData)
     delete d;
 
   mPacketData.clear();
 
-  beginResetModel();
   endResetModel();
 }
 
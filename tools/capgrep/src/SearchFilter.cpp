@@ -30,6 +30,10 @@
 #include "PacketListFilter.h"
 #include "PacketListModel.h"
 
+// Standard C++11 Includes
+#include <algorithm>
+#include <thread>
+
 // Ignore warnings
 #include <PushIgnore.h>
 
@@ -39,7 +43,14 @@
 #include <PopIgnore.h>
 
 SearchFilter::SearchFilter(QObject* p)
-    : QSortFilterProxyModel(p), mSearchType(SearchType_None), mCommand(0) {}
+    : QSortFilterProxyModel(p),
+      mSearchType(SearchType_None),
+      mCommand(0),
+      mWorker(0),
+      mSearchID(0),
+      mRestart(false) {}
+
+SearchFilter::~SearchFilter() { stopSearch(); }
 
 bool SearchFilter::filterAcceptsRow(int row, const QModelIndex& p) const {
   Q_UNUSED(p)
@@ -51,15 +62,34 @@ bool SearchFilter::filterAcceptsRow(int row, const QModelIndex& p) const {
       qobject_cast<PacketListModel*>(filter->sourceModel());
   if (!model) return false;
 
-  PacketData* d = model->packetAt(filter->mapRow(row));
+  int srcRow = filter->mapRow(row);
+
+  PacketData* d = model->packetAt(srcRow);
   if (!d) return false;
 
-  switch (mSearchType) {
+  // Nothing is shown until the search worker is done.
+  if (mWorker) return false;
+
+  // Use the result of the last full search unless the row has changed.
+  if (srcRow < (int)mScanned.size() && mScanned[(size_t)srcRow] == d) {
+    return mMatches[(size_t)srcRow] != 0;
+  }
+
+  return matches(d);
+}
+
+bool SearchFilter::matches(const PacketData* d) const {
+  return matches(mSearchType, mTerm, mCommand, d);
+}
+
+bool SearchFilter::matches(SearchType searchType, const QByteArray& term,
+                           uint16_t cmd, const PacketData* d) {
+  switch (searchType) {
     case SearchType_Binary:
     case SearchType_Text:
-      return d->data.contains(mTerm);
+      return d->data.contains(term);
     case SearchType_Command:
-      return d->cmd == mCommand;
+      return d->cmd == cmd;
     case SearchType_None:
     default:
       break;
@@ -68,7 +98,103 @@ bool SearchFilter::filterAcceptsRow(int row, const QModelIndex& p) const {
   return false;
 }
 
+void SearchFilter::updateMatches() {
+  stopSearch();
+
+  if (mSearchType == SearchType_None) return;
+
+  PacketListFilter* filter = qobject_cast<PacketListFilter*>(sourceModel());
+  if (!filter) return;
+
+  PacketListModel* model =
+      qobject_cast<PacketListModel*>(filter->sourceModel());
+  if (!model) return;
+
+  // Stop the worker before it can read a packet the model deletes.
+  connect(model, SIGNAL(modelAboutToBeReset()), this,
+          SLOT(modelAboutToChange()), Qt::UniqueConnection);
+  connect(model, SIGNAL(rowsAboutToBeRemoved(const QModelIndex&, int, int)),
+          this, SLOT(modelAboutToChange()), Qt::UniqueConnection);
+  connect(model, SIGNAL(modelReset()), this, SLOT(modelChanged()),
+          Qt::UniqueConnection);
+  connect(model, SIGNAL(rowsRemoved(const QModelIndex&, int, int)), this,
+          SLOT(modelChanged()), Qt::UniqueConnection);
+
+  size_t count = (size_t)model->rowCount();
+
+  std::vector<PacketData*> packets(count);
+
+  for (size_t i = 0; i < count; i++) {
+    packets[i] = model->packetAt((int)i);
+  }
+
+  // The worker gets its own copy of the search so it is not changed while
+  // the worker is running.
+  SearchType searchType = mSearchType;
+  QByteArray term = mTerm;
+  uint16_t cmd = mCommand;
+
+  mWorker = new SearchWorker(
+      ++mSearchID, packets, [searchType, term, cmd](const PacketData* d) {
+        return SearchFilter::matches(searchType, term, cmd, d);
+      });
+
+  // The searched signal is emitted from the worker thread so the results
+  // are used on the GUI thread.
+  connect(mWorker, SIGNAL(searched(int)), this, SLOT(searchFinished(int)),
+          Qt::QueuedConnection);
+
+  mWorker->start();
+}
+
+void SearchFilter::searchFinished(int id) {
+  // Ignore a search that was stopped after it finished.
+  if (!mWorker || id != mSearchID) return;
+
+  // The signal is the last thing the worker does so this returns right away.
+  mWorker->wait();
+
+  mScanned.swap(mWorker->packets());
+  mMatches.swap(mWorker->matches());
+
+  delete mWorker;
+  mWorker = 0;
+
+  invalidateFilter();
+}
+
+void SearchFilter::stopSearch() {
+  mScanned.clear();
+  mMatches.clear();
+  mRestart = false;
+
+  if (!mWorker) return;
+
+  mWorker->cancel();
+  mWorker->wait();
+
+  delete mWorker;
+  mWorker = 0;
+}
+
+void SearchFilter::modelAboutToChange() {
+  bool running = nullptr != mWorker;
+
+  stopSearch();
+
+  mRestart = running;
+}
+
+void SearchFilter::modelChanged() {
+  if (!mRestart) return;
+
+  updateMatches();
+  invalidateFilter();
+}
+
 void SearchFilter::reset() {
+  stopSearch();
+
   mSearchType = SearchType_None;
   mTerm.clear();
   mCommand = 0;
@@ -82,6 +208,7 @@ void SearchFilter::findBinary(const QByteArray& term) {
   mSearchType = SearchType_Binary;
   mTerm = term;
 
+  updateMatches();
   invalidateFilter();
 }
 
@@ -100,6 +227,7 @@ void SearchFilter::findText(const QString& encoding, const QString& text) {
   }
   mTerm.chop(1);
 
+  updateMatches();
   invalidateFilter();
 }
 
@@ -107,6 +235,7 @@ void SearchFilter::findCommand(uint16_t cmd) {
   mSearchType = SearchType_Command;
   mCommand = cmd;
 
+  updateMatches();
   invalidateFilter();
 }
 
@@ -134,3 +263,56 @@ bool SearchFilter::searchResult(const QModelIndex& idx, int& packet,
 
   return true;
 }
+
+SearchWorker::SearchWorker(
+    int id, const std::vector<PacketData*>& packets,
+    const std::function<bool(const PacketData*)>& matches, QObject* p)
+    : QThread(p),
+      mID(id),
+      mPackets(packets),
+      mMatchFunc(matches),
+      mCancelled(false) {}
+
+void SearchWorker::cancel() { mCancelled = true; }
+
+std::vector<PacketData*>& SearchWorker::packets() { return mPackets; }
+
+std::vector<char>& SearchWorker::matches() { return mMatches; }
+
+void SearchWorker::run() {
+  size_t count = mPackets.size();
+
+  mMatches.assign(count, 0);
+
+  // Small lists are not worth starting threads for.
+  const size_t minChunk = 4096;
+
+  size_t threadCount = std::min<size_t>(
+      std::max(1u, std::thread::hardware_concurrency()),
+      (count + minChunk - 1) / minChunk);
+
+  auto search = [this](size_t start, size_t end) {
+    for (size_t i = start; i < end && !mCancelled; i++) {
+      mMatches[i] = mMatchFunc(mPackets[i]) ? 1 : 0;
+    }
+  };
+
+  if (threadCount <= 1) {
+    search(0, count);
+  } else {
+    size_t chunk = (count + threadCount - 1) / threadCount;
+
+    std::vector<std::thread> threads;
+
+    for (size_t start = 0; start < count; start += chunk) {
+      threads.push_back(
+          std::thread(search, start, std::min(start + chunk, count)));
+    }
+
+    for (auto& thread : threads) {
+      thread.join();
+    }
+  }
+
+  if (!mCancelled) emit searched(mID);
+}
@@ -27,21 +27,31 @@
 
 #include <stdint.h>
 
+// Standard C++11 Includes
+#include <atomic>
+#include <functional>
+#include <vector>
+
 // Ignore warnings
 #include <PushIgnore.h>
 
 #include <QByteArray>
 #include <QSortFilterProxyModel>
 #include <QString>
+#include <QThread>
 
 // Stop ignoring warnings
 #include <PopIgnore.h>
 
+class PacketData;
+class SearchWorker;
+
 class SearchFilter : public QSortFilterProxyModel {
   Q_OBJECT
 
  public:
   SearchFilter(QObject* parent = 0);
+  virtual ~SearchFilter();
 
   void reset();
 
@@ -59,13 +69,140 @@ class SearchFilter : public QSortFilterProxyModel {
   bool searchResult(const QModelIndex& index, int& packet, int& offset,
                     QByteArray& term);
 
+  /**
+   * Check if a packet matches a search.
+   * @param searchType Type of the search.
+   * @param term Binary or text term to find.
+   * @param cmd Command code to find.
+   * @param d Packet to check.
+   * @returns true if the packet matches.
+   */
+  static bool matches(SearchType searchType, const QByteArray& term,
+                      uint16_t cmd, const PacketData* d);
+
+ protected slots:
+  /**
+   * Use the results of the search worker and refresh the filter.
+   * @param id ID of the search that finished.
+   */
+  void searchFinished(int id);
+
+  /**
+   * Stop the search worker, if any, and forget the results of the last
+   * search.
+   */
+  void stopSearch();
+
+  /**
+   * Stop the search worker before packets are removed from the packet list
+   * model so the worker never reads a deleted packet.
+   */
+  void modelAboutToChange();
+
+  /**
+   * Start the search again if the worker was stopped by a change to the
+   * packet list model.
+   */
+  void modelChanged();
+
  protected:
   bool filterAcceptsRow(int row, const QModelIndex& parent) const;
 
+  /**
+   * Check if a packet matches the current search.
+   * @param d Packet to check.
+   * @returns true if the packet matches.
+   */
+  bool matches(const PacketData* d) const;
+
+  /**
+   * Start checking every packet in the packet list model against the
+   * current search on a worker thread. No packet is shown until the worker
+   * is done.
+   */
+  void updateMatches();
+
   SearchType mSearchType;
 
   QByteArray mTerm;
   uint16_t mCommand;
+
+  /// Packet that was at each row of the packet list model when the search
+  /// was run. Used to detect rows that have changed since.
+  std::vector<PacketData*> mScanned;
+
+  /// If the packet at each row of the packet list model matched the search.
+  std::vector<char> mMatches;
+
+  /// Thread running the current search, null if no search is running.
+  SearchWorker* mWorker;
+
+  /// ID of the last search that was started.
+  int mSearchID;
+
+  /// If the search worker was stopped by a change to the packet list model.
+  bool mRestart;
+};
+
+/**
+ * Thread that checks a snapshot of the packet list against a search. Large
+ * lists are split into chunks that are searched on their own thread. The
+ * searched signal is emitted from the worker thread when every packet has
+ * been checked.
+ */
+class SearchWorker : public QThread {
+  Q_OBJECT
+
+ public:
+  /**
+   * Create a search worker.
+   * @param id ID passed to the searched signal.
+   * @param packets Packets to check. They must not be deleted until the
+   * worker has stopped.
+   * @param matches Function that checks if a packet matches the search.
+   * @param parent Parent object.
+   */
+  SearchWorker(int id, const std::vector<PacketData*>& packets,
+               const std::function<bool(const PacketData*)>& matches,
+               QObject* parent = 0);
+
+  /**
+   * Ask the thread to stop searching. Call wait() to wait for it to stop.
+   */
+  void cancel();
+
+  /**
+   * Get the packets that were checked.
+   * @returns Packets that were checked.
+   */
+  std::vector<PacketData*>& packets();
+
+  /**
+   * Get if each packet matched the search. Only valid after the searched
+   * signal.
+   * @returns If the packet at the same position matched the search.
+   */
+  std::vector<char>& matches();
+
+ signals:
+  /**
+   * Emitted from the worker thread when every packet is checked. It is not
+   * emitted if the worker was cancelled.
+   * @param id ID the worker was created with.
+   */
+  void searched(int id);
+
+ protected:
+  virtual void run();
+
+ private:
+  int mID;
+
+  std::vector<PacketData*> mPackets;
+  std::vector<char> mMatches;
+  std::function<bool(const PacketData*)> mMatchFunc;
+
+  std::atomic<bool> mCancelled;
 };
 
 #endif  // TOOLS_CAPGREP_SRC_SEARCHFILTER_H
@@ -0,0 +1,564 @@
+/**
+ * @file tools/capstat/src/main.cpp
+ * @ingroup tools
+ *
+ * @author COMP Omega <compomega@tutanota.com>
+ *
+ * @brief Tool to print packet statistics for capture files.
+ *
+ * This tool reads capture files written by the logger one record at a time
+ * and prints the number of commands, the byte volume, the time between
+ * commands and any bursts for each command code.
+ *
+ * Copyright (C) 2012-2020 COMP_hack Team <compomega@tutanota.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// libcomp Includes
+#include <CString.h>
+#include <Compress.h>
+
+// Ignore warnings
+#include <PushIgnore.h>
+
+// tinyxml2 Includes
+#include <tinyxml2.h>
+
+// Stop ignoring warnings
+#include <PopIgnore.h>
+
+// Standard C++11 Includes
+#include <algorithm>
+#include <array>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <vector>
+
+// Standard C Includes
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+static const uint32_t FORMAT_MAGIC = 0x4B434148;   // HACK
+static const uint32_t FORMAT_MAGIC2 = 0x504D4F43;  // COMP
+static const uint32_t FORMAT_VER1 = 0x00010000;  // Major, Minor, Patch (1.0.0)
+static const uint32_t FORMAT_VER2 = 0x00010100;  // Major, Minor, Patch (1.1.0)
+
+/// Number of power of two buckets in the inter-arrival histogram. The last
+/// bucket holds every interval of 2^(HISTOGRAM_BUCKETS - 2) us or more.
+static const size_t HISTOGRAM_BUCKETS = 28;
+
+/**
+ * Running statistics for a single command code. The size of this object does
+ * not depend on the length of the capture.
+ */
+class CommandStats {
+ public:
+  /// Number of commands sent by the client (0) and server (1).
+  std::array<uint64_t, 2> count = {{0, 0}};
+
+  /// Number of bytes sent by the client (0) and server (1).
+  std::array<uint64_t, 2> bytes = {{0, 0}};
+
+  /// Number of intervals (in microseconds) that fall in each bucket.
+  std::array<uint64_t, HISTOGRAM_BUCKETS> intervals = {};
+
+  /// Time the command was last seen (in microseconds).
+  uint64_t lastSeen = 0;
+
+  /// If the command has been seen in the current capture.
+  bool seen = false;
+
+  /// Start of the current burst window (in microseconds).
+  uint64_t windowStart = 0;
+
+  /// Number of commands in the current burst window.
+  uint64_t windowCount = 0;
+
+  /// Most commands seen in a single burst window.
+  uint64_t windowMax = 0;
+
+  /// Number of burst windows that met the burst threshold.
+  uint64_t bursts = 0;
+};
+
+/**
+ * Totals for every capture read.
+ */
+class CaptureTotals {
+ public:
+  uint64_t records = 0;
+  uint64_t compressedRecords = 0;
+  uint64_t commands = 0;
+  uint64_t bytes = 0;
+  uint64_t recordBytes = 0;
+  uint64_t firstSeen = 0;
+  uint64_t lastSeen = 0;
+  bool seen = false;
+};
+
+/**
+ * Options passed on the command line.
+ */
+class Options {
+ public:
+  /// Path to the packets.xml file with the command names.
+  std::string packetsPath;
+
+  /// Length of a burst window (in microseconds).
+  uint64_t burstWindow = 1000000;
+
+  /// Number of commands in a window to count as a burst.
+  uint64_t burstThreshold = 50;
+
+  /// Number of commands to print (0 for all of them).
+  size_t top = 0;
+
+  /// Print the inter-arrival histogram for each command.
+  bool histogram = false;
+
+  /// Capture files to read.
+  std::vector<std::string> captures;
+};
+
+void PrintSyntax() {
+  std::cerr << "SYNTAX: comp_capstat [--packets PACKETS_XML] "
+               "[--burst-window MS] [--burst-threshold N] [--top N] "
+               "[--histogram] CAPTURE..."
+            << std::endl;
+  std::cerr << std::endl;
+  std::cerr << "PACKETS_XML is the packets.xml file from capgrep "
+               "(tools/capgrep/res/packets.xml) used to name each command."
+            << std::endl;
+  std::cerr << "A command is reported as bursting when it is seen N or more "
+               "times in a window of MS milliseconds (default: 50 in 1000)."
+            << std::endl;
+}
+
+static bool ParseUnsigned(const char *szValue, uint64_t &value) {
+  bool ok = false;
+  value = libcomp::String(szValue).ToInteger<uint64_t>(&ok);
+
+  return ok;
+}
+
+static bool ParseOptions(int argc, char *argv[], Options &options) {
+  for (int i = 1; i < argc; i++) {
+    std::string arg = argv[i];
+    uint64_t value = 0;
+
+    if (arg == "--packets" && (i + 1) < argc) {
+      options.packetsPath = argv[++i];
+    } else if (arg == "--burst-window" && (i + 1) < argc) {
+      if (!ParseUnsigned(argv[++i], value) || 0 == value) {
+        return false;
+      }
+
+      options.burstWindow = value * 1000;
+    } else if (arg == "--burst-threshold" && (i + 1) < argc) {
+      if (!ParseUnsigned(argv[++i], value) || 0 == value) {
+        return false;
+      }
+
+      options.burstThreshold = value;
+    } else if (arg == "--top" && (i + 1) < argc) {
+      if (!ParseUnsigned(argv[++i], value)) {
+        return false;
+      }
+
+      options.top = (size_t)value;
+    } else if (arg == "--histogram") {
+      options.histogram = true;
+    } else if (0 == arg.compare(0, 2, "--")) {
+      return false;
+    } else {
+      options.captures.push_back(argv[i]);
+    }
+  }
+
+  return !options.captures.empty();
+}
+
+static std::map<uint16_t, std::string> LoadPacketNames(
+    const std::string &path) {
+  std::map<uint16_t, std::string> names;
+
+  tinyxml2::XMLDocument doc;
+
+  if (tinyxml2::XML_SUCCESS != doc.LoadFile(path.c_str())) {
+    std::cerr << "Failed to load packet names from: " << path << std::endl;
+
+    return names;
+  }
+
+  const tinyxml2::XMLElement *pRoot = doc.RootElement();
+  const tinyxml2::XMLElement *pPacket =
+      pRoot ? pRoot->FirstChildElement("packet") : nullptr;
+
+  while (pPacket) {
+    const char *szCode = pPacket->Attribute("code");
+    const char *szName = pPacket->Attribute("name");
+
+    if (szCode && szName) {
+      names[(uint16_t)strtoul(szCode, nullptr, 0)] = szName;
+    }
+
+    pPacket = pPacket->NextSiblingElement("packet");
+  }
+
+  return names;
+}
+
+static size_t HistogramBucket(uint64_t interval) {
+  size_t bucket = 0;
+
+  while (interval > 0 && bucket < (HISTOGRAM_BUCKETS - 1)) {
+    interval >>= 1;
+    bucket++;
+  }
+
+  return bucket;
+}
+
+static void AddCommand(CommandStats &stats, uint8_t source, uint16_t size,
+                       uint64_t micro, const Options &options) {
+  size_t idx = source ? 1 : 0;
+
+  stats.count[idx]++;
+  stats.bytes[idx] += size;
+
+  if (stats.seen) {
+    uint64_t interval = micro >= stats.lastSeen ? micro - stats.lastSeen : 0;
+
+    stats.intervals[HistogramBucket(interval)]++;
+  }
+
+  if (!stats.seen || micro >= (stats.windowStart + options.burstWindow)) {
+    // Start a new window.
+    stats.windowStart = micro;
+    stats.windowCount = 0;
+  }
+
+  stats.windowCount++;
+  stats.windowMax = std::max(stats.windowMax, stats.windowCount);
+
+  if (stats.windowCount == options.burstThreshold) {
+    stats.bursts++;
+  }
+
+  stats.lastSeen = micro;
+  stats.seen = true;
+}
+
+static bool ReadCapture(const std::string &path, const Options &options,
+                        std::map<uint16_t, CommandStats> &commands,
+                        CaptureTotals &totals) {
+  std::ifstream file;
+  file.open(path, std::ifstream::binary);
+
+  if (!file.good()) {
+    std::cerr << "Failed to open capture file: " << path << std::endl;
+
+    return false;
+  }
+
+  uint32_t magic = 0, ver = 0;
+
+  file.read((char *)&magic, 4);
+  file.read((char *)&ver, 4);
+
+  if (!file.good() || (magic != FORMAT_MAGIC && magic != FORMAT_MAGIC2) ||
+      (ver != FORMAT_VER1 && ver != FORMAT_VER2)) {
+    std::cerr << "Invalid or corrupt capture file: " << path << std::endl;
+
+    return false;
+  }
+
+  bool isLobby = (FORMAT_MAGIC2 == magic);
+
+  uint64_t stamp = 0;
+  uint32_t addrlen = 0;
+
+  file.read((char *)&stamp, ver == FORMAT_VER1 ? 4 : 8);
+  file.read((char *)&addrlen, 4);
+  file.seekg(addrlen, std::ifstream::cur);
+
+  if (!file.good()) {
+    std::cerr << "Invalid or corrupt capture file: " << path << std::endl;
+
+    return false;
+  }
+
+  // Intervals are only measured within a single capture.
+  for (auto &pair : commands) {
+    pair.second.seen = false;
+  }
+
+  // Only the current record is kept in memory.
+  std::vector<char> buffer;
+  std::vector<char> decompressed;
+
+  while (file.peek() != std::ifstream::traits_type::eof()) {
+    uint8_t source = 0;
+    uint64_t micro = 0;
+    uint32_t sz = 0;
+
+    stamp = 0;
+
+    file.read((char *)&source, 1);
+
+    if (ver == FORMAT_VER1) {
+      file.read((char *)&stamp, 4);
+    } else {
+      file.read((char *)&stamp, 8);
+      file.read((char *)&micro, 8);
+    }
+
+    file.read((char *)&sz, 4);
+
+    if (!file.good()) {
+      std::cerr << "Capture file is truncated: " << path << std::endl;
+
+      return false;
+    }
+
+    buffer.resize(sz);
+
+    if (sz && !file.read(&buffer[0], sz)) {
+      std::cerr << "Capture file is truncated: " << path << std::endl;
+
+      return false;
+    }
+
+    // Version 1 captures only have a time stamp in seconds.
+    if (ver == FORMAT_VER1) {
+      micro = stamp * 1000000ull;
+    }
+
+    if (!totals.seen) {
+      totals.firstSeen = micro;
+      totals.seen = true;
+    }
+
+    totals.firstSeen = std::min(totals.firstSeen, micro);
+    totals.lastSeen = std::max(totals.lastSeen, micro);
+    totals.records++;
+    totals.recordBytes += sz;
+
+    const char *data = buffer.data();
+    uint32_t size = sz;
+
+    // Check for compression
+    if (!isLobby && size >= 24 && 0 == memcmp(data + 8, "gzip", 4)) {
+      int32_t uncompressedSize = 0;
+      int32_t compressedSize = 0;
+
+      memcpy(&uncompressedSize, data + 12, 4);
+      memcpy(&compressedSize, data + 16, 4);
+
+      if (compressedSize != uncompressedSize && uncompressedSize > 0 &&
+          compressedSize > 0 && (24 + (uint32_t)compressedSize) <= size) {
+        decompressed.resize(24 + (size_t)uncompressedSize);
+        memcpy(&decompressed[0], data, 24);
+
+        int32_t written = libcomp::Compress::Decompress(
+            data + 24, &decompressed[24], compressedSize, uncompressedSize);
+
+        if (written != uncompressedSize) {
+          std::cerr << "Failed to decompress a packet in: " << path
+                    << std::endl;
+
+          continue;
+        }
+
+        data = decompressed.data();
+        size = (uint32_t)decompressed.size();
+        totals.compressedRecords++;
+      }
+    }
+
+    uint32_t offset = isLobby ? 8 : 24;
+
+    while (size >= offset && (size - offset) >= 6) {
+      offset += 2;  // Big endian size
+
+      uint32_t cmdStart = offset;
+      uint16_t cmdSize = 0;
+      uint16_t cmd = 0;
+
+      memcpy(&cmdSize, data + offset, 2);
+      offset += 2;
+
+      if (cmdSize < 4) continue;
+
+      // Stop at a command that runs past the end of the packet
+      if ((cmdStart + cmdSize) > size) break;
+
+      memcpy(&cmd, data + offset, 2);
+
+      AddCommand(commands[cmd], source, cmdSize, micro, options);
+
+      totals.commands++;
+      totals.bytes += cmdSize;
+
+      offset = cmdStart + cmdSize;
+    }
+  }
+
+  return true;
+}
+
+static std::string CommandName(const std::map<uint16_t, std::string> &names,
+                               uint16_t cmd) {
+  auto it = names.find(cmd);
+
+  if (it != names.end()) {
+    return it->second;
+  }
+
+  char szName[16];
+  snprintf(szName, sizeof(szName), "CMD%04x", cmd);
+
+  return szName;
+}
+
+static std::string FormatCode(uint16_t cmd) {
+  char szCode[16];
+  snprintf(szCode, sizeof(szCode), "0x%04X", cmd);
+
+  return szCode;
+}
+
+static std::string FormatInterval(size_t bucket) {
+  if (0 == bucket) {
+    return "0us";
+  }
+
+  uint64_t interval = 1ull << (bucket - 1);
+
+  if (interval >= 1000000) {
+    return libcomp::String("%1s").Arg(interval / 1000000).ToUtf8();
+  } else if (interval >= 1000) {
+    return libcomp::String("%1ms").Arg(interval / 1000).ToUtf8();
+  }
+
+  return libcomp::String("%1us").Arg(interval).ToUtf8();
+}
+
+int main(int argc, char *argv[]) {
+  Options options;
+
+  if (!ParseOptions(argc, argv, options)) {
+    PrintSyntax();
+
+    return EXIT_FAILURE;
+  }
+
+  std::map<uint16_t, std::string> names;
+
+  if (!options.packetsPath.empty()) {
+    names = LoadPacketNames(options.packetsPath);
+  }
+
+  std::map<uint16_t, CommandStats> commands;
+  CaptureTotals totals;
+
+  bool fail = false;
+
+  for (auto &path : options.captures) {
+    if (!ReadCapture(path, options, commands, totals)) {
+      fail = true;
+    }
+  }
+
+  double seconds =
+      totals.seen ? (double)(totals.lastSeen - totals.firstSeen) / 1000000.0
+                  : 0.0;
+
+  std::cout << "Records:  " << totals.records << " ("
+            << totals.compressedRecords << " compressed, "
+            << totals.recordBytes << " bytes)" << std::endl;
+  std::cout << "Commands: " << totals.commands << " (" << totals.bytes
+            << " bytes)" << std::endl;
+  std::cout << "Duration: " << std::fixed << std::setprecision(3) << seconds
+            << "s" << std::endl;
+
+  if (seconds > 0.0) {
+    std::cout << "Rate:     " << std::setprecision(1)
+              << ((double)totals.commands / seconds) << " cmd/s, "
+              << ((double)totals.bytes / seconds) << " B/s" << std::endl;
+  }
+
+  std::cout << std::endl;
+
+  // Sort the commands with the most bytes first.
+  std::vector<std::pair<uint16_t, const CommandStats *>> sorted;
+
+  for (auto &pair : commands) {
+    sorted.push_back(std::make_pair(pair.first, &pair.second));
+  }
+
+  std::stable_sort(
+      sorted.begin(), sorted.end(),
+      [](const std::pair<uint16_t, const CommandStats *> &a,
+         const std::pair<uint16_t, const CommandStats *> &b) {
+        return (a.second->bytes[0] + a.second->bytes[1]) >
+               (b.second->bytes[0] + b.second->bytes[1]);
+      });
+
+  if (options.top && sorted.size() > options.top) {
+    sorted.resize(options.top);
+  }
+
+  std::cout << std::left << std::setw(8) << "CODE" << std::setw(40) << "NAME"
+            << std::right << std::setw(12) << "CLIENT" << std::setw(12)
+            << "SERVER" << std::setw(14) << "BYTES" << std::setw(8) << "%BYTES"
+            << std::setw(10) << "CMD/S" << std::setw(10) << "MAX/WIN"
+            << std::setw(8) << "BURSTS" << std::endl;
+
+  for (auto &pair : sorted) {
+    const CommandStats &stats = *pair.second;
+
+    uint64_t count = stats.count[0] + stats.count[1];
+    uint64_t bytes = stats.bytes[0] + stats.bytes[1];
+
+    std::cout << std::left << std::setw(8)
+              << FormatCode(pair.first)
+              << std::setw(40) << CommandName(names, pair.first) << std::right
+              << std::setw(12) << stats.count[0] << std::setw(12)
+              << stats.count[1] << std::setw(14) << bytes << std::setw(8)
+              << std::setprecision(1)
+              << (totals.bytes ? (100.0 * (double)bytes / (double)totals.bytes)
+                               : 0.0)
+              << std::setw(10)
+              << (seconds > 0.0 ? (double)count / seconds : 0.0)
+              << std::setw(10) << stats.windowMax << std::setw(8)
+              << stats.bursts << std::endl;
+
+    if (options.histogram) {
+      for (size_t i = 0; i < HISTOGRAM_BUCKETS; i++) {
+        if (!stats.intervals[i]) continue;
+
+        std::cout << "        >= " << std::left << std::setw(8)
+                  << FormatInterval(i) << std::right << std::setw(12)
+                  << stats.intervals[i] << std::endl;
+      }
+    }
+  }
+
+  return fail ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -31,10 +31,13 @@
 #include <DataStore.h>
 
 // Standard C++11 Includes
+#include <atomic>
+#include <chrono>
 #include <fstream>
 #include <iostream>
 #include <map>
 #include <regex>
+#include <thread>
 #include <vector>
 
 // Standard C Includes
@@ -50,6 +53,35 @@ class FileData {
   int uncompressed_size;
 };
 
+/**
+ * Work item for a single overlay file. Jobs are processed by the worker
+ * threads and merged into the file list in their original order so the
+ * output does not depend on the number of threads.
+ */
+class FileJob {
+ public:
+  /// Absolute path to the file in the overlay.
+  libcomp::String file;
+
+  /// Path relative to the overlay.
+  libcomp::String shortName;
+
+  /// Relative path for the compressed file.
+  libcomp::String shortComp;
+
+  /// Entry from the last overlay hashlist.dat (if any).
+  FileData *previous = nullptr;
+
+  /// New entry for the file or null if the file was empty.
+  FileData *result = nullptr;
+
+  /// Number of bytes read from the overlay file.
+  size_t bytesRead = 0;
+
+  /// If the compressed copy from the last run was reused.
+  bool skipped = false;
+};
+
 std::map<libcomp::String, FileData *> ParseFileList(
     const std::vector<char> data) {
   std::map<libcomp::String, FileData *> files;
@@ -108,12 +140,103 @@ std::list<libcomp::String> RecursiveEntryList(const libcomp::String &dir) {
   return files;
 }
 
+bool CompressFile(FileJob &job, bool incremental) {
+  // Get the original file contents.
+  std::vector<char> uncomp_data = libcomp::Crypto::LoadFile(job.file.ToUtf8());
+
+  job.bytesRead = uncomp_data.size();
+
+  // Ignore empty files
+  if (uncomp_data.empty()) {
+    return true;
+  }
+
+  // Create a new entry for the file.
+  FileData *d = new FileData;
+  d->path = job.shortComp;
+
+  // Hash the original file.
+  d->uncompressed_hash = libcomp::Crypto::MD5(uncomp_data).ToUpper();
+  d->uncompressed_size = (int)uncomp_data.size();
+
+  // If the file has not changed since the last run and the compressed copy
+  // is still there, reuse it instead of compressing the file again.
+  if (incremental && job.previous &&
+      job.previous->uncompressed_size == d->uncompressed_size &&
+      job.previous->uncompressed_hash == d->uncompressed_hash) {
+    std::ifstream file_comp(libcomp::String(job.file + ".compressed").C(),
+                            std::ifstream::binary | std::ifstream::ate);
+
+    if (file_comp.good() &&
+        (int)file_comp.tellg() == job.previous->compressed_size) {
+      d->compressed_hash = job.previous->compressed_hash;
+      d->compressed_size = job.previous->compressed_size;
+
+      job.result = d;
+      job.skipped = true;
+
+      return true;
+    }
+  }
+
+  //
+  // Process the compressed copy now.
+  //
+
+  // Calculate max size.
+  int out_size = (int)((float)uncomp_data.size() * 0.001f + 0.5f);
+  out_size += (int32_t)uncomp_data.size() + 12;
+
+  std::vector<char> out_buffer((size_t)out_size);
+
+  // Compress the file.
+  int32_t sz =
+      libcomp::Compress::Compress(&uncomp_data[0], &out_buffer[0],
+                                  (int32_t)uncomp_data.size(), out_size, 9);
+
+  if (0 > sz) {
+    delete d;
+
+    return false;
+  }
+
+  out_buffer.resize((size_t)sz);
+
+  // Write the compressed copy
+  {
+    std::ofstream file_comp;
+    file_comp.open(libcomp::String(job.file + ".compressed").C(),
+                   std::ofstream::binary);
+    file_comp.write(&out_buffer[0], (std::streamsize)sz);
+    file_comp.close();
+
+    if (!file_comp.good()) {
+      delete d;
+
+      return false;
+    }
+  }
+
+  // Get the hash for the compressed copy.
+  d->compressed_hash = libcomp::Crypto::MD5(out_buffer).ToUpper();
+  d->compressed_size = sz;
+
+  job.result = d;
+
+  return true;
+}
+
+void PrintSyntax() {
+  std::cerr << "SYNTAX: comp_rehash --base BASE --overlay OVERLAY "
+               "[--incremental] [--jobs N]"
+            << std::endl;
+}
+
 int main(int argc, char *argv[]) {
   // Check the arguments and print the usage.
-  if (argc != 5 || libcomp::String(argv[1]) != "--base" ||
+  if (argc < 5 || libcomp::String(argv[1]) != "--base" ||
       libcomp::String(argv[3]) != "--overlay") {
-    std::cerr << "SYNTAX: comp_rehash --base BASE --overlay OVERLAY"
-              << std::endl;
+    PrintSyntax();
 
     return -1;
   }
@@ -121,6 +244,37 @@ int main(int argc, char *argv[]) {
   libcomp::String base = argv[2];
   libcomp::String overlay = argv[4];
 
+  // Skip files that match the hashlist.dat from the last run.
+  bool incremental = false;
+
+  // Number of files to compress at the same time.
+  unsigned int jobCount = std::thread::hardware_concurrency();
+
+  for (int i = 5; i < argc; i++) {
+    libcomp::String arg = argv[i];
+
+    if (arg == "--incremental") {
+      incremental = true;
+    } else if (arg == "--jobs" && (i + 1) < argc) {
+      bool ok = false;
+      jobCount = libcomp::String(argv[++i]).ToInteger<unsigned int>(&ok);
+
+      if (!ok) {
+        PrintSyntax();
+
+        return -1;
+      }
+    } else {
+      PrintSyntax();
+
+      return -1;
+    }
+  }
+
+  if (0 == jobCount) {
+    jobCount = 1;
+  }
+
   // Read in the original file list
   std::map<libcomp::String, FileData *> files;
 
@@ -140,8 +294,24 @@ int main(int argc, char *argv[]) {
     files = ParseFileList(hashlist);
   }
 
+  // Read in the file list from the last run (if any).
+  std::map<libcomp::String, FileData *> previousFiles;
+
+  if (incremental) {
+    auto hashlist = libcomp::Crypto::LoadFile(
+        libcomp::String("%1/hashlist.dat").Arg(overlay).ToUtf8());
+
+    if (!hashlist.empty()) {
+      previousFiles = ParseFileList(hashlist);
+    }
+  }
+
+  auto startTime = std::chrono::steady_clock::now();
+
   static const std::regex compressedRx("^.+\\.compressed$");
 
+  std::vector<FileJob> jobs;
+
   // Find each file in the overlay and handle it.
   for (auto filePath : RecursiveEntryList(overlay)) {
     std::smatch match;
@@ -152,28 +322,72 @@ int main(int argc, char *argv[]) {
     // See if the file is an *.compressed file and ignore it.
     if (std::regex_match(fileString, match, compressedRx)) continue;
 
+    FileJob job;
+
     // Get the relative path.
-    libcomp::String shortName = file.Mid(1);
+    job.shortName = file.Mid(1);
 
     // Make the path absolute.
-    file = overlay + file;
+    job.file = overlay + file;
 
     // Relative path for the compressed file.
-    libcomp::String shortComp = libcomp::String("%1.compressed").Arg(shortName);
+    job.shortComp = libcomp::String("%1.compressed").Arg(job.shortName);
 
     // Ignore the hashlist.dat and hashlist.ver files.
-    if (shortName == "hashlist.dat") continue;
-    if (shortName == "hashlist.ver") continue;
+    if (job.shortName == "hashlist.dat") continue;
+    if (job.shortName == "hashlist.ver") continue;
 
-    // Check if the file is in the original hashlist.dat file.
-    auto it = files.find(shortComp);
+    auto it = previousFiles.find(job.shortComp);
 
-    // If the file is in the base, remove the entry.
-    if (files.end() != it) {
-      delete it->second;
+    if (previousFiles.end() != it) {
+      job.previous = it->second;
+    }
+
+    jobs.push_back(job);
+  }
+
+  // Compress and hash the files across all worker threads. Each worker only
+  // holds one file in memory at a time.
+  std::atomic<size_t> nextJob(0);
+  std::atomic<bool> failed(false);
+
+  std::vector<std::thread> workers;
+
+  for (unsigned int i = 0; i < jobCount; i++) {
+    workers.push_back(std::thread([&]() {
+      size_t idx;
+
+      while (!failed && (idx = nextJob++) < jobs.size()) {
+        if (!CompressFile(jobs[idx], incremental)) {
+          std::cerr << "Failed to compress file: " << jobs[idx].file.C()
+                    << std::endl;
+
+          failed = true;
+        }
+      }
+    }));
+  }
+
+  for (auto &worker : workers) {
+    worker.join();
+  }
+
+  if (failed) {
+    return -1;
+  }
+
+  // Merge the results in the same order the files were found.
+  size_t totalBytes = 0;
+  size_t skippedCount = 0;
+
+  for (auto &job : jobs) {
+    totalBytes += job.bytesRead;
+
+    if (job.skipped) {
+      skippedCount++;
     }
 
-    it = files.find(shortName);
+    auto it = files.find(job.shortName);
 
     if (files.end() != it) {
       delete it->second;
@@ -181,57 +395,42 @@ int main(int argc, char *argv[]) {
       files.erase(it);
     }
 
-    // Create a new entry for the file.
-    FileData *d = new FileData;
-    d->path = shortComp;
-
-    // Get the original file contents.
-    std::vector<char> uncomp_data = libcomp::Crypto::LoadFile(file.ToUtf8());
-
     // Ignore empty files
-    if (uncomp_data.empty()) {
+    if (!job.result) {
       continue;
     }
 
-    // Hash the original file.
-    d->uncompressed_hash = libcomp::Crypto::MD5(uncomp_data).ToUpper();
-    d->uncompressed_size = (int)uncomp_data.size();
-
-    //
-    // Process the compressed copy now.
-    //
+    // If the file is in the base, replace the entry.
+    it = files.find(job.shortComp);
 
-    // Calculate max size.
-    int out_size = (int)((float)uncomp_data.size() * 0.001f + 0.5f);
-    out_size += (int32_t)uncomp_data.size() + 12;
-
-    char *out_buffer = new char[(size_t)out_size];
+    if (files.end() != it) {
+      delete it->second;
+    }
 
-    // Compress the file.
-    int32_t sz = libcomp::Compress::Compress(
-        &uncomp_data[0], out_buffer, (int32_t)uncomp_data.size(), out_size, 9);
+    // Save the entry.
+    files[job.shortComp] = job.result;
+  }
 
-    // Write the compressed copy
-    {
-      std::ofstream file_comp;
-      file_comp.open(libcomp::String(file + ".compressed").C(),
-                     std::ofstream::binary);
-      file_comp.write(out_buffer, (std::streamsize)sz);
-      file_comp.close();
-    }
+  for (auto &file : previousFiles) {
+    delete file.second;
+  }
 
-    // Get the hash for the compressed copy.
-    d->compressed_hash =
-        libcomp::Crypto::MD5(std::vector<char>(out_buffer, out_buffer + sz))
-            .ToUpper();
-    d->compressed_size = sz;
+  double elapsed = std::chrono::duration<double>(
+                       std::chrono::steady_clock::now() - startTime)
+                       .count();
 
-    // Save the entry.
-    files[shortComp] = d;
+  std::cout << "Processed " << jobs.size() << " file(s) ("
+            << skippedCount << " unchanged) using " << jobCount
+            << " thread(s) in " << elapsed << " second(s)";
 
-    delete[] out_buffer;
+  if (0.0 < elapsed) {
+    std::cout << " at "
+              << ((double)totalBytes / (1024.0 * 1024.0)) / elapsed
+              << " MB/s";
   }
 
+  std::cout << std::endl;
+
   // Write the overlay hashlist.dat file now.
   std::ofstream hashlist;
   hashlist.open(libcomp::String("%1/hashlist.dat").Arg(overlay).C(),
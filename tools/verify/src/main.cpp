@@ -25,8 +25,17 @@
 // Standard C++11 Includes
 #include <fstream>
 #include <iostream>
+#include <list>
+#include <map>
+#include <mutex>
+#include <set>
+#include <sstream>
+
+// Standard C Includes
+#include <cstdio>
 
 // libcomp Includes
+#include <Crypto.h>
 #include <DataStore.h>
 #include <DefinitionManager.h>
 #include <Log.h>
@@ -48,7 +57,9 @@ int UsageMisc(const char *szAppName) {
 
 int Usage(const char *szAppName, const char *mode) {
   if (mode == std::string("server_data")) {
-    std::cerr << "USAGE: " << szAppName << " server_data MODE LEVEL STORE"
+    std::cerr << "USAGE: " << szAppName
+              << " server_data MODE LEVEL [--jobs N] [--report REPORT] "
+                 "[--state STATE] STORE..."
               << std::endl;
     std::cerr << std::endl;
     std::cerr << "MODE indicates if (0) startup errors only should be checked "
@@ -58,6 +69,16 @@ int Usage(const char *szAppName, const char *mode) {
         << "LEVEL indicates the log levels to print. Levels include DEBUG, "
            "INFO, WARNING and ERROR. CRITICAL levels will always print."
         << std::endl;
+    std::cerr << "N is the number of threads to run the integrity checks on "
+                 "(default: one per hardware thread)."
+              << std::endl;
+    std::cerr << "REPORT is a file to write a JSON report of the checks and "
+                 "the logged messages to."
+              << std::endl;
+    std::cerr << "STATE is a file used to remember the datastore file hashes "
+                 "and check results between runs. Checks that passed last "
+                 "time and only read unchanged files are skipped."
+              << std::endl;
     std::cerr
         << "STORE indicates a list of paths to use when loading the datastore."
         << std::endl;
@@ -66,6 +87,175 @@ int Usage(const char *szAppName, const char *mode) {
   return EXIT_FAILURE;
 }
 
+/**
+ * Escape a string for use as a JSON string value.
+ * @param str String to escape
+ * @return Escaped string without the surrounding quotes
+ */
+std::string JsonEscape(const std::string &str) {
+  std::ostringstream ss;
+
+  for (char c : str) {
+    switch (c) {
+      case '"':
+        ss << "\\\"";
+        break;
+      case '\\':
+        ss << "\\\\";
+        break;
+      case '\n':
+        ss << "\\n";
+        break;
+      case '\r':
+        ss << "\\r";
+        break;
+      case '\t':
+        ss << "\\t";
+        break;
+      default:
+        if ((unsigned char)c < 0x20) {
+          char szEscape[8];
+          snprintf(szEscape, sizeof(szEscape), "\\u%04x", (unsigned char)c);
+          ss << szEscape;
+        } else {
+          ss << c;
+        }
+        break;
+    }
+  }
+
+  return ss.str();
+}
+
+/**
+ * Hash every file in the datastore.
+ * @param datastore Datastore to hash the files of
+ * @return Map of datastore path to file hash
+ */
+std::map<libcomp::String, libcomp::String> HashDataStore(
+    libcomp::DataStore &datastore) {
+  std::map<libcomp::String, libcomp::String> hashes;
+
+  std::list<libcomp::String> files;
+  std::list<libcomp::String> dirs;
+  std::list<libcomp::String> symLinks;
+
+  (void)datastore.GetListing("/", files, dirs, symLinks, true, true);
+
+  for (auto &path : files) {
+    hashes[path] = libcomp::Crypto::MD5(datastore.ReadFile(path));
+  }
+
+  return hashes;
+}
+
+/**
+ * Load the file hashes and check results from the last run.
+ * @param path Path to the state file
+ * @param hashes Output map of datastore path to file hash
+ * @param passed Output set of checks that passed
+ * @return true if the state file was loaded
+ */
+bool LoadState(const std::string &path,
+               std::map<libcomp::String, libcomp::String> &hashes,
+               std::set<libcomp::String> &passed) {
+  std::ifstream in(path);
+
+  if (!in.good()) {
+    return false;
+  }
+
+  std::string line;
+
+  while (std::getline(in, line)) {
+    std::istringstream ss(line);
+    std::string type, value, name;
+
+    ss >> type >> value;
+    std::getline(ss >> std::ws, name);
+
+    if (type == "file") {
+      hashes[name] = value;
+    } else if (type == "check" && value == "pass") {
+      passed.insert(name);
+    }
+  }
+
+  return true;
+}
+
+/**
+ * Save the file hashes and check results for the next run.
+ * @param path Path to the state file
+ * @param hashes Map of datastore path to file hash
+ * @param checks Checks that were run or skipped
+ * @return true if the state file was saved
+ */
+bool SaveState(
+    const std::string &path,
+    const std::map<libcomp::String, libcomp::String> &hashes,
+    const std::list<std::shared_ptr<libhack::ServerDataCheck>> &checks) {
+  std::ofstream out(path);
+
+  for (auto &pair : hashes) {
+    out << "file " << pair.second.C() << " " << pair.first.C() << std::endl;
+  }
+
+  for (auto &check : checks) {
+    out << "check " << (check->Valid ? "pass" : "fail") << " "
+        << check->Name.C() << std::endl;
+  }
+
+  return out.good();
+}
+
+/**
+ * Write the JSON report of a server_data verification.
+ * @param path Path to the report file
+ * @param valid If the server data is valid
+ * @param checks Checks that were run or skipped
+ * @param messages Messages logged as level name and message pairs
+ * @return true if the report was written
+ */
+bool WriteReport(
+    const std::string &path, bool valid,
+    const std::list<std::shared_ptr<libhack::ServerDataCheck>> &checks,
+    const std::list<std::pair<std::string, libcomp::String>> &messages) {
+  std::ofstream out(path);
+
+  out << "{" << std::endl;
+  out << "  \"valid\": " << (valid ? "true" : "false") << "," << std::endl;
+  out << "  \"checks\": [";
+
+  bool first = true;
+  for (auto &check : checks) {
+    out << (first ? "" : ",") << std::endl;
+    out << "    {\"name\": \"" << JsonEscape(check->Name.ToUtf8())
+        << "\", \"status\": \""
+        << (check->Skip ? "skipped" : (check->Valid ? "passed" : "failed"))
+        << "\", \"duration_us\": " << check->Duration << "}";
+
+    first = false;
+  }
+
+  out << std::endl << "  ]," << std::endl;
+  out << "  \"messages\": [";
+
+  first = true;
+  for (auto &msg : messages) {
+    out << (first ? "" : ",") << std::endl;
+    out << "    {\"level\": \"" << msg.first << "\", \"message\": \""
+        << JsonEscape(msg.second.Trimmed().ToUtf8()) << "\"}";
+
+    first = false;
+  }
+
+  out << std::endl << "  ]" << std::endl;
+  out << "}" << std::endl;
+
+  return out.good();
+}
+
 int VerifyServerData(int argc, char *argv[]) {
   if (argc < 5) {
     return Usage(argv[0], argv[1]);
@@ -87,6 +277,34 @@ int VerifyServerData(int argc, char *argv[]) {
     return Usage(argv[0], argv[1]);
   }
 
+  size_t jobCount = 0;
+  std::string reportPath;
+  std::string statePath;
+  std::list<std::string> storePaths;
+
+  for (int i = 4; i < argc; i++) {
+    std::string arg = argv[i];
+
+    if (arg == "--jobs" && (i + 1) < argc) {
+      bool ok = false;
+      jobCount = libcomp::String(argv[++i]).ToInteger<size_t>(&ok);
+
+      if (!ok) {
+        return Usage(argv[0], argv[1]);
+      }
+    } else if (arg == "--report" && (i + 1) < argc) {
+      reportPath = argv[++i];
+    } else if (arg == "--state" && (i + 1) < argc) {
+      statePath = argv[++i];
+    } else {
+      storePaths.push_back(arg);
+    }
+  }
+
+  if (storePaths.empty()) {
+    return Usage(argv[0], argv[1]);
+  }
+
   log->SetLogLevel(to_underlying(libcomp::BaseLogComponent_t::General),
                    logLevel);
   log->SetLogLevel(to_underlying(libhack::LogComponent_t::DefinitionManager),
@@ -96,16 +314,54 @@ int VerifyServerData(int argc, char *argv[]) {
 
   log->AddStandardOutputHook();
 
+  // Collect the messages for the report. Checks log from every worker
+  // thread so access to the list is locked.
+  std::mutex messageLock;
+  std::list<std::pair<std::string, libcomp::String>> messages;
+
+  if (!reportPath.empty()) {
+    log->AddLogHook([&](libcomp::GenericLogComponent_t comp,
+                        libcomp::BaseLog::Level_t level,
+                        const libcomp::String &msg) {
+      (void)comp;
+
+      std::string levelName;
+      switch (level) {
+        case libcomp::BaseLog::Level_t::LOG_LEVEL_DEBUG:
+          levelName = "DEBUG";
+          break;
+        case libcomp::BaseLog::Level_t::LOG_LEVEL_INFO:
+          levelName = "INFO";
+          break;
+        case libcomp::BaseLog::Level_t::LOG_LEVEL_WARNING:
+          levelName = "WARNING";
+          break;
+        case libcomp::BaseLog::Level_t::LOG_LEVEL_ERROR:
+          levelName = "ERROR";
+          break;
+        case libcomp::BaseLog::Level_t::LOG_LEVEL_CRITICAL:
+        default:
+          levelName = "CRITICAL";
+          break;
+      }
+
+      std::lock_guard<std::mutex> lock(messageLock);
+      messages.push_back(std::make_pair(levelName, msg));
+    });
+  }
+
   bool fail = false;
 
   libcomp::DataStore datastore(argv[0]);
 
-  for (int i = 4; i < argc; i++) {
-    if (!datastore.AddSearchPath(argv[i])) {
+  for (auto &path : storePaths) {
+    if (!datastore.AddSearchPath(path)) {
       fail = true;
     }
   }
 
+  std::list<std::shared_ptr<libhack::ServerDataCheck>> checks;
+
   if (!fail) {
     libhack::DefinitionManager definitionManager;
     libhack::ServerDataManager serverDataManager;
@@ -113,9 +369,75 @@ int VerifyServerData(int argc, char *argv[]) {
     if (!definitionManager.LoadAllData(&datastore) ||
         !serverDataManager.LoadData(&datastore, &definitionManager)) {
       fail = true;
-    } else if (argv[2] == std::string("1") &&
-               !serverDataManager.VerifyDataIntegrity(&definitionManager)) {
-      fail = true;
+    } else if (argv[2] == std::string("1")) {
+      checks = serverDataManager.GetIntegrityChecks(&definitionManager);
+
+      std::map<libcomp::String, libcomp::String> hashes;
+
+      if (!statePath.empty()) {
+        std::map<libcomp::String, libcomp::String> lastHashes;
+        std::set<libcomp::String> lastPassed;
+
+        hashes = HashDataStore(datastore);
+
+        if (LoadState(statePath, lastHashes, lastPassed)) {
+          // Gather every file added, changed or removed since the last run.
+          std::set<libcomp::String> changed;
+
+          for (auto &pair : hashes) {
+            auto it = lastHashes.find(pair.first);
+            if (it == lastHashes.end() || it->second != pair.second) {
+              changed.insert(pair.first);
+            }
+          }
+
+          for (auto &pair : lastHashes) {
+            if (hashes.find(pair.first) == hashes.end()) {
+              changed.insert(pair.first);
+            }
+          }
+
+          for (auto &check : checks) {
+            if (lastPassed.find(check->Name) == lastPassed.end()) {
+              continue;
+            }
+
+            bool dirty = false;
+            for (auto &path : changed) {
+              for (auto &prefix : check->Paths) {
+                if (path.Mid(0, prefix.Length()) == prefix) {
+                  dirty = true;
+                  break;
+                }
+              }
+
+              if (dirty) {
+                break;
+              }
+            }
+
+            check->Skip = !dirty;
+          }
+        }
+      }
+
+      if (!libhack::ServerDataManager::RunIntegrityChecks(checks, jobCount)) {
+        fail = true;
+      }
+
+      if (!statePath.empty() && !SaveState(statePath, hashes, checks)) {
+        std::cerr << "Failed to save the state file: " << statePath
+                  << std::endl;
+      }
+    }
+  }
+
+  if (!reportPath.empty()) {
+    std::lock_guard<std::mutex> lock(messageLock);
+
+    if (!WriteReport(reportPath, !fail, checks, messages)) {
+      std::cerr << "Failed to write the report file: " << reportPath
+                << std::endl;
     }
   }
 